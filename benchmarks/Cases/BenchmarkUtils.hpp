@@ -0,0 +1,28 @@
+#pragma once
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace LiveProfilerBenchmarks {
+	namespace {
+		/**
+		 * Run func for the specified times and print the average time per operation,
+		 * func should return a value depends on the work to prevent it from being optimized out.
+		 * Return nanoseconds per operation.
+		 */
+		template <class Func>
+		double measure(const std::string& name, std::size_t iterations, std::size_t operations, const Func& func) {
+			std::size_t checksum = 0;
+			auto start = std::chrono::high_resolution_clock::now();
+			for (std::size_t i = 0; i < iterations; ++i) {
+				checksum += static_cast<std::size_t>(func());
+			}
+			auto elapsed = std::chrono::high_resolution_clock::now() - start;
+			double nanoseconds = std::chrono::duration<double, std::nano>(elapsed).count();
+			double result = nanoseconds / (static_cast<double>(iterations) * operations);
+			std::printf("  %-48s %10.2f ns/op (checksum %zu)\n", name.c_str(), result, checksum);
+			return result;
+		}
+	}
+}
+
@@ -0,0 +1,83 @@
+#include <iostream>
+#include <random>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <LiveProfiler/Utils/Containers/StaticSearchTree.hpp>
+#include "../../BenchmarkUtils.hpp"
+
+namespace LiveProfilerBenchmarks {
+	using namespace LiveProfiler;
+
+	namespace {
+		/** Symbol entry stored by shared_ptr, like the symbol tables before LinuxSymbolTable */
+		struct PointerEntry {
+			std::size_t start;
+			std::size_t end;
+		};
+
+		void benchmarkStaticSearchTreeLookup(std::size_t symbolCount, std::size_t callChainSize) {
+			// symbols with random sizes, and random addresses inside the whole range
+			std::mt19937_64 generator(0x5eed);
+			std::vector<std::size_t> ends;
+			std::vector<std::shared_ptr<PointerEntry>> pointerEntries;
+			std::size_t address = 0x400000;
+			for (std::size_t i = 0; i < symbolCount; ++i) {
+				std::size_t size = 16 + generator() % 512;
+				pointerEntries.emplace_back(std::make_shared<PointerEntry>(PointerEntry({ address, address + size })));
+				address += size;
+				ends.emplace_back(address);
+			}
+			std::vector<std::size_t> values(1 << 16);
+			for (auto& value : values) {
+				value = 0x400000 + generator() % (address - 0x400000);
+			}
+			StaticSearchTree tree;
+			tree.assign(ends.size(), [&ends](auto index) { return ends[index]; });
+			std::vector<std::size_t> results(callChainSize);
+			std::cout << "upper bound on " << symbolCount << " symbols:" << std::endl;
+			auto pointerTime = measure("std::upper_bound on vector<shared_ptr>", 20, values.size(), [&] {
+				std::size_t sum = 0;
+				for (auto value : values) {
+					sum += static_cast<std::size_t>(std::upper_bound(
+						pointerEntries.begin(), pointerEntries.end(), value,
+						[](auto a, const auto& b) { return a < b->end; }) - pointerEntries.begin());
+				}
+				return sum;
+			});
+			auto vectorTime = measure("std::upper_bound on vector<size_t>", 20, values.size(), [&] {
+				std::size_t sum = 0;
+				for (auto value : values) {
+					sum += static_cast<std::size_t>(std::upper_bound(ends.begin(), ends.end(), value) - ends.begin());
+				}
+				return sum;
+			});
+			auto treeTime = measure("StaticSearchTree", 20, values.size(), [&] {
+				std::size_t sum = 0;
+				for (auto value : values) {
+					sum += tree.upperBound(value);
+				}
+				return sum;
+			});
+			auto batchTime = measure("StaticSearchTree batch of " + std::to_string(callChainSize), 20, values.size(), [&] {
+				std::size_t sum = 0;
+				for (std::size_t start = 0; start + callChainSize <= values.size(); start += callChainSize) {
+					tree.upperBound(values.data() + start, callChainSize, results.data());
+					for (auto result : results) {
+						sum += result;
+					}
+				}
+				return sum;
+			});
+			std::printf("  speedup: %.2fx (vector<shared_ptr>), %.2fx (vector<size_t>), batch %.2fx (vector<size_t>)\n",
+				pointerTime / treeTime, vectorTime / treeTime, vectorTime / batchTime);
+		}
+	}
+
+	void benchmarkStaticSearchTree() {
+		std::cout << __func__ << std::endl;
+		benchmarkStaticSearchTreeLookup(10000, 32);
+		benchmarkStaticSearchTreeLookup(1000000, 32);
+	}
+}
+
@@ -0,0 +1,85 @@
+#if defined(__linux__)
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <LiveProfiler/Utils/Allocators/SingletonAllocator.hpp>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxExecutableSymbolResolverAllocator.hpp>
+#include "../../../BenchmarkUtils.hpp"
+
+namespace LiveProfilerBenchmarks {
+	using namespace LiveProfiler;
+
+	namespace {
+		/** Build mappings like a process loaded the shared libraries in the directory, up to `maxCount` */
+		std::vector<LinuxProcessAddressMap> buildMaps(
+			const std::string& directory,
+			std::size_t maxCount,
+			const std::shared_ptr<SingletonAllocator<std::string, std::string>>& pathAllocator) {
+			std::vector<LinuxProcessAddressMap> maps;
+			auto* dir = ::opendir(directory.c_str());
+			if (dir == nullptr) {
+				return maps;
+			}
+			std::uintptr_t address = 0x7f0000000000;
+			struct ::stat st;
+			while (auto* entry = ::readdir(dir)) {
+				std::string name(entry->d_name);
+				auto path = directory + "/" + name;
+				if (name.find(".so") == std::string::npos ||
+					::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+					continue;
+				}
+				auto size = static_cast<std::uintptr_t>(st.st_size);
+				maps.emplace_back(address, address + size, 0, pathAllocator->allocate(path),
+					static_cast<std::uint64_t>(st.st_dev), static_cast<std::uint64_t>(st.st_ino));
+				address += (size + 0xfff) & ~static_cast<std::uintptr_t>(0xfff);
+				if (maps.size() >= maxCount) {
+					break;
+				}
+			}
+			::closedir(dir);
+			return maps;
+		}
+
+		/** Load all mapped files with a new allocator, return how many resolvers are loaded */
+		std::size_t preload(std::vector<LinuxProcessAddressMap>& maps, std::size_t workerCount) {
+			std::vector<std::pair<pid_t, LinuxProcessAddressMap*>> pairs;
+			for (auto& map : maps) {
+				map.setResolver(nullptr);
+				pairs.emplace_back(::getpid(), &map);
+			}
+			LinuxExecutableSymbolResolverAllocator allocator;
+			return allocator.preload(pairs, workerCount);
+		}
+	}
+
+	void benchmarkLinuxExecutableSymbolResolverAllocator() {
+		std::cout << __func__ << std::endl;
+		auto pathAllocator = std::make_shared<SingletonAllocator<std::string, std::string>>();
+		auto maps = buildMaps("/usr/lib/x86_64-linux-gnu", 200, pathAllocator);
+		// the first run reads files into page cache
+		auto fileCount = preload(maps, 1);
+		if (fileCount == 0) {
+			return;
+		}
+		std::size_t threadCount = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+		std::cout << "preload " << fileCount << " files, " << threadCount << " hardware threads:" << std::endl;
+		auto serialTime = measure("1 worker", 3, fileCount,
+			[&] { return preload(maps, 1); });
+		auto parallelTime = measure(std::to_string(threadCount) + " workers", 3, fileCount,
+			[&] { return preload(maps, threadCount); });
+		std::printf("  speedup: %.2fx\n", serialTime / parallelTime);
+	}
+}
+#else // defined(__linux__)
+namespace LiveProfilerBenchmarks {
+	void benchmarkLinuxExecutableSymbolResolverAllocator() {
+		// unsupported on other platform
+	}
+}
+#endif // defined(__linux__)
+
@@ -0,0 +1,134 @@
+#if defined(__linux__)
+#include <unistd.h>
+#include <cstdio>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <LiveProfiler/Utils/StringUtils.hpp>
+#include <LiveProfiler/Utils/TypeConvertUtils.hpp>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxPerfMapIndex.hpp>
+#include "../../../BenchmarkUtils.hpp"
+
+namespace LiveProfilerBenchmarks {
+	using namespace LiveProfiler;
+
+	namespace {
+		using SymbolNameAllocatorType = SingletonAllocator<std::string, SymbolName>;
+
+		/** Append lines like a jit runtime, addresses are mostly increasing but not sorted */
+		void appendLines(const std::string& path, std::size_t& lineIndex, std::size_t count) {
+			std::ofstream file(path, std::ios::app);
+			char line[256];
+			for (std::size_t i = 0; i < count; ++i, ++lineIndex) {
+				std::size_t address = 0x7f0000000000 + (lineIndex ^ 0x3f) * 0x100;
+				std::snprintf(line, sizeof(line),
+					"%zx %x void [System.Private.CoreLib] System.Benchmark.Method%zu(int32, class System.String)\n",
+					address, 0x80 + static_cast<unsigned>(lineIndex % 0x40), lineIndex);
+				file << line;
+			}
+		}
+
+		/** The previous index, read appended lines with ifstream and sort all symbols after each read */
+		class PreviousPerfMapIndex {
+		public:
+			std::size_t update() {
+				std::ifstream file(*path_);
+				file.seekg(lastReadOffset_);
+				while (std::getline(file, line_) && !file.eof()) {
+					lastReadOffset_ = file.tellg();
+					std::uintptr_t startAddress = 0;
+					std::size_t symbolSize = 0;
+					std::string functionName;
+					StringUtils::split(line_,
+						[this, &startAddress, &symbolSize, &functionName]
+						(auto startIndex, auto, auto count) {
+						if (count == 0) {
+							unsigned long long startAddressL = 0;
+							if (TypeConvertUtils::strToUnsignedLongLong(
+								line_.c_str() + startIndex, startAddressL, 16)) {
+								startAddress = static_cast<std::uintptr_t>(startAddressL);
+							}
+						} else if (count == 1) {
+							unsigned long long symbolSizeL = 0;
+							if (TypeConvertUtils::strToUnsignedLongLong(
+								line_.c_str() + startIndex, symbolSizeL, 16)) {
+								symbolSize = static_cast<std::size_t>(symbolSizeL);
+							}
+						} else if (count == 2) {
+							functionName.assign(line_, startIndex, line_.size() - startIndex);
+						}
+					});
+					if (startAddress != 0 && symbolSize != 0 && !functionName.empty()) {
+						auto symbolName = symbolNameAllocator_->allocate(std::move(functionName), path_);
+						symbolNames_.emplace_back(Entry({ std::move(symbolName),
+							static_cast<std::size_t>(startAddress),
+							static_cast<std::size_t>(startAddress) + symbolSize }));
+					}
+				}
+				std::sort(symbolNames_.begin(), symbolNames_.end(), [](auto& a, auto& b) {
+					return a.end < b.end;
+				});
+				return symbolNames_.size();
+			}
+
+			PreviousPerfMapIndex(const std::string& path) :
+				path_(std::make_shared<std::string>(path)),
+				symbolNameAllocator_(std::make_shared<SymbolNameAllocatorType>()),
+				symbolNames_(),
+				line_(),
+				lastReadOffset_(0) { }
+
+		protected:
+			struct Entry {
+				std::shared_ptr<SymbolName> symbolName;
+				std::size_t start;
+				std::size_t end;
+			};
+			std::shared_ptr<std::string> path_;
+			std::shared_ptr<SymbolNameAllocatorType> symbolNameAllocator_;
+			std::vector<Entry> symbolNames_;
+			std::string line_;
+			std::size_t lastReadOffset_;
+		};
+
+		void benchmarkLinuxPerfMapIndexUpdate(std::size_t initialLines, std::size_t appendLinesPerUpdate) {
+			auto path = "/tmp/LiveProfilerBenchmarkPerfMap-" + std::to_string(::getpid()) + ".map";
+			::unlink(path.c_str());
+			std::size_t lineIndex = 0;
+			appendLines(path, lineIndex, initialLines);
+			PreviousPerfMapIndex previousIndex(path);
+			LinuxPerfMapIndex index;
+			index.reset(path, std::make_shared<std::string>("perfmap"), std::make_shared<SymbolNameAllocatorType>());
+			previousIndex.update();
+			index.update();
+			assert(index.size() == initialLines);
+			std::cout << "append " << appendLinesPerUpdate << " lines to " << initialLines << " lines:" << std::endl;
+			auto previousTime = measure("ifstream + getline + sort all", 10, appendLinesPerUpdate, [&] {
+				appendLines(path, lineIndex, appendLinesPerUpdate);
+				return previousIndex.update();
+			});
+			auto time = measure("pread + memchr + sort new + merge runs", 10, appendLinesPerUpdate, [&] {
+				appendLines(path, lineIndex, appendLinesPerUpdate);
+				return index.update();
+			});
+			std::printf("  speedup: %.2fx (runs: %zu)\n", previousTime / time, index.getRunCount());
+			::unlink(path.c_str());
+		}
+	}
+
+	void benchmarkLinuxPerfMapIndex() {
+		std::cout << __func__ << std::endl;
+		benchmarkLinuxPerfMapIndexUpdate(100000, 1000);
+		benchmarkLinuxPerfMapIndexUpdate(1000000, 1000);
+	}
+}
+#else // defined(__linux__)
+namespace LiveProfilerBenchmarks {
+	void benchmarkLinuxPerfMapIndex() {
+		// unsupported on other platform
+	}
+}
+#endif // defined(__linux__)
+
@@ -0,0 +1,115 @@
+#if defined(__linux__)
+#include <unistd.h>
+#include <cstdio>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxFileUtils.hpp>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxProcessAddressMap.hpp>
+#include "../../../BenchmarkUtils.hpp"
+
+namespace LiveProfilerBenchmarks {
+	using namespace LiveProfiler;
+
+	namespace {
+		using PathAllocatorType = SingletonAllocator<std::string, std::string>;
+
+		/** Write a maps file like a process loaded many shared libraries, each library has 4 lines */
+		void writeMaps(const std::string& path, std::size_t libraryCount) {
+			static const char* permissions[] = { "r--p", "r-xp", "r--p", "rw-p" };
+			std::ofstream file(path);
+			std::uintptr_t address = 0x7f0000000000;
+			char line[256];
+			for (std::size_t i = 0; i < libraryCount; ++i) {
+				for (std::size_t j = 0; j < 4; ++j) {
+					std::snprintf(line, sizeof(line),
+						"%012lx-%012lx %s %08lx fd:01 %-10zu                 /usr/lib/x86_64-linux-gnu/libbenchmark%zu.so.1\n",
+						static_cast<unsigned long>(address),
+						static_cast<unsigned long>(address + 0x1000 * (j + 1)),
+						permissions[j],
+						static_cast<unsigned long>(0x1000 * j),
+						1000000 + i,
+						i);
+					file << line;
+					address += 0x1000 * (j + 1);
+				}
+				// anonymous mapping between libraries
+				std::snprintf(line, sizeof(line), "%012lx-%012lx rw-p 00000000 00:00 0 \n",
+					static_cast<unsigned long>(address), static_cast<unsigned long>(address + 0x2000));
+				file << line;
+				address += 0x2000;
+			}
+		}
+
+		/** The previous parser, read line by line with ifstream and parse each line with split and strtoull */
+		std::size_t parseByLines(
+			const std::string& path,
+			const std::shared_ptr<PathAllocatorType>& pathAllocator,
+			std::string& line,
+			std::vector<LinuxProcessAddressMap>& maps) {
+			std::ifstream file(path);
+			LinuxProcessAddressMap map;
+			maps.clear();
+			while (std::getline(file, line)) {
+				if (map.parseLine(line, pathAllocator)) {
+					maps.emplace_back(std::move(map));
+				}
+			}
+			return maps.size();
+		}
+
+		/** The bulk parser, read the whole file into buffer and parse it in memory */
+		std::size_t parseInBulk(
+			const std::string& path,
+			const std::shared_ptr<PathAllocatorType>& pathAllocator,
+			std::string& buffer,
+			std::vector<LinuxProcessAddressMap>& maps) {
+			maps.clear();
+			if (LinuxFileUtils::readFile(path.c_str(), buffer)) {
+				LinuxProcessAddressMap::parseMaps(
+					buffer.data(), buffer.data() + buffer.size(), pathAllocator, maps);
+			}
+			return maps.size();
+		}
+
+		void benchmarkLinuxProcessAddressMapParse(const std::string& path, std::size_t iterations) {
+			auto pathAllocator = std::make_shared<PathAllocatorType>();
+			std::string buffer;
+			std::vector<LinuxProcessAddressMap> lineMaps;
+			std::vector<LinuxProcessAddressMap> bulkMaps;
+			// both parsers should produce the same result
+			parseByLines(path, pathAllocator, buffer, lineMaps);
+			parseInBulk(path, pathAllocator, buffer, bulkMaps);
+			assert(lineMaps.size() == bulkMaps.size());
+			for (std::size_t i = 0; i < lineMaps.size(); ++i) {
+				assert(lineMaps[i].getStartAddress() == bulkMaps[i].getStartAddress());
+				assert(lineMaps[i].getEndAddress() == bulkMaps[i].getEndAddress());
+				assert(lineMaps[i].getFileOffset() == bulkMaps[i].getFileOffset());
+			}
+			std::cout << path << " (" << lineMaps.size() << " lines):" << std::endl;
+			auto lineTime = measure("ifstream + getline + split + strtoull", iterations, lineMaps.size(),
+				[&] { return parseByLines(path, pathAllocator, buffer, lineMaps); });
+			auto bulkTime = measure("read + memchr + hex decode", iterations, bulkMaps.size(),
+				[&] { return parseInBulk(path, pathAllocator, buffer, bulkMaps); });
+			std::printf("  speedup: %.2fx\n", lineTime / bulkTime);
+		}
+	}
+
+	void benchmarkLinuxProcessAddressMap() {
+		std::cout << __func__ << std::endl;
+		auto path = "/tmp/LiveProfilerBenchmarkMaps-" + std::to_string(::getpid());
+		writeMaps(path, 10000);
+		benchmarkLinuxProcessAddressMapParse(path, 20);
+		::unlink(path.c_str());
+		benchmarkLinuxProcessAddressMapParse("/proc/self/maps", 2000);
+	}
+}
+#else // defined(__linux__)
+namespace LiveProfilerBenchmarks {
+	void benchmarkLinuxProcessAddressMap() {
+		// unsupported on other platform
+	}
+}
+#endif // defined(__linux__)
+
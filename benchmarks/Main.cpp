@@ -0,0 +1,19 @@
+#include "./Cases/Utils/Containers/BenchmarkStaticSearchTree.hpp"
+#include "./Cases/Utils/Platform/Linux/BenchmarkLinuxExecutableSymbolResolverAllocator.hpp"
+#include "./Cases/Utils/Platform/Linux/BenchmarkLinuxPerfMapIndex.hpp"
+#include "./Cases/Utils/Platform/Linux/BenchmarkLinuxProcessAddressMap.hpp"
+
+namespace LiveProfilerBenchmarks {
+	void benchmarkAll() {
+		benchmarkStaticSearchTree();
+		benchmarkLinuxExecutableSymbolResolverAllocator();
+		benchmarkLinuxPerfMapIndex();
+		benchmarkLinuxProcessAddressMap();
+	}
+}
+
+int main() {
+	LiveProfilerBenchmarks::benchmarkAll();
+	return 0;
+}
+
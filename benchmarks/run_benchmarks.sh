@@ -0,0 +1,18 @@
+#!/usr/bin/env bash
+# Benchmarks compare the current implementation with the previous one,
+# the numbers are only meaningful on the same machine
+# ###################################################################
+set -e
+
+IS_LINUX="$(uname | grep Linux || true)"
+
+if [ -z "${IS_LINUX}" ]; then
+	echo "Benchmarks only support linux"
+	exit 1
+fi
+
+mkdir -p Build
+cd Build
+cmake -DCMAKE_SYSTEM_NAME="Linux" ../
+make
+./LiveProfilerBenchmark
@@ -10,6 +10,8 @@ namespace LiveProfiler {
 	 * There two different rankings:
 	 * Top Inclusive Symbol Names: The functions that uses the most cpu, include the functions it called
 	 * Top Exclusive Symbol Names: The functions that uses the most cpu, not include the functions it called
+	 * Placeholder symbol names are merged into their resolved symbol names when generating the result,
+	 * placeholders with a binder (raw addresses) are resolved in bulk at that time.
 	 */
 	class CpuSampleFrequencyAnalyzer : public BaseAnalyzer<CpuSampleModel> {
 	public:
@@ -22,6 +24,7 @@ namespace LiveProfiler {
 			topInclusiveSymbolNames_.clear();
 			topExclusiveSymbolNames_.clear();
 			totalSampleCount_ = 0;
+			hasPlaceholders_ = false;
 		}
 
 		/** Receive performance data */
@@ -44,13 +47,52 @@ namespace LiveProfiler {
 			inclusiveTraceLevel_ = inclusiveTraceLevel;
 		}
 
+		/** Merge counts of resolved placeholders into their resolved symbol names */
+		void backfill() {
+			if (!hasPlaceholders_) {
+				return;
+			}
+			// resolve placeholders that waiting for binding, each distinct key once
+			placeholders_.clear();
+			for (const auto& pair : counts_) {
+				if (pair.first->isPending() && pair.first->getBinder() != nullptr) {
+					placeholders_.emplace_back(pair.first);
+				}
+			}
+			SymbolName::bindPlaceholders(placeholders_);
+			// merge resolved placeholders
+			hasPlaceholders_ = false;
+			placeholders_.clear();
+			for (const auto& pair : counts_) {
+				if (pair.first->isPending()) {
+					hasPlaceholders_ = true;
+				} else if (pair.first->isPlaceholder()) {
+					placeholders_.emplace_back(pair.first);
+				}
+			}
+			for (const auto& placeholder : placeholders_) {
+				auto it = counts_.find(placeholder);
+				auto count = it->second;
+				counts_.erase(it);
+				auto& resolved = placeholder->getResolved();
+				if (resolved != nullptr) {
+					auto& resolvedCount = counts_[resolved];
+					resolvedCount.inclusiveCount += count.inclusiveCount;
+					resolvedCount.exclusiveCount += count.exclusiveCount;
+				}
+			}
+			placeholders_.clear();
+		}
+
 		/** Constructor */
 		CpuSampleFrequencyAnalyzer() :
 			counts_(),
 			inclusiveTraceLevel_(DefaultInclusiveTraceLevel),
 			topInclusiveSymbolNames_(),
 			topExclusiveSymbolNames_(),
-			totalSampleCount_(0) { }
+			totalSampleCount_(0),
+			hasPlaceholders_(false),
+			placeholders_() { }
 
 	public:
 		using SymbolNameAndCountType = std::pair<std::shared_ptr<SymbolName>, std::size_t>;
@@ -80,6 +122,7 @@ namespace LiveProfiler {
 
 		/** Generate the result */
 		ResultType getResult(std::size_t topInclusive, std::size_t topExclusive) & {
+			backfill();
 			topInclusiveSymbolNames_.clear();
 			topExclusiveSymbolNames_.clear();
 			for (const auto& pair : counts_) {
@@ -120,8 +163,10 @@ namespace LiveProfiler {
 	protected:
 		/** Increase count for symbol name */
 		void countSymbolName(
-			const std::shared_ptr<SymbolName>& symbolName, bool inclusive) {
+			const std::shared_ptr<SymbolName>& lateBoundSymbolName, bool inclusive) {
+			auto& symbolName = SymbolName::resolveLateBound(lateBoundSymbolName);
 			if (symbolName != nullptr) {
+				hasPlaceholders_ |= symbolName->isPending();
 				auto& count = counts_[symbolName];
 				++count.inclusiveCount;
 				if (!inclusive) {
@@ -141,6 +186,8 @@ namespace LiveProfiler {
 		std::vector<SymbolNameAndCountType> topInclusiveSymbolNames_;
 		std::vector<SymbolNameAndCountType> topExclusiveSymbolNames_;
 		std::size_t totalSampleCount_;
+		bool hasPlaceholders_;
+		std::vector<std::shared_ptr<SymbolName>> placeholders_;
 	};
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 #include <unordered_map>
+#include <algorithm>
 #include "BaseAnalyzer.hpp"
 #include "../Models/CpuSampleModel.hpp"
 
@@ -13,6 +14,8 @@ namespace LiveProfiler {
 	 *     - C 25 (0.25)
 	 *     - D 5 (0.05)
 	 * The missing number means there are some samples have none symbol name.
+	 * Placeholder symbol names are merged into their resolved symbol names when generating the result,
+	 * placeholders with a binder (raw addresses) are resolved in bulk at that time.
 	 */
 	class CpuSampleHotPathAnalyzer : public BaseAnalyzer<CpuSampleModel> {
 	public:
@@ -20,6 +23,7 @@ namespace LiveProfiler {
 		void reset() override {
 			root_ = std::make_unique<NodeType>();
 			totalSampleCount_ = 0;
+			hasPlaceholders_ = false;
 		}
 
 		/** Receive performance data */
@@ -33,7 +37,9 @@ namespace LiveProfiler {
 		/** Constructor */
 		CpuSampleHotPathAnalyzer() :
 			root_(std::make_unique<NodeType>()),
-			totalSampleCount_(0) { }
+			totalSampleCount_(0),
+			hasPlaceholders_(false),
+			placeholders_() { }
 	
 	public:
 		/** Tree type represent the call path */
@@ -56,11 +62,77 @@ namespace LiveProfiler {
 				return it->second;
 			}
 
+			/** Merge the count and childs of other node into this node */
+			void merge(NodeType&& other) {
+				count_ += other.count_;
+				mergeChilds(std::move(other));
+			}
+
+			/** Recursively collect pending placeholders that have a binder */
+			void collectBindablePlaceholders(std::vector<std::shared_ptr<SymbolName>>& placeholders) const {
+				for (const auto& pair : childs_) {
+					if (pair.first->isPending() && pair.first->getBinder() != nullptr) {
+						placeholders.emplace_back(pair.first);
+					}
+					pair.second->collectBindablePlaceholders(placeholders);
+				}
+			}
+
+			/**
+			 * Recursively merge childs keyed by resolved placeholders into their resolved symbol names,
+			 * if the placeholder resolved to nullptr, it's childs are merged into this node.
+			 * Return whether there still pending placeholders.
+			 */
+			bool backfill() {
+				bool hasPending = false;
+				std::vector<std::pair<std::shared_ptr<SymbolName>, std::unique_ptr<NodeType>>> resolvedNodes;
+				do {
+					// take out the resolved nodes first, merging them may insert keys and invalidate the iterator,
+					// childs merged from placeholders resolved to nullptr may contain placeholders, so scan again
+					hasPending = false;
+					resolvedNodes.clear();
+					for (auto it = childs_.begin(); it != childs_.end();) {
+						if (!it->first->isPlaceholder() || it->first->isPending()) {
+							hasPending |= it->first->isPlaceholder();
+							++it;
+							continue;
+						}
+						resolvedNodes.emplace_back(it->first->getResolved(), std::move(it->second));
+						it = childs_.erase(it);
+					}
+					for (auto& pair : resolvedNodes) {
+						if (pair.first != nullptr) {
+							getChild(pair.first)->merge(std::move(*pair.second));
+						} else {
+							mergeChilds(std::move(*pair.second));
+						}
+					}
+				} while (!resolvedNodes.empty());
+				for (auto& pair : childs_) {
+					hasPending |= pair.second->backfill();
+				}
+				return hasPending;
+			}
+
 			/** Constructor */
 			NodeType() :
 				count_(0),
 				childs_() { }
 
+		protected:
+			/** Merge the childs of other node into this node */
+			void mergeChilds(NodeType&& other) {
+				for (auto& pair : other.childs_) {
+					auto it = childs_.find(pair.first);
+					if (it == childs_.end()) {
+						childs_.emplace(pair.first, std::move(pair.second));
+					} else {
+						it->second->merge(std::move(*pair.second));
+					}
+				}
+				other.childs_.clear();
+			}
+
 		protected:
 			std::size_t count_;
 			std::unordered_map<std::shared_ptr<SymbolName>, std::unique_ptr<NodeType>> childs_;
@@ -87,6 +159,16 @@ namespace LiveProfiler {
 
 		/** Generate the result */
 		ResultType getResult() {
+			if (hasPlaceholders_) {
+				// the same placeholder may appear in many paths, bind it only once
+				placeholders_.clear();
+				root_->collectBindablePlaceholders(placeholders_);
+				std::sort(placeholders_.begin(), placeholders_.end());
+				placeholders_.erase(std::unique(placeholders_.begin(), placeholders_.end()), placeholders_.end());
+				SymbolName::bindPlaceholders(placeholders_);
+				placeholders_.clear();
+				hasPlaceholders_ = root_->backfill();
+			}
 			return ResultType(root_, totalSampleCount_);
 		}
 
@@ -98,19 +180,22 @@ namespace LiveProfiler {
 			std::size_t index) {
 			if (index > 0) {
 				// symbol name in callchain
-				auto& symbolName = model->getCallChainSymbolNames()[index-1];
+				auto& symbolName = SymbolName::resolveLateBound(
+					model->getCallChainSymbolNames()[index-1]);
 				if (symbolName == nullptr) {
 					// continue to use this node, that mean a -> ? -> b will reduce to a -> b
 					countModel(node, model, index-1);
 				} else {
+					hasPlaceholders_ |= symbolName->isPending();
 					node->increaseCount();
 					countModel(node->getChild(symbolName), model, index-1);
 				}
 			} else {
 				// last symbol name
 				node->increaseCount();
-				auto& symbolName = model->getSymbolName();
+				auto& symbolName = SymbolName::resolveLateBound(model->getSymbolName());
 				if (symbolName != nullptr) {
+					hasPlaceholders_ |= symbolName->isPending();
 					node->getChild(symbolName)->increaseCount();
 				}
 			}
@@ -119,6 +204,8 @@ namespace LiveProfiler {
 	protected:
 		std::unique_ptr<NodeType> root_;
 		std::size_t totalSampleCount_;
+		bool hasPlaceholders_;
+		std::vector<std::shared_ptr<SymbolName>> placeholders_;
 	};
 }
 
@@ -1,15 +1,26 @@
 #pragma once
+#include <unistd.h>
 #include <linux/perf_event.h>
 #include <cassert>
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
 #include <unordered_map>
 #include "BaseCollector.hpp"
 #include "../Utils/Allocators/FreeListAllocator.hpp"
 #include "../Utils/Allocators/SingletonAllocator.hpp"
+#include "../Utils/Containers/SpscQueue.hpp"
+#include "../Utils/Platform/Linux/LinuxCgroupUtils.hpp"
+#include "../Utils/Platform/Linux/LinuxCpuUtils.hpp"
 #include "../Utils/Platform/Linux/LinuxEpollDescriptor.hpp"
 #include "../Utils/Platform/Linux/LinuxPerfEntry.hpp"
 #include "../Utils/Platform/Linux/LinuxPerfUtils.hpp"
+#include "../Utils/Platform/Linux/LinuxProcConnector.hpp"
+#include "../Utils/Platform/Linux/LinuxProcessFilter.hpp"
 #include "../Utils/Platform/Linux/LinuxProcessUtils.hpp"
 
 namespace LiveProfiler {
@@ -17,6 +28,21 @@ namespace LiveProfiler {
 	 * The base class for the collector that use perf_events on linux to monitor processes.
 	 * Child class should provide perfType, perfConfig, sampleType to base constructor.
 	 * Child class should implement function takeSamples.
+	 * Child class can set `recordMmap_` to receive PERF_RECORD_MMAP2 records in takeSamples.
+	 *
+	 * There two ways to decide what to monitor, they can be used together:
+	 * - Filter processes, it will scan /proc periodically and open one perf event per thread
+	 * - Monitor cgroups, it will open one perf event per cpu for each cgroup, without scanning /proc
+	 * When filtering processes, process events from netlink can be used to monitor new threads
+	 * immediately after they are created, then the periodic scan is just a safety net.
+	 *
+	 * By default all perf events are drained in the thread calling `collect`,
+	 * in sharded mode (see setShardCount) they are drained by worker threads pinned to cpus,
+	 * each worker owns an epoll instance and a model allocator, and handles a disjoint set of
+	 * perf events (by cpu for cgroup events, by tid otherwise), the batches from workers
+	 * are merged in `collect` through lock free queues, and models are returned to the worker
+	 * created them in the next `collect`.
+	 * Child class with sharded mode enabled should call `stopShards` in it's destructor.
 	 */
 	template <class Model>
 	class BasePerfLinuxCollector : public BaseCollector<Model> {
@@ -28,6 +54,14 @@ namespace LiveProfiler {
 		static const std::size_t DefaultSamplePeriod = 100000;
 		static const std::size_t DefaultMmapPageCount = 8;
 		static const std::size_t DefaultWakeupEvents = 8;
+		static const std::size_t DefaultMaxReopenPerCollect = 64;
+		static const std::size_t DefaultShardQueueSize = 256;
+		static const std::size_t DefaultShardWaitTimeout = 10;
+
+		/** Epoll data of cgroup perf events is this flag with the index in cgroupPerfEntries_ */
+		static const std::uint64_t CgroupEpollDataFlag = 0x8000000000000000;
+		/** Epoll data of the netlink proc connector */
+		static const std::uint64_t ProcessEventEpollData = 0x4000000000000000;
 
 		/** Reset the state to it's initial state */
 		void reset() override {
@@ -37,6 +71,26 @@ namespace LiveProfiler {
 			}
 			tidToPerfEntry_.clear();
 			threads_.clear();
+			// clear all monitoring cgroups
+			for (auto& entry : cgroupPerfEntries_) {
+				unmonitorThread(std::move(entry));
+			}
+			cgroupPerfEntries_.clear();
+			for (int fd : cgroupFds_) {
+				::close(fd);
+			}
+			cgroupFds_.clear();
+			// nothing to reopen
+			reopenTids_.clear();
+			reopenCgroupEntries_ = false;
+			// stop workers after they freed all entries retired above
+			stopShards();
+			// stop receiving process events
+			if (procConnector_.isOpened()) {
+				epoll_.del(procConnector_.getFd());
+				procConnector_.close();
+			}
+			processEvents_.clear();
 			// reset last threads updated time
 			threadsUpdated_ = {};
 			// reset enabled
@@ -51,6 +105,9 @@ namespace LiveProfiler {
 				assert(pair.second != nullptr);
 				LinuxPerfUtils::perfEventEnable(pair.second->getFd(), true);
 			}
+			for (auto& entry : cgroupPerfEntries_) {
+				LinuxPerfUtils::perfEventEnable(entry->getFd(), true);
+			}
 			// all newly monitored threads should call perfEventEnable
 			enabled_ = true;
 		}
@@ -58,25 +115,56 @@ namespace LiveProfiler {
 		/** Collect performance data for the specified timeout period */
 		std::vector<std::unique_ptr<Model>>& collect(
 			std::chrono::high_resolution_clock::duration timeout) & override {
-			// update the threads to monitor every specified interval
+			// start workers before any perf events opened
+			if (shardCount_ > 0 && shards_.empty() &&
+				tidToPerfEntry_.empty() && cgroupPerfEntries_.empty()) {
+				startShards();
+			}
 			auto now = std::chrono::high_resolution_clock::now();
 			if (now - threadsUpdated_ > threadsUpdateInterval_) {
+				updateProcConnector();
 				threads_.clear();
-				LinuxProcessUtils::listProcesses(threads_, filter_, true);
+				if (filter_) {
+					if (processFilter_ != nullptr) {
+						processFilter_->beginScan();
+					}
+					LinuxProcessUtils::listProcesses(threads_, filter_, true);
+				}
 				updatePerfEvents();
+				updateCgroupPerfEvents();
 				threadsUpdated_ = now;
 			}
 			// clear results
+			recycleShardResults();
 			for (auto& result : results_) {
 				resultAllocator_.deallocate(std::move(result));
 			}
 			results_.clear();
+			// apply changed attributes to monitoring threads gradually
+			reopenPerfEvents();
 			// poll events
 			if (timeout > threadsUpdateInterval_) {
 				timeout = threadsUpdateInterval_;
 			}
+			if (!shards_.empty() && timeout > shardWaitTimeout_) {
+				// perf events are polled by workers, don't delay their batches
+				timeout = shardWaitTimeout_;
+			}
 			auto& events = epoll_.wait(timeout);
 			for (auto& event : events) {
+				// process events from netlink
+				if (event.data.u64 == ProcessEventEpollData) {
+					handleProcessEvents();
+					continue;
+				}
+				// cgroup perf events are never closed while collecting
+				if ((event.data.u64 & CgroupEpollDataFlag) != 0) {
+					if ((event.events & EPOLLIN) == EPOLLIN) {
+						auto index = event.data.u64 & ~CgroupEpollDataFlag;
+						takeSamples(*cgroupPerfEntries_.at(index), results_, resultAllocator_);
+					}
+					continue;
+				}
 				// get entry by tid
 				pid_t tid = static_cast<pid_t>(event.data.u64);
 				auto it = tidToPerfEntry_.find(tid);
@@ -87,13 +175,15 @@ namespace LiveProfiler {
 				// check events
 				if ((event.events & EPOLLIN) == EPOLLIN) {
 					// take samples
-					takeSamples(it->second);
+					takeSamples(*it->second, results_, resultAllocator_);
 				} else if ((event.events & (EPOLLERR | EPOLLHUP)) != 0) {
 					// thread no longer exist
 					unmonitorThread(std::move(it->second));
 					tidToPerfEntry_.erase(it);
 				}
 			}
+			// merge batches from workers
+			mergeShardResults();
 			return results_;
 		}
 
@@ -104,6 +194,9 @@ namespace LiveProfiler {
 				assert(pair.second != nullptr);
 				LinuxPerfUtils::perfEventDisable(pair.second->getFd());
 			}
+			for (auto& entry : cgroupPerfEntries_) {
+				LinuxPerfUtils::perfEventDisable(entry->getFd());
+			}
 			// reset enabled
 			enabled_ = false;
 		}
@@ -118,20 +211,75 @@ namespace LiveProfiler {
 
 		/** Use the specified function to decide which processes to monitor */
 		void filterProcessBy(const std::function<bool(pid_t)>& filter) {
+			processFilter_ = nullptr;
 			filter_ = filter;
 		}
 
+		/**
+		 * Use the specified process filter to decide which processes to monitor.
+		 * The filter caches match results, only new processes are evaluated on each update.
+		 */
+		void filterProcessBy(const std::shared_ptr<LinuxProcessFilter>& filter) {
+			assert(filter != nullptr);
+			processFilter_ = filter;
+			filter_ = [filter](pid_t pid) { return (*filter)(pid); };
+		}
+
 		/** Use the specified process name to decide which processes to monitor */
 		void filterProcessByName(const std::string& name) {
-			filterProcessBy(LinuxProcessUtils::getProcessFilterByName(name));
+			auto filter = std::make_shared<LinuxProcessFilter>();
+			filter->byName(name);
+			filterProcessBy(filter);
+		}
+
+		/**
+		 * Set whether to use process events from netlink proc connector to find new threads.
+		 * It requires root permission, and it's recommended to increase the processes update interval.
+		 * Default value is false.
+		 */
+		void setUseProcessEvents(bool useProcessEvents) {
+			useProcessEvents_ = useProcessEvents;
+		}
+
+		/**
+		 * Monitor all processes in the specified cgroup (v2), call it multiple times for multiple cgroups.
+		 * The path should be a full path like "/sys/fs/cgroup/system.slice/docker-$id.scope".
+		 * Samples from cgroups will be tagged with the cgroup id.
+		 * Throws ProfilerException if the cgroup can't be opened.
+		 */
+		void monitorCgroup(const std::string& path) {
+			// open it here so the caller gets the error, perf events are opened on the next collect
+			::close(LinuxCgroupUtils::openCgroup(path));
+			cgroupPaths_.emplace_back(path);
+		}
+
+		/**
+		 * Set how many worker threads used to drain perf events, 0 means no worker.
+		 * Workers are pinned to online cpus in order, use it when a single thread
+		 * can't drain the ring buffers fast enough, for example, sampling many busy cpus.
+		 * It should be called before collecting, or it will take effect after reset.
+		 * Default value is 0.
+		 */
+		void setShardCount(std::size_t shardCount) {
+			shardCount_ = shardCount;
 		}
 
 		/**
 		 * Set how often to take a sample, the unit is cpu clock.
+		 * It applies to monitoring threads immediately, without reopening perf events.
 		 * Default value is DefaultSamplePeriod.
 		 */
 		void setSamplePeriod(std::uint64_t samplePeriod) {
+			if (samplePeriod_ == samplePeriod) {
+				return;
+			}
 			samplePeriod_ = samplePeriod;
+			for (auto& pair : tidToPerfEntry_) {
+				LinuxPerfUtils::perfEventSetPeriod(pair.second->getFd(), samplePeriod_);
+			}
+			for (auto& entry : cgroupPerfEntries_) {
+				LinuxPerfUtils::perfEventSetPeriod(entry->getFd(), samplePeriod_);
+			}
 		}
 
 		/**
@@ -140,7 +288,10 @@ namespace LiveProfiler {
 		 * Default value is DefaultMmapPageCount.
 		 */
 		void setMmapPageCount(std::size_t mmapPageCount) {
-			mmapPageCount_ = mmapPageCount;
+			if (mmapPageCount_ != mmapPageCount) {
+				mmapPageCount_ = mmapPageCount;
+				scheduleReopen();
+			}
 		}
 
 		/**
@@ -149,7 +300,10 @@ namespace LiveProfiler {
 		 * Default value is DefaultWakeupEvents.
 		 */
 		void setWakeupEvents(std::uint32_t wakeupEvents) {
-			wakeupEvents_ = wakeupEvents;
+			if (wakeupEvents_ != wakeupEvents) {
+				wakeupEvents_ = wakeupEvents;
+				scheduleReopen();
+			}
 		}
 
 		/**
@@ -157,7 +311,10 @@ namespace LiveProfiler {
 		 * Default value is false.
 		 */
 		void setExcludeUser(bool excludeUser) {
-			excludeUser_ = excludeUser;
+			if (excludeUser_ != excludeUser) {
+				excludeUser_ = excludeUser;
+				scheduleReopen();
+			}
 		}
 
 		/**
@@ -165,7 +322,10 @@ namespace LiveProfiler {
 		 * Default value is true.
 		 */
 		void setExcludeKernel(bool excludeKernel) {
-			excludeKernel_ = excludeKernel;
+			if (excludeKernel_ != excludeKernel) {
+				excludeKernel_ = excludeKernel;
+				scheduleReopen();
+			}
 		}
 
 		/**
@@ -173,7 +333,10 @@ namespace LiveProfiler {
 		 * Default value is true.
 		 */
 		void setExcludeHypervisor(bool excludeHypervisor) {
-			excludeHypervisor_ = excludeHypervisor;
+			if (excludeHypervisor_ != excludeHypervisor) {
+				excludeHypervisor_ = excludeHypervisor;
+				scheduleReopen();
+			}
 		}
 
 		/** Constructor */
@@ -184,11 +347,17 @@ namespace LiveProfiler {
 			results_(),
 			resultAllocator_(DefaultMaxFreeResult),
 			filter_(),
+			processFilter_(),
 			threads_(),
 			threadsUpdated_(),
 			threadsUpdateInterval_(
 				std::chrono::milliseconds(+DefaultThreadsUpdateInterval)),
 			tidToPerfEntry_(),
+			cgroupPaths_(),
+			cgroupFds_(),
+			cgroupPerfEntries_(),
+			reopenTids_(),
+			reopenCgroupEntries_(false),
 			perfEntryAllocator_(DefaultMaxFreePerfEntry),
 			perfType_(perfType),
 			perfConfig_(perfConfig),
@@ -199,8 +368,26 @@ namespace LiveProfiler {
 			excludeUser_(false),
 			excludeKernel_(true),
 			excludeHypervisor_(true),
+			recordMmap_(false),
 			enabled_(false),
-			epoll_() { }
+			useProcessEvents_(false),
+			procConnector_(),
+			processEvents_(),
+			epoll_(),
+			shardCount_(0),
+			shardWaitTimeout_(std::chrono::milliseconds(+DefaultShardWaitTimeout)),
+			shardCpus_(),
+			shards_(),
+			shardResultCounts_(),
+			spareBatches_() { }
+
+		/** Destructor */
+		~BasePerfLinuxCollector() {
+			stopShards();
+			for (int fd : cgroupFds_) {
+				::close(fd);
+			}
+		}
 
 	protected:
 		/** Update the threads to monitor based on `threads_` */
@@ -227,12 +414,150 @@ namespace LiveProfiler {
 			}
 		}
 
+		/** Open or close the netlink proc connector based on useProcessEvents_ */
+		void updateProcConnector() {
+			if (useProcessEvents_ && !procConnector_.isOpened()) {
+				procConnector_.open();
+				epoll_.add(procConnector_.getFd(), EPOLLIN | EPOLLET, ProcessEventEpollData);
+			} else if (!useProcessEvents_ && procConnector_.isOpened()) {
+				epoll_.del(procConnector_.getFd());
+				procConnector_.close();
+			}
+		}
+
+		/** Monitor or unmonitor threads based on process events */
+		void handleProcessEvents() {
+			processEvents_.clear();
+			if (!procConnector_.receive(processEvents_)) {
+				// some events are lost, rescan processes on next collect
+				threadsUpdated_ = {};
+			}
+			if (!filter_) {
+				return;
+			}
+			for (const auto& event : processEvents_) {
+				auto it = tidToPerfEntry_.find(event.tid);
+				bool monitoring = it != tidToPerfEntry_.end();
+				if (event.type == LinuxProcConnector::EventType::Exit) {
+					if (monitoring) {
+						unmonitorThread(std::move(it->second));
+						tidToPerfEntry_.erase(it);
+					}
+					continue;
+				}
+				// the process may execute a program that is no longer matched
+				if (event.type == LinuxProcConnector::EventType::Exec && processFilter_ != nullptr) {
+					processFilter_->forget(event.pid);
+				}
+				bool matched = filter_(event.pid);
+				if (matched && !monitoring) {
+					tidToPerfEntry_.emplace(event.tid, monitorThread(event.tid));
+				} else if (!matched && monitoring) {
+					unmonitorThread(std::move(it->second));
+					tidToPerfEntry_.erase(it);
+				}
+			}
+		}
+
+		/**
+		 * Mark all monitoring perf events as outdated because some attributes are changed,
+		 * they will be reopened in the following collects, see reopenPerfEvents.
+		 */
+		void scheduleReopen() {
+			reopenTids_.clear();
+			for (const auto& pair : tidToPerfEntry_) {
+				reopenTids_.emplace_back(pair.first);
+			}
+			reopenCgroupEntries_ = !cgroupPerfEntries_.empty();
+		}
+
+		/**
+		 * Reopen some outdated perf events with the latest attributes.
+		 * The new event is opened before the old one is closed,
+		 * and the samples left in the old one are taken, so the collection is never interrupted.
+		 * At most DefaultMaxReopenPerCollect thread events are reopened each time.
+		 */
+		void reopenPerfEvents() {
+			for (std::size_t count = 0;
+				count < DefaultMaxReopenPerCollect && !reopenTids_.empty(); ++count) {
+				pid_t tid = reopenTids_.back();
+				reopenTids_.pop_back();
+				auto it = tidToPerfEntry_.find(tid);
+				if (it == tidToPerfEntry_.end()) {
+					continue; // thread no longer be monitored
+				}
+				auto entry = monitorThread(tid);
+				replacePerfEntry(it->second, std::move(entry));
+			}
+			if (reopenCgroupEntries_) {
+				for (std::size_t index = 0; index < cgroupPerfEntries_.size(); ++index) {
+					auto& oldEntry = cgroupPerfEntries_[index];
+					auto entry = perfEntryAllocator_.allocate();
+					entry->setCpu(oldEntry->getCpu());
+					entry->setCgroupFd(oldEntry->getCgroupFd());
+					entry->setCgroupId(oldEntry->getCgroupId());
+					monitorEntry(entry, CgroupEpollDataFlag | index);
+					replacePerfEntry(oldEntry, std::move(entry));
+				}
+				reopenCgroupEntries_ = false;
+			}
+		}
+
+		/** Take the samples left in the old entry, close it and use the new entry */
+		void replacePerfEntry(
+			std::unique_ptr<LinuxPerfEntry>& oldEntry,
+			std::unique_ptr<LinuxPerfEntry>&& newEntry) {
+			// in sharded mode the worker takes the samples left when the entry is retired
+			if (shards_.empty() && oldEntry->getFd() > 0) {
+				takeSamples(*oldEntry, results_, resultAllocator_);
+			}
+			unmonitorThread(std::move(oldEntry));
+			oldEntry = std::move(newEntry);
+		}
+
+		/** Open perf events for newly added cgroups, one per cpu for each cgroup */
+		void updateCgroupPerfEvents() {
+			if (cgroupFds_.size() >= cgroupPaths_.size()) {
+				return;
+			}
+			std::vector<int> cpus;
+			LinuxCpuUtils::listOnlineCpus(cpus);
+			for (std::size_t i = cgroupFds_.size(); i < cgroupPaths_.size(); ++i) {
+				auto& path = cgroupPaths_[i];
+				int cgroupFd = -1;
+				try {
+					cgroupFd = LinuxCgroupUtils::openCgroup(path);
+				} catch (...) {
+					// the cgroup is removed after `monitorCgroup`, stop monitoring it
+					cgroupPaths_.erase(cgroupPaths_.begin() + i);
+					throw;
+				}
+				cgroupFds_.emplace_back(cgroupFd);
+				auto cgroupId = LinuxCgroupUtils::getCgroupId(path);
+				for (int cpu : cpus) {
+					auto entry = perfEntryAllocator_.allocate();
+					entry->setCpu(cpu);
+					entry->setCgroupFd(cgroupFd);
+					entry->setCgroupId(cgroupId);
+					monitorEntry(entry, CgroupEpollDataFlag | cgroupPerfEntries_.size());
+					cgroupPerfEntries_.emplace_back(std::move(entry));
+				}
+			}
+		}
+
 		/** Monitor specified thread, will not access tidToPerfEntry_ */
 		std::unique_ptr<LinuxPerfEntry> monitorThread(pid_t tid) {
-			// open perf event
 			auto entry = perfEntryAllocator_.allocate();
 			entry->setPid(tid);
-			LinuxPerfUtils::monitorSample(
+			// associated data is tid
+			monitorEntry(entry, static_cast<std::uint64_t>(tid));
+			return entry;
+		}
+
+		/** Open perf event for the target set in entry and register it to epoll */
+		void monitorEntry(std::unique_ptr<LinuxPerfEntry>& entry, std::uint64_t epollData) {
+			// open perf event
+			bool opened = LinuxPerfUtils::monitorSample(
 				entry,
 				perfType_,
 				perfConfig_,
@@ -242,41 +567,260 @@ namespace LiveProfiler {
 				wakeupEvents_,
 				excludeUser_,
 				excludeKernel_,
-				excludeHypervisor_);
+				excludeHypervisor_,
+				recordMmap_);
+			if (!opened) {
+				return; // thread may have exited
+			}
 			// enable events if collecting
 			if (enabled_) {
 				LinuxPerfUtils::perfEventEnable(entry->getFd(), true);
 			}
-			// register to epoll, use edge trigger and associated data is tid
-			epoll_.add(entry->getFd(), EPOLLIN | EPOLLET, static_cast<std::uint64_t>(tid));
-			return entry;
+			// register to epoll, use edge trigger
+			if (shards_.empty()) {
+				epoll_.add(entry->getFd(), EPOLLIN | EPOLLET, epollData);
+			} else {
+				// associated data of worker's epoll is the address of entry
+				auto& shard = *shards_[getShardIndex(*entry)];
+				shard.epoll.add(entry->getFd(), EPOLLIN | EPOLLET,
+					reinterpret_cast<std::uintptr_t>(entry.get()));
+			}
 		}
 
-		/** Unmonitor specified thread, will not access tidToPerfEntry_ */
+		/** Unmonitor specified thread or cgroup, will not access tidToPerfEntry_ */
 		void unmonitorThread(std::unique_ptr<LinuxPerfEntry>&& entry) {
 			assert(entry != nullptr);
-			// unregister from epoll
-			epoll_.del(entry->getFd());
-			// disable events
-			LinuxPerfUtils::perfEventDisable(entry->getFd());
+			if (entry->getFd() > 0) {
+				if (!shards_.empty()) {
+					retirePerfEntry(std::move(entry));
+					return;
+				}
+				// unregister from epoll
+				epoll_.del(entry->getFd());
+				// disable events
+				LinuxPerfUtils::perfEventDisable(entry->getFd());
+			}
 			// return instance to allocator
 			perfEntryAllocator_.deallocate(std::move(entry));
 		}
 
+		/** Batch of models produced by worker */
+		using ModelBatch = std::vector<std::unique_ptr<Model>>;
+
+		/** State of worker thread, members except `thread` are shared with the collector */
+		struct Shard {
+			LinuxEpollDescriptor epoll;
+			FreeListAllocator<Model> resultAllocator; // only used by worker
+			SpscQueue<ModelBatch> filledBatches; // worker -> collector
+			SpscQueue<ModelBatch> recycledBatches; // collector -> worker
+			SpscQueue<std::unique_ptr<LinuxPerfEntry>> retiredEntries; // collector -> worker
+			std::atomic_bool running;
+			std::atomic_bool failed;
+			std::exception_ptr error; // set before `failed`
+			std::thread thread;
+
+			Shard() :
+				epoll(),
+				resultAllocator(DefaultMaxFreeResult),
+				filledBatches(DefaultShardQueueSize),
+				recycledBatches(DefaultShardQueueSize),
+				retiredEntries(DefaultMaxFreePerfEntry),
+				running(true),
+				failed(false),
+				error(),
+				thread() { }
+		};
+
+		/** Create worker threads, each pinned to an online cpu */
+		void startShards() {
+			shardCpus_.clear();
+			LinuxCpuUtils::listOnlineCpus(shardCpus_);
+			for (std::size_t index = 0; index < shardCount_; ++index) {
+				auto shard = std::make_unique<Shard>();
+				int cpu = shardCpus_.empty() ? -1 : shardCpus_[index % shardCpus_.size()];
+				auto* shardPtr = shard.get();
+				shard->thread = std::thread([this, shardPtr, cpu] {
+					if (cpu >= 0) {
+						// ignore error, the process may not allowed to run on this cpu
+						LinuxCpuUtils::setCurrentThreadAffinity(cpu);
+					}
+					runShard(*shardPtr);
+				});
+				shards_.emplace_back(std::move(shard));
+			}
+			shardResultCounts_.assign(shards_.size(), 0);
+		}
+
+		/** Stop and join worker threads, all perf entries should be unmonitored first */
+		void stopShards() {
+			for (auto& shard : shards_) {
+				shard->running.store(false, std::memory_order_release);
+			}
+			for (auto& shard : shards_) {
+				shard->thread.join();
+				// models in queues are freed with the shard
+			}
+			shards_.clear();
+			// models belonging to workers are in results_, they can be freed by any allocator
+			shardResultCounts_.clear();
+		}
+
+		/** Worker thread function, drain perf events until stopped */
+		void runShard(Shard& shard) {
+			ModelBatch batch;
+			ModelBatch recycled;
+			std::vector<ModelBatch> spares;
+			std::unique_ptr<LinuxPerfEntry> retired;
+			try {
+				while (true) {
+					// loop once more after stopped, to free all retired entries
+					bool running = shard.running.load(std::memory_order_acquire);
+					auto& events = shard.epoll.wait(
+						running ? shardWaitTimeout_ : std::chrono::milliseconds(0));
+					for (auto& event : events) {
+						if ((event.events & EPOLLIN) == EPOLLIN) {
+							auto* entry = reinterpret_cast<LinuxPerfEntry*>(event.data.u64);
+							takeSamples(*entry, batch, shard.resultAllocator);
+						}
+					}
+					// retired entries are removed from epoll before pushed to the queue,
+					// and all events returned before are handled, so it's safe to free them
+					while (shard.retiredEntries.pop(retired)) {
+						LinuxPerfUtils::perfEventDisable(retired->getFd());
+						takeSamples(*retired, batch, shard.resultAllocator);
+						retired = nullptr;
+					}
+					// reuse models returned from the collector
+					while (shard.recycledBatches.pop(recycled)) {
+						for (auto& model : recycled) {
+							shard.resultAllocator.deallocate(std::move(model));
+						}
+						recycled.clear();
+						spares.emplace_back(std::move(recycled));
+					}
+					// publish samples, keep them in the batch if the queue is full
+					if (!batch.empty() && shard.filledBatches.push(std::move(batch))) {
+						if (spares.empty()) {
+							batch = ModelBatch();
+						} else {
+							batch = std::move(spares.back());
+							spares.pop_back();
+						}
+					}
+					if (!running) {
+						break;
+					}
+				}
+			} catch (...) {
+				shard.error = std::current_exception();
+				shard.failed.store(true, std::memory_order_release);
+			}
+		}
+
+		/** Get which worker should handle the perf entry */
+		std::size_t getShardIndex(const LinuxPerfEntry& entry) const {
+			auto cpu = entry.getCpu();
+			if (cpu >= 0) {
+				// handle per cpu events by the worker pinned to that cpu
+				auto it = std::lower_bound(shardCpus_.cbegin(), shardCpus_.cend(), cpu);
+				if (it != shardCpus_.cend() && *it == cpu) {
+					return static_cast<std::size_t>(it - shardCpus_.cbegin()) % shards_.size();
+				}
+				return static_cast<std::size_t>(cpu) % shards_.size();
+			}
+			return static_cast<std::size_t>(entry.getPid()) % shards_.size();
+		}
+
+		/** Remove the entry from worker's epoll and let the worker drain and free it */
+		void retirePerfEntry(std::unique_ptr<LinuxPerfEntry>&& entry) {
+			auto& shard = *shards_[getShardIndex(*entry)];
+			shard.epoll.del(entry->getFd());
+			while (!shard.failed.load(std::memory_order_acquire) &&
+				!shard.retiredEntries.push(std::move(entry))) {
+				std::this_thread::yield();
+			}
+			if (entry != nullptr) {
+				// worker is stopped, free in this thread
+				perfEntryAllocator_.deallocate(std::move(entry));
+			}
+		}
+
+		/** Return models in results_ to the workers created them, shard by shard */
+		void recycleShardResults() {
+			std::size_t offset = 0;
+			for (std::size_t index = 0; index < shardResultCounts_.size(); ++index) {
+				auto count = shardResultCounts_[index];
+				if (count == 0) {
+					continue;
+				}
+				ModelBatch batch;
+				if (!spareBatches_.empty()) {
+					batch = std::move(spareBatches_.back());
+					spareBatches_.pop_back();
+				}
+				for (std::size_t i = offset; i < offset + count; ++i) {
+					batch.emplace_back(std::move(results_[i]));
+				}
+				offset += count;
+				shardResultCounts_[index] = 0;
+				if (!shards_[index]->recycledBatches.push(std::move(batch))) {
+					// queue is full, free them in this thread
+					for (auto& model : batch) {
+						resultAllocator_.deallocate(std::move(model));
+					}
+					batch.clear();
+					spareBatches_.emplace_back(std::move(batch));
+				}
+			}
+			// the rest are created in this thread, they will be freed by the caller
+			results_.erase(results_.begin(), results_.begin() + offset);
+		}
+
+		/** Move models from workers to results_, and record how many models each worker provides */
+		void mergeShardResults() {
+			ModelBatch batch;
+			for (std::size_t index = 0; index < shards_.size(); ++index) {
+				auto& shard = *shards_[index];
+				if (shard.failed.load(std::memory_order_acquire)) {
+					std::rethrow_exception(shard.error);
+				}
+				while (shard.filledBatches.pop(batch)) {
+					shardResultCounts_[index] += batch.size();
+					for (auto& model : batch) {
+						results_.emplace_back(std::move(model));
+					}
+					batch.clear();
+					spareBatches_.emplace_back(std::move(batch));
+				}
+			}
+		}
+
 	protected:
-		/** Take samples from perf entry and append result to results_ */
-		virtual void takeSamples(std::unique_ptr<LinuxPerfEntry>& entry) = 0;
+		/**
+		 * Take samples from perf entry, allocate models from `resultAllocator` and append them to `results`.
+		 * It may be called from worker threads in sharded mode, so don't access other members.
+		 */
+		virtual void takeSamples(
+			LinuxPerfEntry& entry,
+			std::vector<std::unique_ptr<Model>>& results,
+			FreeListAllocator<Model>& resultAllocator) = 0;
 
 	protected:
 		std::vector<std::unique_ptr<Model>> results_;
 		FreeListAllocator<Model> resultAllocator_;
 
 		std::function<bool(pid_t)> filter_;
+		std::shared_ptr<LinuxProcessFilter> processFilter_;
 		std::vector<pid_t> threads_;
 		std::chrono::high_resolution_clock::time_point threadsUpdated_;
 		std::chrono::high_resolution_clock::duration threadsUpdateInterval_;
 
 		std::unordered_map<pid_t, std::unique_ptr<LinuxPerfEntry>> tidToPerfEntry_;
+		std::vector<std::string> cgroupPaths_;
+		std::vector<int> cgroupFds_;
+		std::vector<std::unique_ptr<LinuxPerfEntry>> cgroupPerfEntries_;
+		std::vector<pid_t> reopenTids_;
+		bool reopenCgroupEntries_;
 		FreeListAllocator<LinuxPerfEntry> perfEntryAllocator_;
 
 		std::uint32_t perfType_;
@@ -288,9 +832,21 @@ namespace LiveProfiler {
 		bool excludeUser_;
 		bool excludeKernel_;
 		bool excludeHypervisor_;
+		bool recordMmap_;
 		bool enabled_;
 
+		bool useProcessEvents_;
+		LinuxProcConnector procConnector_;
+		std::vector<LinuxProcConnector::Event> processEvents_;
+
 		LinuxEpollDescriptor epoll_;
+
+		std::size_t shardCount_;
+		std::chrono::milliseconds shardWaitTimeout_;
+		std::vector<int> shardCpus_;
+		std::vector<std::unique_ptr<Shard>> shards_;
+		std::vector<std::size_t> shardResultCounts_;
+		std::vector<ModelBatch> spareBatches_;
 	};
 }
 
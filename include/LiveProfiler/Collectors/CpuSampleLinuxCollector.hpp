@@ -1,4 +1,6 @@
 #pragma once
+#include <sys/sysmacros.h>
+#include <cstring>
 #include "BasePerfLinuxCollector.hpp"
 #include "../Models/CpuSampleModel.hpp"
 
@@ -8,6 +10,11 @@ namespace LiveProfiler {
 	 *
 	 * Q: Why callchain is incomplete for my program?
 	 * A: Backtrace is based on frame pointer, please compile with -fno-omit-frame-pointer option.
+	 *
+	 * New executable mappings are recorded by perf_events (PERF_RECORD_MMAP2),
+	 * they are attached to the next sample of the same thread, see CpuSampleModel::getAddressMaps,
+	 * so the interceptor can update the address maps incrementally instead of reading /proc/$pid/maps.
+	 * If mmap records are lost by kernel or dropped here, the next sample is marked by `setAddressMapsLost`.
 	 */
 	class CpuSampleLinuxCollector : public BasePerfLinuxCollector<CpuSampleModel> {
 	public:
@@ -17,10 +24,26 @@ namespace LiveProfiler {
 		 * Default value is true.
 		 */
 		void setIncludeCallChain(bool includeCallChain) {
+			auto sampleType = sampleType_;
 			if (includeCallChain) {
-				sampleType_ |= PERF_SAMPLE_CALLCHAIN;
+				sampleType |= PERF_SAMPLE_CALLCHAIN;
 			} else {
-				sampleType_ &= ~PERF_SAMPLE_CALLCHAIN;
+				sampleType &= ~PERF_SAMPLE_CALLCHAIN;
+			}
+			if (sampleType_ != sampleType) {
+				sampleType_ = sampleType;
+				scheduleReopen();
+			}
+		}
+
+		/**
+		 * Set whether to record new executable mappings and attach them to samples.
+		 * Default value is true.
+		 */
+		void setIncludeAddressMaps(bool includeAddressMaps) {
+			if (recordMmap_ != includeAddressMaps) {
+				recordMmap_ = includeAddressMaps;
+				scheduleReopen();
 			}
 		}
 
@@ -28,25 +51,51 @@ namespace LiveProfiler {
 		CpuSampleLinuxCollector() : BasePerfLinuxCollector(
 			PERF_TYPE_SOFTWARE,
 			PERF_COUNT_SW_CPU_CLOCK,
-			PERF_SAMPLE_IP | PERF_SAMPLE_TID | PERF_SAMPLE_CALLCHAIN) { }
+			PERF_SAMPLE_IP | PERF_SAMPLE_TID | PERF_SAMPLE_TIME | PERF_SAMPLE_CALLCHAIN) {
+			recordMmap_ = true;
+		}
+
+		/** Destructor */
+		~CpuSampleLinuxCollector() {
+			// workers call takeSamples, stop them before this class destroyed
+			stopShards();
+		}
 
 	protected:
 		/** Take samples for executing instruction (actually is the next instruction) */
-		void takeSamples(std::unique_ptr<LinuxPerfEntry>& entry) override {
-			assert(entry != nullptr);
-			auto& records = entry->getRecords();
-			for (auto* record : records) {
+		void takeSamples(
+			LinuxPerfEntry& entry,
+			std::vector<std::unique_ptr<CpuSampleModel>>& results,
+			FreeListAllocator<CpuSampleModel>& resultAllocator) override {
+			auto& records = entry.getRecords();
+			// mmap records from this index are not attached to any sample yet
+			std::size_t mmapIndex = 0;
+			for (std::size_t index = 0; index < records.size(); ++index) {
+				auto* record = records[index];
 				// check if the record is sample
-				if (record->type != PERF_RECORD_SAMPLE) {
+				if (record->type == PERF_RECORD_LOST) {
+					entry.setRecordsLost(true);
+					continue;
+				} else if (record->type != PERF_RECORD_SAMPLE) {
 					continue;
 				}
 				auto* data = reinterpret_cast<const CpuSampleRawData*>(record);
 				// setup model data
-				auto result = resultAllocator_.allocate();
+				auto result = resultAllocator.allocate();
+				for (; mmapIndex < index; ++mmapIndex) {
+					if (records[mmapIndex]->type == PERF_RECORD_MMAP2) {
+						appendAddressMap(records[mmapIndex], entry.getAttrRef(), result->getAddressMaps());
+					}
+				}
+				mmapIndex = index + 1;
+				result->setAddressMapsLost(entry.isRecordsLost());
+				entry.setRecordsLost(false);
 				auto ip = data->ip;
 				result->setIp(ip);
 				result->setPid(data->pid);
 				result->setTid(data->tid);
+				result->setTimestamp(data->time);
+				result->setCgroupId(entry.getCgroupId());
 				result->setSymbolName(nullptr);
 				auto& callChainIps = result->getCallChainIps();
 				auto& callChainSymbolNames = result->getCallChainSymbolNames();
@@ -67,10 +116,68 @@ namespace LiveProfiler {
 					}
 				}
 				// append model data
-				results_.emplace_back(std::move(result));
+				results.emplace_back(std::move(result));
+			}
+			// keep mmap records after the last sample, if too many are kept, the rest are dropped
+			for (; mmapIndex < records.size(); ++mmapIndex) {
+				if (records[mmapIndex]->type == PERF_RECORD_MMAP2 && !entry.keepRecord(records[mmapIndex])) {
+					entry.setRecordsLost(true);
+					break;
+				}
 			}
 			// all records handled, update read offset
-			entry->updateReadOffset();
+			entry.updateReadOffset();
+		}
+
+		/** Parse PERF_RECORD_MMAP2 record and append it to `addressMaps` */
+		static void appendAddressMap(
+			const ::perf_event_header* record,
+			const ::perf_event_attr& attr,
+			std::vector<CpuSampleModel::AddressMap>& addressMaps) {
+			if (record->size <= sizeof(MmapRawData)) {
+				return;
+			}
+			auto* data = reinterpret_cast<const MmapRawData*>(record);
+			auto* path = reinterpret_cast<const char*>(data + 1);
+			auto pathSize = ::strnlen(path, record->size - sizeof(MmapRawData));
+			addressMaps.emplace_back();
+			auto& addressMap = addressMaps.back();
+			addressMap.pid = data->pid;
+			addressMap.timestamp = getRecordTimestamp(record, attr);
+			addressMap.startAddress = data->addr;
+			addressMap.endAddress = data->addr + data->len;
+			addressMap.fileOffset = data->pgoff;
+			addressMap.device = makedev(data->maj, data->min);
+			addressMap.inode = data->ino;
+			// anonymous mappings have empty path in /proc/$pid/maps
+			static const char anonymousPath[] = "//anon";
+			if (pathSize != sizeof(anonymousPath) - 1 ||
+				std::memcmp(path, anonymousPath, pathSize) != 0) {
+				addressMap.path.assign(path, pathSize);
+			}
+		}
+
+		/**
+		 * Get the timestamp from the sample_id fields appended to non sample records,
+		 * return 0 if it's not available. See man perf_events, section sample_id_all.
+		 */
+		static std::uint64_t getRecordTimestamp(const ::perf_event_header* record, const ::perf_event_attr& attr) {
+			if (!attr.sample_id_all || (attr.sample_type & PERF_SAMPLE_TIME) == 0) {
+				return 0;
+			}
+			// fields after time: id, stream_id, cpu, identifier, 8 bytes each
+			std::size_t offset = sizeof(std::uint64_t);
+			for (auto sampleType : { PERF_SAMPLE_ID, PERF_SAMPLE_STREAM_ID, PERF_SAMPLE_CPU, PERF_SAMPLE_IDENTIFIER }) {
+				if ((attr.sample_type & sampleType) != 0) {
+					offset += sizeof(std::uint64_t);
+				}
+			}
+			if (record->size < sizeof(MmapRawData) + offset) {
+				return 0;
+			}
+			std::uint64_t timestamp = 0;
+			std::memcpy(&timestamp, reinterpret_cast<const char*>(record) + record->size - offset, sizeof(timestamp));
+			return timestamp;
 		}
 
 		/**
@@ -86,6 +193,7 @@ namespace LiveProfiler {
 			std::uint64_t ip;
 			std::uint32_t pid;
 			std::uint32_t tid;
+			std::uint64_t time;
 		};
 
 		/** See man perf_events, section PERF_RECORD_SAMPLE */
@@ -94,6 +202,22 @@ namespace LiveProfiler {
 			std::uint64_t nr;
 			std::uint64_t ips[];
 		};
+
+		/** See man perf_events, section PERF_RECORD_MMAP2, filename is followed by it */
+		struct MmapRawData {
+			::perf_event_header header;
+			std::uint32_t pid;
+			std::uint32_t tid;
+			std::uint64_t addr;
+			std::uint64_t len;
+			std::uint64_t pgoff;
+			std::uint32_t maj;
+			std::uint32_t min;
+			std::uint64_t ino;
+			std::uint64_t inoGeneration;
+			std::uint32_t prot;
+			std::uint32_t flags;
+		};
 	};
 }
 
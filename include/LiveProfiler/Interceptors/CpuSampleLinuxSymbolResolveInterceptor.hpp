@@ -1,26 +1,55 @@
 #pragma once
 #include <unistd.h>
 #include <vector>
+#include <algorithm>
 #include <memory>
 #include <chrono>
+#include <thread>
 #include <unordered_map>
 #include "BaseInterceptor.hpp"
 #include "../Models/CpuSampleModel.hpp"
 #include "../Utils/Allocators/FreeListAllocator.hpp"
 #include "../Utils/Allocators/SingletonAllocator.hpp"
+#include "../Utils/Containers/AddressCache.hpp"
 #include "../Utils/Platform/Linux/LinuxExecutableSymbolResolver.hpp"
+#include "../Utils/Platform/Linux/LinuxExecutableSymbolResolverAllocator.hpp"
+#include "../Utils/Platform/Linux/LinuxExecutableSymbolResolverLoader.hpp"
 #include "../Utils/Platform/Linux/LinuxKernelSymbolResolver.hpp"
 #include "../Utils/Platform/Linux/LinuxProcessAddressLocator.hpp"
 #include "../Utils/Platform/Linux/LinuxProcessCustomSymbolResolver.hpp"
 #include "../Utils/Platform/Linux/LinuxProcessUtils.hpp"
+#include "../Utils/Platform/Linux/LinuxRemoteSymbolClient.hpp"
 
 namespace LiveProfiler {
 	/**
 	 * Interceptor used to setup symbol names in model data.
 	 * How this interceptor resolve symbol name:
-	 * - First, use LinuxProcessAddressLocator and LinuxExecutableSymbolResolver
-	 * - Then, use LinuxKernelSymbolResolver
+	 * - First, use LinuxProcessAddressLocator and LinuxExecutableSymbolResolver,
+	 *   resolvers are shared by all processes mapping the same file (by device and inode, or build-id)
+	 * - Then, use LinuxKernelSymbolResolver, it is shared by all interceptors in the process
 	 * - Finally, use LinuxProcessCustomSymbolResolver
+	 *
+	 * With asynchronous loading enabled, symbol tables of executable files are loaded on background threads,
+	 * before the table is ready, the symbol name will be a pending placeholder with (path, offset),
+	 * and it will be resolved in the following `alter` once the table is ready (backfill).
+	 *
+	 * With raw address mode enabled, addresses in executable files are not resolved here,
+	 * the symbol name will be a placeholder with (path, offset) and a binder,
+	 * analyzers aggregate on placeholders and resolve them in bulk when generating the result.
+	 *
+	 * With a remote symbol server set, symbol tables of executable files with build-id are not loaded,
+	 * addresses missed by the local cache are sent to the server as (build-id, offset) in one batch per `alter`.
+	 *
+	 * Call `prewarm` with the target processes before collecting, to load their symbol tables in parallel,
+	 * so the first samples don't wait for cold binaries loaded one by one on the pipeline thread.
+	 *
+	 * Resolved symbol names are cached per process by ip, the cache of a process is cleared
+	 * when it's maps are reloaded, pending placeholders and failed lookups are not cached,
+	 * custom symbol names are not cached either because jit code addresses may be reused.
+	 *
+	 * Address maps attached to model data by the collector are applied to the address locator
+	 * of the process before resolving, so newly mapped addresses are located without reloading /proc/$pid/maps.
+	 * The maps are still reloaded when an address can't be located (rate limited), or mappings are lost.
 	 */
 	class CpuSampleLinuxSymbolResolveInterceptor : public BaseInterceptor<CpuSampleModel> {
 	public:
@@ -28,6 +57,8 @@ namespace LiveProfiler {
 		static const std::size_t DefaultMaxFreeAddressLocator = 1024;
 		static const std::size_t DefaultMaxFreeCustomResolver = 1024;
 		static const std::size_t DefaultSurvivalProcessMinCheckInterval = 1000;
+		static const std::size_t DefaultIpCacheCapacity = 1024;
+		static const std::size_t DefaultMaxRawSymbolNames = 65536;
 
 		/** Reset the state to it's initial state */
 		void reset() override {
@@ -37,17 +68,156 @@ namespace LiveProfiler {
 			lastAddressLocatorPid_ = 0;
 			lastAddressLocatorIterator_ = {};
 			pidToAddressLocator_.clear();
+			for (auto& pair : pidToIpCache_) {
+				ipCacheAllocator_.deallocate(std::move(pair.second));
+			}
+			lastIpCache_ = nullptr;
+			pidToIpCache_.clear();
+			ipCacheHitCount_ = 0;
+			ipCacheMissCount_ = 0;
 			for (auto& pair : pidToCustomResolver_) {
 				customResolverAllocator_.deallocate(std::move(pair.second));
 			}
 			lastCustomResolverPid_ = 0;
 			lastCustomResolverIterator_ = {};
 			pidToCustomResolver_.clear();
+			pendingSymbolNames_.clear();
+			rawSymbolNames_.clear();
+			rawSymbolNameCount_ = 0;
 			survivalProcessChecked_ = {};
 		}
 
+		/**
+		 * Use the specified directory to cache symbol tables of executable files on disk,
+		 * later loads of the same file (by build-id) don't need to parse and demangle symbols again.
+		 * Only affects files not loaded yet.
+		 * Default is no cache.
+		 */
+		void setSymbolTableCache(
+			const std::string& directory,
+			std::size_t maxTotalSize = LinuxSymbolTableCache::DefaultMaxTotalSize) {
+			symbolTableCache_ = std::make_shared<LinuxSymbolTableCache>(directory, maxTotalSize);
+			resolverAllocator_->setSymbolTableCache(symbolTableCache_);
+			rawSymbolNameBinder_ = std::make_shared<ExecutableSymbolNameBinder>(resolverAllocator_);
+			rawSymbolNames_.clear();
+			rawSymbolNameCount_ = 0;
+		}
+
+		/**
+		 * Load symbol tables of executable files on background threads with the specified worker count,
+		 * 0 means load synchronously in `alter`.
+		 * It avoids blocking the pipeline when the first sample from a big binary arrives,
+		 * but analyzers will receive placeholders until the table is ready,
+		 * builtin analyzers merge them into the resolved symbol names in `getResult`.
+		 * Default value is 0.
+		 */
+		void setAsyncSymbolLoading(std::size_t workerCount) {
+			asyncWorkerCount_ = workerCount;
+			resolverLoader_ = nullptr;
+			loadedResolvers_.clear();
+			pendingSymbolNames_.clear();
+		}
+
+		/**
+		 * Don't resolve addresses in executable files while intercepting (raw address mode),
+		 * only file-backed mappings use placeholders, anonymous and pseudo mappings are resolved as usual,
+		 * model data will contain placeholders keyed by (path, offset),
+		 * builtin analyzers aggregate samples on these placeholders,
+		 * and resolve each distinct placeholder once when generating the result.
+		 * Kernel and custom (perf map) symbol names are still resolved immediately.
+		 * At most `maxSymbolNames` placeholders are kept for reuse, the kept placeholders are dropped
+		 * when exceeded, analyzers still merge the duplicated placeholders by their resolved symbol names.
+		 * Default value is false.
+		 */
+		void setRawAddressMode(bool enabled, std::size_t maxSymbolNames = DefaultMaxRawSymbolNames) {
+			rawAddressMode_ = enabled;
+			rawSymbolNames_.clear();
+			rawSymbolNameCount_ = 0;
+			maxRawSymbolNames_ = maxSymbolNames;
+		}
+
+		/**
+		 * Resolve addresses in executable files by the symbol server at the address (see LinuxRemoteSymbolServer),
+		 * instead of loading symbol tables in this process, empty address means disable.
+		 * Files without build-id are still resolved locally,
+		 * raw address mode and asynchronous loading don't apply to the files resolved remotely.
+		 * `cacheCapacity` is how many answers can be cached.
+		 * Default is disabled.
+		 */
+		void setRemoteSymbolServer(
+			const std::string& address,
+			std::size_t cacheCapacity = LinuxRemoteSymbolClient::DefaultCacheCapacity) {
+			remoteClient_ = address.empty() ? nullptr :
+				std::make_unique<LinuxRemoteSymbolClient>(address, cacheCapacity);
+			remoteSymbolNames_.clear();
+			remoteQueries_.clear();
+		}
+
+		/** Get the client of remote symbol server, return nullptr if not set */
+		const std::unique_ptr<LinuxRemoteSymbolClient>& getRemoteSymbolClient() const& { return remoteClient_; }
+
+		/**
+		 * Set how many resolved symbol names can be cached for each process, 0 means disable the cache.
+		 * Use `getIpCacheHitCount` and `getIpCacheMissCount` to find out the suitable capacity.
+		 * Only affects processes seen after the call, call `reset` to apply to all.
+		 * Default value is 1024.
+		 */
+		void setIpCacheCapacity(std::size_t capacity) {
+			ipCacheCapacity_ = capacity;
+		}
+
+		/**
+		 * Load symbol tables of executable files mapped by the processes before collecting (prewarm).
+		 * The maps of each process are read once, distinct files are loaded by `workerCount` threads,
+		 * and resolvers are attached to the mappings, files mapped later are still loaded on demand.
+		 * Return how long the prewarm takes, it's also available from `getPrewarmDuration`.
+		 */
+		std::chrono::high_resolution_clock::duration prewarm(
+			const std::vector<pid_t>& pids,
+			std::size_t workerCount = std::max<std::size_t>(std::thread::hardware_concurrency(), 1)) {
+			auto start = std::chrono::high_resolution_clock::now();
+			std::vector<std::pair<pid_t, LinuxProcessAddressMap*>> maps;
+			for (pid_t pid : pids) {
+				getAddressLocator(pid)->forEachMap([this, &maps, pid](auto& map) {
+					// files resolved remotely only need their build-ids
+					if (remoteClient_ == nullptr || remoteClient_->getBuildId(pid, map) == nullptr) {
+						maps.emplace_back(pid, &map);
+					}
+				});
+			}
+			resolverAllocator_->preload(maps, workerCount);
+			// asynchronous loading finds resolvers by path
+			if (asyncWorkerCount_ > 0) {
+				for (const auto& pair : maps) {
+					const auto& resolver = pair.second->getResolver();
+					if (resolver != nullptr) {
+						loadedResolvers_.emplace(pair.second->getPath(), resolver);
+					}
+				}
+			}
+			prewarmDuration_ = std::chrono::high_resolution_clock::now() - start;
+			return prewarmDuration_;
+		}
+
+		/** Get how long the last `prewarm` takes */
+		std::chrono::high_resolution_clock::duration getPrewarmDuration() const { return prewarmDuration_; }
+
+		/** Get how many ips are resolved from cache since last reset */
+		std::size_t getIpCacheHitCount() const { return ipCacheHitCount_; }
+
+		/** Get how many ips are not found in cache since last reset */
+		std::size_t getIpCacheMissCount() const { return ipCacheMissCount_; }
+
 		/** Setup symbol names in model data */
 		void alter(std::vector<std::unique_ptr<CpuSampleModel>>& models) override {
+			// resolve placeholders created before, if their symbol tables are ready
+			if (asyncWorkerCount_ > 0) {
+				if (resolverLoader_ == nullptr) {
+					resolverLoader_ = std::make_unique<LinuxExecutableSymbolResolverLoader>(
+						asyncWorkerCount_, symbolTableCache_);
+				}
+				backfillPendingSymbolNames();
+			}
 			 // cleanup pidToAddressLocator_
 			auto now = std::chrono::high_resolution_clock::now();
 			if (now - survivalProcessChecked_ > survivalProcessMinCheckInterval_) {
@@ -56,17 +226,37 @@ namespace LiveProfiler {
 			}
 			// setup symbol names in model data
 			for (auto& model : models) {
+				// apply new mappings before resolving, reload the maps if some mappings are lost
+				if (model->isAddressMapsLost()) {
+					getAddressLocator(static_cast<pid_t>(model->getPid()))->invalidate();
+				}
+				for (const auto& addressMap : model->getAddressMaps()) {
+					auto& addressLocator = getAddressLocator(static_cast<pid_t>(addressMap.pid));
+					addressLocator->update(
+						static_cast<std::uintptr_t>(addressMap.startAddress),
+						static_cast<std::uintptr_t>(addressMap.endAddress),
+						static_cast<std::uintptr_t>(addressMap.fileOffset),
+						pathAllocator_->allocate(addressMap.path),
+						addressMap.device,
+						addressMap.inode,
+						addressMap.timestamp);
+				}
 				// resolve symbol names
 				auto ip = model->getIp();
 				pid_t pid = model->getPid();
-				model->setSymbolName(resolve(pid, ip));
+				auto timestamp = model->getTimestamp();
+				model->setSymbolName(resolve(pid, ip, timestamp));
 				auto& callChainIps = model->getCallChainIps();
 				auto& callChainSymbolNames = model->getCallChainSymbolNames();
 				for (std::size_t i = 0; i < callChainIps.size(); ++i) {
 					auto callChainIp = callChainIps[i];
-					callChainSymbolNames.at(i) = resolve(pid, callChainIp);
+					callChainSymbolNames.at(i) = resolve(pid, callChainIp, timestamp);
 				}
 			}
+			// send addresses missed by the cache of remote client in one batch
+			if (!remoteQueries_.empty()) {
+				resolveRemoteQueries(models);
+			}
 		}
 
 		/** Constructor */
@@ -75,9 +265,31 @@ namespace LiveProfiler {
 			addressLocatorAllocator_(DefaultMaxFreeAddressLocator),
 			lastAddressLocatorPid_(0),
 			lastAddressLocatorIterator_(),
+			pidToIpCache_(),
+			ipCacheAllocator_(DefaultMaxFreeAddressLocator),
+			lastIpCache_(nullptr),
+			ipCacheCapacity_(DefaultIpCacheCapacity),
+			ipCacheHitCount_(0),
+			ipCacheMissCount_(0),
 			pathAllocator_(std::make_shared<decltype(pathAllocator_)::element_type>()),
 			resolverAllocator_(std::make_shared<decltype(resolverAllocator_)::element_type>()),
-			kernelResolver_(),
+			symbolTableCache_(),
+			asyncWorkerCount_(0),
+			resolverLoader_(),
+			loadedResolvers_(),
+			loadedPaths_(),
+			pendingSymbolNames_(),
+			prewarmDuration_(),
+			rawAddressMode_(false),
+			rawSymbolNames_(),
+			rawSymbolNameCount_(0),
+			maxRawSymbolNames_(DefaultMaxRawSymbolNames),
+			rawSymbolNameBinder_(std::make_shared<ExecutableSymbolNameBinder>(resolverAllocator_)),
+			remoteClient_(),
+			remoteSymbolNames_(),
+			remoteQueries_(),
+			remoteResults_(),
+			kernelResolver_(LinuxKernelSymbolResolver::getShared()),
 			pidToCustomResolver_(),
 			customResolverAllocator_(DefaultMaxFreeCustomResolver),
 			customSymbolNamePath_(std::make_shared<std::string>("perfmap")),
@@ -89,6 +301,64 @@ namespace LiveProfiler {
 				std::chrono::milliseconds(+DefaultSurvivalProcessMinCheckInterval)) { }
 
 	protected:
+		/** (file, offset) -> placeholder */
+		using PlaceholdersType = std::unordered_map<std::shared_ptr<std::string>,
+			std::unordered_map<std::size_t, std::shared_ptr<SymbolName>>>;
+
+		/** Resolve raw address placeholders by executable files, used in raw address mode */
+		class ExecutableSymbolNameBinder : public SymbolNameBinder {
+		public:
+			/** Resolve placeholders, resolvers are shared with the interceptor */
+			void bind(const std::vector<std::shared_ptr<SymbolName>>& placeholders) override {
+				// group placeholders by file, then resolve offsets of the same file in batch
+				std::vector<const std::shared_ptr<SymbolName>*> order(placeholders.size());
+				std::vector<std::size_t> offsets;
+				std::vector<std::shared_ptr<SymbolName>> results;
+				for (std::size_t i = 0; i < placeholders.size(); ++i) {
+					order[i] = &placeholders[i];
+				}
+				std::sort(order.begin(), order.end(), [](const auto* a, const auto* b) {
+					return (*a)->getPath() < (*b)->getPath();
+				});
+				for (std::size_t start = 0, end = 0; start < order.size(); start = end) {
+					const auto& path = (*order[start])->getPath();
+					offsets.clear();
+					for (end = start; end < order.size() && (*order[end])->getPath() == path; ++end) {
+						offsets.emplace_back((*order[end])->getFileOffsetStart());
+					}
+					results.resize(offsets.size());
+					auto resolver = resolverAllocator_->allocate(path);
+					resolver->resolve(offsets.data(), offsets.size(), results.data());
+					for (std::size_t i = start; i < end; ++i) {
+						(*order[i])->setResolved(results[i - start]);
+					}
+				}
+			}
+
+			/** Constructor */
+			explicit ExecutableSymbolNameBinder(
+				const std::shared_ptr<LinuxExecutableSymbolResolverAllocator>& resolverAllocator) :
+				resolverAllocator_(resolverAllocator) { }
+
+		protected:
+			std::shared_ptr<LinuxExecutableSymbolResolverAllocator> resolverAllocator_;
+		};
+
+		/** Resolved symbol names of single process */
+		struct IpCacheType {
+			AddressCache<std::shared_ptr<SymbolName>> symbolNames;
+			std::size_t mapsGeneration = 0;
+
+			/** For FreeListAllocator */
+			void freeResources() { symbolNames.freeResources(); }
+
+			/** For FreeListAllocator */
+			void reset(std::size_t capacity) {
+				symbolNames.reset(capacity);
+				mapsGeneration = 0;
+			}
+		};
+
 		/** Find out which process no longer exist and cleanup */
 		void checkSurvivalProcess() {
 			// cleanup pidToAddressLocator_
@@ -103,6 +373,17 @@ namespace LiveProfiler {
 					it = pidToAddressLocator_.erase(it);
 				}
 			}
+			// cleanup pidToIpCache_
+			lastIpCache_ = nullptr;
+			for (auto it = pidToIpCache_.begin(); it != pidToIpCache_.end();) {
+				pid_t pid = it->first;
+				if (pidToAddressLocator_.count(pid) > 0) {
+					++it;
+				} else {
+					ipCacheAllocator_.deallocate(std::move(it->second));
+					it = pidToIpCache_.erase(it);
+				}
+			}
 			// cleanup pidToCustomResolver_
 			lastCustomResolverPid_ = 0;
 			lastCustomResolverIterator_ = {};
@@ -118,36 +399,99 @@ namespace LiveProfiler {
 		}
 
 		/**
-		 * Resolve symbol name by pid and ip.
+		 * Resolve symbol name by pid and ip, timestamp is used for jit code and 0 means unknown.
 		 * Return nullptr if no symbol name is found.
 		 */
-		std::shared_ptr<SymbolName> resolve(pid_t pid, std::uint64_t ip) {
-			// find or create address locator by pid
-			// cache last result to improve performance
-			decltype(lastAddressLocatorIterator_) addressLocatorIt = {};
-			if (pid == lastAddressLocatorPid_) {
-				addressLocatorIt = lastAddressLocatorIterator_;
-			} else {
-				addressLocatorIt = pidToAddressLocator_.find(pid);
-				if (addressLocatorIt == pidToAddressLocator_.end()) {
-					auto pair = pidToAddressLocator_.emplace(pid,
-						addressLocatorAllocator_.allocate(pid, pathAllocator_));
-					addressLocatorIt = pair.first;
+		std::shared_ptr<SymbolName> resolve(pid_t pid, std::uint64_t ip, std::uint64_t timestamp) {
+			// find from ip cache, it's cleared if maps of the process are reloaded
+			auto& addressLocator = getAddressLocator(pid);
+			IpCacheType* ipCache = lastIpCache_;
+			if (ipCache != nullptr) {
+				if (ipCache->mapsGeneration != addressLocator->getMapsGeneration()) {
+					ipCache->symbolNames.clear();
+					ipCache->mapsGeneration = addressLocator->getMapsGeneration();
+				}
+				auto* cachedSymbolName = ipCache->symbolNames.get(ip);
+				if (cachedSymbolName != nullptr) {
+					++ipCacheHitCount_;
+					return *cachedSymbolName;
 				}
-				lastAddressLocatorPid_ = pid;
-				lastAddressLocatorIterator_ = addressLocatorIt;
+				++ipCacheMissCount_;
 			}
+			bool cacheable = true;
+			auto symbolName = resolveUncached(pid, ip, timestamp, addressLocator, cacheable);
+			// pending placeholders will be resolved later so don't cache them,
+			// except raw address placeholders, they are stable
+			if (ipCache != nullptr && symbolName != nullptr && cacheable &&
+				(!symbolName->isPending() || symbolName->getBinder() != nullptr)) {
+				// maps may be reloaded while resolving, the result is from the new maps
+				if (ipCache->mapsGeneration != addressLocator->getMapsGeneration()) {
+					ipCache->symbolNames.clear();
+					ipCache->mapsGeneration = addressLocator->getMapsGeneration();
+				}
+				ipCache->symbolNames.set(ip, symbolName);
+			}
+			return symbolName;
+		}
+
+		/**
+		 * Find or create address locator by pid, also select the ip cache of the process.
+		 * Cache last result to improve performance.
+		 */
+		std::unique_ptr<LinuxProcessAddressLocator>& getAddressLocator(pid_t pid) {
+			if (pid == lastAddressLocatorPid_) {
+				return lastAddressLocatorIterator_->second;
+			}
+			auto addressLocatorIt = pidToAddressLocator_.find(pid);
+			if (addressLocatorIt == pidToAddressLocator_.end()) {
+				auto pair = pidToAddressLocator_.emplace(pid,
+					addressLocatorAllocator_.allocate(pid, pathAllocator_));
+				addressLocatorIt = pair.first;
+			}
+			lastAddressLocatorPid_ = pid;
+			lastAddressLocatorIterator_ = addressLocatorIt;
+			lastIpCache_ = getIpCache(pid);
+			return addressLocatorIt->second;
+		}
+
+		/**
+		 * Resolve symbol name by pid and ip without ip cache,
+		 * `cacheable` is set to false if the result can't be cached by ip.
+		 */
+		std::shared_ptr<SymbolName> resolveUncached(
+			pid_t pid,
+			std::uint64_t ip,
+			std::uint64_t timestamp,
+			const std::unique_ptr<LinuxProcessAddressLocator>& addressLocator,
+			bool& cacheable) {
 			// although ip is the next instruction of the executing instruction,
 			// the executing instruction is rare to be ret,
 			// moretimes, the next instruction would be the entry point of a dynamic function,
 			// so here use ip, not ip-1.
 			std::shared_ptr<SymbolName> symbolName;
-			auto pathAndOffset = addressLocatorIt->second->locate(ip, false);
-			if (pathAndOffset.first != nullptr) {
-				auto resolver = resolverAllocator_->allocate(std::move(pathAndOffset.first));
-				symbolName = resolver->resolve(pathAndOffset.second);
+			// kernel addresses are never in the maps, locating them would reload the maps
+			auto* map = isKernelAddress(ip) ? nullptr : addressLocator->locateMap(ip, false);
+			std::size_t offset = (map == nullptr) ? 0 :
+				static_cast<std::size_t>(ip - map->getStartAddress() + map->getFileOffset());
+			if (map != nullptr && remoteClient_ != nullptr && resolveRemote(pid, *map, offset, symbolName)) {
+				// resolved from the cache of remote client, or waiting for the batch at the end of `alter`
+			} else if (map != nullptr && rawAddressMode_ && map->isFileBacked()) {
+				// anonymous (jit) and pseudo mappings fall through to the custom resolver
+				return getRawPlaceholder(map->getPath(), offset);
+			} else if (map != nullptr && resolverLoader_ != nullptr) {
+				auto resolver = getLoadedResolver(map->getPath());
+				if (resolver == nullptr) {
+					return getPlaceholder(pendingSymbolNames_, map->getPath(), offset, nullptr);
+				}
+				symbolName = resolver->resolve(offset);
+			} else if (map != nullptr) {
+				// the resolver is attached to the mapping, so it's only allocated once per mapping
+				if (map->getResolver() == nullptr) {
+					map->setResolver(resolverAllocator_->allocate(pid, *map));
+				}
+				symbolName = map->getResolver()->resolve(offset);
 			} else {
-				symbolName = kernelResolver_.resolve(ip);
+				symbolName = kernelResolver_->resolve(ip);
 			}
 			if (symbolName == nullptr) {
 				// find or create custom resolver by pid
@@ -168,23 +512,205 @@ namespace LiveProfiler {
 					lastCustomResolverPid_ = pid;
 					lastCustomResolverIterator_ = customResolverIt;
 				}
-				symbolName = customResolverIt->second->resolve(ip, false);
+				symbolName = customResolverIt->second->resolve(ip, false, timestamp);
+				// jit code may be moved or replaced, the name of an address depends on the timestamp
+				// and samples are not ordered by time, so names of jit code are not cached by ip
+				cacheable = false;
+			}
+			return symbolName;
+		}
+
+		/** Return whether the address is in kernel space, it's the upper half of address space on 64 bit linux */
+		static bool isKernelAddress(std::uint64_t ip) {
+			return sizeof(std::uintptr_t) >= sizeof(std::uint64_t) && (ip >> 63) != 0;
+		}
+
+		/** Find or create ip cache by pid, return nullptr if ip cache is disabled */
+		IpCacheType* getIpCache(pid_t pid) {
+			auto it = pidToIpCache_.find(pid);
+			if (it != pidToIpCache_.end()) {
+				return it->second.get();
+			}
+			if (ipCacheCapacity_ == 0) {
+				return nullptr;
+			}
+			auto pair = pidToIpCache_.emplace(pid, ipCacheAllocator_.allocate(ipCacheCapacity_));
+			return pair.first->second.get();
+		}
+
+		/** Get the resolver loaded by background threads, return nullptr if it's still loading */
+		std::shared_ptr<LinuxExecutableSymbolResolver> getLoadedResolver(
+			const std::shared_ptr<std::string>& path) {
+			// avoid the lock inside loader for loaded resolvers
+			auto it = loadedResolvers_.find(path);
+			if (it != loadedResolvers_.end()) {
+				return it->second;
+			}
+			auto resolver = resolverLoader_->tryGet(path);
+			if (resolver != nullptr) {
+				loadedResolvers_.emplace(path, resolver);
+			}
+			return resolver;
+		}
+
+		/**
+		 * Resolve the address by the remote client if the mapped file has build-id, return false if it hasn't.
+		 * If the answer is not cached, `symbolName` will be a pending placeholder,
+		 * it's resolved by `resolveRemoteQueries` at the end of `alter`.
+		 */
+		bool resolveRemote(
+			pid_t pid,
+			const LinuxProcessAddressMap& map,
+			std::size_t offset,
+			std::shared_ptr<SymbolName>& symbolName) {
+			const auto& buildId = remoteClient_->getBuildId(pid, map);
+			if (buildId == nullptr) {
+				return false;
+			} else if (remoteClient_->find(buildId, offset, symbolName)) {
+				return true;
+			}
+			// placeholders are keyed by build-id, the same file may have different paths
+			auto& placeholder = remoteSymbolNames_[buildId][offset];
+			if (placeholder == nullptr) {
+				placeholder = makePlaceholder(map.getPath(), offset, nullptr);
+				remoteQueries_.emplace_back(LinuxRemoteSymbolClient::Query({ buildId, map.getPath(), offset }));
+			}
+			symbolName = placeholder;
+			return true;
+		}
+
+		/** Send the pending queries to the remote server, then replace the placeholders in model data */
+		void resolveRemoteQueries(std::vector<std::unique_ptr<CpuSampleModel>>& models) {
+			remoteClient_->resolve(remoteQueries_, remoteResults_);
+			for (std::size_t i = 0; i < remoteQueries_.size(); ++i) {
+				const auto& query = remoteQueries_[i];
+				remoteSymbolNames_[query.buildId][query.offset]->setResolved(remoteResults_[i]);
+			}
+			for (auto& model : models) {
+				model->setSymbolName(SymbolName::resolveLateBound(model->getSymbolName()));
+				for (auto& symbolName : model->getCallChainSymbolNames()) {
+					symbolName = SymbolName::resolveLateBound(symbolName);
+				}
+			}
+			remoteSymbolNames_.clear();
+			remoteQueries_.clear();
+			remoteResults_.clear();
+		}
+
+		/** Get the placeholder for (path, offset) from `placeholders`, create if not exists */
+		std::shared_ptr<SymbolName> getPlaceholder(
+			PlaceholdersType& placeholders,
+			const std::shared_ptr<std::string>& path,
+			std::size_t offset,
+			const std::shared_ptr<SymbolNameBinder>& binder) {
+			auto& symbolName = placeholders[path][offset];
+			if (symbolName == nullptr) {
+				symbolName = makePlaceholder(path, offset, binder);
+			}
+			return symbolName;
+		}
+
+		/** Get the placeholder for (path, offset) in raw address mode, drop all kept placeholders if exceeds the limit */
+		std::shared_ptr<SymbolName> getRawPlaceholder(
+			const std::shared_ptr<std::string>& path,
+			std::size_t offset) {
+			auto& offsets = rawSymbolNames_[path];
+			auto it = offsets.find(offset);
+			if (it != offsets.end()) {
+				return it->second;
+			}
+			if (rawSymbolNameCount_ >= maxRawSymbolNames_) {
+				rawSymbolNames_.clear();
+				rawSymbolNameCount_ = 0;
+			}
+			auto symbolName = makePlaceholder(path, offset, rawSymbolNameBinder_);
+			if (maxRawSymbolNames_ > 0) {
+				rawSymbolNames_[path].emplace(offset, symbolName);
+				++rawSymbolNameCount_;
 			}
 			return symbolName;
 		}
 
+		/** Create the placeholder for (path, offset), the name is "path+0xoffset" */
+		static std::shared_ptr<SymbolName> makePlaceholder(
+			const std::shared_ptr<std::string>& path,
+			std::size_t offset,
+			const std::shared_ptr<SymbolNameBinder>& binder) {
+			static const char hex[] = "0123456789abcdef";
+			std::string name(*path);
+			name.append("+0x");
+			std::size_t digits = 1;
+			while (digits < sizeof(offset) * 2 && (offset >> (digits * 4)) != 0) {
+				++digits;
+			}
+			for (std::size_t i = digits; i > 0; --i) {
+				name.push_back(hex[(offset >> ((i - 1) * 4)) & 0xf]);
+			}
+			auto symbolName = std::make_shared<SymbolName>(name, path);
+			symbolName->setFileOffsetStart(offset);
+			symbolName->setFileOffsetEnd(offset + 1);
+			symbolName->setPending(binder);
+			return symbolName;
+		}
+
+		/** Resolve placeholders whose symbol tables are loaded since last call */
+		void backfillPendingSymbolNames() {
+			if (pendingSymbolNames_.empty()) {
+				return;
+			}
+			resolverLoader_->takeLoadedPaths(loadedPaths_);
+			for (const auto& path : loadedPaths_) {
+				auto it = pendingSymbolNames_.find(path);
+				if (it == pendingSymbolNames_.end()) {
+					continue;
+				}
+				auto resolver = getLoadedResolver(path);
+				assert(resolver != nullptr);
+				for (auto& pair : it->second) {
+					pair.second->setResolved(resolver->resolve(pair.first));
+				}
+				pendingSymbolNames_.erase(it);
+			}
+		}
+
 	protected:
 		// address -> (file, offset)
 		std::unordered_map<pid_t, std::unique_ptr<LinuxProcessAddressLocator>> pidToAddressLocator_;
 		FreeListAllocator<LinuxProcessAddressLocator> addressLocatorAllocator_;
 		pid_t lastAddressLocatorPid_;
 		decltype(pidToAddressLocator_)::iterator lastAddressLocatorIterator_;
+		// address -> symbol, cached
+		std::unordered_map<pid_t, std::unique_ptr<IpCacheType>> pidToIpCache_;
+		FreeListAllocator<IpCacheType> ipCacheAllocator_;
+		IpCacheType* lastIpCache_;
+		std::size_t ipCacheCapacity_;
+		std::size_t ipCacheHitCount_;
+		std::size_t ipCacheMissCount_;
 		// (file, offset) -> symbol
 		std::shared_ptr<SingletonAllocator<std::string, std::string>> pathAllocator_;
-		std::shared_ptr<SingletonAllocator<
-			std::shared_ptr<std::string>, LinuxExecutableSymbolResolver>> resolverAllocator_;
+		std::shared_ptr<LinuxExecutableSymbolResolverAllocator> resolverAllocator_;
+		std::shared_ptr<LinuxSymbolTableCache> symbolTableCache_;
+		// (file, offset) -> symbol, asynchronous
+		std::size_t asyncWorkerCount_;
+		std::unique_ptr<LinuxExecutableSymbolResolverLoader> resolverLoader_;
+		std::unordered_map<std::shared_ptr<std::string>,
+			std::shared_ptr<LinuxExecutableSymbolResolver>> loadedResolvers_;
+		std::vector<std::shared_ptr<std::string>> loadedPaths_;
+		PlaceholdersType pendingSymbolNames_;
+		std::chrono::high_resolution_clock::duration prewarmDuration_;
+		// (file, offset) -> symbol, resolved by analyzers
+		bool rawAddressMode_;
+		PlaceholdersType rawSymbolNames_;
+		std::size_t rawSymbolNameCount_;
+		std::size_t maxRawSymbolNames_;
+		std::shared_ptr<SymbolNameBinder> rawSymbolNameBinder_;
+		// (build-id, offset) -> symbol, resolved by remote server
+		std::unique_ptr<LinuxRemoteSymbolClient> remoteClient_;
+		PlaceholdersType remoteSymbolNames_;
+		std::vector<LinuxRemoteSymbolClient::Query> remoteQueries_;
+		std::vector<std::shared_ptr<SymbolName>> remoteResults_;
 		// address -> kernel symbol
-		LinuxKernelSymbolResolver kernelResolver_;
+		std::shared_ptr<LinuxKernelSymbolResolver> kernelResolver_;
 		// address -> custom symbol
 		std::unordered_map<pid_t, std::unique_ptr<LinuxProcessCustomSymbolResolver>> pidToCustomResolver_;
 		FreeListAllocator<LinuxProcessCustomSymbolResolver> customResolverAllocator_;
@@ -7,22 +7,52 @@ namespace LiveProfiler {
 	 * Result from `getCallChainIps` and `getCallChainSymbolNames` should have same size.
 	 * It's valid that `getSymbolName` returns nullptr,
 	 * and `getCallChainSymbolNames` returns a vector which contains some nullptr.
+	 * `getCgroupId` returns 0 if the sample isn't collected by cgroup.
+	 * `getTimestamp` returns the time of the sample in nanoseconds (CLOCK_MONOTONIC), or 0 if unknown.
+	 * `getAddressMaps` returns the executable mappings created since the previous sample
+	 * of the same thread (or cgroup on the same cpu), they should be applied before resolving this sample.
+	 * `isAddressMapsLost` returns true if some mappings before this sample are lost (e.g. the ring buffer is full),
+	 * the maps of the process should be reloaded instead of trusting the attached mappings.
 	 */
 	class CpuSampleModel {
 	public:
+		/**
+		 * Address range mapped into a process, path is empty for anonymous mappings.
+		 * The mapped file is identified by (device, inode), device is encoded by makedev.
+		 * Timestamp is the time of the mapping (CLOCK_MONOTONIC in nanoseconds), or 0 if unknown.
+		 */
+		struct AddressMap {
+			std::uint64_t pid;
+			std::uint64_t timestamp;
+			std::uint64_t startAddress;
+			std::uint64_t endAddress;
+			std::uint64_t fileOffset;
+			std::uint64_t device;
+			std::uint64_t inode;
+			std::string path;
+		};
+
 		/** Getters and setters */
 		std::uint64_t getIp() const { return ip_; }
 		std::uint64_t getPid() const { return pid_; }
 		std::uint64_t getTid() const { return tid_; }
+		std::uint64_t getCgroupId() const { return cgroupId_; }
+		std::uint64_t getTimestamp() const { return timestamp_; }
 		const auto& getSymbolName() const& { return symbolName_; }
 		const auto& getCallChainIps() const& { return callChainIps_; }
 		auto& getCallChainIps() & { return callChainIps_; }
 		const auto& getCallChainSymbolNames() const& { return callChainSymbolNames_; }
 		auto& getCallChainSymbolNames() & { return callChainSymbolNames_; }
+		const auto& getAddressMaps() const& { return addressMaps_; }
+		auto& getAddressMaps() & { return addressMaps_; }
+		bool isAddressMapsLost() const { return addressMapsLost_; }
 		void setIp(std::uint64_t ip) { ip_ = ip; }
 		void setPid(std::uint64_t pid) { pid_ = pid; }
 		void setTid(std::uint64_t tid) { tid_ = tid; }
+		void setCgroupId(std::uint64_t cgroupId) { cgroupId_ = cgroupId; }
+		void setTimestamp(std::uint64_t timestamp) { timestamp_ = timestamp; }
 		void setSymbolName(const std::shared_ptr<SymbolName>& name) { symbolName_ = name; }
+		void setAddressMapsLost(bool addressMapsLost) { addressMapsLost_ = addressMapsLost; }
 
 		/** For FreeListAllocator */
 		// cppcheck-suppress functionStatic
@@ -33,9 +63,13 @@ namespace LiveProfiler {
 			ip_ = 0;
 			pid_ = 0;
 			tid_ = 0;
+			cgroupId_ = 0;
+			timestamp_ = 0;
 			symbolName_ = nullptr;
 			callChainIps_.clear();
 			callChainSymbolNames_.clear();
+			addressMaps_.clear();
+			addressMapsLost_ = false;
 		}
 
 		/** Constructor */
@@ -43,17 +77,25 @@ namespace LiveProfiler {
 			ip_(),
 			pid_(),
 			tid_(),
+			cgroupId_(),
+			timestamp_(),
 			symbolName_(),
 			callChainIps_(),
-			callChainSymbolNames_() { }
+			callChainSymbolNames_(),
+			addressMaps_(),
+			addressMapsLost_(false) { }
 
 	protected:
 		std::uint64_t ip_;
 		std::uint64_t pid_;
 		std::uint64_t tid_;
+		std::uint64_t cgroupId_;
+		std::uint64_t timestamp_;
 		std::shared_ptr<SymbolName> symbolName_;
 		std::vector<std::uint64_t> callChainIps_;
 		std::vector<std::shared_ptr<SymbolName>> callChainSymbolNames_;
+		std::vector<AddressMap> addressMaps_;
+		bool addressMapsLost_;
 	};
 }
 
@@ -1,29 +1,125 @@
 #pragma once
 #include <string>
 #include <memory>
+#include <vector>
+#include <algorithm>
+#include "../../Utils/DemangleUtils.hpp"
 
 namespace LiveProfiler {
+	class SymbolName;
+
+	/**
+	 * Interface used to resolve placeholders in bulk when their symbol names are needed,
+	 * `bind` should call `setResolved` on each placeholder.
+	 */
+	class SymbolNameBinder {
+	public:
+		/** Resolve the placeholders, they are all pending and bound to this binder */
+		virtual void bind(const std::vector<std::shared_ptr<SymbolName>>& placeholders) = 0;
+
+		/** Virtual destructor */
+		virtual ~SymbolNameBinder() = default;
+	};
+
 	/**
 	 * Represent a symbol name in the executable file.
 	 * The originalName and path should not be empty, the demangleName can be empty.
+	 * If the demangleName is not set, it's demangled from the originalName on first access,
+	 * most symbols are never sampled so it's not necessary to demangle them on load.
+	 *
+	 * A symbol name can be a placeholder for the symbol that is not resolved yet,
+	 * the path and file offset start are set, and the name is "path+0xoffset".
+	 * Once resolved, the placeholder points to the resolved symbol name (may be nullptr),
+	 * analyzers should use `resolveLateBound` to merge placeholders into resolved symbol names.
+	 * A placeholder may have a binder, that means it's resolved only when asked,
+	 * analyzers should call `bindPlaceholders` for pending placeholders before generating the result.
 	 */
 	class SymbolName {
 	public:
 		/** Getters and Setters **/
 		const std::string& getOriginalName() const& { return originalName_; }
-		const std::string& getDemangleName() const& { return demangleName_; }
+		const std::string& getDemangleName() const& {
+			if (!demangled_) {
+				demangleName_ = DemangleUtils::demangle(originalName_);
+				demangled_ = true;
+			}
+			return *demangleName_;
+		}
 		const std::shared_ptr<std::string>& getPath() const& { return path_; }
 		std::size_t getFileOffsetStart() const { return fileOffsetStart_; }
 		std::size_t getFileOffsetEnd() const { return fileOffsetEnd_; }
-		void setOriginalName(const std::string& name) { originalName_ = name; }
-		void setDemangleName(const std::string& name) { demangleName_ = name; }
+		bool isDemangled() const { return demangled_; }
+		void setOriginalName(const std::string& name) { originalName_ = name; demangled_ = false; }
+		void setDemangleName(const std::string& name) {
+			demangleName_ = name.empty() ?
+				DemangleUtils::getEmptyName() : std::make_shared<const std::string>(name);
+			demangled_ = true;
+		}
 		void setPath(const std::shared_ptr<std::string>& path) { path_ = path; }
 		void setFileOffsetStart(std::size_t offset) { fileOffsetStart_ = offset; }
 		void setFileOffsetEnd(std::size_t offset) { fileOffsetEnd_ = offset; }
+		bool isPlaceholder() const { return placeholder_; }
+		bool isPending() const { return placeholder_ && pending_; }
+		const std::shared_ptr<SymbolName>& getResolved() const& { return resolved_; }
+		const std::shared_ptr<SymbolNameBinder>& getBinder() const& { return binder_; }
+
+		/**
+		 * Mark this symbol name as a placeholder that waiting to be resolved,
+		 * if binder is given, it's resolved by the binder when `bindPlaceholders` is called.
+		 */
+		void setPending(const std::shared_ptr<SymbolNameBinder>& binder = nullptr) {
+			placeholder_ = true;
+			pending_ = true;
+			resolved_ = nullptr;
+			binder_ = binder;
+		}
+
+		/** Bind the resolved symbol name to this placeholder, nullptr means no symbol found */
+		void setResolved(const std::shared_ptr<SymbolName>& resolved) {
+			placeholder_ = true;
+			pending_ = false;
+			resolved_ = resolved;
+			binder_ = nullptr;
+		}
+
+		/**
+		 * Resolve pending placeholders that have a binder, each binder is called once with all it's placeholders.
+		 * Other symbol names are ignored, the order of `symbolNames` may be changed.
+		 */
+		static void bindPlaceholders(std::vector<std::shared_ptr<SymbolName>>& symbolNames) {
+			auto end = std::partition(symbolNames.begin(), symbolNames.end(), [](const auto& symbolName) {
+				return symbolName != nullptr && symbolName->isPending() && symbolName->binder_ != nullptr;
+			});
+			std::sort(symbolNames.begin(), end, [](const auto& a, const auto& b) {
+				return a->binder_ < b->binder_;
+			});
+			std::vector<std::shared_ptr<SymbolName>> placeholders;
+			for (auto it = symbolNames.begin(); it != end;) {
+				auto binder = (*it)->binder_;
+				placeholders.clear();
+				for (; it != end && (*it)->binder_ == binder; ++it) {
+					placeholders.emplace_back(*it);
+				}
+				binder->bind(placeholders);
+			}
+		}
+
+		/**
+		 * Return the resolved symbol name (may be nullptr) if it's a resolved placeholder,
+		 * otherwise return the symbol name itself.
+		 */
+		static const std::shared_ptr<SymbolName>& resolveLateBound(
+			const std::shared_ptr<SymbolName>& symbolName) {
+			if (symbolName != nullptr && symbolName->placeholder_ && !symbolName->pending_) {
+				return symbolName->resolved_;
+			}
+			return symbolName;
+		}
 
 		/** Return either the demangle name or the orignal name */
 		const std::string& getName() const& {
-			return demangleName_.empty() ? originalName_ : demangleName_;
+			const auto& demangleName = getDemangleName();
+			return demangleName.empty() ? originalName_ : demangleName;
 		}
 
 		/** Constructor */
@@ -35,16 +131,26 @@ namespace LiveProfiler {
 			const std::shared_ptr<std::string>& path) :
 			originalName_(name),
 			demangleName_(),
+			demangled_(false),
 			path_(path),
 			fileOffsetStart_(0),
-			fileOffsetEnd_(0) { }
+			fileOffsetEnd_(0),
+			placeholder_(false),
+			pending_(false),
+			resolved_(),
+			binder_() { }
 
 	protected:
 		std::string originalName_;
-		std::string demangleName_;
+		mutable std::shared_ptr<const std::string> demangleName_;
+		mutable bool demangled_;
 		std::shared_ptr<std::string> path_;
 		std::size_t fileOffsetStart_;
 		std::size_t fileOffsetEnd_;
+		bool placeholder_;
+		bool pending_;
+		std::shared_ptr<SymbolName> resolved_;
+		std::shared_ptr<SymbolNameBinder> binder_;
 	};
 }
 
@@ -18,9 +18,9 @@ namespace LiveProfiler {
 		std::shared_ptr<T> allocate(Head&& key, Rest&&... rest) {
 			auto it = mapping_.find(key);
 			if (it == mapping_.end()) {
-				auto pair = mapping_.emplace(key,
-					std::make_shared<T>(std::forward<Head>(key), std::forward<Rest>(rest)...));
-				it = pair.first;
+				// insert the key first, the key may be moved and can't be used after constructing T
+				it = mapping_.emplace(std::forward<Head>(key), nullptr).first;
+				it->second = std::make_shared<T>(it->first, std::forward<Rest>(rest)...);
 			}
 			return it->second;
 		}
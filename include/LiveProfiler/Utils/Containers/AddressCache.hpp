@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <utility>
+
+namespace LiveProfiler {
+	/**
+	 * Fixed size 2-way set associative cache keyed by address.
+	 * Each address can be stored in 2 slots of it's set, the most recently used one comes first,
+	 * the least recently used one is replaced when inserting.
+	 * Address 0 is used to mark empty slot, so it can't be cached.
+	 * This class is not thread safe.
+	 */
+	template <class T>
+	class AddressCache {
+	public:
+		/** Getters */
+		std::size_t capacity() const { return entries_.size(); }
+
+		/** For FreeListAllocator */
+		void freeResources() {
+			entries_.clear();
+			entries_.shrink_to_fit();
+		}
+
+		/** For FreeListAllocator, capacity will be rounded up to power of 2 */
+		void reset(std::size_t capacity) {
+			std::size_t setCount = 1;
+			while (setCount * Ways < capacity) {
+				setCount <<= 1;
+			}
+			setMask_ = setCount - 1;
+			entries_.clear();
+			entries_.resize(setCount * Ways);
+		}
+
+		/** Get the cached value of address, return nullptr if not cached */
+		const T* get(std::uint64_t address) {
+			auto* set = getSet(address);
+			if (set[0].first == address && address != 0) {
+				return &set[0].second;
+			} else if (set[1].first == address && address != 0) {
+				std::swap(set[0], set[1]);
+				return &set[0].second;
+			}
+			return nullptr;
+		}
+
+		/** Set the cached value of address, replace the least recently used one if the set is full */
+		void set(std::uint64_t address, const T& value) {
+			if (address == 0) {
+				return;
+			}
+			auto* set = getSet(address);
+			if (set[0].first != address) {
+				set[1] = std::move(set[0]);
+				set[0].first = address;
+			}
+			set[0].second = value;
+		}
+
+		/** Remove all cached values */
+		void clear() {
+			for (auto& entry : entries_) {
+				entry = {};
+			}
+		}
+
+		/** Constructor */
+		AddressCache() :
+			entries_(),
+			setMask_(0) { }
+
+	protected:
+		static const std::size_t Ways = 2;
+
+		/** Get the first slot of the set for address */
+		std::pair<std::uint64_t, T>* getSet(std::uint64_t address) {
+			// fibonacci hashing, instruction addresses are not uniformly distributed
+			auto hash = static_cast<std::size_t>((address * 0x9e3779b97f4a7c15ULL) >> 32);
+			return entries_.data() + (hash & setMask_) * Ways;
+		}
+
+	protected:
+		std::vector<std::pair<std::uint64_t, T>> entries_;
+		std::size_t setMask_;
+	};
+}
+
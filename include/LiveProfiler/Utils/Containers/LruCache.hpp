@@ -0,0 +1,84 @@
+#pragma once
+#include <list>
+#include <iterator>
+#include <utility>
+#include <functional>
+#include <unordered_map>
+
+namespace LiveProfiler {
+	/**
+	 * Fixed capacity cache evicts the least recently used entry first.
+	 * Entries are kept in a list ordered by use, the most recently used one comes first,
+	 * and indexed by a hash map, so get and set are O(1).
+	 * Unlike AddressCache, keys can be any hashable type and there no collision between keys.
+	 * This class is not thread safe.
+	 */
+	template <class Key, class Value, class Hash = std::hash<Key>>
+	class LruCache {
+	public:
+		/** Getters */
+		std::size_t size() const { return index_.size(); }
+		std::size_t capacity() const { return capacity_; }
+
+		/** For FreeListAllocator */
+		void freeResources() {
+			clear();
+		}
+
+		/** For FreeListAllocator, capacity 0 means nothing will be cached */
+		void reset(std::size_t capacity) {
+			clear();
+			capacity_ = capacity;
+		}
+
+		/** Get the cached value of key and mark it as most recently used, return nullptr if not cached */
+		const Value* get(const Key& key) {
+			auto it = index_.find(key);
+			if (it == index_.end()) {
+				return nullptr;
+			}
+			entries_.splice(entries_.begin(), entries_, it->second);
+			return &it->second->second;
+		}
+
+		/** Set the cached value of key, remove the least recently used one if the cache is full */
+		void set(const Key& key, const Value& value) {
+			auto it = index_.find(key);
+			if (it != index_.end()) {
+				it->second->second = value;
+				entries_.splice(entries_.begin(), entries_, it->second);
+				return;
+			} else if (capacity_ == 0) {
+				return;
+			}
+			if (index_.size() >= capacity_) {
+				// reuse the node of the evicted entry
+				index_.erase(entries_.back().first);
+				entries_.splice(entries_.begin(), entries_, std::prev(entries_.end()));
+				entries_.front().first = key;
+				entries_.front().second = value;
+			} else {
+				entries_.emplace_front(key, value);
+			}
+			index_.emplace(key, entries_.begin());
+		}
+
+		/** Remove all cached values */
+		void clear() {
+			entries_.clear();
+			index_.clear();
+		}
+
+		/** Constructor */
+		explicit LruCache(std::size_t capacity = 0) :
+			entries_(),
+			index_(),
+			capacity_(capacity) { }
+
+	protected:
+		std::list<std::pair<Key, Value>> entries_;
+		std::unordered_map<Key, typename std::list<std::pair<Key, Value>>::iterator, Hash> index_;
+		std::size_t capacity_;
+	};
+}
+
@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+namespace LiveProfiler {
+	/**
+	 * Bounded lock free queue with single producer and single consumer.
+	 * `push` should only be called from the producer thread,
+	 * and `pop` should only be called from the consumer thread.
+	 * The capacity will be rounded up to power of 2.
+	 */
+	template <class T>
+	class SpscQueue {
+	public:
+		/** Size of cache line, used to separate head and tail */
+		static const std::size_t CacheLineSize = 64;
+
+		/** Getters */
+		std::size_t capacity() const { return slots_.size(); }
+		bool empty() const {
+			return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+		}
+
+		/** Push element to the queue, return false and keep `value` untouched if the queue is full */
+		bool push(T&& value) {
+			auto tail = tail_.load(std::memory_order_relaxed);
+			if (tail - head_.load(std::memory_order_acquire) >= slots_.size()) {
+				return false;
+			}
+			slots_[tail & mask_] = std::move(value);
+			tail_.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		/** Pop element from the queue, return false if the queue is empty */
+		bool pop(T& value) {
+			auto head = head_.load(std::memory_order_relaxed);
+			if (head == tail_.load(std::memory_order_acquire)) {
+				return false;
+			}
+			value = std::move(slots_[head & mask_]);
+			head_.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		/** Constructor */
+		explicit SpscQueue(std::size_t capacity) :
+			slots_(),
+			mask_(0),
+			head_(0),
+			headPadding_(),
+			tail_(0),
+			tailPadding_() {
+			std::size_t size = 1;
+			while (size < capacity) {
+				size <<= 1;
+			}
+			slots_.resize(size);
+			mask_ = size - 1;
+		}
+
+	protected:
+		/** Disable copy */
+		SpscQueue(const SpscQueue&) = delete;
+		SpscQueue& operator=(const SpscQueue&) = delete;
+
+	protected:
+		std::vector<T> slots_;
+		std::size_t mask_;
+		// head and tail are separated by padding to avoid false sharing,
+		// alignas doesn't work for heap allocated objects before c++17 (no aligned operator new)
+		std::atomic<std::size_t> head_;
+		char headPadding_[CacheLineSize - sizeof(std::atomic<std::size_t>)];
+		std::atomic<std::size_t> tail_;
+		char tailPadding_[CacheLineSize - sizeof(std::atomic<std::size_t>)];
+	};
+}
+
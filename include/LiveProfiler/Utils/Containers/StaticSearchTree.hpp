@@ -0,0 +1,207 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+namespace LiveProfiler {
+	/**
+	 * Static search tree over sorted 64 bit keys, used to find the first key greater than the value (upper bound).
+	 * Keys are copied into a B-tree with 8 keys per node (one cache line), nodes are stored in a single array
+	 * in breadth first order (like Eytzinger layout), so children of node k are k*9+1 ... k*9+9.
+	 * A lookup touches one cache line per level, about log9(n) lines instead of log2(n) lines,
+	 * keys inside a node are compared at once, with AVX2 or SSE4.2 if the compiler enables them.
+	 *
+	 * Batched lookups walk multiple values level by level and prefetch the next nodes,
+	 * so cache misses of different values are overlapped, it's useful for addresses of a call chain.
+	 * The tree stores the index of each key in the original array, up to UINT32_MAX - 1 keys are supported.
+	 * All const functions are thread safe.
+	 */
+	class StaticSearchTree {
+	public:
+		/** How many values are walked together in batched lookups */
+		static const std::size_t BatchSize = 16;
+
+		/** Getters */
+		std::size_t size() const { return size_; }
+		bool empty() const { return size_ == 0; }
+
+		/**
+		 * Rebuild the tree from `count` sorted keys, `getKey(index)` should return the key at index.
+		 * Return false if the keys are too many, the tree will be empty.
+		 */
+		template <class Func>
+		bool assign(std::size_t count, const Func& getKey) {
+			clear();
+			if (count >= UINT32_MAX) {
+				return false;
+			}
+			size_ = count;
+			nodeCount_ = (count + NodeSize - 1) / NodeSize;
+			// extra node for alignment, unused slots are filled with max key and index of the end
+			keys_.assign((nodeCount_ + 1) * NodeSize, UINT64_MAX);
+			indices_.assign(nodeCount_ * NodeSize, static_cast<std::uint32_t>(count));
+			std::size_t next = 0;
+			build(0, getNodes(), next, getKey);
+			return true;
+		}
+
+		/** Remove all keys and free the memory */
+		void clear() {
+			keys_ = {};
+			indices_ = {};
+			size_ = 0;
+			nodeCount_ = 0;
+		}
+
+		/** Find the index of the first key greater than value, return `size()` if not found */
+		std::size_t upperBound(std::uint64_t value) const {
+			const std::uint64_t* nodes = getNodes();
+			std::size_t slot = NoSlot;
+			std::size_t node = 0;
+			while (node < nodeCount_) {
+				auto rank = getRank(nodes + node * NodeSize, value);
+				if (rank < NodeSize) {
+					slot = node * NodeSize + rank;
+				}
+				node = node * (NodeSize + 1) + rank + 1;
+			}
+			return (slot == NoSlot) ? size_ : indices_[slot];
+		}
+
+		/**
+		 * Find the indices of the first keys greater than each value, `size()` is stored if not found.
+		 * Values don't need to be sorted.
+		 */
+		template <class T>
+		void upperBound(const T* values, std::size_t count, std::size_t* results) const {
+			const std::uint64_t* nodes = getNodes();
+			std::size_t groupNodes[BatchSize];
+			std::size_t groupSlots[BatchSize];
+			for (std::size_t groupStart = 0; groupStart < count; groupStart += BatchSize) {
+				std::size_t groupSize = std::min(BatchSize, count - groupStart);
+				const T* groupValues = values + groupStart;
+				for (std::size_t i = 0; i < groupSize; ++i) {
+					groupNodes[i] = 0;
+					groupSlots[i] = NoSlot;
+				}
+				// walk all values by level, the next nodes are fetching while comparing other values
+				bool walking = nodeCount_ > 0;
+				while (walking) {
+					walking = false;
+					for (std::size_t i = 0; i < groupSize; ++i) {
+						std::size_t node = groupNodes[i];
+						if (node >= nodeCount_) {
+							continue;
+						}
+						auto rank = getRank(nodes + node * NodeSize, static_cast<std::uint64_t>(groupValues[i]));
+						if (rank < NodeSize) {
+							groupSlots[i] = node * NodeSize + rank;
+						}
+						node = node * (NodeSize + 1) + rank + 1;
+						groupNodes[i] = node;
+						if (node < nodeCount_) {
+							prefetch(nodes + node * NodeSize);
+							walking = true;
+						}
+					}
+				}
+				for (std::size_t i = 0; i < groupSize; ++i) {
+					std::size_t slot = groupSlots[i];
+					results[groupStart + i] = (slot == NoSlot) ? size_ : indices_[slot];
+				}
+			}
+		}
+
+		/** Constructor */
+		StaticSearchTree() :
+			keys_(),
+			indices_(),
+			size_(0),
+			nodeCount_(0) { }
+
+	protected:
+		/** Keys per node, 8 * 64 bits is the size of a cache line */
+		static const std::size_t NodeSize = 8;
+		static const std::size_t NoSlot = SIZE_MAX;
+
+		/** Get the first node, it's aligned to cache line */
+		std::uint64_t* getNodes() {
+			auto address = reinterpret_cast<std::uintptr_t>(keys_.data());
+			auto alignment = NodeSize * sizeof(std::uint64_t);
+			return keys_.data() + (((alignment - address % alignment) % alignment) / sizeof(std::uint64_t));
+		}
+		const std::uint64_t* getNodes() const {
+			return const_cast<StaticSearchTree*>(this)->getNodes();
+		}
+
+		/** Fill keys of the subtree in sorted order (in-order traversal) */
+		template <class Func>
+		void build(std::size_t node, std::uint64_t* nodes, std::size_t& next, const Func& getKey) {
+			if (node >= nodeCount_) {
+				return;
+			}
+			for (std::size_t i = 0; i < NodeSize; ++i) {
+				build(node * (NodeSize + 1) + i + 1, nodes, next, getKey);
+				if (next < size_) {
+					nodes[node * NodeSize + i] = static_cast<std::uint64_t>(getKey(next));
+					indices_[node * NodeSize + i] = static_cast<std::uint32_t>(next);
+					++next;
+				}
+			}
+			build(node * (NodeSize + 1) + NodeSize + 1, nodes, next, getKey);
+		}
+
+		/** Get how many keys in the node are less than or equal to value, keys in node are sorted */
+		static std::size_t getRank(const std::uint64_t* node, std::uint64_t value) {
+#if defined(__AVX2__)
+			// there no unsigned compare, flip the sign bit then compare as signed
+			const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+			__m256i target = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(value)), sign);
+			__m256i low = _mm256_xor_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(node)), sign);
+			__m256i high = _mm256_xor_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(node + 4)), sign);
+			auto greater = static_cast<unsigned>(
+				_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(low, target))) |
+				(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(high, target))) << 4));
+			return NodeSize - static_cast<std::size_t>(__builtin_popcount(greater));
+#elif defined(__SSE4_2__)
+			const __m128i sign = _mm_set1_epi64x(INT64_MIN);
+			__m128i target = _mm_xor_si128(_mm_set1_epi64x(static_cast<long long>(value)), sign);
+			unsigned greater = 0;
+			for (std::size_t i = 0; i < NodeSize; i += 2) {
+				__m128i keys = _mm_xor_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(node + i)), sign);
+				greater += static_cast<unsigned>(__builtin_popcount(
+					_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(keys, target)))));
+			}
+			return NodeSize - greater;
+#else
+			// branchless, the compiler may vectorize it
+			std::size_t rank = 0;
+			for (std::size_t i = 0; i < NodeSize; ++i) {
+				rank += static_cast<std::size_t>(node[i] <= value);
+			}
+			return rank;
+#endif
+		}
+
+		/** Hint the cpu to load the node into cache */
+		static void prefetch(const std::uint64_t* node) {
+#if defined(__GNUC__)
+			__builtin_prefetch(node);
+#else
+			(void)node;
+#endif
+		}
+
+	protected:
+		std::vector<std::uint64_t> keys_;
+		std::vector<std::uint32_t> indices_;
+		std::size_t size_;
+		std::size_t nodeCount_;
+	};
+}
+
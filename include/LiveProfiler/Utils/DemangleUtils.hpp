@@ -0,0 +1,91 @@
+#pragma once
+#include <cstdlib>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#if defined(__GNUC__)
+#include <cxxabi.h>
+#endif
+
+namespace LiveProfiler {
+	/**
+	 * Static utility functions releated to demangling c++ symbol names.
+	 * Demangled names are stored in a process wide cache keyed by the mangled name,
+	 * so the same name appears in many executable files (e.g. template instantiation) is demangled once.
+	 * These functions are thread safe.
+	 */
+	struct DemangleUtils {
+		/**
+		 * Demangle the symbol name, return empty string if the name is not mangled.
+		 * The version suffix like "@GLIBCXX_3.4" or "@@Base" is kept, same as `nm -C`.
+		 */
+		static std::shared_ptr<const std::string> demangle(const std::string& name) {
+			auto& empty = getEmptyName();
+			// only itanium c++ abi names are supported, don't demangle plain names like "i" to "int"
+			if (name.size() < 3 || name[0] != '_' || name[1] != 'Z') {
+				return empty;
+			}
+			auto& cache = getCache();
+			{
+				std::lock_guard<std::mutex> guard(cache.mutex);
+				auto it = cache.demangleNames.find(name);
+				if (it != cache.demangleNames.end()) {
+					return it->second;
+				}
+			}
+			// demangle outside of the lock
+			auto demangleName = empty;
+			auto versionIndex = name.find('@');
+			std::string mangleName(name, 0, versionIndex);
+#if defined(__GNUC__)
+			int status = 0;
+			char* result = abi::__cxa_demangle(mangleName.c_str(), nullptr, nullptr, &status);
+			std::unique_ptr<char, void(*)(void*)> resultPtr(result, std::free);
+			if (status == 0 && result != nullptr) {
+				auto str = std::make_shared<std::string>(result);
+				if (versionIndex != name.npos) {
+					str->append(name, versionIndex, name.npos);
+				}
+				demangleName = std::move(str);
+			}
+#endif
+			std::lock_guard<std::mutex> guard(cache.mutex);
+			return cache.demangleNames.emplace(name, std::move(demangleName)).first->second;
+		}
+
+		/** Get the shared empty name, it's returned when the name is not mangled */
+		static const std::shared_ptr<const std::string>& getEmptyName() {
+			static const std::shared_ptr<const std::string> empty(std::make_shared<std::string>());
+			return empty;
+		}
+
+		/** Get how many names are in the cache */
+		static std::size_t getCacheSize() {
+			auto& cache = getCache();
+			std::lock_guard<std::mutex> guard(cache.mutex);
+			return cache.demangleNames.size();
+		}
+
+		/** Remove all names from the cache, names returned before are still valid */
+		static void clearCache() {
+			auto& cache = getCache();
+			std::lock_guard<std::mutex> guard(cache.mutex);
+			cache.demangleNames.clear();
+		}
+
+	protected:
+		/** Cache of demangled names */
+		struct Cache {
+			std::mutex mutex;
+			std::unordered_map<std::string, std::shared_ptr<const std::string>> demangleNames;
+		};
+
+		/** Get the process wide cache */
+		static Cache& getCache() {
+			static Cache cache;
+			return cache;
+		}
+	};
+}
+
@@ -0,0 +1,109 @@
+#pragma once
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <cstdint>
+#include <string>
+#include <fstream>
+#include "../../../Exceptions/ProfilerException.hpp"
+#include "../../Containers/StackBuffer.hpp"
+
+namespace LiveProfiler {
+	/**
+	 * Static utility functions releated to linux cgroups.
+	 * Only cgroup v2 (the unified hierarchy) is supported.
+	 */
+	struct LinuxCgroupUtils {
+		/**
+		 * Get the mount point of cgroup v2, return empty string if not mounted.
+		 * Usually it's /sys/fs/cgroup, or /sys/fs/cgroup/unified in hybrid mode.
+		 */
+		static std::string getCgroupMountPoint() {
+			// line format: device mountpoint type options dump pass
+			std::ifstream file("/proc/mounts");
+			std::string device;
+			std::string mountPoint;
+			std::string type;
+			std::string rest;
+			while (file >> device >> mountPoint >> type) {
+				if (type == "cgroup2") {
+					return mountPoint;
+				}
+				std::getline(file, rest);
+			}
+			return "";
+		}
+
+		/**
+		 * Get the full path of the cgroup v2 that the process belongs to.
+		 * Return empty string if the process doesn't exist or cgroup v2 is not mounted.
+		 */
+		static std::string getProcessCgroupPath(pid_t pid) {
+			return getProcessCgroupPath(pid, getCgroupMountPoint());
+		}
+
+		/**
+		 * Get the full path of the cgroup v2 that the process belongs to.
+		 * Use the mount point from `getCgroupMountPoint` to avoid reading /proc/mounts each time.
+		 */
+		static std::string getProcessCgroupPath(pid_t pid, const std::string& mountPoint) {
+			static const std::string prefix("/proc/");
+			static const std::string suffix("/cgroup");
+			static const std::string unifiedPrefix("0::");
+			StackBuffer<128> buf;
+			// build path "/proc/$pid/cgroup"
+			buf.appendStr(prefix.data(), prefix.size());
+			buf.appendLongLong(pid);
+			buf.appendStr(suffix.data(), suffix.size());
+			buf.appendNullTerminator();
+			// find the line for unified hierarchy, the format is "0::/path"
+			std::ifstream file(buf.data());
+			std::string line;
+			while (std::getline(file, line)) {
+				if (line.compare(0, unifiedPrefix.size(), unifiedPrefix) == 0) {
+					if (mountPoint.empty()) {
+						return "";
+					}
+					return mountPoint + line.substr(unifiedPrefix.size());
+				}
+			}
+			return "";
+		}
+
+		/**
+		 * Get the id of the cgroup from it's full path, return 0 if failed.
+		 * The id is same as the one reported by PERF_SAMPLE_CGROUP and bpf_get_current_cgroup_id.
+		 */
+		static std::uint64_t getCgroupId(const std::string& path) {
+			// the kernel encode cgroup id in the file handle of cgroupfs
+			struct {
+				::file_handle handle;
+				std::uint64_t id;
+			} handle;
+			handle.handle.handle_bytes = sizeof(handle.id);
+			int mountId = 0;
+			if (::name_to_handle_at(AT_FDCWD, path.c_str(), &handle.handle, &mountId, 0) == 0) {
+				return handle.id;
+			}
+			// fallback to inode number, they are same on kernel >= 5.5
+			struct ::stat st;
+			if (::stat(path.c_str(), &st) == 0) {
+				return static_cast<std::uint64_t>(st.st_ino);
+			}
+			return 0;
+		}
+
+		/**
+		 * Open the cgroup directory for perf_event_open with PERF_FLAG_PID_CGROUP.
+		 * The caller should close the returned file descriptor.
+		 */
+		static int openCgroup(const std::string& path) {
+			auto fd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+			if (fd < 0) {
+				throw ProfilerException(errno, "[openCgroup] open " + path);
+			}
+			return fd;
+		}
+	};
+}
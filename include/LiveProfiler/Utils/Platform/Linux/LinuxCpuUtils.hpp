@@ -0,0 +1,55 @@
+#pragma once
+#include <unistd.h>
+#include <sched.h>
+#include <vector>
+#include <string>
+#include <fstream>
+#include "../../StringUtils.hpp"
+#include "../../TypeConvertUtils.hpp"
+
+namespace LiveProfiler {
+	/** Static utility functions releated to linux cpus */
+	struct LinuxCpuUtils {
+		/**
+		 * List the index of all online cpus.
+		 * The result will be appended to `cpus`.
+		 * File format of /sys/devices/system/cpu/online: "0-3,5,7-8"
+		 */
+		static void listOnlineCpus(std::vector<int>& cpus) {
+			std::ifstream file("/sys/devices/system/cpu/online");
+			std::string line;
+			if (!std::getline(file, line)) {
+				// fallback to assume cpus are continuous
+				auto count = ::sysconf(_SC_NPROCESSORS_ONLN);
+				for (long i = 0; i < count; ++i) {
+					cpus.emplace_back(static_cast<int>(i));
+				}
+				return;
+			}
+			StringUtils::split(line,
+				[&line, &cpus](auto startIndex, auto endIndex, auto) {
+				long long first = 0;
+				long long last = 0;
+				if (!TypeConvertUtils::strToLongLong(line.c_str() + startIndex, first)) {
+					return;
+				}
+				auto middleIndex = line.find_first_of('-', startIndex);
+				if (middleIndex == line.npos || middleIndex >= endIndex ||
+					!TypeConvertUtils::strToLongLong(line.c_str() + middleIndex + 1, last)) {
+					last = first;
+				}
+				for (long long cpu = first; cpu <= last; ++cpu) {
+					cpus.emplace_back(static_cast<int>(cpu));
+				}
+			}, ",\n");
+		}
+
+		/** Pin the calling thread to the specified cpu, return whether successful */
+		static bool setCurrentThreadAffinity(int cpu) {
+			::cpu_set_t cpuSet;
+			CPU_ZERO(&cpuSet);
+			CPU_SET(cpu, &cpuSet);
+			return ::sched_setaffinity(0, sizeof(cpuSet), &cpuSet) == 0;
+		}
+	};
+}
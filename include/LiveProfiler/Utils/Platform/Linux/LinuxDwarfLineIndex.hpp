@@ -0,0 +1,1291 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <memory>
+#include <deque>
+#include <algorithm>
+#include <unordered_map>
+#include "../../DemangleUtils.hpp"
+#include "LinuxElfFile.hpp"
+
+namespace LiveProfiler {
+	/**
+	 * Index of DWARF debug information (version 2 to 5) of single elf file.
+	 * It maps file offset to file:line and the chain of inlined frames,
+	 * by reading .debug_info, .debug_abbrev, .debug_line and their related sections.
+	 *
+	 * Only the address ranges of compile units are indexed when constructed,
+	 * the line table and function ranges of a compile unit are built when the first lookup falls into it,
+	 * and the earliest built units are dropped when exceeds the limit, so memory stays bounded on large binaries.
+	 * The file is kept mapped until the index is destroyed.
+	 */
+	class LinuxDwarfLineIndex {
+	public:
+		/** Default parameters */
+		static const std::size_t DefaultMaxCachedCompileUnits = 64;
+
+		/** Source location of a frame */
+		struct Frame {
+			/** Demangled function name, empty if unknown */
+			std::shared_ptr<const std::string> function;
+			/** Source file path, nullptr if unknown */
+			std::shared_ptr<const std::string> file;
+			/** Line number starts from 1, 0 if unknown */
+			std::size_t line;
+		};
+
+		/** Getters */
+		bool isValid() const { return !unitRanges_.empty(); }
+		std::size_t getCompileUnitCount() const { return units_.size(); }
+		std::size_t getCachedCompileUnitCount() const { return cachedUnits_.size(); }
+
+		/** Set how many compile units can keep their line table and function ranges in memory */
+		void setMaxCachedCompileUnits(std::size_t maxCachedCompileUnits) {
+			maxCachedCompileUnits_ = std::max<std::size_t>(maxCachedCompileUnits, 1);
+		}
+
+		/**
+		 * Resolve source locations from file offset.
+		 * Frames are ordered from the innermost inlined function to the outermost function,
+		 * the location of outer frame is the call site of the inner frame.
+		 * Return false if no debug information covers the offset.
+		 */
+		bool resolve(std::size_t fileOffset, std::vector<Frame>& frames) {
+			std::size_t address = 0;
+			if (!LinuxElfFile::toAddress(file_.getSegments(), fileOffset, address)) {
+				frames.clear();
+				return false;
+			}
+			return resolveAddress(address, frames);
+		}
+
+		/**
+		 * Resolve source locations from virtual address, see `resolve`.
+		 * It's useful for separate debug file, the address should be translated by the runtime file.
+		 */
+		bool resolveAddress(std::size_t address, std::vector<Frame>& frames) {
+			frames.clear();
+			auto unitIndex = findUnit(address);
+			if (unitIndex >= units_.size()) {
+				return false;
+			}
+			const auto& data = getCompileUnitData(unitIndex);
+			// find line row
+			std::shared_ptr<const std::string> file;
+			std::size_t line = 0;
+			auto sequenceIt = findRange(data.sequences, address);
+			if (sequenceIt != data.sequences.cend()) {
+				auto rowBegin = data.rows.cbegin() + sequenceIt->firstRow;
+				auto rowEnd = data.rows.cbegin() + sequenceIt->lastRow;
+				auto rowIt = std::upper_bound(rowBegin, rowEnd, address,
+					[](const auto& a, const auto& b) { return a < b.address; });
+				if (rowIt != rowBegin) {
+					--rowIt;
+					file = getFile(data, rowIt->file);
+					line = rowIt->line;
+				}
+			}
+			// find functions contains the address, ordered from outermost to innermost
+			auto groupIt = findRange(data.groups, address);
+			if (groupIt != data.groups.cend()) {
+				for (auto index = groupIt->firstRow; index < groupIt->lastRow; ++index) {
+					const auto& function = data.functions[index];
+					if (address >= function.low && address < function.high) {
+						frames.emplace_back(Frame({ function.name, nullptr, index }));
+					}
+				}
+			}
+			if (frames.empty()) {
+				if (file == nullptr) {
+					return false;
+				}
+				frames.emplace_back(Frame({ DemangleUtils::getEmptyName(), file, line }));
+				return true;
+			}
+			// reverse to innermost first, and replace indices with call sites
+			std::reverse(frames.begin(), frames.end());
+			for (auto& frame : frames) {
+				const auto& function = data.functions[frame.line];
+				frame.file = std::move(file);
+				frame.line = line;
+				file = getFile(data, function.callFile);
+				line = function.callLine;
+			}
+			return true;
+		}
+
+		/** Constructor, use `isValid` to check whether the file contains usable debug information */
+		explicit LinuxDwarfLineIndex(const std::string& path) :
+			file_(path),
+			info_(),
+			abbrev_(),
+			line_(),
+			str_(),
+			lineStr_(),
+			strOffsets_(),
+			addr_(),
+			ranges_(),
+			rnglists_(),
+			aranges_(),
+			units_(),
+			unitRanges_(),
+			cachedUnits_(),
+			cachedUnitOrder_(),
+			functionNames_(),
+			maxCachedCompileUnits_(DefaultMaxCachedCompileUnits) {
+			if (!file_.isOpen()) {
+				return;
+			}
+			info_ = getSection(".debug_info");
+			abbrev_ = getSection(".debug_abbrev");
+			line_ = getSection(".debug_line");
+			str_ = getSection(".debug_str");
+			lineStr_ = getSection(".debug_line_str");
+			strOffsets_ = getSection(".debug_str_offsets");
+			addr_ = getSection(".debug_addr");
+			ranges_ = getSection(".debug_ranges");
+			rnglists_ = getSection(".debug_rnglists");
+			aranges_ = getSection(".debug_aranges");
+			// strings are read as null terminated, ignore string sections not terminated
+			for (auto* strings : { &str_, &lineStr_ }) {
+				if (strings->size > 0 && strings->data[strings->size - 1] != '\0') {
+					*strings = {};
+				}
+			}
+			loadUnits();
+			loadUnitRanges();
+		}
+
+	protected:
+		/** Disable copy */
+		LinuxDwarfLineIndex(const LinuxDwarfLineIndex&) = delete;
+		LinuxDwarfLineIndex& operator=(const LinuxDwarfLineIndex&) = delete;
+
+		/** DWARF constants used by this class, see the DWARF 5 specification */
+		enum : std::uint32_t {
+			DW_TAG_inlined_subroutine = 0x1d,
+			DW_TAG_subprogram = 0x2e,
+			DW_AT_name = 0x03,
+			DW_AT_stmt_list = 0x10,
+			DW_AT_low_pc = 0x11,
+			DW_AT_high_pc = 0x12,
+			DW_AT_comp_dir = 0x1b,
+			DW_AT_abstract_origin = 0x31,
+			DW_AT_specification = 0x47,
+			DW_AT_ranges = 0x55,
+			DW_AT_call_file = 0x58,
+			DW_AT_call_line = 0x59,
+			DW_AT_linkage_name = 0x6e,
+			DW_AT_str_offsets_base = 0x72,
+			DW_AT_addr_base = 0x73,
+			DW_AT_rnglists_base = 0x74,
+			DW_AT_MIPS_linkage_name = 0x2007,
+			DW_FORM_addr = 0x01,
+			DW_FORM_block2 = 0x03,
+			DW_FORM_block4 = 0x04,
+			DW_FORM_data2 = 0x05,
+			DW_FORM_data4 = 0x06,
+			DW_FORM_data8 = 0x07,
+			DW_FORM_string = 0x08,
+			DW_FORM_block = 0x09,
+			DW_FORM_block1 = 0x0a,
+			DW_FORM_data1 = 0x0b,
+			DW_FORM_flag = 0x0c,
+			DW_FORM_sdata = 0x0d,
+			DW_FORM_strp = 0x0e,
+			DW_FORM_udata = 0x0f,
+			DW_FORM_ref_addr = 0x10,
+			DW_FORM_ref1 = 0x11,
+			DW_FORM_ref2 = 0x12,
+			DW_FORM_ref4 = 0x13,
+			DW_FORM_ref8 = 0x14,
+			DW_FORM_ref_udata = 0x15,
+			DW_FORM_indirect = 0x16,
+			DW_FORM_sec_offset = 0x17,
+			DW_FORM_exprloc = 0x18,
+			DW_FORM_flag_present = 0x19,
+			DW_FORM_strx = 0x1a,
+			DW_FORM_addrx = 0x1b,
+			DW_FORM_ref_sup4 = 0x1c,
+			DW_FORM_strp_sup = 0x1d,
+			DW_FORM_data16 = 0x1e,
+			DW_FORM_line_strp = 0x1f,
+			DW_FORM_ref_sig8 = 0x20,
+			DW_FORM_implicit_const = 0x21,
+			DW_FORM_loclistx = 0x22,
+			DW_FORM_rnglistx = 0x23,
+			DW_FORM_ref_sup8 = 0x24,
+			DW_FORM_strx1 = 0x25,
+			DW_FORM_strx2 = 0x26,
+			DW_FORM_strx3 = 0x27,
+			DW_FORM_strx4 = 0x28,
+			DW_FORM_addrx1 = 0x29,
+			DW_FORM_addrx2 = 0x2a,
+			DW_FORM_addrx3 = 0x2b,
+			DW_FORM_addrx4 = 0x2c,
+			DW_FORM_GNU_addr_index = 0x1f01,
+			DW_FORM_GNU_str_index = 0x1f02,
+			DW_FORM_GNU_ref_alt = 0x1f20,
+			DW_FORM_GNU_strp_alt = 0x1f21,
+			DW_UT_compile = 0x01,
+			DW_UT_type = 0x02,
+			DW_UT_partial = 0x03,
+			DW_UT_skeleton = 0x04,
+			DW_UT_split_compile = 0x05,
+			DW_UT_split_type = 0x06,
+			DW_LNS_copy = 0x01,
+			DW_LNS_advance_pc = 0x02,
+			DW_LNS_advance_line = 0x03,
+			DW_LNS_set_file = 0x04,
+			DW_LNS_const_add_pc = 0x08,
+			DW_LNS_fixed_advance_pc = 0x09,
+			DW_LNE_end_sequence = 0x01,
+			DW_LNE_set_address = 0x02,
+			DW_LNCT_path = 0x01,
+			DW_LNCT_directory_index = 0x02,
+			DW_RLE_end_of_list = 0x00,
+			DW_RLE_base_addressx = 0x01,
+			DW_RLE_startx_endx = 0x02,
+			DW_RLE_startx_length = 0x03,
+			DW_RLE_offset_pair = 0x04,
+			DW_RLE_base_address = 0x05,
+			DW_RLE_start_end = 0x06,
+			DW_RLE_start_length = 0x07,
+		};
+
+		/** Contents of debug section */
+		struct SectionData {
+			const char* data = nullptr;
+			std::size_t size = 0;
+		};
+
+		/** Bounds checked little helper for reading debug section, it fails instead of reading out of range */
+		struct Reader {
+			const char* data;
+			std::size_t size;
+			std::size_t offset;
+			bool failed;
+
+			bool ok() const { return !failed && offset < size; }
+			void seek(std::size_t newOffset) { offset = newOffset; failed = failed || offset > size; }
+			void skip(std::size_t count) {
+				if (count > size - offset) {
+					failed = true;
+					offset = size;
+				} else {
+					offset += count;
+				}
+			}
+			std::uint64_t readUnsigned(std::size_t count) {
+				std::uint64_t value = 0;
+				if (failed || count > 8 || count > size - offset) {
+					failed = true;
+					offset = size;
+					return 0;
+				}
+				// little endian only, same as the elf files this library can profile
+				std::memcpy(&value, data + offset, count);
+				offset += count;
+				return value;
+			}
+			std::uint64_t readOffset(bool is64) { return readUnsigned(is64 ? 8 : 4); }
+			std::uint64_t readUleb() {
+				std::uint64_t value = 0;
+				unsigned shift = 0;
+				while (offset < size) {
+					auto byte = static_cast<unsigned char>(data[offset++]);
+					if (shift < 64) {
+						value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+					}
+					shift += 7;
+					if ((byte & 0x80) == 0) {
+						return value;
+					}
+				}
+				failed = true;
+				return 0;
+			}
+			std::int64_t readSleb() {
+				std::int64_t value = 0;
+				unsigned shift = 0;
+				while (offset < size) {
+					auto byte = static_cast<unsigned char>(data[offset++]);
+					if (shift < 64) {
+						value |= static_cast<std::int64_t>(static_cast<std::uint64_t>(byte & 0x7f) << shift);
+					}
+					shift += 7;
+					if ((byte & 0x80) == 0) {
+						if (shift < 64 && (byte & 0x40) != 0) {
+							value |= -(static_cast<std::int64_t>(1) << shift);
+						}
+						return value;
+					}
+				}
+				failed = true;
+				return 0;
+			}
+			const char* readString() {
+				const char* begin = data + offset;
+				const void* terminator = failed ? nullptr : std::memchr(begin, 0, size - offset);
+				if (terminator == nullptr) {
+					failed = true;
+					offset = size;
+					return "";
+				}
+				offset += static_cast<const char*>(terminator) - begin + 1;
+				return begin;
+			}
+
+			Reader(const SectionData& section, std::size_t startOffset) :
+				data(section.data),
+				size(section.size),
+				offset(startOffset),
+				failed(section.data == nullptr || startOffset > section.size) { }
+		};
+
+		/** Header of unit in .debug_info, bases are read from the root DIE */
+		struct Unit {
+			std::size_t offset;
+			std::size_t end;
+			std::size_t dieOffset;
+			std::size_t abbrevOffset;
+			std::uint16_t version;
+			std::uint8_t unitType;
+			std::uint8_t addressSize;
+			bool is64;
+			bool rootParsed;
+			std::size_t lowPc;
+			std::size_t stmtList;
+			const char* compDir;
+			std::size_t strOffsetsBase;
+			std::size_t addrBase;
+			std::size_t rnglistsBase;
+		};
+
+		/** Attribute specification in abbreviation */
+		struct AttributeSpec {
+			std::uint32_t name;
+			std::uint32_t form;
+			std::int64_t implicitConst;
+		};
+
+		/** Abbreviation describes the layout of DIE */
+		struct Abbrev {
+			std::uint32_t tag;
+			bool hasChildren;
+			std::vector<AttributeSpec> attributes;
+		};
+		using AbbrevTable = std::unordered_map<std::uint64_t, Abbrev>;
+
+		/** Attribute value read from DIE, data is set for inline string and block */
+		struct AttributeValue {
+			std::uint32_t name;
+			std::uint32_t form;
+			std::uint64_t value;
+			const char* data;
+		};
+		using AttributeValues = std::vector<AttributeValue>;
+
+		/** Address range [low, high) */
+		struct Range {
+			std::size_t low;
+			std::size_t high;
+		};
+
+		/** Range with index, firstRow and lastRow is the index range of rows or functions */
+		struct IndexedRange {
+			std::size_t low;
+			std::size_t high;
+			std::size_t firstRow;
+			std::size_t lastRow;
+		};
+
+		/** Row in line table */
+		struct LineRow {
+			std::size_t address;
+			std::uint32_t file;
+			std::uint32_t line;
+		};
+
+		/** Range of subprogram or inlined subroutine */
+		struct Function {
+			std::size_t low;
+			std::size_t high;
+			std::shared_ptr<const std::string> name;
+			std::uint32_t callFile;
+			std::uint32_t callLine;
+		};
+
+		/** Line table and function ranges of compile unit */
+		struct CompileUnitData {
+			std::vector<std::shared_ptr<const std::string>> files;
+			std::vector<LineRow> rows;
+			std::vector<IndexedRange> sequences;
+			std::vector<Function> functions;
+			std::vector<IndexedRange> groups;
+		};
+
+		/** Get section contents by name */
+		SectionData getSection(const char* name) const {
+			SectionData result;
+			auto section = file_.findSection(name);
+			if (section != nullptr) {
+				result.data = file_.getSectionData(*section);
+				result.size = (result.data == nullptr) ? 0 : section->size;
+			}
+			return result;
+		}
+
+		/** Find the range contains the address from ranges sorted by low */
+		template <class T>
+		static typename std::vector<T>::const_iterator findRange(
+			const std::vector<T>& ranges, std::size_t address) {
+			auto it = std::upper_bound(ranges.cbegin(), ranges.cend(), address,
+				[](const auto& a, const auto& b) { return a < b.low; });
+			if (it == ranges.cbegin()) {
+				return ranges.cend();
+			}
+			--it;
+			return (address < it->high) ? it : ranges.cend();
+		}
+
+		/** Find the compile unit contains the address, return units_.size() if not found */
+		std::size_t findUnit(std::size_t address) const {
+			auto it = findRange(unitRanges_, address);
+			return (it == unitRanges_.cend()) ? units_.size() : it->firstRow;
+		}
+
+		/** Find the unit contains the offset of .debug_info, return units_.size() if not found */
+		std::size_t findUnitByOffset(std::size_t offset) const {
+			auto it = std::upper_bound(units_.cbegin(), units_.cend(), offset,
+				[](const auto& a, const auto& b) { return a < b.offset; });
+			if (it == units_.cbegin() || offset >= (it - 1)->end) {
+				return units_.size();
+			}
+			return static_cast<std::size_t>(it - 1 - units_.cbegin());
+		}
+
+		/** Get file name by index in line table, return nullptr if not found */
+		static std::shared_ptr<const std::string> getFile(
+			const CompileUnitData& data, std::uint32_t index) {
+			return (index < data.files.size()) ? data.files[index] : nullptr;
+		}
+
+		/** Read unit headers from .debug_info */
+		void loadUnits() {
+			Reader reader(info_, 0);
+			while (reader.ok()) {
+				Unit unit = {};
+				unit.offset = reader.offset;
+				std::uint64_t length = reader.readUnsigned(4);
+				if (length == 0xffffffff) {
+					length = reader.readUnsigned(8);
+					unit.is64 = true;
+				} else if (length >= 0xfffffff0) {
+					break; // reserved
+				}
+				if (reader.failed || length > reader.size - reader.offset) {
+					break;
+				}
+				unit.end = reader.offset + static_cast<std::size_t>(length);
+				unit.version = static_cast<std::uint16_t>(reader.readUnsigned(2));
+				if (unit.version >= 5) {
+					unit.unitType = static_cast<std::uint8_t>(reader.readUnsigned(1));
+					unit.addressSize = static_cast<std::uint8_t>(reader.readUnsigned(1));
+					unit.abbrevOffset = static_cast<std::size_t>(reader.readOffset(unit.is64));
+					if (unit.unitType == DW_UT_skeleton || unit.unitType == DW_UT_split_compile) {
+						reader.skip(8); // dwo id
+					} else if (unit.unitType == DW_UT_type || unit.unitType == DW_UT_split_type) {
+						reader.skip(8 + (unit.is64 ? 8 : 4)); // type signature and type offset
+					}
+				} else {
+					unit.unitType = DW_UT_compile;
+					unit.abbrevOffset = static_cast<std::size_t>(reader.readOffset(unit.is64));
+					unit.addressSize = static_cast<std::uint8_t>(reader.readUnsigned(1));
+				}
+				unit.dieOffset = reader.offset;
+				if (!reader.failed && unit.version >= 2 && unit.version <= 5 &&
+					(unit.addressSize == 4 || unit.addressSize == 8)) {
+					// defaults for DWARF 5 units without base attributes, they are the size of section headers
+					unit.strOffsetsBase = unit.is64 ? 16 : 8;
+					unit.addrBase = 8;
+					unit.rnglistsBase = unit.is64 ? 20 : 12;
+					units_.emplace_back(unit);
+				}
+				reader.seek(unit.end);
+			}
+		}
+
+		/**
+		 * Load address ranges of compile units.
+		 * Use .debug_aranges if exists, units not covered by it use the ranges of their root DIE.
+		 */
+		void loadUnitRanges() {
+			std::vector<bool> covered(units_.size(), false);
+			Reader reader(aranges_, 0);
+			while (reader.ok()) {
+				std::uint64_t length = reader.readUnsigned(4);
+				bool is64 = false;
+				if (length == 0xffffffff) {
+					length = reader.readUnsigned(8);
+					is64 = true;
+				}
+				if (reader.failed || length > reader.size - reader.offset) {
+					break;
+				}
+				auto setStart = reader.offset;
+				auto setEnd = reader.offset + static_cast<std::size_t>(length);
+				reader.skip(2); // version
+				auto unitIndex = findUnitByOffset(static_cast<std::size_t>(reader.readOffset(is64)));
+				auto addressSize = static_cast<std::size_t>(reader.readUnsigned(1));
+				reader.skip(1); // segment selector size
+				if (unitIndex < units_.size() && (addressSize == 4 || addressSize == 8)) {
+					// tuples are aligned to twice the address size, counts from the start of the set
+					auto headerSize = reader.offset - setStart + (is64 ? 12 : 4);
+					auto tupleSize = addressSize * 2;
+					reader.skip((tupleSize - headerSize % tupleSize) % tupleSize);
+					while (!reader.failed && reader.offset < setEnd) {
+						auto start = static_cast<std::size_t>(reader.readUnsigned(addressSize));
+						auto size = static_cast<std::size_t>(reader.readUnsigned(addressSize));
+						if (start == 0 && size == 0) {
+							break;
+						}
+						addUnitRange(unitIndex, start, start + size);
+						covered[unitIndex] = true;
+					}
+				}
+				reader.seek(setEnd);
+			}
+			AbbrevTable abbrevs;
+			AttributeValues values;
+			std::vector<Range> ranges;
+			for (std::size_t unitIndex = 0; unitIndex < units_.size(); ++unitIndex) {
+				auto& unit = units_[unitIndex];
+				if (covered[unitIndex] ||
+					(unit.unitType != DW_UT_compile && unit.unitType != DW_UT_partial)) {
+					continue;
+				}
+				if (!parseRoot(unit, abbrevs, values)) {
+					continue;
+				}
+				ranges.clear();
+				readRanges(unit, values, ranges);
+				for (const auto& range : ranges) {
+					addUnitRange(unitIndex, range.low, range.high);
+				}
+			}
+			std::sort(unitRanges_.begin(), unitRanges_.end(),
+				[](const auto& a, const auto& b) { return a.low < b.low; });
+		}
+
+		/** Add address range of compile unit, ranges start from 0 are discarded code */
+		void addUnitRange(std::size_t unitIndex, std::size_t low, std::size_t high) {
+			if (low != 0 && low < high) {
+				unitRanges_.emplace_back(IndexedRange({ low, high, unitIndex, unitIndex + 1 }));
+			}
+		}
+
+		/** Parse abbreviation table at the offset of .debug_abbrev */
+		bool parseAbbrevs(std::size_t offset, AbbrevTable& abbrevs) const {
+			abbrevs.clear();
+			Reader reader(abbrev_, offset);
+			while (reader.ok()) {
+				auto code = reader.readUleb();
+				if (code == 0) {
+					return !reader.failed;
+				}
+				auto& abbrev = abbrevs[code];
+				abbrev.tag = static_cast<std::uint32_t>(reader.readUleb());
+				abbrev.hasChildren = reader.readUnsigned(1) != 0;
+				abbrev.attributes.clear();
+				while (reader.ok()) {
+					AttributeSpec spec = {};
+					spec.name = static_cast<std::uint32_t>(reader.readUleb());
+					spec.form = static_cast<std::uint32_t>(reader.readUleb());
+					if (spec.name == 0 && spec.form == 0) {
+						break;
+					}
+					if (spec.form == DW_FORM_implicit_const) {
+						spec.implicitConst = reader.readSleb();
+					}
+					abbrev.attributes.emplace_back(spec);
+				}
+			}
+			return false;
+		}
+
+		/** Read value of attribute, the value is left unresolved (e.g. index of string) */
+		static void readAttribute(
+			Reader& reader, const Unit& unit, const AttributeSpec& spec, AttributeValue& value) {
+			value.name = spec.name;
+			value.form = spec.form;
+			value.value = 0;
+			value.data = nullptr;
+			switch (spec.form) {
+			case DW_FORM_addr:
+				value.value = reader.readUnsigned(unit.addressSize);
+				break;
+			case DW_FORM_data1: case DW_FORM_ref1: case DW_FORM_flag:
+			case DW_FORM_strx1: case DW_FORM_addrx1:
+				value.value = reader.readUnsigned(1);
+				break;
+			case DW_FORM_data2: case DW_FORM_ref2: case DW_FORM_strx2: case DW_FORM_addrx2:
+				value.value = reader.readUnsigned(2);
+				break;
+			case DW_FORM_strx3: case DW_FORM_addrx3:
+				value.value = reader.readUnsigned(3);
+				break;
+			case DW_FORM_data4: case DW_FORM_ref4: case DW_FORM_ref_sup4:
+			case DW_FORM_strx4: case DW_FORM_addrx4:
+				value.value = reader.readUnsigned(4);
+				break;
+			case DW_FORM_data8: case DW_FORM_ref8: case DW_FORM_ref_sig8: case DW_FORM_ref_sup8:
+				value.value = reader.readUnsigned(8);
+				break;
+			case DW_FORM_data16:
+				reader.skip(16);
+				break;
+			case DW_FORM_sdata:
+				value.value = static_cast<std::uint64_t>(reader.readSleb());
+				break;
+			case DW_FORM_udata: case DW_FORM_ref_udata: case DW_FORM_strx: case DW_FORM_addrx:
+			case DW_FORM_loclistx: case DW_FORM_rnglistx:
+			case DW_FORM_GNU_addr_index: case DW_FORM_GNU_str_index:
+				value.value = reader.readUleb();
+				break;
+			case DW_FORM_string:
+				value.data = reader.readString();
+				break;
+			case DW_FORM_strp: case DW_FORM_line_strp: case DW_FORM_sec_offset:
+			case DW_FORM_strp_sup: case DW_FORM_GNU_ref_alt: case DW_FORM_GNU_strp_alt:
+				value.value = reader.readOffset(unit.is64);
+				break;
+			case DW_FORM_ref_addr:
+				value.value = (unit.version <= 2) ?
+					reader.readUnsigned(unit.addressSize) : reader.readOffset(unit.is64);
+				break;
+			case DW_FORM_block1:
+				reader.skip(static_cast<std::size_t>(reader.readUnsigned(1)));
+				break;
+			case DW_FORM_block2:
+				reader.skip(static_cast<std::size_t>(reader.readUnsigned(2)));
+				break;
+			case DW_FORM_block4:
+				reader.skip(static_cast<std::size_t>(reader.readUnsigned(4)));
+				break;
+			case DW_FORM_block: case DW_FORM_exprloc:
+				reader.skip(static_cast<std::size_t>(reader.readUleb()));
+				break;
+			case DW_FORM_flag_present:
+				value.value = 1;
+				break;
+			case DW_FORM_implicit_const:
+				value.value = static_cast<std::uint64_t>(spec.implicitConst);
+				break;
+			case DW_FORM_indirect: {
+				AttributeSpec indirectSpec = spec;
+				indirectSpec.form = static_cast<std::uint32_t>(reader.readUleb());
+				if (indirectSpec.form == DW_FORM_indirect) {
+					reader.failed = true;
+				} else {
+					readAttribute(reader, unit, indirectSpec, value);
+				}
+				break;
+			}
+			default:
+				reader.failed = true; // unknown form, the size is unknown
+				break;
+			}
+		}
+
+		/** Read attributes of DIE */
+		static void readAttributes(
+			Reader& reader, const Unit& unit, const Abbrev& abbrev, AttributeValues& values) {
+			values.resize(abbrev.attributes.size());
+			for (std::size_t index = 0; index < values.size(); ++index) {
+				readAttribute(reader, unit, abbrev.attributes[index], values[index]);
+			}
+		}
+
+		/** Find attribute by name, return nullptr if not found */
+		static const AttributeValue* findAttribute(const AttributeValues& values, std::uint32_t name) {
+			for (const auto& value : values) {
+				if (value.name == name) {
+					return &value;
+				}
+			}
+			return nullptr;
+		}
+
+		/** Get string from attribute value, return nullptr if it's not a string or out of range */
+		const char* getString(const Unit& unit, const AttributeValue& value) const {
+			switch (value.form) {
+			case DW_FORM_string:
+				return value.data;
+			case DW_FORM_strp:
+				return (value.value < str_.size) ? str_.data + value.value : nullptr;
+			case DW_FORM_line_strp:
+				return (value.value < lineStr_.size) ? lineStr_.data + value.value : nullptr;
+			case DW_FORM_strx: case DW_FORM_strx1: case DW_FORM_strx2:
+			case DW_FORM_strx3: case DW_FORM_strx4: case DW_FORM_GNU_str_index: {
+				auto offsetSize = unit.is64 ? 8 : 4;
+				Reader reader(strOffsets_, unit.strOffsetsBase);
+				reader.skip(static_cast<std::size_t>(value.value) * offsetSize);
+				auto offset = reader.readOffset(unit.is64);
+				return (!reader.failed && offset < str_.size) ? str_.data + offset : nullptr;
+			}
+			default:
+				return nullptr;
+			}
+		}
+
+		/** Check whether the form is address class */
+		static bool isAddressForm(std::uint32_t form) {
+			return form == DW_FORM_addr || isAddressIndexForm(form);
+		}
+
+		/** Check whether the form is index of .debug_addr */
+		static bool isAddressIndexForm(std::uint32_t form) {
+			return form == DW_FORM_addrx || form == DW_FORM_GNU_addr_index ||
+				(form >= DW_FORM_addrx1 && form <= DW_FORM_addrx4);
+		}
+
+		/** Get address from attribute value */
+		std::size_t getAddress(const Unit& unit, const AttributeValue& value) const {
+			if (isAddressIndexForm(value.form)) {
+				return getAddressByIndex(unit, value.value);
+			}
+			return static_cast<std::size_t>(value.value);
+		}
+
+		/** Get address from .debug_addr by index */
+		std::size_t getAddressByIndex(const Unit& unit, std::uint64_t index) const {
+			Reader reader(addr_, unit.addrBase);
+			reader.skip(static_cast<std::size_t>(index) * unit.addressSize);
+			return static_cast<std::size_t>(reader.readUnsigned(unit.addressSize));
+		}
+
+		/** Get the offset of referenced DIE in .debug_info, return 0 if unsupported */
+		static std::size_t getReference(const Unit& unit, const AttributeValue& value) {
+			switch (value.form) {
+			case DW_FORM_ref1: case DW_FORM_ref2: case DW_FORM_ref4:
+			case DW_FORM_ref8: case DW_FORM_ref_udata:
+				return unit.offset + static_cast<std::size_t>(value.value);
+			case DW_FORM_ref_addr:
+				return static_cast<std::size_t>(value.value);
+			default:
+				return 0; // references to other files are unsupported
+			}
+		}
+
+		/** Parse abbreviations and the root DIE of unit, fill bases of the unit */
+		bool parseRoot(Unit& unit, AbbrevTable& abbrevs, AttributeValues& values) const {
+			if (!parseAbbrevs(unit.abbrevOffset, abbrevs)) {
+				return false;
+			}
+			Reader reader(info_, unit.dieOffset);
+			reader.size = unit.end;
+			auto it = abbrevs.find(reader.readUleb());
+			if (it == abbrevs.end()) {
+				return false;
+			}
+			readAttributes(reader, unit, it->second, values);
+			if (reader.failed) {
+				return false;
+			}
+			if (!unit.rootParsed) {
+				// bases should be set before reading other attributes
+				for (const auto& value : values) {
+					if (value.name == DW_AT_str_offsets_base) {
+						unit.strOffsetsBase = static_cast<std::size_t>(value.value);
+					} else if (value.name == DW_AT_addr_base) {
+						unit.addrBase = static_cast<std::size_t>(value.value);
+					} else if (value.name == DW_AT_rnglists_base) {
+						unit.rnglistsBase = static_cast<std::size_t>(value.value);
+					}
+				}
+				unit.stmtList = SIZE_MAX;
+				unit.compDir = nullptr;
+				for (const auto& value : values) {
+					if (value.name == DW_AT_low_pc) {
+						unit.lowPc = getAddress(unit, value);
+					} else if (value.name == DW_AT_stmt_list) {
+						unit.stmtList = static_cast<std::size_t>(value.value);
+					} else if (value.name == DW_AT_comp_dir) {
+						unit.compDir = getString(unit, value);
+					}
+				}
+				unit.rootParsed = true;
+			}
+			return true;
+		}
+
+		/** Read address ranges of DIE from low_pc, high_pc and ranges attributes */
+		void readRanges(const Unit& unit, const AttributeValues& values, std::vector<Range>& ranges) const {
+			auto lowPc = findAttribute(values, DW_AT_low_pc);
+			auto highPc = findAttribute(values, DW_AT_high_pc);
+			auto rangesValue = findAttribute(values, DW_AT_ranges);
+			if (lowPc != nullptr && highPc != nullptr) {
+				auto low = getAddress(unit, *lowPc);
+				auto high = getAddress(unit, *highPc);
+				if (!isAddressForm(highPc->form)) {
+					high += low; // high_pc is the size if it's a constant, since DWARF 4
+				}
+				addRange(ranges, low, high);
+			} else if (rangesValue != nullptr) {
+				if (unit.version >= 5) {
+					readRangeList(unit, *rangesValue, ranges);
+				} else {
+					readRangesV4(unit, static_cast<std::size_t>(rangesValue->value), ranges);
+				}
+			}
+		}
+
+		/** Add range if valid, ranges start from 0 are discarded code */
+		static void addRange(std::vector<Range>& ranges, std::size_t low, std::size_t high) {
+			if (low != 0 && low < high) {
+				ranges.emplace_back(Range({ low, high }));
+			}
+		}
+
+		/** Read ranges from .debug_ranges (DWARF 2 to 4) */
+		void readRangesV4(const Unit& unit, std::size_t offset, std::vector<Range>& ranges) const {
+			Reader reader(ranges_, offset);
+			std::size_t base = unit.lowPc;
+			std::uint64_t maxAddress = (unit.addressSize == 8) ? UINT64_MAX : UINT32_MAX;
+			while (reader.ok()) {
+				auto start = reader.readUnsigned(unit.addressSize);
+				auto end = reader.readUnsigned(unit.addressSize);
+				if (reader.failed || (start == 0 && end == 0)) {
+					break;
+				} else if (start == maxAddress) {
+					base = static_cast<std::size_t>(end);
+				} else {
+					addRange(ranges,
+						base + static_cast<std::size_t>(start), base + static_cast<std::size_t>(end));
+				}
+			}
+		}
+
+		/** Read ranges from .debug_rnglists (DWARF 5) */
+		void readRangeList(const Unit& unit, const AttributeValue& value, std::vector<Range>& ranges) const {
+			std::size_t offset = static_cast<std::size_t>(value.value);
+			if (value.form == DW_FORM_rnglistx) {
+				auto offsetSize = unit.is64 ? 8 : 4;
+				Reader reader(rnglists_, unit.rnglistsBase);
+				reader.skip(offset * offsetSize);
+				offset = unit.rnglistsBase + static_cast<std::size_t>(reader.readOffset(unit.is64));
+				if (reader.failed) {
+					return;
+				}
+			}
+			Reader reader(rnglists_, offset);
+			std::size_t base = unit.lowPc;
+			while (reader.ok()) {
+				auto kind = reader.readUnsigned(1);
+				if (kind == DW_RLE_end_of_list) {
+					break;
+				} else if (kind == DW_RLE_base_addressx) {
+					base = getAddressByIndex(unit, reader.readUleb());
+				} else if (kind == DW_RLE_startx_endx) {
+					auto start = getAddressByIndex(unit, reader.readUleb());
+					auto end = getAddressByIndex(unit, reader.readUleb());
+					addRange(ranges, start, end);
+				} else if (kind == DW_RLE_startx_length) {
+					auto start = getAddressByIndex(unit, reader.readUleb());
+					addRange(ranges, start, start + static_cast<std::size_t>(reader.readUleb()));
+				} else if (kind == DW_RLE_offset_pair) {
+					auto start = base + static_cast<std::size_t>(reader.readUleb());
+					addRange(ranges, start, base + static_cast<std::size_t>(reader.readUleb()));
+				} else if (kind == DW_RLE_base_address) {
+					base = static_cast<std::size_t>(reader.readUnsigned(unit.addressSize));
+				} else if (kind == DW_RLE_start_end) {
+					auto start = static_cast<std::size_t>(reader.readUnsigned(unit.addressSize));
+					addRange(ranges, start, static_cast<std::size_t>(reader.readUnsigned(unit.addressSize)));
+				} else if (kind == DW_RLE_start_length) {
+					auto start = static_cast<std::size_t>(reader.readUnsigned(unit.addressSize));
+					addRange(ranges, start, start + static_cast<std::size_t>(reader.readUleb()));
+				} else {
+					break; // unknown entry
+				}
+			}
+		}
+
+		/** Get line table and function ranges of compile unit, build if not cached */
+		const CompileUnitData& getCompileUnitData(std::size_t unitIndex) {
+			auto it = cachedUnits_.find(unitIndex);
+			if (it != cachedUnits_.end()) {
+				return *it->second;
+			}
+			// drop the earliest built unit if exceeds the limit
+			while (cachedUnits_.size() >= maxCachedCompileUnits_ && !cachedUnitOrder_.empty()) {
+				cachedUnits_.erase(cachedUnitOrder_.front());
+				cachedUnitOrder_.pop_front();
+			}
+			auto data = std::make_unique<CompileUnitData>();
+			AbbrevTable abbrevs;
+			AttributeValues values;
+			auto& unit = units_[unitIndex];
+			if (parseRoot(unit, abbrevs, values)) {
+				if (unit.stmtList != SIZE_MAX) {
+					buildLineTable(unit, *data);
+				}
+				buildFunctions(unit, abbrevs, *data);
+			}
+			cachedUnitOrder_.emplace_back(unitIndex);
+			return *cachedUnits_.emplace(unitIndex, std::move(data)).first->second;
+		}
+
+		/** Build line table from the line program at the offset of .debug_line */
+		void buildLineTable(const Unit& unit, CompileUnitData& data) const {
+			Reader reader(line_, unit.stmtList);
+			std::uint64_t length = reader.readUnsigned(4);
+			Unit lineUnit = unit;
+			lineUnit.is64 = false;
+			if (length == 0xffffffff) {
+				length = reader.readUnsigned(8);
+				lineUnit.is64 = true;
+			}
+			if (reader.failed || length > reader.size - reader.offset) {
+				return;
+			}
+			reader.size = reader.offset + static_cast<std::size_t>(length);
+			auto version = static_cast<std::uint16_t>(reader.readUnsigned(2));
+			if (version < 2 || version > 5) {
+				return;
+			}
+			if (version >= 5) {
+				lineUnit.addressSize = static_cast<std::uint8_t>(reader.readUnsigned(1));
+				reader.skip(1); // segment selector size
+			}
+			auto headerLength = static_cast<std::size_t>(reader.readOffset(lineUnit.is64));
+			auto programOffset = reader.offset + headerLength;
+			auto minInstLength = static_cast<std::size_t>(reader.readUnsigned(1));
+			if (version >= 4) {
+				reader.skip(1); // maximum operations per instruction, only used by VLIW
+			}
+			auto defaultIsStmt = reader.readUnsigned(1);
+			(void)defaultIsStmt;
+			auto lineBase = static_cast<std::int8_t>(reader.readUnsigned(1));
+			auto lineRange = static_cast<std::uint8_t>(reader.readUnsigned(1));
+			auto opcodeBase = static_cast<std::uint8_t>(reader.readUnsigned(1));
+			if (reader.failed || lineRange == 0 || opcodeBase == 0) {
+				return;
+			}
+			std::vector<std::uint8_t> opcodeLengths(opcodeBase, 0);
+			for (std::size_t index = 1; index < opcodeBase; ++index) {
+				opcodeLengths[index] = static_cast<std::uint8_t>(reader.readUnsigned(1));
+			}
+			// directories and files
+			std::vector<const char*> directories;
+			if (version >= 5) {
+				readEntries(reader, lineUnit, directories, nullptr);
+				std::vector<const char*> files;
+				std::vector<std::uint64_t> fileDirectories;
+				readEntries(reader, lineUnit, files, &fileDirectories);
+				for (std::size_t index = 0; index < files.size(); ++index) {
+					data.files.emplace_back(makeFilePath(
+						unit, directories, static_cast<std::size_t>(fileDirectories[index]), files[index]));
+				}
+			} else {
+				directories.emplace_back(unit.compDir);
+				while (reader.ok()) {
+					const char* directory = reader.readString();
+					if (*directory == '\0') {
+						break;
+					}
+					directories.emplace_back(directory);
+				}
+				data.files.emplace_back(nullptr); // file index starts from 1 before DWARF 5
+				while (reader.ok()) {
+					const char* file = reader.readString();
+					if (*file == '\0') {
+						break;
+					}
+					auto directoryIndex = static_cast<std::size_t>(reader.readUleb());
+					reader.readUleb(); // modification time
+					reader.readUleb(); // file size
+					data.files.emplace_back(makeFilePath(unit, directories, directoryIndex, file));
+				}
+			}
+			if (reader.failed) {
+				return;
+			}
+			// run the line program
+			reader.seek(programOffset);
+			std::size_t address = 0;
+			std::uint32_t file = 1;
+			std::int64_t line = 1;
+			std::size_t sequenceStart = data.rows.size();
+			auto emitRow = [&data, &address, &file, &line]() {
+				data.rows.emplace_back(LineRow({ address, file, static_cast<std::uint32_t>(line) }));
+			};
+			while (reader.ok()) {
+				auto opcode = static_cast<std::uint8_t>(reader.readUnsigned(1));
+				if (opcode >= opcodeBase) {
+					auto adjusted = static_cast<std::size_t>(opcode - opcodeBase);
+					address += (adjusted / lineRange) * minInstLength;
+					line += lineBase + static_cast<std::int64_t>(adjusted % lineRange);
+					emitRow();
+				} else if (opcode == 0) {
+					auto extendedLength = static_cast<std::size_t>(reader.readUleb());
+					auto extendedEnd = reader.offset + extendedLength;
+					auto extendedOpcode = (extendedLength > 0) ? reader.readUnsigned(1) : 0;
+					if (extendedOpcode == DW_LNE_end_sequence) {
+						// discard sequences of removed code, their address start from 0
+						if (sequenceStart < data.rows.size() &&
+							data.rows[sequenceStart].address != 0 &&
+							data.rows[sequenceStart].address < address) {
+							data.sequences.emplace_back(IndexedRange({
+								data.rows[sequenceStart].address, address, sequenceStart, data.rows.size() }));
+						} else {
+							data.rows.resize(sequenceStart);
+						}
+						sequenceStart = data.rows.size();
+						address = 0;
+						file = 1;
+						line = 1;
+					} else if (extendedOpcode == DW_LNE_set_address && extendedLength > 1) {
+						address = static_cast<std::size_t>(reader.readUnsigned(extendedLength - 1));
+					}
+					reader.seek(extendedEnd);
+				} else if (opcode == DW_LNS_copy) {
+					emitRow();
+				} else if (opcode == DW_LNS_advance_pc) {
+					address += static_cast<std::size_t>(reader.readUleb()) * minInstLength;
+				} else if (opcode == DW_LNS_advance_line) {
+					line += reader.readSleb();
+				} else if (opcode == DW_LNS_set_file) {
+					file = static_cast<std::uint32_t>(reader.readUleb());
+				} else if (opcode == DW_LNS_const_add_pc) {
+					address += ((255 - opcodeBase) / lineRange) * minInstLength;
+				} else if (opcode == DW_LNS_fixed_advance_pc) {
+					address += static_cast<std::size_t>(reader.readUnsigned(2));
+				} else {
+					// other standard opcodes only change registers not used here
+					for (std::size_t index = 0; index < opcodeLengths[opcode]; ++index) {
+						reader.readUleb();
+					}
+				}
+			}
+			data.rows.resize(sequenceStart); // drop unterminated sequence
+			std::sort(data.sequences.begin(), data.sequences.end(),
+				[](const auto& a, const auto& b) { return a.low < b.low; });
+		}
+
+		/** Read directory or file entries from DWARF 5 line program header */
+		void readEntries(
+			Reader& reader,
+			const Unit& lineUnit,
+			std::vector<const char*>& paths,
+			std::vector<std::uint64_t>* directoryIndices) const {
+			std::vector<AttributeSpec> formats(static_cast<std::size_t>(reader.readUnsigned(1)));
+			for (auto& format : formats) {
+				format.name = static_cast<std::uint32_t>(reader.readUleb());
+				format.form = static_cast<std::uint32_t>(reader.readUleb());
+				format.implicitConst = 0;
+			}
+			auto count = static_cast<std::size_t>(reader.readUleb());
+			AttributeValue value;
+			for (std::size_t index = 0; index < count && !reader.failed; ++index) {
+				const char* path = nullptr;
+				std::uint64_t directoryIndex = 0;
+				for (const auto& format : formats) {
+					readAttribute(reader, lineUnit, format, value);
+					if (format.name == DW_LNCT_path) {
+						path = getString(lineUnit, value);
+					} else if (format.name == DW_LNCT_directory_index) {
+						directoryIndex = value.value;
+					}
+				}
+				paths.emplace_back(path);
+				if (directoryIndices != nullptr) {
+					directoryIndices->emplace_back(directoryIndex);
+				}
+			}
+		}
+
+		/** Join directory and file name, relative directories are relative to the compilation directory */
+		static std::shared_ptr<const std::string> makeFilePath(
+			const Unit& unit,
+			const std::vector<const char*>& directories,
+			std::size_t directoryIndex,
+			const char* file) {
+			if (file == nullptr) {
+				return nullptr;
+			}
+			auto path = std::make_shared<std::string>();
+			const char* directory = (directoryIndex < directories.size()) ?
+				directories[directoryIndex] : nullptr;
+			if (file[0] != '/' && directory != nullptr) {
+				if (directory[0] != '/' && unit.compDir != nullptr && directory != unit.compDir) {
+					path->append(unit.compDir).append("/");
+				}
+				path->append(directory).append("/");
+			}
+			path->append(file);
+			return path;
+		}
+
+		/** Build ranges of subprograms and inlined subroutines by walking all DIEs of the unit */
+		void buildFunctions(const Unit& unit, const AbbrevTable& abbrevs, CompileUnitData& data) {
+			Reader reader(info_, unit.dieOffset);
+			reader.size = unit.end;
+			AttributeValues values;
+			std::vector<Range> ranges;
+			std::size_t openGroups = 0;
+			auto closeGroups = [&data, &openGroups]() {
+				for (auto index = openGroups; index < data.groups.size(); ++index) {
+					data.groups[index].lastRow = data.functions.size();
+				}
+				openGroups = data.groups.size();
+			};
+			while (reader.ok()) {
+				auto code = reader.readUleb();
+				if (code == 0) {
+					continue; // end of siblings
+				}
+				auto it = abbrevs.find(code);
+				if (it == abbrevs.end()) {
+					break;
+				}
+				readAttributes(reader, unit, it->second, values);
+				auto tag = it->second.tag;
+				if (tag != DW_TAG_subprogram && tag != DW_TAG_inlined_subroutine) {
+					continue;
+				}
+				ranges.clear();
+				readRanges(unit, values, ranges);
+				if (ranges.empty()) {
+					continue; // declaration or abstract instance
+				}
+				if (tag == DW_TAG_subprogram) {
+					// each subprogram starts a new group, inlined subroutines belong to the last group
+					closeGroups();
+					for (const auto& range : ranges) {
+						data.groups.emplace_back(IndexedRange({
+							range.low, range.high, data.functions.size(), data.functions.size() }));
+					}
+				} else if (openGroups == data.groups.size()) {
+					continue; // inlined subroutine outside of subprogram
+				}
+				auto name = getFunctionName(unit, abbrevs, values, 0);
+				std::uint32_t callFile = 0;
+				std::uint32_t callLine = 0;
+				for (const auto& value : values) {
+					if (value.name == DW_AT_call_file) {
+						callFile = static_cast<std::uint32_t>(value.value);
+					} else if (value.name == DW_AT_call_line) {
+						callLine = static_cast<std::uint32_t>(value.value);
+					}
+				}
+				for (const auto& range : ranges) {
+					data.functions.emplace_back(Function({ range.low, range.high, name, callFile, callLine }));
+				}
+			}
+			closeGroups();
+			std::sort(data.groups.begin(), data.groups.end(),
+				[](const auto& a, const auto& b) { return a.low < b.low; });
+		}
+
+		/**
+		 * Get demangled function name of DIE,
+		 * prefer linkage name, follow abstract origin and specification if the DIE has no linkage name.
+		 */
+		std::shared_ptr<const std::string> getFunctionName(
+			const Unit& unit, const AbbrevTable& abbrevs, const AttributeValues& values, std::size_t depth) {
+			const char* linkageName = nullptr;
+			const char* name = nullptr;
+			std::size_t reference = 0;
+			for (const auto& value : values) {
+				if (value.name == DW_AT_linkage_name || value.name == DW_AT_MIPS_linkage_name) {
+					linkageName = getString(unit, value);
+				} else if (value.name == DW_AT_name) {
+					name = getString(unit, value);
+				} else if (value.name == DW_AT_abstract_origin || value.name == DW_AT_specification) {
+					reference = getReference(unit, value);
+				}
+			}
+			if (linkageName != nullptr) {
+				return internFunctionName(linkageName);
+			}
+			// depth limit avoids loop in corrupted file
+			if (reference != 0 && depth < 8) {
+				auto result = getFunctionNameByReference(unit, abbrevs, reference, depth + 1);
+				if (!result->empty()) {
+					return result;
+				}
+			}
+			return (name != nullptr) ? internFunctionName(name) : DemangleUtils::getEmptyName();
+		}
+
+		/** Get demangled function name of DIE at the offset of .debug_info */
+		std::shared_ptr<const std::string> getFunctionNameByReference(
+			const Unit& unit, const AbbrevTable& abbrevs, std::size_t offset, std::size_t depth) {
+			// find the unit of referenced DIE, use its abbreviations if it's another unit
+			const Unit* targetUnit = &unit;
+			const AbbrevTable* targetAbbrevs = &abbrevs;
+			AbbrevTable otherAbbrevs;
+			if (offset < unit.dieOffset || offset >= unit.end) {
+				auto unitIndex = findUnitByOffset(offset);
+				if (unitIndex >= units_.size() ||
+					!parseAbbrevs(units_[unitIndex].abbrevOffset, otherAbbrevs)) {
+					return DemangleUtils::getEmptyName();
+				}
+				targetUnit = &units_[unitIndex];
+				targetAbbrevs = &otherAbbrevs;
+			}
+			Reader reader(info_, offset);
+			reader.size = targetUnit->end;
+			auto it = targetAbbrevs->find(reader.readUleb());
+			if (it == targetAbbrevs->end()) {
+				return DemangleUtils::getEmptyName();
+			}
+			AttributeValues values;
+			readAttributes(reader, *targetUnit, it->second, values);
+			if (reader.failed) {
+				return DemangleUtils::getEmptyName();
+			}
+			return getFunctionName(*targetUnit, *targetAbbrevs, values, depth);
+		}
+
+		/**
+		 * Get demangled name from the name in the mapped file, the same name instance is returned for the same name.
+		 * Names in .debug_str are merged by linker so the address is used as key.
+		 */
+		std::shared_ptr<const std::string> internFunctionName(const char* name) {
+			auto& result = functionNames_[name];
+			if (result == nullptr) {
+				std::string originalName(name);
+				result = DemangleUtils::demangle(originalName);
+				if (result->empty()) {
+					result = std::make_shared<std::string>(std::move(originalName));
+				}
+			}
+			return result;
+		}
+
+	protected:
+		LinuxElfFile file_;
+		SectionData info_;
+		SectionData abbrev_;
+		SectionData line_;
+		SectionData str_;
+		SectionData lineStr_;
+		SectionData strOffsets_;
+		SectionData addr_;
+		SectionData ranges_;
+		SectionData rnglists_;
+		SectionData aranges_;
+		std::vector<Unit> units_;
+		// firstRow is the index of unit
+		std::vector<IndexedRange> unitRanges_;
+		std::unordered_map<std::size_t, std::unique_ptr<CompileUnitData>> cachedUnits_;
+		std::deque<std::size_t> cachedUnitOrder_;
+		std::unordered_map<const char*, std::shared_ptr<const std::string>> functionNames_;
+		std::size_t maxCachedCompileUnits_;
+	};
+}
+
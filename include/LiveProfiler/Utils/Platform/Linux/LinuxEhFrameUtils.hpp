@@ -0,0 +1,287 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <unordered_map>
+#include "LinuxElfFile.hpp"
+
+namespace LiveProfiler {
+	/**
+	 * Static utility functions releated to .eh_frame and .eh_frame_hdr sections.
+	 * Compilers emit unwind information (FDE) for each function by default, even for stripped files,
+	 * so the ranges of FDEs can be used as function boundaries if there no symbol table.
+	 */
+	class LinuxEhFrameUtils {
+	public:
+		/** Range of function in virtual address, [first, second) */
+		using RangeType = std::pair<std::size_t, std::size_t>;
+
+		/**
+		 * Read the address ranges of all FDEs in .eh_frame.
+		 * The index table in .eh_frame_hdr only contains start addresses, so it's only used to reserve space,
+		 * the size of each function is read from the FDE itself.
+		 * Ranges are sorted by start address, empty ranges and FDEs with unsupported encoding are skipped.
+		 * Return false if the file has no .eh_frame section.
+		 */
+		static bool readFunctionRanges(const LinuxElfFile& file, std::vector<RangeType>& ranges) {
+			ranges.clear();
+			auto section = file.findSection(".eh_frame");
+			const char* data = (section == nullptr) ? nullptr : file.getSectionData(*section);
+			if (data == nullptr) {
+				return false;
+			}
+			ranges.reserve(readFdeCount(file));
+			Cursor cursor(data, data + section->size, section->address, file.is64Bit() ? 8U : 4U, false);
+			// encoding of pointers in FDE, by the offset of CIE
+			std::unordered_map<std::size_t, std::uint8_t> cieEncodings;
+			while (cursor.end - cursor.ptr >= 4) {
+				const char* entryStart = cursor.ptr;
+				std::uint64_t length = cursor.readUnsigned(4);
+				if (length == 0) {
+					break; // terminator
+				} else if (length == UINT32_MAX) {
+					length = cursor.readUnsigned(8);
+				}
+				if (cursor.failed || length < 4 || length > static_cast<std::size_t>(cursor.end - cursor.ptr)) {
+					break;
+				}
+				const char* entryEnd = cursor.ptr + length;
+				// CIE pointer is relative to the field itself, and 0 means the entry is CIE
+				const char* idField = cursor.ptr;
+				auto cieDelta = static_cast<std::size_t>(cursor.readUnsigned(4));
+				if (cieDelta == 0) {
+					cieEncodings[entryStart - data] = readCieEncoding(cursor, entryEnd);
+				} else if (cieDelta <= static_cast<std::size_t>(idField - data)) {
+					auto cieOffset = static_cast<std::size_t>(idField - data) - cieDelta;
+					auto it = cieEncodings.find(cieOffset);
+					if (it == cieEncodings.end()) {
+						Cursor cieCursor(cursor);
+						cieCursor.ptr = data + cieOffset;
+						it = cieEncodings.emplace(cieOffset, readCieEncodingAt(cieCursor)).first;
+					}
+					std::size_t start = 0;
+					std::size_t size = 0;
+					if (cursor.readPointer(it->second, start) &&
+						cursor.readPointer(it->second & 0x0f, size) &&
+						!cursor.failed && cursor.ptr <= entryEnd && size > 0) {
+						ranges.emplace_back(start, start + size);
+					}
+				}
+				cursor.ptr = entryEnd;
+				cursor.failed = false;
+			}
+			std::sort(ranges.begin(), ranges.end());
+			return true;
+		}
+
+	protected:
+		/** DW_EH_PE_* values, see LSB "Exception Frames" */
+		enum : std::uint8_t {
+			PeAbsolutePointer = 0x00,
+			PeUleb128 = 0x01,
+			PeUdata2 = 0x02,
+			PeUdata4 = 0x03,
+			PeUdata8 = 0x04,
+			PeSleb128 = 0x09,
+			PeSdata2 = 0x0a,
+			PeSdata4 = 0x0b,
+			PeSdata8 = 0x0c,
+			PePcRelative = 0x10,
+			PeDataRelative = 0x30,
+			PeOmit = 0xff
+		};
+
+		/** Bounds checked reader of section contents, `address` is the virtual address of `begin` */
+		struct Cursor {
+			const char* begin;
+			const char* end;
+			std::size_t address;
+			unsigned pointerSize;
+			bool failed;
+			const char* ptr;
+
+			Cursor(const char* beginValue, const char* endValue,
+				std::size_t addressValue, unsigned pointerSizeValue, bool failedValue) :
+				begin(beginValue),
+				end(endValue),
+				address(addressValue),
+				pointerSize(pointerSizeValue),
+				failed(failedValue),
+				ptr(beginValue) { }
+
+			std::uint64_t readUnsigned(std::size_t count) {
+				std::uint64_t value = 0;
+				if (failed || ptr < begin || count > static_cast<std::size_t>(end - ptr)) {
+					failed = true;
+					return 0;
+				}
+				// little endian only, same as LinuxDwarfLineIndex
+				std::memcpy(&value, ptr, count);
+				ptr += count;
+				return value;
+			}
+
+			std::int64_t readSigned(std::size_t count) {
+				auto value = readUnsigned(count);
+				auto shift = static_cast<unsigned>(64 - count * 8);
+				return static_cast<std::int64_t>(value << shift) >> shift;
+			}
+
+			std::uint64_t readUleb() {
+				std::uint64_t value = 0;
+				unsigned shift = 0;
+				while (!failed && ptr < end) {
+					auto byte = static_cast<unsigned char>(*ptr++);
+					if (shift < 64) {
+						value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+					}
+					shift += 7;
+					if ((byte & 0x80) == 0) {
+						return value;
+					}
+				}
+				failed = true;
+				return 0;
+			}
+
+			std::int64_t readSleb() {
+				std::int64_t value = 0;
+				unsigned shift = 0;
+				while (!failed && ptr < end) {
+					auto byte = static_cast<unsigned char>(*ptr++);
+					if (shift < 64) {
+						value |= static_cast<std::int64_t>(static_cast<std::uint64_t>(byte & 0x7f) << shift);
+					}
+					shift += 7;
+					if ((byte & 0x80) == 0) {
+						if (shift < 64 && (byte & 0x40) != 0) {
+							value |= -(static_cast<std::int64_t>(1) << shift);
+						}
+						return value;
+					}
+				}
+				failed = true;
+				return 0;
+			}
+
+			/**
+			 * Read pointer with DW_EH_PE_* encoding, pc relative values are relative to the field itself,
+			 * data relative values are relative to the start of section (used by .eh_frame_hdr).
+			 * Return false if the encoding is not supported.
+			 */
+			bool readPointer(std::uint8_t encoding, std::size_t& value) {
+				std::size_t fieldAddress = address + static_cast<std::size_t>(ptr - begin);
+				std::uint64_t raw = 0;
+				switch (encoding & 0x0f) {
+				case PeAbsolutePointer: raw = readUnsigned(pointerSize); break;
+				case PeUleb128: raw = readUleb(); break;
+				case PeUdata2: raw = readUnsigned(2); break;
+				case PeUdata4: raw = readUnsigned(4); break;
+				case PeUdata8: raw = readUnsigned(8); break;
+				case PeSleb128: raw = static_cast<std::uint64_t>(readSleb()); break;
+				case PeSdata2: raw = static_cast<std::uint64_t>(readSigned(2)); break;
+				case PeSdata4: raw = static_cast<std::uint64_t>(readSigned(4)); break;
+				case PeSdata8: raw = static_cast<std::uint64_t>(readSigned(8)); break;
+				default: return false;
+				}
+				switch (encoding & 0x70) {
+				case 0: break;
+				case PePcRelative: raw += fieldAddress; break;
+				case PeDataRelative: raw += address; break;
+				default: return false; // text, function relative and aligned are not used by compilers
+				}
+				// indirect pointers point to the runtime memory, they're not readable from file
+				value = static_cast<std::size_t>(raw);
+				return !failed && (encoding & 0x80) == 0;
+			}
+		};
+
+		/** Read the FDE pointer encoding from CIE, the cursor is after the CIE id */
+		static std::uint8_t readCieEncoding(Cursor& cursor, const char* entryEnd) {
+			auto version = static_cast<unsigned>(cursor.readUnsigned(1));
+			const char* augmentation = cursor.ptr;
+			const void* terminator = (cursor.failed || cursor.ptr >= entryEnd) ? nullptr :
+				std::memchr(cursor.ptr, 0, entryEnd - cursor.ptr);
+			if (terminator == nullptr) {
+				return PeOmit;
+			}
+			cursor.ptr = static_cast<const char*>(terminator) + 1;
+			if (std::strstr(augmentation, "eh") != nullptr) {
+				cursor.readUnsigned(cursor.pointerSize); // eh_data of old gcc
+			}
+			cursor.readUleb(); // code alignment factor
+			cursor.readSleb(); // data alignment factor
+			if (version == 1) {
+				cursor.readUnsigned(1); // return address register
+			} else {
+				cursor.readUleb();
+			}
+			if (augmentation[0] != 'z') {
+				return PeAbsolutePointer;
+			}
+			cursor.readUleb(); // augmentation data length
+			for (const char* c = augmentation + 1; *c != '\0' && !cursor.failed; ++c) {
+				if (*c == 'R') {
+					auto encoding = static_cast<std::uint8_t>(cursor.readUnsigned(1));
+					return cursor.failed ? static_cast<std::uint8_t>(PeOmit) : encoding;
+				} else if (*c == 'P') {
+					std::size_t personality = 0;
+					auto encoding = static_cast<std::uint8_t>(cursor.readUnsigned(1));
+					if (!cursor.readPointer(encoding & 0x7f, personality)) {
+						return PeOmit; // the size of personality is unknown, the following data can't be parsed
+					}
+				} else if (*c == 'L') {
+					cursor.readUnsigned(1);
+				} else if (*c != 'S' && *c != 'B') {
+					return PeOmit; // unknown augmentation, the following data can't be parsed
+				}
+			}
+			return cursor.failed ? PeOmit : PeAbsolutePointer;
+		}
+
+		/** Read the FDE pointer encoding from CIE at the cursor, used when FDE refers to a CIE not read yet */
+		static std::uint8_t readCieEncodingAt(Cursor& cursor) {
+			auto length = cursor.readUnsigned(4);
+			if (length == UINT32_MAX) {
+				length = cursor.readUnsigned(8);
+			}
+			if (cursor.failed || length < 4 || length > static_cast<std::size_t>(cursor.end - cursor.ptr)) {
+				return PeOmit;
+			}
+			const char* entryEnd = cursor.ptr + length;
+			if (cursor.readUnsigned(4) != 0) {
+				return PeOmit;
+			}
+			return readCieEncoding(cursor, entryEnd);
+		}
+
+		/**
+		 * Read how many FDEs in .eh_frame_hdr, return 0 if the section is not found.
+		 * Format: version, eh_frame_ptr encoding, fde_count encoding, table encoding, eh_frame_ptr, fde_count.
+		 */
+		static std::size_t readFdeCount(const LinuxElfFile& file) {
+			auto section = file.findSection(".eh_frame_hdr");
+			const char* data = (section == nullptr) ? nullptr : file.getSectionData(*section);
+			if (data == nullptr) {
+				return 0;
+			}
+			Cursor cursor(data, data + section->size, section->address, file.is64Bit() ? 8U : 4U, false);
+			auto version = cursor.readUnsigned(1);
+			auto framePointerEncoding = static_cast<std::uint8_t>(cursor.readUnsigned(1));
+			auto countEncoding = static_cast<std::uint8_t>(cursor.readUnsigned(1));
+			cursor.readUnsigned(1);
+			std::size_t framePointer = 0;
+			std::size_t count = 0;
+			if (version != 1 || framePointerEncoding == PeOmit || countEncoding == PeOmit ||
+				!cursor.readPointer(framePointerEncoding, framePointer) ||
+				!cursor.readPointer(countEncoding, count)) {
+				return 0;
+			}
+			// each entry of the table costs at least 8 bytes, prevent reserving too much for broken file
+			return std::min(count, section->size / 8);
+		}
+	};
+}
+
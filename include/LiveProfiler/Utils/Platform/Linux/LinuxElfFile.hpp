@@ -0,0 +1,350 @@
+#pragma once
+#include <elf.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace LiveProfiler {
+	/**
+	 * Read only view of elf file mapped into memory, supports both ELF32 and ELF64.
+	 * Headers are converted to the common structures below when opened,
+	 * section contents and symbols are read from the mapped memory directly without copy.
+	 * All const functions are thread safe, so sections can be parsed in parallel.
+	 */
+	class LinuxElfFile {
+	public:
+		/** Section header, name points to the section header string table */
+		struct Section {
+			const char* name;
+			std::uint32_t type;
+			std::uint64_t flags;
+			std::size_t address;
+			std::size_t offset;
+			std::size_t size;
+			std::uint32_t link;
+			std::size_t entrySize;
+		};
+
+		/** Program header */
+		struct Segment {
+			std::uint32_t type;
+			std::uint32_t flags;
+			std::size_t offset;
+			std::size_t address;
+			std::size_t fileSize;
+			std::size_t memorySize;
+		};
+
+		/** Symbol from SHT_SYMTAB or SHT_DYNSYM section, name points to the linked string table */
+		struct Symbol {
+			const char* name;
+			std::size_t value;
+			std::size_t size;
+			unsigned char type;
+			unsigned char binding;
+			std::uint16_t sectionIndex;
+		};
+
+		/** Getters */
+		bool isOpen() const { return data_ != nullptr; }
+		bool is64Bit() const { return is64Bit_; }
+		std::uint16_t getType() const { return type_; }
+		const char* data() const { return data_; }
+		std::size_t size() const { return size_; }
+		const std::vector<Section>& getSections() const& { return sections_; }
+		const std::vector<Segment>& getSegments() const& { return segments_; }
+
+		/** Find the first section with the given name, return nullptr if not found */
+		const Section* findSection(const char* name) const {
+			for (const auto& section : sections_) {
+				if (std::strcmp(section.name, name) == 0) {
+					return &section;
+				}
+			}
+			return nullptr;
+		}
+
+		/** Find the first section with the given type, return nullptr if not found */
+		const Section* findSectionByType(std::uint32_t type) const {
+			for (const auto& section : sections_) {
+				if (section.type == type) {
+					return &section;
+				}
+			}
+			return nullptr;
+		}
+
+		/**
+		 * Get the contents of the section in the mapped memory,
+		 * return nullptr if the section has no contents in file (SHT_NOBITS) or it's out of range.
+		 */
+		const char* getSectionData(const Section& section) const {
+			if (section.type == SHT_NOBITS || !inRange(section.offset, section.size)) {
+				return nullptr;
+			}
+			return data_ + section.offset;
+		}
+
+		/** Get how many symbols in the SHT_SYMTAB or SHT_DYNSYM section */
+		std::size_t getSymbolCount(const Section& section) const {
+			std::size_t entrySize = is64Bit_ ? sizeof(Elf64_Sym) : sizeof(Elf32_Sym);
+			if (getSectionData(section) == nullptr) {
+				return 0;
+			}
+			return section.size / entrySize;
+		}
+
+		/**
+		 * Invoke func(const Symbol&) for each symbol in the SHT_SYMTAB or SHT_DYNSYM section.
+		 * Symbols with invalid name are passed with empty name.
+		 */
+		template <class Func>
+		void forEachSymbol(const Section& section, const Func& func) const {
+			if (section.link >= sections_.size()) {
+				return;
+			}
+			const auto& stringSection = sections_[section.link];
+			const char* strings = getSectionData(stringSection);
+			if (strings == nullptr || stringSection.size == 0 ||
+				strings[stringSection.size - 1] != '\0') {
+				return; // string table should be null terminated
+			}
+			if (is64Bit_) {
+				forEachSymbolByElfClass<Elf64_Sym>(section, strings, stringSection.size, func);
+			} else {
+				forEachSymbolByElfClass<Elf32_Sym>(section, strings, stringSection.size, func);
+			}
+		}
+
+		/**
+		 * Convert file offset to virtual address by PT_LOAD segments.
+		 * Return false if the offset isn't inside any PT_LOAD segment.
+		 */
+		static bool toAddress(
+			const std::vector<Segment>& segments, std::size_t fileOffset, std::size_t& address) {
+			for (const auto& segment : segments) {
+				if (segment.type == PT_LOAD &&
+					fileOffset >= segment.offset &&
+					fileOffset < segment.offset + segment.fileSize) {
+					address = fileOffset - segment.offset + segment.address;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		/**
+		 * Convert virtual address to file offset by PT_LOAD segments.
+		 * Return false if the address isn't inside any PT_LOAD segment.
+		 */
+		static bool toFileOffset(
+			const std::vector<Segment>& segments, std::size_t address, std::size_t& fileOffset) {
+			// usually there very few LOAD entries so it's not necessary to do binary search
+			for (const auto& segment : segments) {
+				if (segment.type == PT_LOAD &&
+					address >= segment.address &&
+					address < segment.address + segment.memorySize) {
+					fileOffset = address - segment.address + segment.offset;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		/** Map the file into memory and parse the headers, return whether the file is valid elf */
+		bool open(const std::string& path) {
+			close();
+			int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+			if (fd < 0) {
+				return false;
+			}
+			struct ::stat st;
+			void* mapped = MAP_FAILED;
+			if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) &&
+				static_cast<std::size_t>(st.st_size) >= EI_NIDENT) {
+				mapped = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			}
+			::close(fd);
+			if (mapped == MAP_FAILED) {
+				return false;
+			}
+			data_ = static_cast<const char*>(mapped);
+			size_ = static_cast<std::size_t>(st.st_size);
+			bool parsed = false;
+			if (std::memcmp(data_, ELFMAG, SELFMAG) == 0) {
+				auto elfClass = data_[EI_CLASS];
+				if (elfClass == ELFCLASS32) {
+					parsed = parseHeaders<Elf32_Ehdr, Elf32_Phdr, Elf32_Shdr>();
+				} else if (elfClass == ELFCLASS64) {
+					parsed = parseHeaders<Elf64_Ehdr, Elf64_Phdr, Elf64_Shdr>();
+				}
+			}
+			if (!parsed) {
+				close();
+			}
+			return parsed;
+		}
+
+		/** Unmap the file */
+		void close() {
+			if (data_ != nullptr) {
+				::munmap(const_cast<char*>(data_), size_);
+			}
+			data_ = nullptr;
+			size_ = 0;
+			is64Bit_ = false;
+			type_ = ET_NONE;
+			sections_.clear();
+			segments_.clear();
+		}
+
+		/** Constructor */
+		LinuxElfFile() :
+			data_(nullptr),
+			size_(0),
+			is64Bit_(false),
+			type_(ET_NONE),
+			sections_(),
+			segments_() { }
+
+		/** Constructor, use `isOpen` to check whether the file is valid elf */
+		explicit LinuxElfFile(const std::string& path) : LinuxElfFile() {
+			open(path);
+		}
+
+		/** Destructor */
+		~LinuxElfFile() {
+			close();
+		}
+
+	protected:
+		/** Disable copy */
+		LinuxElfFile(const LinuxElfFile&) = delete;
+		LinuxElfFile& operator=(const LinuxElfFile&) = delete;
+
+		/** Check whether [offset, offset+size) is inside the file */
+		bool inRange(std::size_t offset, std::size_t size) const {
+			return offset <= size_ && size <= size_ - offset;
+		}
+
+		/** Read the structure at offset, the mapped memory may not aligned for it */
+		template <class T>
+		T readAt(std::size_t offset) const {
+			T value;
+			std::memcpy(&value, data_ + offset, sizeof(value));
+			return value;
+		}
+
+		/** Parse program headers and section headers by elf class type */
+		template <class Ehdr, class Phdr, class Shdr>
+		bool parseHeaders() {
+			if (!inRange(0, sizeof(Ehdr))) {
+				return false;
+			}
+			auto header = readAt<Ehdr>(0);
+			is64Bit_ = sizeof(Ehdr) == sizeof(Elf64_Ehdr);
+			type_ = header.e_type;
+			// program headers
+			if (header.e_phoff != 0 && header.e_phentsize == sizeof(Phdr)) {
+				if (!inRange(header.e_phoff, sizeof(Phdr) * header.e_phnum)) {
+					return false;
+				}
+				segments_.reserve(header.e_phnum);
+				for (std::size_t i = 0; i < header.e_phnum; ++i) {
+					auto programHeader = readAt<Phdr>(header.e_phoff + sizeof(Phdr) * i);
+					segments_.emplace_back(Segment({
+						programHeader.p_type,
+						programHeader.p_flags,
+						static_cast<std::size_t>(programHeader.p_offset),
+						static_cast<std::size_t>(programHeader.p_vaddr),
+						static_cast<std::size_t>(programHeader.p_filesz),
+						static_cast<std::size_t>(programHeader.p_memsz)
+					}));
+				}
+			}
+			// section headers, the count and the string table index may be stored in the first section
+			if (header.e_shoff == 0 || header.e_shentsize != sizeof(Shdr) ||
+				!inRange(header.e_shoff, sizeof(Shdr))) {
+				return true; // no section headers, it's valid for stripped files
+			}
+			auto firstSectionHeader = readAt<Shdr>(header.e_shoff);
+			std::size_t sectionCount = header.e_shnum;
+			std::size_t stringSectionIndex = header.e_shstrndx;
+			if (sectionCount == 0) {
+				sectionCount = static_cast<std::size_t>(firstSectionHeader.sh_size);
+			}
+			if (stringSectionIndex == SHN_XINDEX) {
+				stringSectionIndex = firstSectionHeader.sh_link;
+			}
+			if (sectionCount > size_ / sizeof(Shdr) ||
+				!inRange(header.e_shoff, sizeof(Shdr) * sectionCount)) {
+				return false;
+			}
+			static const char emptyName[] = "";
+			sections_.reserve(sectionCount);
+			for (std::size_t i = 0; i < sectionCount; ++i) {
+				auto sectionHeader = readAt<Shdr>(header.e_shoff + sizeof(Shdr) * i);
+				sections_.emplace_back(Section({
+					emptyName,
+					sectionHeader.sh_type,
+					static_cast<std::uint64_t>(sectionHeader.sh_flags),
+					static_cast<std::size_t>(sectionHeader.sh_addr),
+					static_cast<std::size_t>(sectionHeader.sh_offset),
+					static_cast<std::size_t>(sectionHeader.sh_size),
+					sectionHeader.sh_link,
+					static_cast<std::size_t>(sectionHeader.sh_entsize)
+				}));
+			}
+			// section names
+			if (stringSectionIndex < sections_.size()) {
+				const auto& stringSection = sections_[stringSectionIndex];
+				const char* strings = getSectionData(stringSection);
+				if (strings != nullptr && stringSection.size > 0 &&
+					strings[stringSection.size - 1] == '\0') {
+					for (std::size_t i = 0; i < sectionCount; ++i) {
+						auto nameOffset = readAt<Shdr>(header.e_shoff + sizeof(Shdr) * i).sh_name;
+						if (nameOffset < stringSection.size) {
+							sections_[i].name = strings + nameOffset;
+						}
+					}
+				}
+			}
+			return true;
+		}
+
+		/** Invoke func for each symbol by elf class type */
+		template <class Sym, class Func>
+		void forEachSymbolByElfClass(
+			const Section& section,
+			const char* strings,
+			std::size_t stringsSize,
+			const Func& func) const {
+			std::size_t count = getSymbolCount(section);
+			Symbol symbol;
+			for (std::size_t i = 0; i < count; ++i) {
+				auto sym = readAt<Sym>(section.offset + sizeof(Sym) * i);
+				symbol.name = strings + ((sym.st_name < stringsSize) ? sym.st_name : stringsSize - 1);
+				symbol.value = static_cast<std::size_t>(sym.st_value);
+				symbol.size = static_cast<std::size_t>(sym.st_size);
+				symbol.type = ELF64_ST_TYPE(sym.st_info);
+				symbol.binding = ELF64_ST_BIND(sym.st_info);
+				symbol.sectionIndex = sym.st_shndx;
+				func(symbol);
+			}
+		}
+
+	protected:
+		const char* data_;
+		std::size_t size_;
+		bool is64Bit_;
+		std::uint16_t type_;
+		std::vector<Section> sections_;
+		std::vector<Segment> segments_;
+	};
+}
+
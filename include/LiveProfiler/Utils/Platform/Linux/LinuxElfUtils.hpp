@@ -0,0 +1,168 @@
+#pragma once
+#include <elf.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <array>
+#include "LinuxElfFile.hpp"
+
+namespace LiveProfiler {
+	/** Static utility functions releated to elf files */
+	struct LinuxElfUtils {
+		/** The directory contains separate debug files, same as gdb's default */
+		static const std::string& getDefaultDebugDirectory() {
+			static const std::string directory("/usr/lib/debug");
+			return directory;
+		}
+
+		/**
+		 * Read the GNU build-id from the PT_NOTE segments of the elf file,
+		 * the result is a lower case hex string, the same as `readelf -n` shows.
+		 * Return whether the build-id is found.
+		 */
+		static bool readBuildId(const std::string& path, std::string& buildId) {
+			buildId.clear();
+			LinuxElfFile file(path);
+			return file.isOpen() && readBuildId(file, buildId);
+		}
+
+		/** Read the GNU build-id from the PT_NOTE segments of the opened elf file */
+		static bool readBuildId(const LinuxElfFile& file, std::string& buildId) {
+			static const char hex[] = "0123456789abcdef";
+			buildId.clear();
+			for (const auto& segment : file.getSegments()) {
+				if (segment.type != PT_NOTE ||
+					segment.offset > file.size() || segment.fileSize > file.size() - segment.offset) {
+					continue;
+				}
+				// note format: header, name (4 bytes aligned), desc (4 bytes aligned)
+				// the header has the same layout for elf32 and elf64
+				const char* notes = file.data() + segment.offset;
+				std::size_t offset = 0;
+				while (offset + sizeof(Elf32_Nhdr) <= segment.fileSize) {
+					Elf32_Nhdr note;
+					std::memcpy(&note, notes + offset, sizeof(note));
+					std::size_t nameOffset = offset + sizeof(note);
+					std::size_t descOffset = nameOffset + ((note.n_namesz + 3) & ~3);
+					std::size_t nextOffset = descOffset + ((note.n_descsz + 3) & ~3);
+					if (nextOffset > segment.fileSize) {
+						break; // corrupted note
+					}
+					if (note.n_type == NT_GNU_BUILD_ID && note.n_namesz == sizeof(ELF_NOTE_GNU) &&
+						std::memcmp(notes + nameOffset, ELF_NOTE_GNU, sizeof(ELF_NOTE_GNU)) == 0) {
+						for (std::size_t i = 0; i < note.n_descsz; ++i) {
+							auto c = static_cast<unsigned char>(notes[descOffset + i]);
+							buildId.push_back(hex[c >> 4]);
+							buildId.push_back(hex[c & 0xf]);
+						}
+						return !buildId.empty();
+					}
+					offset = nextOffset;
+				}
+			}
+			return false;
+		}
+
+		/**
+		 * Read the file name and crc from .gnu_debuglink section.
+		 * Return whether the section is found.
+		 */
+		static bool readDebugLink(const LinuxElfFile& file, std::string& name, std::uint32_t& crc) {
+			name.clear();
+			crc = 0;
+			auto section = file.findSection(".gnu_debuglink");
+			const char* data = (section == nullptr) ? nullptr : file.getSectionData(*section);
+			if (data == nullptr) {
+				return false;
+			}
+			// format: file name, padding to 4 bytes, crc32 of the debug file
+			auto nameSize = ::strnlen(data, section->size);
+			auto crcOffset = (nameSize + 4) & ~static_cast<std::size_t>(3);
+			if (nameSize == 0 || crcOffset + sizeof(crc) > section->size) {
+				return false;
+			}
+			name.assign(data, nameSize);
+			std::memcpy(&crc, data + crcOffset, sizeof(crc));
+			return true;
+		}
+
+		/**
+		 * Find the separate debug file of the elf file, the search order is the same as gdb:
+		 * - $debugDirectory/.build-id/xx/yyyy.debug
+		 * - $dir/$debuglink
+		 * - $dir/.debug/$debuglink
+		 * - $debugDirectory/$dir/$debuglink
+		 * Files found by debuglink are only accepted if the crc matches.
+		 * Return whether the debug file is found.
+		 */
+		static bool findDebugFile(
+			const LinuxElfFile& file,
+			const std::string& path,
+			std::string& debugPath,
+			const std::string& debugDirectory = getDefaultDebugDirectory()) {
+			debugPath.clear();
+			// find by build-id
+			std::string buildId;
+			if (readBuildId(file, buildId) && buildId.size() > 2) {
+				debugPath.append(debugDirectory).append("/.build-id/")
+					.append(buildId, 0, 2).append("/")
+					.append(buildId, 2, buildId.npos).append(".debug");
+				if (debugPath != path && ::access(debugPath.c_str(), R_OK) == 0) {
+					return true;
+				}
+			}
+			// find by debuglink
+			std::string name;
+			std::uint32_t crc = 0;
+			if (!readDebugLink(file, name, crc)) {
+				debugPath.clear();
+				return false;
+			}
+			auto slashIndex = path.rfind('/');
+			std::string directory = (slashIndex == path.npos) ? "." : path.substr(0, slashIndex);
+			std::array<std::string, 3> candidates = {{
+				directory + "/" + name,
+				directory + "/.debug/" + name,
+				debugDirectory + directory + "/" + name
+			}};
+			for (auto& candidate : candidates) {
+				if (candidate == path || ::access(candidate.c_str(), R_OK) != 0) {
+					continue;
+				}
+				LinuxElfFile debugFile(candidate);
+				if (debugFile.isOpen() && crc32(debugFile.data(), debugFile.size()) == crc) {
+					debugPath = std::move(candidate);
+					return true;
+				}
+			}
+			debugPath.clear();
+			return false;
+		}
+
+		/** Calculate crc32 used by .gnu_debuglink, it's the same as zlib's crc32 */
+		static std::uint32_t crc32(const char* data, std::size_t size, std::uint32_t crc = 0) {
+			static const auto table = makeCrc32Table();
+			crc = ~crc;
+			for (std::size_t i = 0; i < size; ++i) {
+				crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xff] ^ (crc >> 8);
+			}
+			return ~crc;
+		}
+
+	protected:
+		/** Build lookup table for crc32 */
+		static std::array<std::uint32_t, 256> makeCrc32Table() {
+			std::array<std::uint32_t, 256> table;
+			for (std::uint32_t i = 0; i < table.size(); ++i) {
+				std::uint32_t value = i;
+				for (std::size_t bit = 0; bit < 8; ++bit) {
+					value = (value & 1) ? (0xedb88320 ^ (value >> 1)) : (value >> 1);
+				}
+				table[i] = value;
+			}
+			return table;
+		}
+	};
+}
+
@@ -1,258 +1,287 @@
 #pragma once
-#include <bfd.h>
 #include <elf.h>
 #include <cassert>
+#include <cstdio>
 #include <cstring>
 #include <vector>
 #include <memory>
-#include <fstream>
 #include <algorithm>
-#include <array>
 #include "../../../Models/Shared/SymbolName.hpp"
+#include "LinuxElfFile.hpp"
+#include "LinuxElfUtils.hpp"
+#include "LinuxEhFrameUtils.hpp"
+#include "LinuxDwarfLineIndex.hpp"
+#include "LinuxSymbolTable.hpp"
+#include "LinuxSymbolTableCache.hpp"
 
 namespace LiveProfiler {
 	/**
 	 * Class used to resolve symbol name from single linux executable file
-	 * For how to get the symbols from executable file please see nm.c in binutils.
-	 * This class require binutils-dev to be installed.
+	 * The file is mapped into memory and .symtab, .dynsym and PT_LOAD entries are read directly,
+	 * no extra library is required, see LinuxElfFile.
+	 * For stripped files, .symtab and debug information are read from the separate debug file
+	 * found by build-id or .gnu_debuglink, addresses are still translated by the file itself.
+	 * If no .symtab is found, ranges of FDEs in .eh_frame are used as function boundaries,
+	 * functions without symbol get synthetic names like "sub_1a2b0@libfoo.so" (file offset and file name).
+	 * If a LinuxSymbolTableCache is given, the symbol table is loaded from the cache when possible,
+	 * and stored to the cache after parsed.
+	 * Symbols are stored in a compact LinuxSymbolTable, SymbolName is created only for resolved symbols.
+	 * The file can be opened from a path different from the path of symbol names,
+	 * e.g. /proc/$pid/root$path for processes in containers.
 	 */
 	class LinuxExecutableSymbolResolver {
 	public:
 		/** Getters */
 		const std::shared_ptr<std::string>& getPath() const& { return path_; }
+		const std::string& getFilePath() const& { return filePath_; }
+		const LinuxSymbolTable& getSymbolTable() const& { return symbolTable_; }
+
+		/** Resolve symbol handle from file offset, return InvalidHandle if not found */
+		LinuxSymbolTable::HandleType resolveHandle(std::size_t offset) const {
+			return symbolTable_.find(offset);
+		}
 
 		/** Resolve symbol name from file offset, return nullptr if not found */
 		std::shared_ptr<SymbolName> resolve(std::size_t offset) {
-			// find first symbol that fileOffsetEnd > offset
-			auto it = std::upper_bound(
-				symbolNames_.cbegin(), symbolNames_.cend(), offset,
-				[](const auto& a, const auto& b) {
-					return a < b->getFileOffsetEnd();
-				});
-			if (it == symbolNames_.cend()) {
-				return nullptr;
+			return symbolTable_.getSymbolName(symbolTable_.find(offset));
+		}
+
+		/** Resolve symbol names from file offsets in batch, nullptr is stored if not found */
+		void resolve(const std::size_t* offsets, std::size_t count, std::shared_ptr<SymbolName>* results) {
+			LinuxSymbolTable::HandleType handles[StaticSearchTree::BatchSize];
+			for (std::size_t start = 0; start < count; start += StaticSearchTree::BatchSize) {
+				std::size_t batchSize = std::min(StaticSearchTree::BatchSize, count - start);
+				symbolTable_.find(offsets + start, batchSize, handles);
+				for (std::size_t i = 0; i < batchSize; ++i) {
+					results[start + i] = symbolTable_.getSymbolName(handles[i]);
+				}
 			}
-			// check is offset >= fileOffsetStart and offset < fileOffsetEnd
-			// since the smallest fileOffsetStart will come first when fileOffsetEnd is equal
-			// only check the first element
-			const auto& symbolName = *it;
-			if (offset >= symbolName->getFileOffsetStart()) {
-				return symbolName;
+		}
+
+		/**
+		 * Resolve source locations (file:line and inlined frames, innermost first) from file offset.
+		 * The DWARF index is created on the first call, it's optional and costs nothing if never used.
+		 * Return false if the file has no debug information covers the offset.
+		 */
+		bool resolveSourceLocations(std::size_t offset, std::vector<LinuxDwarfLineIndex::Frame>& frames) {
+			if (lineIndex_ == nullptr) {
+				LinuxElfFile file(filePath_);
+				loadSegments_ = file.getSegments();
+				std::string debugPath;
+				if (file.isOpen() && file.findSection(".debug_info") == nullptr &&
+					LinuxElfUtils::findDebugFile(file, filePath_, debugPath, debugDirectory_)) {
+					lineIndex_ = std::make_unique<LinuxDwarfLineIndex>(debugPath);
+				} else {
+					lineIndex_ = std::make_unique<LinuxDwarfLineIndex>(filePath_);
+				}
+			}
+			std::size_t address = 0;
+			if (!LinuxElfFile::toAddress(loadSegments_, offset, address)) {
+				frames.clear();
+				return false;
 			}
-			return nullptr;
+			return lineIndex_->resolveAddress(address, frames);
 		}
 
-		/** Constructor */
-		explicit LinuxExecutableSymbolResolver(const std::shared_ptr<std::string>& path) :
+		/** Constructor, the file is opened from `filePath` if it's not empty, otherwise from `path` */
+		explicit LinuxExecutableSymbolResolver(
+			const std::shared_ptr<std::string>& path,
+			const std::shared_ptr<LinuxSymbolTableCache>& cache = nullptr,
+			const std::string& debugDirectory = LinuxElfUtils::getDefaultDebugDirectory(),
+			const std::string& filePath = std::string()) :
 			path_(path),
-			loadEntries_(),
-			symbolNames_() {
-			loadLoadEntries();
+			filePath_(filePath.empty() && path != nullptr ? *path : filePath),
+			debugDirectory_(debugDirectory),
+			symbolTable_(path),
+			lineIndex_(),
+			loadSegments_() {
+			assert(path_ != nullptr);
+			std::string cacheKey;
+			if (cache != nullptr && !filePath_.empty()) {
+				cacheKey = LinuxSymbolTableCache::getKey(filePath_);
+				if (cache->load(cacheKey, symbolTable_)) {
+					return;
+				}
+			}
 			loadSymbolNames();
+			if (cache != nullptr && !symbolTable_.empty()) {
+				cache->store(cacheKey, symbolTable_);
+			}
 		}
 
 	protected:
-		/** Load LOAD entries from elf program headers by elf class type */
-		template <class EHdr, class Phdr>
-		void loadLoadEntriesByElfClass(std::ifstream& file) {
-			EHdr header;
-			file.seekg(0);
-			if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
-				return; // read elf header failed
-			}
-			std::vector<Phdr> programHeaders;
-			programHeaders.resize(header.e_phnum);
-			file.seekg(header.e_phoff);
-			if (!file.read(
-				reinterpret_cast<char*>(programHeaders.data()),
-				sizeof(Phdr) * programHeaders.size())) {
-				return; // read program headers failed
-			}
-			for (auto& programHeader : programHeaders) {
-				if (programHeader.p_type == PT_LOAD) {
-					// found LOAD entry
-					loadEntries_.emplace_back(LoadEntry({
-						static_cast<std::size_t>(programHeader.p_offset),
-						static_cast<std::size_t>(programHeader.p_vaddr),
-						static_cast<std::size_t>(programHeader.p_vaddr + programHeader.p_memsz)
-					}));
+		/** Represent symbol collected from symbol sections, see `loadSymbolNames`, name is nullptr if unnamed */
+		struct SymbolEntry {
+			const char* name;
+			std::size_t value;
+			std::size_t size;
+			std::size_t sectionEnd;
+		};
+
+		/**
+		 * Collect symbols from single SHT_SYMTAB or SHT_DYNSYM section.
+		 * It only reads the mapped file so different sections can be collected in parallel.
+		 */
+		static void collectSymbols(
+			const LinuxElfFile& file,
+			const LinuxElfFile::Section& section,
+			std::vector<SymbolEntry>& entries) {
+			const auto& sections = file.getSections();
+			entries.reserve(entries.size() + file.getSymbolCount(section));
+			file.forEachSymbol(section, [&sections, &entries](const auto& symbol) {
+				// see filter_symbols in nm.c in binutils, also skip undefined, absolute and tls symbols
+				// since their values are not virtual addresses
+				if (symbol.type == STT_SECTION || symbol.type == STT_FILE || symbol.type == STT_TLS ||
+					symbol.sectionIndex == SHN_UNDEF || symbol.sectionIndex >= sections.size() ||
+					symbol.name[0] == '\0') {
+					return;
 				}
-			}
+				// use section end instead of index, the indices of debug file may be different
+				const auto& symbolSection = sections[symbol.sectionIndex];
+				entries.emplace_back(SymbolEntry({
+					symbol.name, symbol.value, symbol.size, symbolSection.address + symbolSection.size }));
+			});
 		}
 
-		/** Load LOAD entries from elf program headers */
-		void loadLoadEntries() {
-			assert(path_ != nullptr);
-			std::ifstream file(*path_);
-			std::array<char, EI_NIDENT> ident;
-			if (!file.read(ident.data(), ident.size())) {
-				return; // read ident failed
-			}
-			if (std::memcmp(ident.data(), ELFMAG, SELFMAG) != 0) {
-				return; // magic not matched
+		/**
+		 * Use ranges of FDEs as function boundaries, entries should be sorted by value.
+		 * Symbols start at the same address get the size of the range if they have no size,
+		 * other ranges are added as unnamed entries, so guessed sizes will end at the next function.
+		 */
+		static void collectUnnamedFunctions(const LinuxElfFile& file, std::vector<SymbolEntry>& entries) {
+			std::vector<LinuxEhFrameUtils::RangeType> ranges;
+			if (!LinuxEhFrameUtils::readFunctionRanges(file, ranges)) {
+				return;
 			}
-			auto elfClass = ident.at(EI_CLASS);
-			if (elfClass == ELFCLASS32) {
-				loadLoadEntriesByElfClass<Elf32_Ehdr, Elf32_Phdr>(file);
-			} else if (elfClass == ELFCLASS64) {
-				loadLoadEntriesByElfClass<Elf64_Ehdr, Elf64_Phdr>(file);
-			} else {
-				// other elf classes are unsupported, but there no others for now
+			auto compareValue = [](const auto& a, const auto& b) { return a.value < b.value; };
+			std::size_t namedCount = entries.size();
+			for (const auto& range : ranges) {
+				auto it = std::lower_bound(entries.begin(), entries.begin() + namedCount,
+					range.first, [](const auto& a, auto b) { return a.value < b; });
+				bool named = false;
+				for (; it < entries.begin() + namedCount && it->value == range.first; ++it) {
+					named = true;
+					if (it->size == 0) {
+						it->size = range.second - range.first;
+					}
+				}
+				if (!named) {
+					entries.emplace_back(SymbolEntry({ nullptr, range.first, range.second - range.first, range.second }));
+				}
 			}
+			std::inplace_merge(entries.begin(), entries.begin() + namedCount, entries.end(), compareValue);
 		}
 
 		/**
 		 * Load symbol names from executable file
 		 * 
-		 * First use bfd api from binutils to find symbol names,
+		 * First map the elf file into memory and walk .symtab and .dynsym to find symbol names,
 		 * Then use LOAD entry from elf program headers to calcualte the file offset.
-		 *
-		 * Test Code: https://gist.github.com/303248153/f792ed53a4245b46900d4ce3926888e6
 		 * Please compare the result with `nm -S $path`.
 		 */
 		void loadSymbolNames() {
 			assert(path_ != nullptr);
 			// if path is empty, don't load
-			if (path_->empty()) {
+			if (filePath_.empty()) {
 				return;
 			}
-			// if cannot open file, don't load
-			::bfd* file = ::bfd_openr(path_->c_str(), nullptr);
-			if (file == nullptr) {
+			// if cannot open file or file isn't elf file, don't load
+			LinuxElfFile file(filePath_);
+			if (!file.isOpen()) {
 				return;
 			}
-			std::unique_ptr<::bfd, int(*)(::bfd*)> filePtr(file, ::bfd_close);
-			// if file isn't object file, don't load
-			char** matching = nullptr;
-			if (!::bfd_check_format_matches(file, ::bfd_object, &matching)) {
-				return;
-			}
-			// load symbols
-			static auto load = [](::bfd* file, std::vector<asymbol*>& symbols, bool dynamic) {
-				void* miniSymbols = nullptr;
-				unsigned int miniSymbolSize = 0;
-				std::size_t miniSymbolCount = bfd_read_minisymbols(
-					file, dynamic, &miniSymbols, &miniSymbolSize);
-				std::unique_ptr<void, void(*)(void*)> miniSymbolsPtr(miniSymbols, ::free);
-				if (miniSymbolCount == 0 ||  miniSymbols == nullptr) {
-					return miniSymbolsPtr;
+			// load symbols, symbols exist in both sections are merged later
+			std::vector<SymbolEntry> entries;
+			for (const auto& section : file.getSections()) {
+				if (section.type == SHT_SYMTAB || section.type == SHT_DYNSYM) {
+					collectSymbols(file, section, entries);
 				}
-				bfd_byte* miniSymbolsFrom = reinterpret_cast<bfd_byte*>(miniSymbols);
-				bfd_byte* miniSymbolsTo = miniSymbolsFrom + miniSymbolSize * miniSymbolCount;
-				asymbol* symbolStore = bfd_make_empty_symbol(file);
-				for (; miniSymbolsFrom < miniSymbolsTo; miniSymbolsFrom += miniSymbolSize) {
-					asymbol* symbol = bfd_minisymbol_to_symbol(
-						file, dynamic, miniSymbolsFrom, symbolStore);
-					// see filter_symbols in nm.c in binutils
-					if (symbol == nullptr ||
-						(symbol->flags & (BSF_SECTION_SYM | BSF_DEBUGGING)) != 0) {
-						continue;
+			}
+			// stripped file only have .dynsym, merge it with .symtab from the separate debug file
+			bool hasSymbolTable = file.findSectionByType(SHT_SYMTAB) != nullptr;
+			LinuxElfFile debugFile;
+			std::string debugPath;
+			if (!hasSymbolTable &&
+				LinuxElfUtils::findDebugFile(file, filePath_, debugPath, debugDirectory_) &&
+				debugFile.open(debugPath)) {
+				for (const auto& section : debugFile.getSections()) {
+					if (section.type == SHT_SYMTAB) {
+						collectSymbols(debugFile, section, entries);
+						hasSymbolTable = true;
 					}
-					symbols.emplace_back(symbol);
-				}
-				return miniSymbolsPtr;
-			};
-			std::vector<asymbol*> symbols;
-			auto normalMiniSymbolsPtr = load(file, symbols, false);
-			auto dynamicMiniSymbolsPtr = load(file, symbols, true);
-			// load symbol sizes and append to symbolNames_
-			std::sort(symbols.begin(), symbols.end(), [](const auto& a, const auto& b) {
-				// sort by symbol value, then by section vma
-				// see `size_forward1` in nm.c in binutils
-				auto valueA = bfd_asymbol_value(a);
-				auto valueB = bfd_asymbol_value(b);
-				if (valueA != valueB) {
-					return valueA < valueB;
-				}
-				auto baseA = bfd_asymbol_base(a); // section->vma
-				auto baseB = bfd_asymbol_base(b);
-				return baseA < baseB;
-			});
-			static const std::string elf32("elf32");
-			static const std::string elf64("elf64");
-			const char* target = bfd_get_target(file);
-			bool isElf32 = std::strncmp(target, elf32.c_str(), elf32.size()) == 0;
-			bool isElf64 = std::strncmp(target, elf64.c_str(), elf64.size()) == 0;
-			for (auto it = symbols.begin(); it < symbols.end(); ++it) {
-				asymbol* symbol = *it;
-				asymbol* next = (it + 1 < symbols.end()) ? *(it + 1) : nullptr;
-				// get size from elf format
-				std::size_t size = 0;
-				bool sizeIsSure = false;
-				if ((symbol->flags & (BSF_SECTION_SYM | BSF_SYNTHETIC)) != 0) {
-					// don't have a full type set of data available, see nm.c for full explanation
-				} else if (isElf32) {
-					size = *reinterpret_cast<std::uint32_t*>(
-						reinterpret_cast<char*>(symbol)+sizeof(asymbol)+8);
-					sizeIsSure = true;
-				} else if (isElf64) {
-					size = *reinterpret_cast<std::uint64_t*>(
-						reinterpret_cast<char*>(symbol)+sizeof(asymbol)+8);
-					sizeIsSure = true;
 				}
-				// guess size by next symbol in same section
-				std::size_t guessSize = 0;
-				if (next != nullptr && bfd_get_section(symbol) == bfd_get_section(next)) {
-					guessSize = bfd_asymbol_value(next) - bfd_asymbol_value(symbol);
-				} else {
-					guessSize = (bfd_asymbol_base(symbol) +
-						bfd_section_size(file, bfd_get_section(symbol)) - bfd_asymbol_value(symbol));
+			}
+			// sort by symbol value, then by section, then by name
+			// see `size_forward1` in nm.c in binutils
+			std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+				if (a.value != b.value) {
+					return a.value < b.value;
 				}
-				if (!sizeIsSure) {
-					// guestSize may be 0 if two symbol have same address
-					// guestSize may less than size if file only contains the first part
-					size = guessSize;
+				if (a.sectionEnd != b.sectionEnd) {
+					return a.sectionEnd < b.sectionEnd;
 				}
-				// demangle name, these flags are defined in demangle.h in binutils
-				static const int DMGL_ANSI = (1 << 1);
-				static const int DMGL_PARAMS = (1 << 0);
-				const char* originalName = bfd_asymbol_name(symbol);
-				char* demangleName = ::bfd_demangle(file, originalName, DMGL_ANSI | DMGL_PARAMS);
-				std::unique_ptr<char, void(*)(void*)> demangleNamePtr(demangleName, ::free);
-				// convert virtual address to file offset
-				// usually there very few LOAD entries so it's not necessary to do binary search
-				auto fileOffset = bfd_asymbol_value(symbol);
-				for (const auto& loadEntry : loadEntries_) {
-					if (fileOffset >= loadEntry.virtualAddressStart &&
-						fileOffset < loadEntry.virtualAddressEnd) {
-						fileOffset = fileOffset - loadEntry.virtualAddressStart + loadEntry.fileOffset;
-						break;
+				return std::strcmp(a.name, b.name) < 0;
+			});
+			entries.erase(std::unique(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+				return a.value == b.value && a.sectionEnd == b.sectionEnd &&
+					a.size == b.size && std::strcmp(a.name, b.name) == 0;
+			}), entries.end());
+			// without .symtab, the sizes guessed from few .dynsym symbols may cover many functions
+			if (!hasSymbolTable) {
+				collectUnnamedFunctions(file, entries);
+			}
+			// append to symbolTable_, addresses are translated by the segments of the file itself
+			const auto& segments = file.getSegments();
+			symbolTable_.reserve(entries.size(), 0);
+			auto slashIndex = path_->rfind('/');
+			std::string fileName = (slashIndex == path_->npos) ? *path_ : path_->substr(slashIndex + 1);
+			std::string unnamedName;
+			std::size_t nextIndex = 0;
+			for (std::size_t index = 0; index < entries.size(); ++index) {
+				const auto& entry = entries[index];
+				std::size_t size = entry.size;
+				if (size == 0) {
+					// guess size by next symbol that has greater value in same section,
+					// or by the end of the section, it's usually a symbol defined in assembly
+					nextIndex = std::max(nextIndex, index + 1);
+					while (nextIndex < entries.size() && entries[nextIndex].value <= entry.value) {
+						++nextIndex;
+					}
+					if (nextIndex < entries.size() && entries[nextIndex].value < entry.sectionEnd) {
+						size = entries[nextIndex].value - entry.value;
+					} else if (entry.value < entry.sectionEnd) {
+						size = entry.sectionEnd - entry.value;
 					}
 				}
-				// append to symbolNames_
-				auto symbolName = std::make_shared<SymbolName>();
-				symbolName->setOriginalName(originalName);
-				if (demangleName != nullptr && symbolName->getOriginalName() != demangleName) {
-					symbolName->setDemangleName(demangleName);
+				// convert virtual address to file offset
+				auto fileOffset = entry.value;
+				LinuxElfFile::toFileOffset(segments, entry.value, fileOffset);
+				// the name will be demangled on first access, see SymbolName
+				std::uint32_t nameOffset = 0;
+				if (entry.name != nullptr) {
+					nameOffset = symbolTable_.appendName(entry.name, std::strlen(entry.name));
 				} else {
-					symbolName->setDemangleName("");
+					char offsetName[32];
+					std::snprintf(offsetName, sizeof(offsetName), "sub_%zx@", fileOffset);
+					unnamedName.assign(offsetName).append(fileName);
+					nameOffset = symbolTable_.appendName(unnamedName.c_str(), unnamedName.size());
 				}
-				symbolName->setPath(path_);
-				symbolName->setFileOffsetStart(fileOffset);
-				symbolName->setFileOffsetEnd(fileOffset + size);
-				symbolNames_.emplace_back(std::move(symbolName));
-			}
-			// sort symbolNames_ by file offset
-			// it's already sorted by virtual address
-			std::sort(symbolNames_.begin(), symbolNames_.end(), [](auto& a, auto& b) {
-				if (a->getFileOffsetEnd() != b->getFileOffsetEnd()) {
-					return a->getFileOffsetEnd() < b->getFileOffsetEnd();
+				if (nameOffset == LinuxSymbolTable::InvalidHandle) {
+					break; // string pool is full
 				}
-				return a->getFileOffsetStart() < b->getFileOffsetStart();
-			});
+				symbolTable_.append(fileOffset, fileOffset + size, nameOffset);
+			}
+			// sort by file offset, it's already sorted by virtual address
+			symbolTable_.sort();
 		}
 
-		/** Represent LOAD entry in elf program headers */
-		struct LoadEntry {
-			std::size_t fileOffset;
-			std::size_t virtualAddressStart;
-			std::size_t virtualAddressEnd;
-		};
-
 	protected:
 		std::shared_ptr<std::string> path_;
-		std::vector<LoadEntry> loadEntries_;
-		std::vector<std::shared_ptr<SymbolName>> symbolNames_;
+		std::string filePath_;
+		std::string debugDirectory_;
+		LinuxSymbolTable symbolTable_;
+		std::unique_ptr<LinuxDwarfLineIndex> lineIndex_;
+		std::vector<LinuxElfFile::Segment> loadSegments_;
 	};
 }
 
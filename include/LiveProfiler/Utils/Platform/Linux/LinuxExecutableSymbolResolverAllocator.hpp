@@ -0,0 +1,269 @@
+#pragma once
+#include <sys/stat.h>
+#include <cassert>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include "LinuxElfFile.hpp"
+#include "LinuxElfUtils.hpp"
+#include "LinuxExecutableSymbolResolver.hpp"
+#include "LinuxProcessAddressMap.hpp"
+#include "LinuxProcessUtils.hpp"
+#include "LinuxSymbolTableCache.hpp"
+
+namespace LiveProfiler {
+	/**
+	 * Class used to share LinuxExecutableSymbolResolver between all processes mapping the same file.
+	 * Files are identified by (device, inode) first, then by build-id,
+	 * so the same file seen from different paths, and copies of the same binary
+	 * (e.g. the same library in different container images) are loaded only once.
+	 * Files without inode (e.g. [vdso]) are identified by path,
+	 * paths should be allocated from the same SingletonAllocator, they are compared by address.
+	 * Files mapped by processes in other mount namespaces (e.g. containers) are opened via /proc/$pid,
+	 * so one agent can symbolize many containers and each distinct file is loaded only once.
+	 * Use `preload` to load the files mapped by a set of processes on multiple threads before profiling.
+	 * This class is not thread safe, `preload` only uses threads internally.
+	 */
+	class LinuxExecutableSymbolResolverAllocator {
+	public:
+		/** Get how many resolvers are loaded */
+		std::size_t getResolverCount() const { return resolverCount_; }
+
+		/** Set the on disk cache used by resolvers loaded after the call */
+		void setSymbolTableCache(const std::shared_ptr<LinuxSymbolTableCache>& cache) {
+			cache_ = cache;
+		}
+
+		/**
+		 * Get the resolver for the file mapped from `path` with (device, inode),
+		 * load it if the file is never seen, inode 0 means the identity is unknown.
+		 * The device should be encoded by makedev, as the same as `stat::st_dev`.
+		 */
+		std::shared_ptr<LinuxExecutableSymbolResolver> allocate(
+			const std::shared_ptr<std::string>& path, std::uint64_t device, std::uint64_t inode) {
+			assert(path != nullptr);
+			auto resolver = find(path, device, inode);
+			if (resolver != nullptr) {
+				return resolver;
+			}
+			return load(path, device, inode, *path);
+		}
+
+		/**
+		 * Get the resolver for the file mapped by the process,
+		 * the file is opened from the mount namespace of the process, see `LinuxProcessUtils::findMappedFilePath`.
+		 */
+		std::shared_ptr<LinuxExecutableSymbolResolver> allocate(pid_t pid, const LinuxProcessAddressMap& map) {
+			const auto& path = map.getPath();
+			assert(path != nullptr);
+			auto resolver = find(path, map.getDevice(), map.getInode());
+			if (resolver != nullptr) {
+				return resolver;
+			}
+			if (map.getInode() == 0) {
+				// not a regular file, the path isn't used to open file anyway
+				return load(path, 0, 0, *path);
+			}
+			LinuxProcessUtils::findMappedFilePath(pid, *path,
+				map.getStartAddress(), map.getEndAddress(), map.getDevice(), map.getInode(), filePath_);
+			return load(path, map.getDevice(), map.getInode(), filePath_);
+		}
+
+		/** Get the resolver for the file at `path`, the identity is read by stat */
+		std::shared_ptr<LinuxExecutableSymbolResolver> allocate(const std::shared_ptr<std::string>& path) {
+			assert(path != nullptr);
+			struct ::stat st;
+			if (!path->empty() && ::stat(path->c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+				return allocate(path, static_cast<std::uint64_t>(st.st_dev), static_cast<std::uint64_t>(st.st_ino));
+			}
+			return allocate(path, 0, 0);
+		}
+
+		/**
+		 * Load the resolvers for files mapped by processes in parallel, `maps` is a list of (pid, mapping).
+		 * Distinct files are found first, by (device, inode) then by build-id,
+		 * then they are loaded by `workerCount` threads (the calling thread included),
+		 * larger files are loaded first, so the biggest binary starts early instead of being the tail.
+		 * Mappings without inode, non elf files and files already loaded are skipped,
+		 * the resolver is attached to each mapping whose file is loaded.
+		 * Return how many resolvers are loaded.
+		 */
+		std::size_t preload(
+			const std::vector<std::pair<pid_t, LinuxProcessAddressMap*>>& maps,
+			std::size_t workerCount) {
+			// find distinct files, it only reads the headers so it's done serially
+			std::vector<PreloadJob> jobs;
+			std::unordered_set<std::pair<std::uint64_t, std::uint64_t>, FileIdHash> seenFileIds;
+			std::unordered_map<std::string, std::size_t> buildIdToJob;
+			for (const auto& pair : maps) {
+				assert(pair.second != nullptr);
+				const auto& map = *pair.second;
+				const auto& path = map.getPath();
+				auto fileId = std::make_pair(map.getDevice(), map.getInode());
+				if (path == nullptr || map.getInode() == 0 ||
+					fileIdToResolver_.find(fileId) != fileIdToResolver_.end() ||
+					!seenFileIds.emplace(fileId).second ||
+					!LinuxProcessUtils::findMappedFilePath(pair.first, *path,
+						map.getStartAddress(), map.getEndAddress(), map.getDevice(), map.getInode(), filePath_)) {
+					continue;
+				}
+				LinuxElfFile file(filePath_);
+				if (!file.isOpen()) {
+					continue;
+				}
+				// copies of the same binary are loaded once
+				buildId_.clear();
+				if (LinuxElfUtils::readBuildId(file, buildId_)) {
+					auto loadedIt = buildIdToResolver_.find(buildId_);
+					if (loadedIt != buildIdToResolver_.end()) {
+						fileIdToResolver_.emplace(fileId, loadedIt->second);
+						continue;
+					}
+					auto jobIt = buildIdToJob.find(buildId_);
+					if (jobIt != buildIdToJob.end()) {
+						jobs[jobIt->second].fileIds.emplace_back(fileId);
+						continue;
+					}
+					buildIdToJob.emplace(buildId_, jobs.size());
+				}
+				jobs.emplace_back(PreloadJob({ path, filePath_, buildId_, file.size(), { fileId }, nullptr }));
+			}
+			// load files in parallel, each job only touches it's own resolver and the thread safe cache
+			std::sort(jobs.begin(), jobs.end(), [](const auto& a, const auto& b) {
+				return a.fileSize > b.fileSize;
+			});
+			const auto& debugDirectory = LinuxElfUtils::getDefaultDebugDirectory();
+			std::atomic<std::size_t> nextJob(0);
+			auto work = [this, &jobs, &nextJob, &debugDirectory] {
+				std::size_t index = 0;
+				while ((index = nextJob.fetch_add(1)) < jobs.size()) {
+					auto& job = jobs[index];
+					job.resolver = std::make_shared<LinuxExecutableSymbolResolver>(
+						job.path, cache_, debugDirectory, job.filePath);
+				}
+			};
+			std::vector<std::thread> threads;
+			std::size_t threadCount = std::min(std::max<std::size_t>(workerCount, 1), jobs.size());
+			for (std::size_t i = 1; i < threadCount; ++i) {
+				threads.emplace_back(work);
+			}
+			work();
+			for (auto& thread : threads) {
+				thread.join();
+			}
+			// register the loaded resolvers
+			for (const auto& job : jobs) {
+				++resolverCount_;
+				if (!job.buildId.empty()) {
+					buildIdToResolver_.emplace(job.buildId, job.resolver);
+				}
+				for (const auto& fileId : job.fileIds) {
+					fileIdToResolver_.emplace(fileId, job.resolver);
+				}
+			}
+			for (const auto& pair : maps) {
+				auto& map = *pair.second;
+				if (map.getInode() != 0 && map.getResolver() == nullptr) {
+					auto it = fileIdToResolver_.find(std::make_pair(map.getDevice(), map.getInode()));
+					if (it != fileIdToResolver_.end()) {
+						map.setResolver(it->second);
+					}
+				}
+			}
+			return jobs.size();
+		}
+
+		/** Constructor */
+		explicit LinuxExecutableSymbolResolverAllocator(
+			const std::shared_ptr<LinuxSymbolTableCache>& cache = nullptr) :
+			cache_(cache),
+			fileIdToResolver_(),
+			buildIdToResolver_(),
+			pathToResolver_(),
+			resolverCount_(0),
+			buildId_(),
+			filePath_() { }
+
+	protected:
+		/** Disable copy */
+		LinuxExecutableSymbolResolverAllocator(const LinuxExecutableSymbolResolverAllocator&) = delete;
+		LinuxExecutableSymbolResolverAllocator& operator=(const LinuxExecutableSymbolResolverAllocator&) = delete;
+
+		/** Hash function for (device, inode) */
+		struct FileIdHash {
+			std::size_t operator()(const std::pair<std::uint64_t, std::uint64_t>& fileId) const {
+				return std::hash<std::uint64_t>()(fileId.first * 0x9e3779b97f4a7c15ULL ^ fileId.second);
+			}
+		};
+
+		/** File to load in `preload`, shared by all identities with the same build-id */
+		struct PreloadJob {
+			std::shared_ptr<std::string> path;
+			std::string filePath;
+			std::string buildId;
+			std::size_t fileSize;
+			std::vector<std::pair<std::uint64_t, std::uint64_t>> fileIds;
+			std::shared_ptr<LinuxExecutableSymbolResolver> resolver;
+		};
+
+		/** Find the resolver of loaded file, return nullptr if not found */
+		std::shared_ptr<LinuxExecutableSymbolResolver> find(
+			const std::shared_ptr<std::string>& path, std::uint64_t device, std::uint64_t inode) const {
+			if (inode != 0) {
+				auto it = fileIdToResolver_.find(std::make_pair(device, inode));
+				return (it == fileIdToResolver_.end()) ? nullptr : it->second;
+			}
+			auto it = pathToResolver_.find(path);
+			return (it == pathToResolver_.end()) ? nullptr : it->second;
+		}
+
+		/** Load the resolver for new identity from `filePath`, it may be a copy of loaded file */
+		std::shared_ptr<LinuxExecutableSymbolResolver> load(
+			const std::shared_ptr<std::string>& path,
+			std::uint64_t device,
+			std::uint64_t inode,
+			const std::string& filePath) {
+			std::shared_ptr<LinuxExecutableSymbolResolver> resolver;
+			buildId_.clear();
+			if (!filePath.empty() && LinuxElfUtils::readBuildId(filePath, buildId_)) {
+				auto it = buildIdToResolver_.find(buildId_);
+				if (it != buildIdToResolver_.end()) {
+					resolver = it->second;
+				}
+			}
+			if (resolver == nullptr) {
+				resolver = std::make_shared<LinuxExecutableSymbolResolver>(
+					path, cache_, LinuxElfUtils::getDefaultDebugDirectory(), filePath);
+				++resolverCount_;
+				if (!buildId_.empty()) {
+					buildIdToResolver_.emplace(buildId_, resolver);
+				}
+			}
+			if (inode != 0) {
+				fileIdToResolver_.emplace(std::make_pair(device, inode), resolver);
+			} else {
+				pathToResolver_.emplace(path, resolver);
+			}
+			return resolver;
+		}
+
+	protected:
+		std::shared_ptr<LinuxSymbolTableCache> cache_;
+		std::unordered_map<std::pair<std::uint64_t, std::uint64_t>,
+			std::shared_ptr<LinuxExecutableSymbolResolver>, FileIdHash> fileIdToResolver_;
+		std::unordered_map<std::string, std::shared_ptr<LinuxExecutableSymbolResolver>> buildIdToResolver_;
+		std::unordered_map<std::shared_ptr<std::string>,
+			std::shared_ptr<LinuxExecutableSymbolResolver>> pathToResolver_;
+		std::size_t resolverCount_;
+		std::string buildId_;
+		std::string filePath_;
+	};
+}
+
@@ -0,0 +1,135 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <unordered_map>
+#include "LinuxExecutableSymbolResolver.hpp"
+#include "LinuxSymbolTableCache.hpp"
+
+namespace LiveProfiler {
+	/**
+	 * Class used to load LinuxExecutableSymbolResolver on background threads.
+	 * Loading symbols from big executable files may take seconds,
+	 * use this class to avoid blocking the thread that resolving symbol names.
+	 * Paths should be allocated from the same SingletonAllocator, they are compared by address.
+	 * This class is thread safe.
+	 */
+	class LinuxExecutableSymbolResolverLoader {
+	public:
+		/** Default parameters */
+		static const std::size_t DefaultWorkerCount = 2;
+
+		/**
+		 * Get the resolver if it's loaded, otherwise schedule the loading and return nullptr.
+		 * The loaded path will be reported by `takeLoadedPaths` once.
+		 */
+		std::shared_ptr<LinuxExecutableSymbolResolver> tryGet(const std::shared_ptr<std::string>& path) {
+			std::lock_guard<std::mutex> guard(mutex_);
+			auto it = resolvers_.find(path);
+			if (it != resolvers_.end()) {
+				return it->second; // nullptr if still loading
+			}
+			resolvers_.emplace(path, nullptr);
+			queue_.emplace_back(path);
+			++loadingCount_;
+			queueCondition_.notify_one();
+			return nullptr;
+		}
+
+		/** Move the paths loaded since last call to `paths`, the previous content will be cleared */
+		void takeLoadedPaths(std::vector<std::shared_ptr<std::string>>& paths) {
+			paths.clear();
+			std::lock_guard<std::mutex> guard(mutex_);
+			paths.swap(loadedPaths_);
+		}
+
+		/** Get how many paths are scheduled but not loaded yet */
+		std::size_t getLoadingCount() const {
+			std::lock_guard<std::mutex> guard(mutex_);
+			return loadingCount_;
+		}
+
+		/** Block until all scheduled loading are finished */
+		void waitAll() {
+			std::unique_lock<std::mutex> lock(mutex_);
+			idleCondition_.wait(lock, [this] { return loadingCount_ == 0; });
+		}
+
+		/** Constructor */
+		explicit LinuxExecutableSymbolResolverLoader(
+			std::size_t workerCount = DefaultWorkerCount,
+			const std::shared_ptr<LinuxSymbolTableCache>& cache = nullptr) :
+			cache_(cache),
+			mutex_(),
+			queueCondition_(),
+			idleCondition_(),
+			queue_(),
+			resolvers_(),
+			loadedPaths_(),
+			loadingCount_(0),
+			stopping_(false),
+			workers_() {
+			for (std::size_t i = 0; i < std::max<std::size_t>(workerCount, 1); ++i) {
+				workers_.emplace_back([this] { run(); });
+			}
+		}
+
+		/** Destructor, stop all workers, paths not loaded yet are dropped */
+		~LinuxExecutableSymbolResolverLoader() {
+			{
+				std::lock_guard<std::mutex> guard(mutex_);
+				stopping_ = true;
+			}
+			queueCondition_.notify_all();
+			for (auto& worker : workers_) {
+				worker.join();
+			}
+		}
+
+	protected:
+		/** Disable copy */
+		LinuxExecutableSymbolResolverLoader(const LinuxExecutableSymbolResolverLoader&) = delete;
+		LinuxExecutableSymbolResolverLoader& operator=(const LinuxExecutableSymbolResolverLoader&) = delete;
+
+		/** Worker thread function */
+		void run() {
+			std::unique_lock<std::mutex> lock(mutex_);
+			while (true) {
+				queueCondition_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+				if (stopping_) {
+					break;
+				}
+				auto path = std::move(queue_.front());
+				queue_.pop_front();
+				lock.unlock();
+				// parse outside of the lock
+				auto resolver = std::make_shared<LinuxExecutableSymbolResolver>(path, cache_);
+				lock.lock();
+				resolvers_[path] = std::move(resolver);
+				loadedPaths_.emplace_back(std::move(path));
+				if (--loadingCount_ == 0) {
+					idleCondition_.notify_all();
+				}
+			}
+		}
+
+	protected:
+		std::shared_ptr<LinuxSymbolTableCache> cache_;
+		mutable std::mutex mutex_;
+		std::condition_variable queueCondition_;
+		std::condition_variable idleCondition_;
+		std::deque<std::shared_ptr<std::string>> queue_;
+		std::unordered_map<std::shared_ptr<std::string>,
+			std::shared_ptr<LinuxExecutableSymbolResolver>> resolvers_;
+		std::vector<std::shared_ptr<std::string>> loadedPaths_;
+		std::size_t loadingCount_;
+		bool stopping_;
+		std::vector<std::thread> workers_;
+	};
+}
+
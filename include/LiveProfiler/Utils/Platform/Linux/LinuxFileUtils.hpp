@@ -0,0 +1,49 @@
+#pragma once
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <string>
+#include <algorithm>
+
+namespace LiveProfiler {
+	/** Static utility functions releated to linux files */
+	struct LinuxFileUtils {
+		/** Default parameters */
+		static const std::size_t DefaultReadChunkSize = 65536;
+
+		/**
+		 * Read the whole file into the buffer with few `read` calls, the capacity of buffer is reused.
+		 * It works for files under /proc which report 0 as their size.
+		 * Return whether successful.
+		 */
+		static bool readFile(const char* path, std::string& buffer) {
+			buffer.clear();
+			int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+			if (fd < 0) {
+				return false;
+			}
+			std::size_t size = 0;
+			buffer.resize(std::max<std::size_t>(buffer.capacity(), +DefaultReadChunkSize));
+			while (true) {
+				if (size == buffer.size()) {
+					buffer.resize(buffer.size() * 2);
+				}
+				auto ret = ::read(fd, &buffer[size], buffer.size() - size);
+				if (ret < 0 && errno == EINTR) {
+					continue;
+				} else if (ret < 0) {
+					::close(fd);
+					buffer.clear();
+					return false;
+				} else if (ret == 0) {
+					break;
+				}
+				size += static_cast<std::size_t>(ret);
+			}
+			::close(fd);
+			buffer.resize(size);
+			return true;
+		}
+	};
+}
+
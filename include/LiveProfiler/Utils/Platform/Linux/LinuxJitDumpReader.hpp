@@ -0,0 +1,396 @@
+#pragma once
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <deque>
+#include <map>
+#include <memory>
+#include <iterator>
+#include <algorithm>
+#include "../../../Models/Shared/SymbolName.hpp"
+#include "../../Allocators/SingletonAllocator.hpp"
+
+namespace LiveProfiler {
+	/**
+	 * Class used to read symbol names of jit compiled code from jitdump file (jit-$pid.dump).
+	 * The format is defined in tools/perf/Documentation/jitdump-specification.txt in linux source,
+	 * it's written by v8 (--perf-prof), .net (DOTNET_PerfMapEnabled) and perf's jvmti agent.
+	 *
+	 * The file is mapped into memory and records are applied incrementally, only new records are parsed on update.
+	 * Unlike /tmp/perf-$pid.map, each code range has a lifetime:
+	 * it starts from the timestamp of JIT_CODE_LOAD, and ends when the code is moved by JIT_CODE_MOVE,
+	 * or the range is reused by newer code (there no unload record in the format, reusing implies unloading).
+	 * Ended code ranges are kept (at most `DefaultMaxRetiredEntries`),
+	 * so samples taken before the address is reused still resolve to the old code.
+	 * Timestamps should be CLOCK_MONOTONIC in nanoseconds, same as CpuSampleModel::getTimestamp,
+	 * if the file uses arch specific timestamps (e.g. TSC), only the latest code is resolved.
+	 * This class is not thread safe.
+	 */
+	class LinuxJitDumpReader {
+	public:
+		/** Default parameters */
+		static const std::size_t DefaultMaxRetiredEntries = 65536;
+		static const std::uint32_t Magic = 0x4a695444; // "JiTD"
+		static const std::uint32_t Version = 1;
+
+		/** Record types */
+		enum class RecordType : std::uint32_t {
+			CodeLoad = 0,
+			CodeMove = 1,
+			CodeDebugInfo = 2,
+			CodeClose = 3,
+			CodeUnwindingInfo = 4
+		};
+
+		/** Getters */
+		const std::string& getPath() const& { return path_; }
+		bool isOpen() const { return fd_ >= 0; }
+		bool isClosed() const { return closed_; }
+		std::size_t getLiveCount() const { return live_.size(); }
+		std::size_t getRetiredCount() const { return retired_.size(); }
+		/** Increased when any code is moved or replaced, names resolved before may be changed */
+		std::size_t getGeneration() const { return generation_; }
+
+		/** For FreeListAllocator */
+		void freeResources() {
+			close();
+		}
+
+		/** For FreeListAllocator */
+		void reset(
+			const std::string& path,
+			const std::shared_ptr<std::string>& symbolNamePath,
+			const std::shared_ptr<SingletonAllocator<std::string, SymbolName>>& symbolNameAllocator) {
+			close();
+			path_ = path;
+			symbolNamePath_ = symbolNamePath;
+			symbolNameAllocator_ = symbolNameAllocator;
+		}
+
+		/**
+		 * Map new contents of the file and apply new records.
+		 * Incomplete record at the end is applied in the next update since the writer may not finish it.
+		 * Return whether any record is applied.
+		 */
+		bool update() {
+			if (closed_ || !mapFile()) {
+				return false;
+			}
+			if (readOffset_ == 0 && !readHeader()) {
+				return false;
+			}
+			std::size_t appliedCount = 0;
+			while (readOffset_ + sizeof(RecordHeader) <= mappedSize_) {
+				auto header = readAt<RecordHeader>(readOffset_);
+				if (header.totalSize < sizeof(RecordHeader)) {
+					closed_ = true; // corrupted file
+					break;
+				} else if (header.totalSize > mappedSize_ - readOffset_) {
+					break; // incomplete
+				}
+				auto recordType = static_cast<RecordType>(header.id);
+				if (recordType == RecordType::CodeLoad) {
+					applyCodeLoad(header);
+				} else if (recordType == RecordType::CodeMove) {
+					applyCodeMove(header);
+				} else if (recordType == RecordType::CodeClose) {
+					closed_ = true;
+				}
+				readOffset_ += header.totalSize;
+				++appliedCount;
+				if (closed_) {
+					break;
+				}
+			}
+			return appliedCount > 0;
+		}
+
+		/**
+		 * Resolve symbol name from address and the timestamp of the sample.
+		 * If timestamp is 0, resolve from the latest code.
+		 * Return nullptr if not found.
+		 */
+		std::shared_ptr<SymbolName> resolve(std::uint64_t address, std::uint64_t timestamp) const {
+			// find from the latest code first, it's the most common case
+			auto it = live_.upper_bound(address);
+			if (it != live_.begin()) {
+				--it;
+				const auto& entry = it->second;
+				if (address < entry.endAddress &&
+					(timestamp == 0 || archTimestamp_ || timestamp >= entry.loadTime)) {
+					return entry.symbolName;
+				}
+			}
+			if (timestamp == 0 || archTimestamp_ || retired_.empty()) {
+				return nullptr;
+			}
+			// find from ended code, code ranges are small so walk back by the max size
+			auto retiredIt = retired_.upper_bound(address);
+			while (retiredIt != retired_.begin()) {
+				--retiredIt;
+				const auto& entry = retiredIt->second;
+				if (address - entry.startAddress >= maxRetiredSize_) {
+					break;
+				}
+				if (address < entry.endAddress &&
+					timestamp >= entry.loadTime && timestamp < entry.unloadTime) {
+					return entry.symbolName;
+				}
+			}
+			return nullptr;
+		}
+
+		/** Constructor */
+		LinuxJitDumpReader() :
+			path_(),
+			symbolNamePath_(),
+			symbolNameAllocator_(),
+			fd_(-1),
+			data_(nullptr),
+			mappedSize_(0),
+			readOffset_(0),
+			closed_(false),
+			archTimestamp_(false),
+			live_(),
+			retired_(),
+			retiredOrder_(),
+			maxRetiredSize_(0),
+			maxRetiredEntries_(DefaultMaxRetiredEntries),
+			generation_(0),
+			name_() { }
+
+		/** Destructor */
+		~LinuxJitDumpReader() {
+			close();
+		}
+
+	protected:
+		/** Disable copy */
+		LinuxJitDumpReader(const LinuxJitDumpReader&) = delete;
+		LinuxJitDumpReader& operator=(const LinuxJitDumpReader&) = delete;
+
+		/** File header */
+		struct FileHeader {
+			std::uint32_t magic;
+			std::uint32_t version;
+			std::uint32_t totalSize;
+			std::uint32_t elfMach;
+			std::uint32_t pad1;
+			std::uint32_t pid;
+			std::uint64_t timestamp;
+			std::uint64_t flags;
+		};
+
+		/** Header of each record */
+		struct RecordHeader {
+			std::uint32_t id;
+			std::uint32_t totalSize;
+			std::uint64_t timestamp;
+		};
+
+		/** JIT_CODE_LOAD record, the null terminated function name and the native code are followed by it */
+		struct CodeLoadRecord {
+			RecordHeader header;
+			std::uint32_t pid;
+			std::uint32_t tid;
+			std::uint64_t vma;
+			std::uint64_t codeAddress;
+			std::uint64_t codeSize;
+			std::uint64_t codeIndex;
+		};
+
+		/** JIT_CODE_MOVE record */
+		struct CodeMoveRecord {
+			RecordHeader header;
+			std::uint32_t pid;
+			std::uint32_t tid;
+			std::uint64_t vma;
+			std::uint64_t oldCodeAddress;
+			std::uint64_t newCodeAddress;
+			std::uint64_t codeSize;
+			std::uint64_t codeIndex;
+		};
+
+		/** Code range with lifetime [loadTime, unloadTime) */
+		struct Entry {
+			std::uint64_t startAddress;
+			std::uint64_t endAddress;
+			std::uint64_t loadTime;
+			std::uint64_t unloadTime;
+			std::shared_ptr<SymbolName> symbolName;
+		};
+
+		/** The header flag indicates timestamps are arch specific (e.g. TSC) */
+		static const std::uint64_t ArchTimestampFlag = 1;
+
+		/** Read the structure at offset, the mapped memory may not aligned for it */
+		template <class T>
+		T readAt(std::size_t offset) const {
+			T value;
+			std::memcpy(&value, data_ + offset, sizeof(value));
+			return value;
+		}
+
+		/** Open the file and map it into memory, remap if the file grows, return whether any content is mapped */
+		bool mapFile() {
+			if (fd_ < 0) {
+				fd_ = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+				if (fd_ < 0) {
+					return false;
+				}
+			}
+			struct ::stat st;
+			if (::fstat(fd_, &st) != 0) {
+				return false;
+			}
+			auto size = static_cast<std::size_t>(st.st_size);
+			if (size > mappedSize_) {
+				void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd_, 0);
+				if (mapped == MAP_FAILED) {
+					return false;
+				}
+				if (data_ != nullptr) {
+					::munmap(const_cast<char*>(data_), mappedSize_);
+				}
+				data_ = static_cast<const char*>(mapped);
+				mappedSize_ = size;
+			}
+			return data_ != nullptr;
+		}
+
+		/** Check the file header and move to the first record */
+		bool readHeader() {
+			if (mappedSize_ < sizeof(FileHeader)) {
+				return false; // the writer may not finish the header
+			}
+			auto header = readAt<FileHeader>(0);
+			if (header.magic != Magic || header.version != Version ||
+				header.totalSize < sizeof(FileHeader) || header.totalSize > mappedSize_) {
+				// byte swapped file is written on other architecture, it can't be used for current process
+				closed_ = header.magic != Magic || header.version != Version;
+				return false;
+			}
+			archTimestamp_ = (header.flags & ArchTimestampFlag) != 0;
+			readOffset_ = header.totalSize;
+			return true;
+		}
+
+		/** Apply JIT_CODE_LOAD record */
+		void applyCodeLoad(const RecordHeader& header) {
+			if (header.totalSize <= sizeof(CodeLoadRecord)) {
+				return;
+			}
+			auto record = readAt<CodeLoadRecord>(readOffset_);
+			const char* name = data_ + readOffset_ + sizeof(CodeLoadRecord);
+			auto nameSize = ::strnlen(name, header.totalSize - sizeof(CodeLoadRecord));
+			if (record.codeSize == 0 || nameSize == 0) {
+				return;
+			}
+			name_.assign(name, nameSize);
+			auto symbolName = symbolNameAllocator_->allocate(name_, symbolNamePath_);
+			insertLive(record.codeAddress, record.codeAddress + record.codeSize,
+				header.timestamp, std::move(symbolName));
+		}
+
+		/** Apply JIT_CODE_MOVE record */
+		void applyCodeMove(const RecordHeader& header) {
+			if (header.totalSize < sizeof(CodeMoveRecord)) {
+				return;
+			}
+			auto record = readAt<CodeMoveRecord>(readOffset_);
+			auto it = live_.find(record.oldCodeAddress);
+			if (it == live_.end() || record.codeSize == 0) {
+				return; // the code is unknown
+			}
+			auto symbolName = it->second.symbolName;
+			retire(it, header.timestamp);
+			insertLive(record.newCodeAddress, record.newCodeAddress + record.codeSize,
+				header.timestamp, std::move(symbolName));
+		}
+
+		/** Add code range to live entries, overlapped live entries are ended at the timestamp */
+		void insertLive(
+			std::uint64_t startAddress,
+			std::uint64_t endAddress,
+			std::uint64_t timestamp,
+			std::shared_ptr<SymbolName>&& symbolName) {
+			auto it = live_.lower_bound(startAddress);
+			if (it != live_.begin()) {
+				auto previousIt = std::prev(it);
+				if (previousIt->second.endAddress > startAddress) {
+					it = previousIt;
+				}
+			}
+			while (it != live_.end() && it->second.startAddress < endAddress) {
+				it = retire(it, timestamp);
+			}
+			live_.emplace_hint(it, startAddress, Entry({
+				startAddress, endAddress, timestamp, std::numeric_limits<std::uint64_t>::max(), std::move(symbolName) }));
+		}
+
+		/** Move live entry to retired entries, return the next live entry */
+		std::map<std::uint64_t, Entry>::iterator retire(
+			std::map<std::uint64_t, Entry>::iterator it, std::uint64_t timestamp) {
+			auto& entry = it->second;
+			entry.unloadTime = timestamp;
+			++generation_;
+			if (entry.loadTime < entry.unloadTime && maxRetiredEntries_ > 0) {
+				// drop the oldest one if there too many
+				if (retiredOrder_.size() >= maxRetiredEntries_) {
+					retired_.erase(retiredOrder_.front());
+					retiredOrder_.pop_front();
+				}
+				maxRetiredSize_ = std::max(maxRetiredSize_, entry.endAddress - entry.startAddress);
+				retiredOrder_.emplace_back(retired_.emplace(entry.startAddress, std::move(entry)));
+			}
+			return live_.erase(it);
+		}
+
+		/** Unmap and close the file, and clear all records */
+		void close() {
+			if (data_ != nullptr) {
+				::munmap(const_cast<char*>(data_), mappedSize_);
+			}
+			if (fd_ >= 0) {
+				::close(fd_);
+			}
+			fd_ = -1;
+			data_ = nullptr;
+			mappedSize_ = 0;
+			readOffset_ = 0;
+			closed_ = false;
+			archTimestamp_ = false;
+			live_.clear();
+			retired_.clear();
+			retiredOrder_.clear();
+			maxRetiredSize_ = 0;
+			generation_ = 0;
+		}
+
+	protected:
+		std::string path_;
+		std::shared_ptr<std::string> symbolNamePath_;
+		std::shared_ptr<SingletonAllocator<std::string, SymbolName>> symbolNameAllocator_;
+		int fd_;
+		const char* data_;
+		std::size_t mappedSize_;
+		std::size_t readOffset_;
+		bool closed_;
+		bool archTimestamp_;
+		// code in use, sorted by start address and not overlapped
+		std::map<std::uint64_t, Entry> live_;
+		// ended code, may overlapped
+		std::multimap<std::uint64_t, Entry> retired_;
+		std::deque<std::multimap<std::uint64_t, Entry>::iterator> retiredOrder_;
+		std::uint64_t maxRetiredSize_;
+		std::size_t maxRetiredEntries_;
+		std::size_t generation_;
+		std::string name_;
+	};
+}
+
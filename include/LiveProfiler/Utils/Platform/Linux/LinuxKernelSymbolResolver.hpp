@@ -1,115 +1,290 @@
 #pragma once
-#include <fstream>
+#include <cstring>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <memory>
 #include <algorithm>
-#include <limits>
+#include <unordered_map>
 #include "../../../Models/Shared/SymbolName.hpp"
-#include "../../StringUtils.hpp"
+#include "LinuxSymbolTable.hpp"
+#include "LinuxFileUtils.hpp"
 #include "../../TypeConvertUtils.hpp"
 
 namespace LiveProfiler {
 	/**
 	 * Class used to resolve symbol name from kernel.
 	 * Kernel symbol names are read from /proc/kallsyms.
+	 * Symbols are stored in compact LinuxSymbolTables, SymbolName is created only for resolved symbols.
+	 *
+	 * Symbols are loaded on the first resolve, so it costs nothing if kernel is excluded.
+	 * Symbols of the kernel image use the path "[kallsyms]",
+	 * symbols of each kernel module use their own table with the path "[module name]".
+	 * Module tables are reloaded when /proc/modules changed, tables of unchanged modules are kept.
+	 * It's thread safe, use `getShared` to share the symbols between interceptors.
 	 */
 	class LinuxKernelSymbolResolver {
 	public:
+		/** Default parameters */
+		static const std::size_t DefaultModulesCheckInterval = 1000;
+
+		/** Get the process wide instance reads from /proc, symbols are not loaded until the first resolve */
+		static const std::shared_ptr<LinuxKernelSymbolResolver>& getShared() {
+			static const std::shared_ptr<LinuxKernelSymbolResolver> instance(
+				std::make_shared<LinuxKernelSymbolResolver>());
+			return instance;
+		}
+
 		/** Getters */
-		std::uintptr_t getMinAddress() const { return minAddress_; }
-		std::uintptr_t getMaxAddress() const { return maxAddress_; }
+		bool isLoaded() const {
+			std::lock_guard<std::mutex> guard(mutex_);
+			return loaded_;
+		}
+		std::size_t getModuleCount() const {
+			std::lock_guard<std::mutex> guard(mutex_);
+			return modules_.size();
+		}
+		std::size_t getSymbolCount() const {
+			std::lock_guard<std::mutex> guard(mutex_);
+			std::size_t count = symbolTable_.size();
+			for (const auto& module : modules_) {
+				count += module.symbolTable->size();
+			}
+			return count;
+		}
+
+		/** Set the minimum interval of checking whether /proc/modules is changed */
+		void setModulesCheckInterval(std::chrono::high_resolution_clock::duration interval) {
+			std::lock_guard<std::mutex> guard(mutex_);
+			modulesCheckInterval_ = interval;
+		}
 
 		/** Resolve kernel symbol name from address, return nullptr if not found */
 		std::shared_ptr<SymbolName> resolve(std::size_t address) {
-			// fast check
-			if (address < minAddress_ || address >= maxAddress_) {
-				return nullptr;
-			}
-			// find first symbol that fileOffsetEnd > address
-			auto it = std::upper_bound(
-				symbolNames_.cbegin(), symbolNames_.cend(), address,
-				[](const auto& a, const auto& b) {
-					return a < b->getFileOffsetEnd();
-				});
-			if (it == symbolNames_.cend()) {
-				return nullptr;
+			std::lock_guard<std::mutex> guard(mutex_);
+			if (!loaded_) {
+				loaded_ = true;
+				LinuxFileUtils::readFile(modulesPath_.c_str(), modulesContent_);
+				load(true);
+				modulesChecked_ = std::chrono::high_resolution_clock::now();
 			}
-			// check is address >= fileOffsetStart and address < fileOffsetEnd
-			const auto& symbolName = *it;
-			if (address >= symbolName->getFileOffsetStart()) {
-				return symbolName;
+			auto symbolName = find(address);
+			if (symbolName == nullptr) {
+				// the address may belongs to a newly loaded module
+				auto now = std::chrono::high_resolution_clock::now();
+				if (now - modulesChecked_ >= modulesCheckInterval_) {
+					modulesChecked_ = now;
+					if (LinuxFileUtils::readFile(modulesPath_.c_str(), buffer_) && buffer_ != modulesContent_) {
+						modulesContent_.swap(buffer_);
+						load(false);
+						symbolName = find(address);
+					}
+				}
 			}
-			return nullptr;
+			return symbolName;
 		}
 
-		/** Constructor */
-		LinuxKernelSymbolResolver() :
+		/** Constructor, the paths can be changed for testing */
+		explicit LinuxKernelSymbolResolver(
+			const std::string& kallsymsPath = "/proc/kallsyms",
+			const std::string& modulesPath = "/proc/modules") :
+			mutex_(),
+			kallsymsPath_(kallsymsPath),
+			modulesPath_(modulesPath),
+			loaded_(false),
 			path_(std::make_shared<std::string>("[kallsyms]")),
-			symbolNames_(),
+			symbolTable_(path_),
 			minAddress_(0),
-			maxAddress_(0) {
-			loadSymbolNames();
-		}
+			maxAddress_(0),
+			modules_(),
+			modulesContent_(),
+			modulesChecked_(),
+			modulesCheckInterval_(std::chrono::milliseconds(+DefaultModulesCheckInterval)),
+			buffer_() { }
 
 	protected:
+		/** Disable copy */
+		LinuxKernelSymbolResolver(const LinuxKernelSymbolResolver&) = delete;
+		LinuxKernelSymbolResolver& operator=(const LinuxKernelSymbolResolver&) = delete;
+
+		/** Symbols of kernel module, symbols of a module are placed in a continuous address range */
+		struct Module {
+			std::string name;
+			std::size_t minAddress;
+			std::size_t maxAddress;
+			std::unique_ptr<LinuxSymbolTable> symbolTable;
+		};
+
+		/** Represent a line parsed from /proc/kallsyms */
+		struct Entry {
+			std::size_t startAddress;
+			std::uint32_t nameOffset;
+		};
+
+		/** Find symbol name from kernel image and modules */
+		std::shared_ptr<SymbolName> find(std::size_t address) {
+			if (address >= minAddress_ && address < maxAddress_) {
+				return getSymbolName(symbolTable_, symbolTable_.find(address));
+			}
+			auto it = std::upper_bound(modules_.begin(), modules_.end(), address,
+				[](const auto& a, const auto& b) { return a < b.minAddress; });
+			if (it == modules_.begin()) {
+				return nullptr;
+			}
+			--it;
+			if (address >= it->maxAddress) {
+				return nullptr;
+			}
+			return getSymbolName(*it->symbolTable, it->symbolTable->find(address));
+		}
+
 		/**
+		 * Get the symbol name instance of the handle, kernel symbols are not mangled,
+		 * the demangle name is set here because instances are shared by interceptors on different threads,
+		 * and the lazy demangle on first access is not thread safe.
+		 */
+		static std::shared_ptr<SymbolName> getSymbolName(
+			LinuxSymbolTable& symbolTable, LinuxSymbolTable::HandleType handle) {
+			auto symbolName = symbolTable.getSymbolName(handle);
+			if (symbolName != nullptr && !symbolName->isDemangled()) {
+				symbolName->setDemangleName("");
+			}
+			return symbolName;
+		}
+
+		/**
+		 * Load symbols by scanning the whole file in memory, the kernel image is only loaded if `loadKernel` is true.
 		 * Line format:
 		 * address          type name           module(optional)
 		 * ffffffffc012340d t    cleanup_module [pata_acpi]
 		 */
-		void loadSymbolNames() {
-			// parse file
-			std::ifstream file("/proc/kallsyms");
-			std::string line;
-			while (std::getline(file, line)) {
-				std::uintptr_t startAddress = 0;
-				std::string functionName;
-				StringUtils::split(line,
-					[&line, &startAddress, &functionName]
-					(auto startIndex, auto endIndex, auto count) {
-					if (count == 0) {
-						unsigned long long startAddressL = 0;
-						if (TypeConvertUtils::strToUnsignedLongLong(
-							line.c_str() + startIndex, startAddressL, 16)) {
-							startAddress = static_cast<std::uintptr_t>(startAddressL);
+		void load(bool loadKernel) {
+			if (!LinuxFileUtils::readFile(kallsymsPath_.c_str(), buffer_)) {
+				return;
+			}
+			// keep tables of modules not changed, so the same SymbolName instances are returned
+			std::vector<Module> oldModules;
+			oldModules.swap(modules_);
+			std::vector<Entry> entries;
+			std::vector<std::vector<Entry>> moduleEntries;
+			std::unordered_map<std::string, std::size_t> moduleIndices;
+			std::size_t lastModuleIndex = 0;
+			std::string moduleName;
+			const char* ptr = buffer_.data();
+			const char* end = ptr + buffer_.size();
+			while (ptr < end) {
+				const char* lineEnd = static_cast<const char*>(std::memchr(ptr, '\n', end - ptr));
+				if (lineEnd == nullptr) {
+					lineEnd = end;
+				}
+				const char* lineStart = ptr;
+				ptr = lineEnd + 1;
+				// address
+				unsigned long long startAddress = 0;
+				const char* cursor = TypeConvertUtils::hexToUnsignedLongLong(lineStart, lineEnd, startAddress);
+				if (startAddress == 0 || cursor + 3 >= lineEnd) {
+					continue; // addresses are hidden by kptr_restrict, or the line is incomplete
+				}
+				// skip type, then name ends at tab, module name is in brackets
+				const char* name = cursor + 3;
+				const char* nameEnd = name;
+				while (nameEnd < lineEnd && *nameEnd != '\t' && *nameEnd != ' ') {
+					++nameEnd;
+				}
+				const char* moduleStart = static_cast<const char*>(std::memchr(nameEnd, '[', lineEnd - nameEnd));
+				if (moduleStart == nullptr) {
+					if (loadKernel) {
+						auto nameOffset = symbolTable_.appendName(name, nameEnd - name);
+						if (nameOffset != LinuxSymbolTable::InvalidHandle) {
+							entries.emplace_back(Entry({ static_cast<std::size_t>(startAddress), nameOffset }));
 						}
-					} else if (count == 2) {
-						functionName.assign(line, startIndex, endIndex - startIndex);
 					}
-				});
-				if (startAddress != 0 && !functionName.empty()) {
-					auto symbolName = std::make_shared<SymbolName>();
-					symbolName->setOriginalName(std::move(functionName));
-					symbolName->setDemangleName("");
-					symbolName->setPath(path_);
-					static_assert(
-						std::numeric_limits<std::uintptr_t>::max() ==
-						static_cast<std::size_t>(std::numeric_limits<std::uintptr_t>::max()),
-						"ensure case std::uintptr_t to std::size_t will not cause overflow");
-					symbolName->setFileOffsetStart(static_cast<std::size_t>(startAddress));
-					symbolNames_.emplace_back(std::move(symbolName));
+					continue;
 				}
+				++moduleStart;
+				const char* moduleEnd = static_cast<const char*>(std::memchr(moduleStart, ']', lineEnd - moduleStart));
+				if (moduleEnd == nullptr) {
+					continue;
+				}
+				// lines of the same module are usually continuous, only lookup when module changed
+				if (moduleEntries.empty() ||
+					modules_[lastModuleIndex].name.compare(
+						0, std::string::npos, moduleStart, moduleEnd - moduleStart) != 0) {
+					moduleName.assign(moduleStart, moduleEnd - moduleStart);
+					auto it = moduleIndices.find(moduleName);
+					if (it == moduleIndices.end()) {
+						it = moduleIndices.emplace(moduleName, modules_.size()).first;
+						modules_.emplace_back(Module({ moduleName, 0, 0,
+							std::make_unique<LinuxSymbolTable>(std::make_shared<std::string>("[" + moduleName + "]")) }));
+						moduleEntries.emplace_back();
+					}
+					lastModuleIndex = it->second;
+				}
+				auto nameOffset = modules_[lastModuleIndex].symbolTable->appendName(name, nameEnd - name);
+				if (nameOffset != LinuxSymbolTable::InvalidHandle) {
+					moduleEntries[lastModuleIndex].emplace_back(
+						Entry({ static_cast<std::size_t>(startAddress), nameOffset }));
+				}
+			}
+			buffer_.clear();
+			// build tables
+			if (loadKernel) {
+				buildTable(entries, symbolTable_);
+				minAddress_ = symbolTable_.empty() ? 0 : entries.front().startAddress;
+				maxAddress_ = symbolTable_.empty() ? 0 : symbolTable_.getEnds().back();
 			}
-			// sort symbol names and guess size
-			std::sort(symbolNames_.begin(), symbolNames_.end(), [](auto& a, auto& b) {
-				return a->getFileOffsetStart() < b->getFileOffsetStart();
+			for (std::size_t index = 0; index < modules_.size(); ++index) {
+				auto& module = modules_[index];
+				auto& moduleEntry = moduleEntries[index];
+				buildTable(moduleEntry, *module.symbolTable);
+				module.minAddress = moduleEntry.empty() ? 0 : moduleEntry.front().startAddress;
+				module.maxAddress = module.symbolTable->empty() ? 0 : module.symbolTable->getEnds().back();
+				for (auto& oldModule : oldModules) {
+					if (oldModule.symbolTable != nullptr && oldModule.name == module.name &&
+						oldModule.minAddress == module.minAddress &&
+						oldModule.maxAddress == module.maxAddress) {
+						module.symbolTable = std::move(oldModule.symbolTable);
+						break;
+					}
+				}
+			}
+			modules_.erase(std::remove_if(modules_.begin(), modules_.end(),
+				[](const auto& module) { return module.symbolTable->empty(); }), modules_.end());
+			std::sort(modules_.begin(), modules_.end(),
+				[](const auto& a, const auto& b) { return a.minAddress < b.minAddress; });
+		}
+
+		/** Sort entries and append them to the table, the size of symbol is guessed by the next symbol */
+		static void buildTable(std::vector<Entry>& entries, LinuxSymbolTable& symbolTable) {
+			std::stable_sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+				return a.startAddress < b.startAddress;
 			});
-			for (auto it = symbolNames_.begin(); it < symbolNames_.end(); ++it) {
+			symbolTable.reserve(entries.size(), 0);
+			for (auto it = entries.begin(); it < entries.end(); ++it) {
 				auto next = it + 1;
-				if (next < symbolNames_.end()) {
-					(*it)->setFileOffsetEnd((*next)->getFileOffsetStart());
-				} else {
-					(*it)->setFileOffsetEnd((*it)->getFileOffsetStart() + 1);
-				}
+				auto start = it->startAddress;
+				auto end = (next < entries.end()) ? next->startAddress : start + 1;
+				symbolTable.append(start, end, it->nameOffset);
 			}
-			// set min address and max address
-			minAddress_ = symbolNames_.empty() ? 0 : symbolNames_.front()->getFileOffsetStart();
-			maxAddress_ = symbolNames_.empty() ? 0 : symbolNames_.back()->getFileOffsetEnd();
+			symbolTable.sort();
 		}
 
 	protected:
+		mutable std::mutex mutex_;
+		std::string kallsymsPath_;
+		std::string modulesPath_;
+		bool loaded_;
 		std::shared_ptr<std::string> path_;
-		std::vector<std::shared_ptr<SymbolName>> symbolNames_;
-		std::uintptr_t minAddress_;
-		std::uintptr_t maxAddress_;
+		LinuxSymbolTable symbolTable_;
+		std::size_t minAddress_;
+		std::size_t maxAddress_;
+		// sorted by min address
+		std::vector<Module> modules_;
+		std::string modulesContent_;
+		std::chrono::high_resolution_clock::time_point modulesChecked_;
+		std::chrono::high_resolution_clock::duration modulesCheckInterval_;
+		std::string buffer_;
 	};
 }
 
@@ -2,6 +2,8 @@
 #include <unistd.h>
 #include <linux/perf_event.h>
 #include <sys/mman.h>
+#include <cstdint>
+#include <cstring>
 #include <vector>
 #include <cassert>
 
@@ -13,6 +15,12 @@ namespace LiveProfiler {
 	 * - ring buffer, element size is indeterminate
 	 * mmapDataAddress = mmapStartAddress + pageSize
 	 * mmapDataSize = mmapTotalSize - pageSize
+	 * The monitor target is either a thread (pid, cpu = -1),
+	 * or a cgroup on the specified cpu (cgroupFd, cpu >= 0).
+	 * Records can be kept by `keepRecord` while handling, they will be returned
+	 * again before the records from mapped memory in the next `getRecords`.
+	 * `isRecordsLost` is set by the handler when records are lost by kernel (PERF_RECORD_LOST)
+	 * or can't be kept, until it's reported with a following sample.
 	 */
 	class LinuxPerfEntry {
 	public:
@@ -22,6 +30,14 @@ namespace LiveProfiler {
 		void setPid(pid_t pid) { pid_ = pid; }
 		int getFd() const { return fd_; }
 		void setFd(int fd) { fd_ = fd; }
+		int getCpu() const { return cpu_; }
+		void setCpu(int cpu) { cpu_ = cpu; }
+		int getCgroupFd() const { return cgroupFd_; }
+		void setCgroupFd(int cgroupFd) { cgroupFd_ = cgroupFd; }
+		std::uint64_t getCgroupId() const { return cgroupId_; }
+		void setCgroupId(std::uint64_t cgroupId) { cgroupId_ = cgroupId; }
+		bool isRecordsLost() const { return recordsLost_; }
+		void setRecordsLost(bool recordsLost) { recordsLost_ = recordsLost; }
 
 		/** Unmap mmap address and close file descriptor */
 		void freeResources() {
@@ -42,12 +58,18 @@ namespace LiveProfiler {
 			attr_ = {};
 			pid_ = 0;
 			fd_ = 0;
+			cpu_ = -1;
+			cgroupFd_ = -1;
+			cgroupId_ = 0;
+			recordsLost_ = false;
 			mmapStartAddress_ = nullptr;
 			mmapDataAddress_ = nullptr;
 			mmapTotalSize_ = 0;
 			mmapDataSize_ = 0;
 			mmapReadOffset_ = 0;
 			records_.clear();
+			keptRecords_.clear();
+			nextKeptRecords_.clear();
 		}
 
 		/**
@@ -81,6 +103,13 @@ namespace LiveProfiler {
 		const std::vector<::perf_event_header*>& getRecords() & {
 			assert(mmapDataAddress_ != nullptr);
 			records_.clear();
+			// records kept from last round come first, they are stored in 8 bytes units to keep alignment
+			std::size_t keptOffset = 0;
+			while (keptOffset < keptRecords_.size()) {
+				auto* header = reinterpret_cast<::perf_event_header*>(keptRecords_.data() + keptOffset);
+				records_.emplace_back(header);
+				keptOffset += (header->size + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+			}
 			auto readOffset = mmapReadOffset_;
 			auto headOffset = getMetaPage()->data_head % mmapDataSize_;
 			// read from readOffset to headOffset
@@ -108,6 +137,22 @@ namespace LiveProfiler {
 			return records_;
 		}
 
+		/**
+		 * Keep a copy of the record returned from `getRecords`, it will be returned again in the next round.
+		 * It's used for records that can't be handled until the following records arrive.
+		 * Return false if too many records are kept, the limit is the size of the ring buffer.
+		 */
+		bool keepRecord(const ::perf_event_header* header) {
+			auto units = (header->size + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+			auto offset = nextKeptRecords_.size();
+			if ((offset + units) * sizeof(std::uint64_t) > mmapDataSize_) {
+				return false;
+			}
+			nextKeptRecords_.resize(offset + units);
+			std::memcpy(nextKeptRecords_.data() + offset, header, header->size);
+			return true;
+		}
+
 		/* Update read offset prepare for next round */
 		void updateReadOffset() {
 			// tell kernel data until data_head has been read
@@ -125,6 +170,9 @@ namespace LiveProfiler {
 			auto lastHead = metaPage->data_head;
 			metaPage->data_tail = lastHead;
 			mmapReadOffset_ = lastHead % mmapDataSize_;
+			// records kept in this round replace the records kept in last round
+			keptRecords_.swap(nextKeptRecords_);
+			nextKeptRecords_.clear();
 		}
 
 		/** Constructor */
@@ -132,12 +180,18 @@ namespace LiveProfiler {
 			attr_(),
 			pid_(0),
 			fd_(0),
+			cpu_(-1),
+			cgroupFd_(-1),
+			cgroupId_(0),
+			recordsLost_(false),
 			mmapStartAddress_(nullptr),
 			mmapDataAddress_(nullptr),
 			mmapTotalSize_(0),
 			mmapDataSize_(0),
 			mmapReadOffset_(0),
-			records_() { }
+			records_(),
+			keptRecords_(),
+			nextKeptRecords_() { }
 
 		/** Destructor */
 		~LinuxPerfEntry() {
@@ -148,12 +202,18 @@ namespace LiveProfiler {
 		::perf_event_attr attr_;
 		pid_t pid_;
 		int fd_;
+		int cpu_;
+		int cgroupFd_; // not owned
+		std::uint64_t cgroupId_;
+		bool recordsLost_;
 		char* mmapStartAddress_;
 		char* mmapDataAddress_;
 		std::size_t mmapTotalSize_;
 		std::size_t mmapDataSize_;
 		std::uint64_t mmapReadOffset_;
 		std::vector<::perf_event_header*> records_;
+		std::vector<std::uint64_t> keptRecords_;
+		std::vector<std::uint64_t> nextKeptRecords_;
 	};
 }
 
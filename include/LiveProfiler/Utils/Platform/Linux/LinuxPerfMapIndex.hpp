@@ -0,0 +1,295 @@
+#pragma once
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <unordered_map>
+#include "../../../Models/Shared/SymbolName.hpp"
+#include "../../Allocators/SingletonAllocator.hpp"
+#include "../../Containers/StaticSearchTree.hpp"
+#include "../../TypeConvertUtils.hpp"
+
+namespace LiveProfiler {
+	/**
+	 * Incremental index of perf map file (/tmp/perf-$pid.map), it's written by jit runtimes and keeps growing.
+	 * The file is kept open and only the appended contents are read on update,
+	 * names are stored in a single string pool (arena), SymbolName is created only for resolved symbols.
+	 *
+	 * Entries are stored in sorted runs in a single array, each update sorts the new entries as a new run,
+	 * then merges the last runs while the last run is not smaller than the half of the previous one,
+	 * so there at most log(n) runs and each entry is moved log(n) times in total,
+	 * update cost is proportional to the new contents instead of the whole file.
+	 * Lookups search runs from the newest to the oldest, so newer symbols win if the address is reused,
+	 * each run has a StaticSearchTree of end addresses, it's rebuilt when the run is created or merged.
+	 * If the file is truncated or replaced, the index is rebuilt from the start.
+	 * This class is not thread safe.
+	 */
+	class LinuxPerfMapIndex {
+	public:
+		/** Default parameters */
+		static const std::size_t DefaultReadChunkSize = 65536;
+
+		/** Getters */
+		const std::string& getPath() const& { return path_; }
+		std::size_t size() const { return entries_.size(); }
+		std::size_t getRunCount() const { return runEnds_.size(); }
+		/** Get the offset of the contents already parsed, the incomplete last line is not included */
+		std::size_t getReadOffset() const { return readOffset_ - buffer_.size(); }
+
+		/** For FreeListAllocator */
+		void freeResources() {
+			close();
+			entries_ = {};
+			runEnds_ = {};
+			stringPool_ = {};
+			symbolNames_ = {};
+			buffer_ = {};
+		}
+
+		/** For FreeListAllocator */
+		void reset(
+			const std::string& path,
+			const std::shared_ptr<std::string>& symbolNamePath,
+			const std::shared_ptr<SingletonAllocator<std::string, SymbolName>>& symbolNameAllocator) {
+			close();
+			clear();
+			path_ = path;
+			symbolNamePath_ = symbolNamePath;
+			symbolNameAllocator_ = symbolNameAllocator;
+		}
+
+		/**
+		 * Read the appended contents of the file and add them to the index.
+		 * Return how many entries are added.
+		 */
+		std::size_t update() {
+			struct ::stat pathStat;
+			if (::stat(path_.c_str(), &pathStat) != 0) {
+				return 0; // file does not exist
+			}
+			struct ::stat fileStat;
+			if (fd_ >= 0 && (::fstat(fd_, &fileStat) != 0 ||
+				fileStat.st_ino != pathStat.st_ino || fileStat.st_dev != pathStat.st_dev ||
+				static_cast<std::size_t>(fileStat.st_size) < readOffset_)) {
+				// the file is replaced or truncated
+				close();
+				clear();
+			}
+			if (fd_ < 0) {
+				fd_ = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+				if (fd_ < 0) {
+					return 0;
+				}
+			}
+			// incomplete line from last read is kept in buffer, parse each chunk to limit the buffer size
+			auto addedCount = entries_.size();
+			while (true) {
+				auto size = buffer_.size();
+				buffer_.resize(size + DefaultReadChunkSize);
+				auto ret = ::pread(fd_, &buffer_[size], DefaultReadChunkSize, static_cast<::off_t>(readOffset_));
+				if (ret < 0 && errno == EINTR) {
+					buffer_.resize(size);
+					continue;
+				} else if (ret <= 0) {
+					buffer_.resize(size);
+					break;
+				}
+				buffer_.resize(size + static_cast<std::size_t>(ret));
+				readOffset_ += static_cast<std::size_t>(ret);
+				buffer_.erase(0, parse(buffer_.data(), buffer_.data() + buffer_.size()));
+				if (static_cast<std::size_t>(ret) < DefaultReadChunkSize) {
+					break;
+				}
+			}
+			addRun(addedCount);
+			return entries_.size() - addedCount;
+		}
+
+		/**
+		 * Parse lines in [begin, end) and append them to the pending run, call `addRun` after all lines are appended.
+		 * Line format:
+		 * address          size name(may contains space)
+		 * 00007F7DD9DB0480 2d   instance bool [System.Private.CoreLib] dynamicClass::IL_STUB_UnboxingStub()
+		 * Return the size of complete lines parsed, the last line without '\n' is not parsed.
+		 */
+		std::size_t parse(const char* begin, const char* end) {
+			const char* ptr = begin;
+			while (ptr < end) {
+				const char* lineEnd = static_cast<const char*>(std::memchr(ptr, '\n', end - ptr));
+				if (lineEnd == nullptr) {
+					break;
+				}
+				parseLine(ptr, lineEnd);
+				ptr = lineEnd + 1;
+			}
+			return ptr - begin;
+		}
+
+		/** Sort entries appended since `runStart` as a new run, and merge runs if necessary */
+		void addRun(std::size_t runStart) {
+			if (runStart >= entries_.size()) {
+				return;
+			}
+			std::sort(entries_.begin() + runStart, entries_.end(), EntryComparer());
+			runEnds_.emplace_back(entries_.size());
+			runTrees_.emplace_back();
+			// merge like a binary counter
+			while (runEnds_.size() >= 2) {
+				auto lastStart = runEnds_[runEnds_.size() - 2];
+				auto previousStart = (runEnds_.size() >= 3) ? runEnds_[runEnds_.size() - 3] : 0;
+				if ((entries_.size() - lastStart) * 2 < lastStart - previousStart) {
+					break;
+				}
+				std::inplace_merge(entries_.begin() + previousStart,
+					entries_.begin() + lastStart, entries_.end(), EntryComparer());
+				runEnds_.erase(runEnds_.end() - 2);
+				runTrees_.pop_back();
+			}
+			// only the last run is changed
+			std::size_t lastStart = (runEnds_.size() >= 2) ? runEnds_[runEnds_.size() - 2] : 0;
+			runTrees_.back().assign(entries_.size() - lastStart,
+				[this, lastStart](auto index) { return entries_[lastStart + index].end; });
+		}
+
+		/** Resolve symbol name from address, return nullptr if not found */
+		std::shared_ptr<SymbolName> resolve(std::uint64_t address) {
+			std::size_t runEnd = entries_.size();
+			for (std::size_t index = runEnds_.size(); index > 0; --index) {
+				std::size_t runStart = (index >= 2) ? runEnds_[index - 2] : 0;
+				// find first symbol that end > address
+				std::size_t entryIndex = runStart + runTrees_[index - 1].upperBound(address);
+				if (entryIndex < runEnd && address >= entries_[entryIndex].start) {
+					return getSymbolName(entries_[entryIndex].nameOffset);
+				}
+				runEnd = runStart;
+			}
+			return nullptr;
+		}
+
+		/** Constructor */
+		LinuxPerfMapIndex() :
+			path_(),
+			symbolNamePath_(),
+			symbolNameAllocator_(),
+			fd_(-1),
+			readOffset_(0),
+			entries_(),
+			runEnds_(),
+			runTrees_(),
+			stringPool_(1, '\0'),
+			symbolNames_(),
+			buffer_() { }
+
+		/** Destructor */
+		~LinuxPerfMapIndex() {
+			close();
+		}
+
+	protected:
+		/** Disable copy */
+		LinuxPerfMapIndex(const LinuxPerfMapIndex&) = delete;
+		LinuxPerfMapIndex& operator=(const LinuxPerfMapIndex&) = delete;
+
+		/** Symbol range and the offset of name in string pool */
+		struct Entry {
+			std::uint64_t start;
+			std::uint64_t end;
+			std::uint32_t nameOffset;
+		};
+
+		/** Sort entries by end then by start, the same as LinuxSymbolTable */
+		struct EntryComparer {
+			bool operator()(const Entry& a, const Entry& b) const {
+				if (a.end != b.end) {
+					return a.end < b.end;
+				}
+				return a.start < b.start;
+			}
+		};
+
+		/** Parse single line without '\n' */
+		void parseLine(const char* begin, const char* end) {
+			unsigned long long startAddress = 0;
+			unsigned long long symbolSize = 0;
+			const char* ptr = parseHex(skipSpaces(begin, end), end, startAddress);
+			ptr = parseHex(skipSpaces(ptr, end), end, symbolSize);
+			// custom function name may contains space so copy till last
+			const char* name = skipSpaces(ptr, end);
+			if (startAddress == 0 || symbolSize == 0 || name == ptr || name == end ||
+				stringPool_.size() + (end - name) + 1 > UINT32_MAX) {
+				return;
+			}
+			auto nameOffset = static_cast<std::uint32_t>(stringPool_.size());
+			stringPool_.append(name, end - name);
+			stringPool_.push_back('\0');
+			entries_.emplace_back(Entry({ startAddress, startAddress + symbolSize, nameOffset }));
+		}
+
+		/** Parse hex number with optional "0x" prefix */
+		static const char* parseHex(const char* begin, const char* end, unsigned long long& value) {
+			if (end - begin > 2 && begin[0] == '0' && (begin[1] | 0x20) == 'x') {
+				begin += 2;
+			}
+			return TypeConvertUtils::hexToUnsignedLongLong(begin, end, value);
+		}
+
+		/** Skip spaces and tabs */
+		static const char* skipSpaces(const char* begin, const char* end) {
+			while (begin < end && (*begin == ' ' || *begin == '\t')) {
+				++begin;
+			}
+			return begin;
+		}
+
+		/** Get the symbol name instance of the name, create if not exists */
+		std::shared_ptr<SymbolName> getSymbolName(std::uint32_t nameOffset) {
+			auto& symbolName = symbolNames_[nameOffset];
+			if (symbolName == nullptr) {
+				symbolName = symbolNameAllocator_->allocate(
+					std::string(stringPool_.c_str() + nameOffset), symbolNamePath_);
+			}
+			return symbolName;
+		}
+
+		/** Close the file, the index is kept */
+		void close() {
+			if (fd_ >= 0) {
+				::close(fd_);
+			}
+			fd_ = -1;
+		}
+
+		/** Clear the index and the read cursor */
+		void clear() {
+			readOffset_ = 0;
+			entries_.clear();
+			runEnds_.clear();
+			runTrees_.clear();
+			stringPool_.assign(1, '\0');
+			symbolNames_.clear();
+			buffer_.clear();
+		}
+
+	protected:
+		std::string path_;
+		std::shared_ptr<std::string> symbolNamePath_;
+		std::shared_ptr<SingletonAllocator<std::string, SymbolName>> symbolNameAllocator_;
+		int fd_;
+		// offset of the contents read, include the incomplete line in buffer
+		std::size_t readOffset_;
+		// sorted runs, runEnds_ is the end index of each run, runTrees_ is the search tree of each run
+		std::vector<Entry> entries_;
+		std::vector<std::size_t> runEnds_;
+		std::vector<StaticSearchTree> runTrees_;
+		std::string stringPool_;
+		std::unordered_map<std::uint32_t, std::shared_ptr<SymbolName>> symbolNames_;
+		std::string buffer_;
+	};
+}
+
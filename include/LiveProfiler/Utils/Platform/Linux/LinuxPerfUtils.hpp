@@ -2,6 +2,7 @@
 #include <fcntl.h>
 #include <sys/ioctl.h>
 #include <sys/syscall.h>
+#include <ctime>
 #include <memory>
 #include "LinuxPerfEntry.hpp"
 #include "../../../Exceptions/ProfilerException.hpp"
@@ -29,13 +30,22 @@ namespace LiveProfiler {
 			return retReset >= 0 && retEnable >= 0;
 		}
 
+		/** Update the sample period of perf events, takes effect without reopening */
+		static bool perfEventSetPeriod(int fd, std::uint64_t samplePeriod) {
+			auto ret = ::ioctl(fd, PERF_EVENT_IOC_PERIOD, &samplePeriod);
+			return ret >= 0;
+		}
+
 		/** Disable perf events */
 		static bool perfEventDisable(int fd) {
 			auto ret = ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
 			return ret >= 0;
 		}
 
-		/** Setup perf sample monitor for specified process */
+		/**
+		 * Setup perf sample monitor for specified process,
+		 * or for specified cgroup on specified cpu if cgroup fd of the entry is set.
+		 */
 		static bool monitorSample(
 			std::unique_ptr<LinuxPerfEntry>& entry,
 			std::uint32_t type, // eg: PERF_TYPE_SOFTWARE
@@ -46,10 +56,19 @@ namespace LiveProfiler {
 			std::uint32_t wakeupEvents, // eg: 8, atleast 1
 			bool excludeUser, // exclude samples in user space
 			bool excludeKernel, // exclude samples in kernel space
-			bool excludeHv) { // exclude samples in hypervisor
-			// caller should set a valid pid
+			bool excludeHv, // exclude samples in hypervisor
+			bool recordMmap = false) { // record new executable mappings (PERF_RECORD_MMAP2)
+			// caller should set a valid pid, or a valid cgroup fd with cpu
 			auto pid = entry->getPid();
-			if (pid <= 0) {
+			auto cpu = entry->getCpu();
+			unsigned long flags = 0;
+			if (entry->getCgroupFd() >= 0) {
+				if (cpu < 0) {
+					return false; // cgroup events are per cpu
+				}
+				pid = entry->getCgroupFd();
+				flags = PERF_FLAG_PID_CGROUP;
+			} else if (pid <= 0) {
 				return false;
 			}
 			// setup attributes
@@ -65,8 +84,17 @@ namespace LiveProfiler {
 			attr.exclude_user = excludeUser;
 			attr.exclude_kernel = excludeKernel;
 			attr.exclude_hv = excludeHv;
+			attr.mmap = recordMmap;
+			attr.mmap2 = recordMmap;
+			if ((sampleType & PERF_SAMPLE_TIME) != 0) {
+				// use the same clock as other tools (e.g. jitdump), instead of the perf internal clock
+				attr.use_clockid = 1;
+				attr.clockid = CLOCK_MONOTONIC;
+				// append the time to mmap records, so they can be ordered with /proc/$pid/maps snapshots
+				attr.sample_id_all = recordMmap;
+			}
 			// open file descriptor
-			auto fd = perfEventOpen(&attr, pid, -1, -1, 0);
+			auto fd = perfEventOpen(&attr, pid, cpu, -1, flags);
 			if (fd < 0) {
 				auto err = errno;
 				if (err == ESRCH) {
@@ -0,0 +1,167 @@
+#pragma once
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/connector.h>
+#include <linux/cn_proc.h>
+#include <vector>
+#include <array>
+#include "../../../Exceptions/ProfilerException.hpp"
+
+namespace LiveProfiler {
+	/**
+	 * Class used to receive process events (fork, exec, exit) from the netlink proc connector.
+	 * The file descriptor is non blocking and can be registered to epoll.
+	 * This class require root permission (CAP_NET_ADMIN),
+	 * and only works in the initial network namespace.
+	 */
+	class LinuxProcConnector {
+	public:
+		/** Type of process event */
+		enum class EventType {
+			Fork, // a new thread or process is created, tid is the new thread id
+			Exec, // the process executed a new program, tid equals pid
+			Exit // the thread exited
+		};
+
+		/** Represent a process event */
+		struct Event {
+			EventType type;
+			pid_t pid; // thread group id
+			pid_t tid; // thread id
+		};
+
+		/** Getters */
+		int getFd() const { return fd_; }
+		bool isOpened() const { return fd_ >= 0; }
+
+		/** Open the netlink socket and subscribe to process events */
+		void open() {
+			if (isOpened()) {
+				return;
+			}
+			fd_ = ::socket(PF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+			if (fd_ < 0) {
+				throw ProfilerException(errno, "[LinuxProcConnector::open] socket");
+			}
+			::sockaddr_nl address = {};
+			address.nl_family = AF_NETLINK;
+			address.nl_groups = CN_IDX_PROC;
+			address.nl_pid = 0; // let kernel assign the port id
+			if (::bind(fd_, reinterpret_cast<::sockaddr*>(&address), sizeof(address)) != 0) {
+				auto err = errno;
+				close();
+				throw ProfilerException(err, "[LinuxProcConnector::open] bind");
+			}
+			if (!sendMulticastOp(PROC_CN_MCAST_LISTEN)) {
+				auto err = errno;
+				close();
+				throw ProfilerException(err, "[LinuxProcConnector::open] send");
+			}
+		}
+
+		/** Unsubscribe from process events and close the netlink socket */
+		void close() {
+			if (!isOpened()) {
+				return;
+			}
+			sendMulticastOp(PROC_CN_MCAST_IGNORE);
+			::close(fd_);
+			fd_ = -1;
+		}
+
+		/**
+		 * Receive all pending events, the result will be appended to `events`.
+		 * Return false if some events are lost because the socket buffer was overflowed,
+		 * in this case the caller should rescan processes from /proc.
+		 */
+		bool receive(std::vector<Event>& events) {
+			bool lost = false;
+			while (isOpened()) {
+				auto size = ::recv(fd_, buffer_.data(), buffer_.size(), 0);
+				if (size < 0) {
+					auto err = errno;
+					if (err == EAGAIN || err == EWOULDBLOCK) {
+						break; // no more events
+					} else if (err == EINTR) {
+						continue;
+					} else if (err == ENOBUFS) {
+						lost = true;
+						continue;
+					}
+					throw ProfilerException(err, "[LinuxProcConnector::receive] recv");
+				} else if (size == 0) {
+					break;
+				}
+				auto* header = reinterpret_cast<::nlmsghdr*>(buffer_.data());
+				auto length = static_cast<unsigned int>(size);
+				for (; NLMSG_OK(header, length); header = NLMSG_NEXT(header, length)) {
+					if (header->nlmsg_type == NLMSG_ERROR || header->nlmsg_type == NLMSG_NOOP) {
+						continue;
+					} else if (header->nlmsg_type == NLMSG_OVERRUN) {
+						lost = true;
+						continue;
+					}
+					auto* message = reinterpret_cast<::cn_msg*>(NLMSG_DATA(header));
+					if (message->id.idx != CN_IDX_PROC || message->id.val != CN_VAL_PROC) {
+						continue;
+					}
+					auto* event = reinterpret_cast<::proc_event*>(message->data);
+					if (event->what == ::proc_event::PROC_EVENT_FORK) {
+						events.emplace_back(Event({
+							EventType::Fork,
+							event->event_data.fork.child_tgid,
+							event->event_data.fork.child_pid }));
+					} else if (event->what == ::proc_event::PROC_EVENT_EXEC) {
+						events.emplace_back(Event({
+							EventType::Exec,
+							event->event_data.exec.process_tgid,
+							event->event_data.exec.process_pid }));
+					} else if (event->what == ::proc_event::PROC_EVENT_EXIT) {
+						events.emplace_back(Event({
+							EventType::Exit,
+							event->event_data.exit.process_tgid,
+							event->event_data.exit.process_pid }));
+					}
+				}
+			}
+			return !lost;
+		}
+
+		/** Constructor */
+		LinuxProcConnector() :
+			fd_(-1),
+			buffer_() { }
+
+		/** Destructor */
+		~LinuxProcConnector() {
+			close();
+		}
+
+	protected:
+		/** Disable copy */
+		LinuxProcConnector(const LinuxProcConnector&) = delete;
+		LinuxProcConnector& operator=(const LinuxProcConnector&) = delete;
+
+		/** Send listen or ignore operation to the proc connector */
+		bool sendMulticastOp(::proc_cn_mcast_op op) {
+			// cn_msg contains flexible array member, so build the message in raw buffer
+			static const std::size_t payloadSize = sizeof(::cn_msg) + sizeof(::proc_cn_mcast_op);
+			alignas(::nlmsghdr) std::array<char, NLMSG_SPACE(payloadSize)> message = {};
+			auto* header = reinterpret_cast<::nlmsghdr*>(message.data());
+			header->nlmsg_len = NLMSG_LENGTH(payloadSize);
+			header->nlmsg_type = NLMSG_DONE;
+			header->nlmsg_pid = 0;
+			auto* connectorMessage = reinterpret_cast<::cn_msg*>(NLMSG_DATA(header));
+			connectorMessage->id.idx = CN_IDX_PROC;
+			connectorMessage->id.val = CN_VAL_PROC;
+			connectorMessage->len = sizeof(::proc_cn_mcast_op);
+			*reinterpret_cast<::proc_cn_mcast_op*>(connectorMessage->data) = op;
+			return ::send(fd_, message.data(), header->nlmsg_len, 0) >= 0;
+		}
+
+	protected:
+		int fd_;
+		alignas(::nlmsghdr) std::array<char, 8192> buffer_;
+	};
+}
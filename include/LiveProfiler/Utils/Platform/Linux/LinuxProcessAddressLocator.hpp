@@ -1,14 +1,16 @@
 #pragma once
 #include <sys/types.h>
+#include <time.h>
 #include <cassert>
 #include <vector>
 #include <memory>
 #include <chrono>
 #include <utility>
-#include <fstream>
+#include <iterator>
 #include <algorithm>
 #include "../../Allocators/SingletonAllocator.hpp"
 #include "../../Containers/StackBuffer.hpp"
+#include "LinuxFileUtils.hpp"
 #include "LinuxProcessAddressMap.hpp"
 
 namespace LiveProfiler {
@@ -19,16 +21,39 @@ namespace LiveProfiler {
 	 * Because maps may change continuously, it needs to reload under certain conditions.
 	 * And because I want to avoid frequent reload so locate a newly mapped address may fail,
 	 * use `forceReload` can make it always reload.
+	 *
+	 * If new mappings are reported by `update` (from PERF_RECORD_MMAP2),
+	 * they are applied to the snapshot read from /proc/$pid/maps, so newly mapped addresses
+	 * can be located without reloading. The reported mappings may be incomplete
+	 * (records are delivered with later samples of the thread and may be lost),
+	 * so failed locates still reload the maps with the same rate limit,
+	 * and `invalidate` makes the next locate reload the maps if some mappings are known to be lost.
+	 * Unmapped ranges are not reported, they remain until they are overwritten by new mappings or reload.
+	 * Reloading unchanged maps keeps the mappings (and their resolvers) and the maps generation.
 	 */
 	class LinuxProcessAddressLocator {
 	public:
 		/** Default parameters */
 		static const std::size_t DefaultMapsUpdateMinInterval = 100;
 
+		/**
+		 * Get how many times the maps are reloaded with changes or existing mappings are replaced,
+		 * caches built from located results should be invalidated when it changed.
+		 */
+		std::size_t getMapsGeneration() const { return mapsGeneration_; }
+
+		/** Get whether the maps are updated incrementally */
+		bool isIncremental() const { return incremental_; }
+
+		/** Get how many mappings are known */
+		std::size_t getMapCount() const { return maps_.size(); }
+
 		/** For FreeListAllocator */
 		void freeResources() {
 			pathAllocator_ = nullptr;
 			maps_.clear();
+			std::string().swap(buffer_);
+			std::string().swap(mapsContent_);
 		}
 
 		/** For FreeListAllocator */
@@ -40,8 +65,13 @@ namespace LiveProfiler {
 			pathAllocator_ = pathAllocator;
 			maps_.clear();
 			mapsUpdated_ = {};
+			mapsGeneration_ = 0;
+			mapsTimestamp_ = 0;
+			incremental_ = false;
+			reloadRequired_ = false;
 			mapsPathBuffer_.clear();
-			line_.clear();
+			buffer_.clear();
+			mapsContent_.clear();
 		}
 
 		/**
@@ -53,20 +83,127 @@ namespace LiveProfiler {
 		 */
 		std::pair<std::shared_ptr<std::string>, std::ptrdiff_t> locate(
 			std::uintptr_t address, bool forceReload) {
-			// first try
-			auto result = tryLocate(address);
-			if (result.first != nullptr) {
-				return result;
+			auto* map = locateMap(address, forceReload);
+			if (map == nullptr) {
+				return { nullptr, 0 };
+			}
+			return { map->getPath(), address - map->getStartAddress() + map->getFileOffset() };
+		}
+
+		/**
+		 * Locate the mapping contains the specified address, reload rules are the same as `locate`.
+		 * Return nullptr if locate failed.
+		 * The returned mapping is valid until the next reload or update,
+		 * it can be used to attach the resolver of the mapped file.
+		 */
+		LinuxProcessAddressMap* locateMap(std::uintptr_t address, bool forceReload) {
+			// first try, the located mapping may be replaced if some mappings are lost
+			auto* map = reloadRequired_ ? nullptr : findMap(address);
+			if (map != nullptr) {
+				return map;
 			}
 			// reload maps from file, prevent frequent reloading
 			auto now = std::chrono::high_resolution_clock::now();
-			if (forceReload || now - mapsUpdated_ > mapsUpdateMinInterval_) {
+			if (forceReload || reloadRequired_ || now - mapsUpdated_ > mapsUpdateMinInterval_) {
 				reload();
 				mapsUpdated_ = now;
 				// second try
-				result = tryLocate(address);
+				map = findMap(address);
 			}
-			return result;
+			return map;
+		}
+
+		/**
+		 * Make the next locate or update reload the maps,
+		 * call it when some mappings of the process may not be reported by `update`.
+		 */
+		void invalidate() {
+			reloadRequired_ = true;
+		}
+
+		/**
+		 * Call `func(LinuxProcessAddressMap&)` for each known mapping in address order,
+		 * the maps are read from /proc/$pid/maps if they are never loaded.
+		 * It can be used to attach resolvers before locating any address.
+		 */
+		template <class Func>
+		void forEachMap(const Func& func) {
+			if (mapsGeneration_ == 0) {
+				reload();
+				mapsUpdated_ = std::chrono::high_resolution_clock::now();
+			}
+			for (auto& map : maps_) {
+				func(map);
+			}
+		}
+
+		/**
+		 * Add new mapping, overlapped parts of existing mappings are replaced.
+		 * The initial snapshot is read from /proc/$pid/maps if the maps are never loaded,
+		 * the new mapping may already be in the snapshot, adding it again is harmless.
+		 * The mapped file is identified by (device, inode), 0 means unknown.
+		 * `timestamp` is the time of the mapping (CLOCK_MONOTONIC in nanoseconds, 0 means unknown),
+		 * mappings older than the snapshot are ignored because the snapshot already contains them,
+		 * or the mappings replaced them.
+		 */
+		void update(
+			std::uintptr_t startAddress,
+			std::uintptr_t endAddress,
+			std::uintptr_t fileOffset,
+			const std::shared_ptr<std::string>& path,
+			std::uint64_t device = 0,
+			std::uint64_t inode = 0,
+			std::uint64_t timestamp = 0) {
+			if (mapsGeneration_ == 0 || reloadRequired_) {
+				reload();
+				mapsUpdated_ = std::chrono::high_resolution_clock::now();
+			}
+			if (!incremental_) {
+				// the file buffer is only reused by frequent reloads, release it
+				std::string().swap(buffer_);
+				incremental_ = true;
+			}
+			if (startAddress >= endAddress || (timestamp != 0 && timestamp < mapsTimestamp_)) {
+				return;
+			}
+			// the mappings no longer match the content of file, the next reload should replace them
+			mapsContent_.clear();
+			// find the overlapped range [first, last)
+			auto first = std::upper_bound(
+				maps_.begin(), maps_.end(), startAddress,
+				[](const auto& a, const auto& b) {
+					return a < b.getStartAddress();
+				});
+			if (first != maps_.begin() && std::prev(first)->getEndAddress() > startAddress) {
+				--first;
+			}
+			auto last = first;
+			while (last != maps_.end() && last->getStartAddress() < endAddress) {
+				++last;
+			}
+			if (first == last) {
+				maps_.emplace(first, startAddress, endAddress, fileOffset, path, device, inode);
+				return;
+			}
+			// keep the parts of overlapped mappings outside the new mapping, with their resolvers
+			auto head = *first;
+			auto tail = *std::prev(last);
+			auto index = maps_.erase(first, last) - maps_.begin();
+			if (head.getStartAddress() < startAddress) {
+				maps_.emplace(maps_.begin() + index++,
+					head.getStartAddress(), startAddress, head.getFileOffset(), head.getPath(),
+					head.getDevice(), head.getInode(), head.getResolver());
+			}
+			maps_.emplace(maps_.begin() + index++,
+				startAddress, endAddress, fileOffset, path, device, inode);
+			if (tail.getEndAddress() > endAddress) {
+				maps_.emplace(maps_.begin() + index,
+					endAddress, tail.getEndAddress(),
+					tail.getFileOffset() + (endAddress - tail.getStartAddress()), tail.getPath(),
+					tail.getDevice(), tail.getInode(), tail.getResolver());
+			}
+			// located results of the replaced mappings are no longer valid
+			++mapsGeneration_;
 		}
 
 		/** Constructor */
@@ -75,34 +212,35 @@ namespace LiveProfiler {
 			pathAllocator_(nullptr),
 			maps_(),
 			mapsUpdated_(),
+			mapsGeneration_(0),
+			mapsTimestamp_(0),
+			incremental_(false),
+			reloadRequired_(false),
 			mapsUpdateMinInterval_(
 				std::chrono::milliseconds(+DefaultMapsUpdateMinInterval)),
 			mapsPathBuffer_(),
-			line_() { }
+			buffer_(),
+			mapsContent_() { }
 
 	protected:
-		/**
-		 * Locate file path and offset for the specified address.
-		 * Return (nullptr, 0) if locate failed, no retry.
-		 */
-		std::pair<std::shared_ptr<std::string>, std::ptrdiff_t> tryLocate(std::uintptr_t address) const {
+		/** Find the mapping contains the specified address, return nullptr if not found, no retry */
+		LinuxProcessAddressMap* findMap(std::uintptr_t address) {
 			// find first map that startAddress > address
 			auto it = std::upper_bound(
-				maps_.cbegin(), maps_.cend(), address,
+				maps_.begin(), maps_.end(), address,
 				[](const auto& a, const auto& b) {
 					return a < b.getStartAddress();
 				});
 			// get the previous map
-			if (it == maps_.cbegin()) {
-				return { nullptr, 0 };
+			if (it == maps_.begin()) {
+				return nullptr;
 			}
 			--it;
 			// check is address >= startAddress and address < endAddress
 			if (address < it->getEndAddress()) {
-				auto offset = address - it->getStartAddress() + it->getFileOffset();
-				return { it->getPath(), offset };
+				return &*it;
 			}
-			return { nullptr, 0 };
+			return nullptr;
 		}
 
 		/** Reload maps from /proc/$pid/maps */
@@ -116,20 +254,29 @@ namespace LiveProfiler {
 				mapsPathBuffer_.appendStr(suffix.data(), suffix.size());
 				mapsPathBuffer_.appendNullTerminator();
 			}
-			// parse lines
-			std::ifstream file(mapsPathBuffer_.data());
-			LinuxProcessAddressMap map;
+			// remember when the snapshot is taken, in the same clock as the timestamps of mappings
+			::timespec now = {};
+			::clock_gettime(CLOCK_MONOTONIC, &now);
+			mapsTimestamp_ = static_cast<std::uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+			reloadRequired_ = false;
+			// read the whole file with few read calls, keep the mappings if the content is unchanged
+			if (LinuxFileUtils::readFile(mapsPathBuffer_.data(), buffer_) &&
+				!mapsContent_.empty() && buffer_ == mapsContent_) {
+				return;
+			}
+			// parse it in memory
+			++mapsGeneration_;
 			maps_.clear();
-			while (std::getline(file, line_)) {
-				if (map.parseLine(line_, pathAllocator_)) {
-					maps_.emplace_back(std::move(map));
-				}
+			mapsContent_.swap(buffer_);
+			LinuxProcessAddressMap::parseMaps(
+				mapsContent_.data(), mapsContent_.data() + mapsContent_.size(), pathAllocator_, maps_);
+			// maps are sorted by start address in file, sort them in case not
+			auto compare = [](const auto& a, const auto& b) {
+				return a.getStartAddress() < b.getStartAddress();
+			};
+			if (!std::is_sorted(maps_.begin(), maps_.end(), compare)) {
+				std::sort(maps_.begin(), maps_.end(), compare);
 			}
-			// sort maps by start address
-			std::sort(maps_.begin(), maps_.end(),
-				[](const auto& a, const auto& b) {
-					return a.getStartAddress() < b.getStartAddress();
-				});
 		}
 
 	protected:
@@ -137,9 +284,14 @@ namespace LiveProfiler {
 		std::shared_ptr<SingletonAllocator<std::string, std::string>> pathAllocator_;
 		std::vector<LinuxProcessAddressMap> maps_;
 		std::chrono::high_resolution_clock::time_point mapsUpdated_;
+		std::size_t mapsGeneration_;
+		std::uint64_t mapsTimestamp_;
+		bool incremental_;
+		bool reloadRequired_;
 		std::chrono::high_resolution_clock::duration mapsUpdateMinInterval_;
 		StackBuffer<128> mapsPathBuffer_;
-		std::string line_;
+		std::string buffer_;
+		std::string mapsContent_;
 	};
 }
 
@@ -1,6 +1,9 @@
 #pragma once
+#include <sys/sysmacros.h>
 #include <cassert>
+#include <cstring>
 #include <string>
+#include <vector>
 #include <memory>
 #include "../../Allocators/SingletonAllocator.hpp"
 #include "../../StringUtils.hpp"
@@ -8,7 +11,12 @@
 #include "LinuxExecutableSymbolResolver.hpp"
 
 namespace LiveProfiler {
-	/** Represent a single line in /proc/$pid/maps */
+	/**
+	 * Represent a single line in /proc/$pid/maps.
+	 * Use `parseMaps` to parse the whole file in memory, it doesn't allocate memory except for new paths.
+	 * The file is identified by (device, inode), the device is encoded by makedev like `stat::st_dev`.
+	 * The resolver for the mapped file can be attached to avoid finding it again.
+	 */
 	class LinuxProcessAddressMap {
 	public:
 		/** Getters */
@@ -16,6 +24,15 @@ namespace LiveProfiler {
 		std::uintptr_t getEndAddress() const { return endAddress_; }
 		std::uintptr_t getFileOffset() const { return fileOffset_; }
 		const std::shared_ptr<std::string>& getPath() const& { return path_; }
+		std::uint64_t getDevice() const { return device_; }
+		std::uint64_t getInode() const { return inode_; }
+		const std::shared_ptr<LinuxExecutableSymbolResolver>& getResolver() const& { return resolver_; }
+		void setResolver(const std::shared_ptr<LinuxExecutableSymbolResolver>& resolver) { resolver_ = resolver; }
+
+		/** Return whether the mapping is backed by a file, anonymous and pseudo mappings like [vdso] are not */
+		bool isFileBacked() const {
+			return inode_ != 0 && path_ != nullptr && !path_->empty() && path_->front() == '/';
+		}
 
 		/**
 		 * Line format:
@@ -31,7 +48,10 @@ namespace LiveProfiler {
 			startAddress_ = 0;
 			endAddress_ = 0;
 			fileOffset_ = 0;
+			device_ = 0;
+			inode_ = 0;
 			path_.reset();
+			resolver_.reset();
 			// split line with blank characters
 			std::size_t successParts = 0;
 			StringUtils::split(line,
@@ -59,6 +79,15 @@ namespace LiveProfiler {
 						fileOffset_ = static_cast<std::uintptr_t>(offsetL);
 						++successParts;
 					}
+				} else if (count == 3) {
+					// device, optional
+					device_ = parseDevice(line.c_str() + startIndex, line.c_str() + endIndex);
+				} else if (count == 4) {
+					// inode, optional
+					unsigned long long inodeL = 0;
+					if (TypeConvertUtils::strToUnsignedLongLong(line.c_str() + startIndex, inodeL, 10)) {
+						inode_ = static_cast<std::uint64_t>(inodeL);
+					}
 				} else if (count == 5) {
 					// pathname
 					const char* pathPtr = line.c_str() + startIndex;
@@ -76,18 +105,171 @@ namespace LiveProfiler {
 			return successParts == 3;
 		}
 
+		/**
+		 * Parse the line in [begin, end) without copy, the format is the same as above,
+		 * the pathname is the rest of the line so it can contains spaces (e.g. " (deleted)").
+		 * The path is interned by `pathAllocator`, if it's the same as `previousPath`, the previous one is reused.
+		 * Return whether the parse is successful.
+		 */
+		bool parseLine(
+			const char* begin,
+			const char* end,
+			const std::shared_ptr<SingletonAllocator<std::string, std::string>>& pathAllocator,
+			const std::shared_ptr<std::string>& previousPath = nullptr) {
+			assert(pathAllocator != nullptr);
+			// reset members
+			startAddress_ = 0;
+			endAddress_ = 0;
+			fileOffset_ = 0;
+			device_ = 0;
+			inode_ = 0;
+			path_.reset();
+			resolver_.reset();
+			// address
+			unsigned long long startAddressL = 0;
+			unsigned long long endAddressL = 0;
+			const char* ptr = TypeConvertUtils::hexToUnsignedLongLong(begin, end, startAddressL);
+			if (ptr == begin || ptr == end || *ptr != '-') {
+				return false;
+			}
+			const char* endAddressBegin = ptr + 1;
+			ptr = TypeConvertUtils::hexToUnsignedLongLong(endAddressBegin, end, endAddressL);
+			if (ptr == endAddressBegin) {
+				return false;
+			}
+			// permissions
+			ptr = skipField(skipSpaces(ptr, end), end);
+			// offset
+			unsigned long long offsetL = 0;
+			const char* offsetBegin = skipSpaces(ptr, end);
+			ptr = TypeConvertUtils::hexToUnsignedLongLong(offsetBegin, end, offsetL);
+			if (ptr == offsetBegin || (ptr < end && *ptr != ' ' && *ptr != '\t')) {
+				return false;
+			}
+			// device and inode
+			const char* deviceBegin = skipSpaces(ptr, end);
+			ptr = skipField(deviceBegin, end);
+			std::uint64_t device = parseDevice(deviceBegin, ptr);
+			std::uint64_t inode = 0;
+			for (ptr = skipSpaces(ptr, end); ptr < end && *ptr >= '0' && *ptr <= '9'; ++ptr) {
+				inode = inode * 10 + (*ptr - '0');
+			}
+			ptr = skipField(ptr, end);
+			// pathname, trailing spaces are removed
+			const char* pathBegin = skipSpaces(ptr, end);
+			const char* pathEnd = end;
+			while (pathEnd > pathBegin && (pathEnd[-1] == ' ' || pathEnd[-1] == '\t')) {
+				--pathEnd;
+			}
+			std::size_t pathSize = pathEnd - pathBegin;
+			if (previousPath != nullptr && previousPath->size() == pathSize &&
+				std::memcmp(previousPath->data(), pathBegin, pathSize) == 0) {
+				path_ = previousPath;
+			} else {
+				path_ = pathAllocator->allocate(pathBegin, pathSize);
+			}
+			startAddress_ = static_cast<std::uintptr_t>(startAddressL);
+			endAddress_ = static_cast<std::uintptr_t>(endAddressL);
+			fileOffset_ = static_cast<std::uintptr_t>(offsetL);
+			device_ = device;
+			inode_ = inode;
+			return true;
+		}
+
+		/**
+		 * Parse all lines in the content of /proc/$pid/maps and append them to `maps`,
+		 * lines are split by memchr and invalid lines are skipped.
+		 * Return how many maps are appended.
+		 */
+		static std::size_t parseMaps(
+			const char* begin,
+			const char* end,
+			const std::shared_ptr<SingletonAllocator<std::string, std::string>>& pathAllocator,
+			std::vector<LinuxProcessAddressMap>& maps) {
+			std::size_t count = 0;
+			// consecutive lines usually belong to the same file
+			std::shared_ptr<std::string> previousPath;
+			LinuxProcessAddressMap map;
+			const char* ptr = begin;
+			while (ptr < end) {
+				const char* lineEnd = static_cast<const char*>(std::memchr(ptr, '\n', end - ptr));
+				if (lineEnd == nullptr) {
+					lineEnd = end;
+				}
+				if (map.parseLine(ptr, lineEnd, pathAllocator, previousPath)) {
+					previousPath = map.getPath();
+					maps.emplace_back(std::move(map));
+					++count;
+				}
+				ptr = lineEnd + 1;
+			}
+			return count;
+		}
+
 		/** Constructor */
 		LinuxProcessAddressMap() :
 			startAddress_(0),
 			endAddress_(0),
 			fileOffset_(0),
-			path_() { }
+			device_(0),
+			inode_(0),
+			path_(),
+			resolver_() { }
+
+		/** Constructor */
+		LinuxProcessAddressMap(
+			std::uintptr_t startAddress,
+			std::uintptr_t endAddress,
+			std::uintptr_t fileOffset,
+			const std::shared_ptr<std::string>& path,
+			std::uint64_t device = 0,
+			std::uint64_t inode = 0,
+			const std::shared_ptr<LinuxExecutableSymbolResolver>& resolver = nullptr) :
+			startAddress_(startAddress),
+			endAddress_(endAddress),
+			fileOffset_(fileOffset),
+			device_(device),
+			inode_(inode),
+			path_(path),
+			resolver_(resolver) { }
+
+	protected:
+		/** Parse device in "major:minor" format, both are hex, return 0 if failed */
+		static std::uint64_t parseDevice(const char* begin, const char* end) {
+			unsigned long long major = 0;
+			unsigned long long minor = 0;
+			const char* ptr = TypeConvertUtils::hexToUnsignedLongLong(begin, end, major);
+			if (ptr == begin || ptr == end || *ptr != ':') {
+				return 0;
+			}
+			TypeConvertUtils::hexToUnsignedLongLong(ptr + 1, end, minor);
+			return makedev(major, minor);
+		}
+
+		/** Return the pointer to the first non blank character */
+		static const char* skipSpaces(const char* ptr, const char* end) {
+			while (ptr < end && (*ptr == ' ' || *ptr == '\t')) {
+				++ptr;
+			}
+			return ptr;
+		}
+
+		/** Return the pointer to the first blank character */
+		static const char* skipField(const char* ptr, const char* end) {
+			while (ptr < end && *ptr != ' ' && *ptr != '\t') {
+				++ptr;
+			}
+			return ptr;
+		}
 
 	protected:
 		std::uintptr_t startAddress_;
 		std::uintptr_t endAddress_;
 		std::uintptr_t fileOffset_;
+		std::uint64_t device_;
+		std::uint64_t inode_;
 		std::shared_ptr<std::string> path_;
+		std::shared_ptr<LinuxExecutableSymbolResolver> resolver_;
 	};
 }
 
@@ -0,0 +1,201 @@
+#pragma once
+#include <unistd.h>
+#include <sys/types.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <regex>
+#include <functional>
+#include <unordered_map>
+#include "LinuxCgroupUtils.hpp"
+#include "LinuxProcessUtils.hpp"
+
+namespace LiveProfiler {
+	/**
+	 * Class used to decide which processes to monitor, with match results cached.
+	 * All predicates added must match, the cheap predicates are evaluated first:
+	 * parent pid, uid, executable name, cgroup, command line, then custom predicates.
+	 *
+	 * Results are cached by (pid, start time), the start time is read from /proc/$pid/stat,
+	 * so a reused pid will be evaluated again.
+	 * Call `beginScan` before each round of filtering (like `listProcesses`),
+	 * then a pid that was seen in the previous round is considered as the same process,
+	 * and costs no syscall at all, new pids are evaluated only once.
+	 * Without `beginScan`, the start time is checked on every call.
+	 * This class is not thread safe.
+	 */
+	class LinuxProcessFilter {
+	public:
+		/** Match processes with the specified parent pid */
+		LinuxProcessFilter& byParentPid(pid_t parentPid) & {
+			parentPid_ = parentPid;
+			hasParentPid_ = true;
+			return *this;
+		}
+
+		/** Match processes running as the specified user */
+		LinuxProcessFilter& byUid(uid_t uid) & {
+			uid_ = uid;
+			hasUid_ = true;
+			return *this;
+		}
+
+		/** Match processes with the specified executable name, see LinuxProcessUtils::isProcessNameMatched */
+		LinuxProcessFilter& byName(const std::string& name) & {
+			name_ = name;
+			return *this;
+		}
+
+		/** Match processes in the specified cgroup (v2) or it's descendants, use full path */
+		LinuxProcessFilter& byCgroup(const std::string& path) & {
+			cgroupPath_ = path;
+			while (cgroupPath_.size() > 1 && cgroupPath_.back() == '/') {
+				cgroupPath_.pop_back();
+			}
+			cgroupMountPoint_ = LinuxCgroupUtils::getCgroupMountPoint();
+			return *this;
+		}
+
+		/** Match processes that command line (arguments separated by space) matches the regex */
+		LinuxProcessFilter& byCmdLine(const std::regex& cmdLineRegex) & {
+			cmdLineRegex_ = cmdLineRegex;
+			hasCmdLineRegex_ = true;
+			return *this;
+		}
+
+		/** Match processes by custom predicate, it's evaluated after all builtin predicates */
+		LinuxProcessFilter& by(const std::function<bool(pid_t)>& predicate) & {
+			predicates_.emplace_back(predicate);
+			return *this;
+		}
+
+		/** Start a new round of filtering, forget processes not seen in the previous round */
+		void beginScan() {
+			++generation_;
+			for (auto it = cache_.begin(); it != cache_.end();) {
+				if (it->second.generation + 1 < generation_) {
+					it = cache_.erase(it);
+				} else {
+					++it;
+				}
+			}
+		}
+
+		/** Determine whether the process is of interest */
+		bool operator()(pid_t pid) {
+			auto it = cache_.find(pid);
+			if (generation_ > 0 && it != cache_.end() && it->second.generation + 1 >= generation_) {
+				// the process is still alive since the previous round
+				it->second.generation = generation_;
+				return it->second.matched;
+			}
+			pid_t parentPid = 0;
+			std::uint64_t startTime = 0;
+			if (!LinuxProcessUtils::readProcessStat(pid, parentPid, startTime)) {
+				if (it != cache_.end()) {
+					cache_.erase(it);
+				}
+				return false;
+			}
+			if (it != cache_.end() && it->second.startTime == startTime) {
+				// same process
+				it->second.generation = generation_;
+				return it->second.matched;
+			}
+			// new process or pid reused
+			auto& result = cache_[pid];
+			result.startTime = startTime;
+			result.generation = generation_;
+			result.matched = evaluate(pid, parentPid);
+			return result.matched;
+		}
+
+		/** Forget the cached result of the process, call it when the process executed a new program */
+		void forget(pid_t pid) {
+			cache_.erase(pid);
+		}
+
+		/** Get how many processes are cached, for diagnostics */
+		std::size_t getCachedCount() const { return cache_.size(); }
+
+		/** Constructor */
+		LinuxProcessFilter() :
+			parentPid_(0),
+			hasParentPid_(false),
+			uid_(0),
+			hasUid_(false),
+			name_(),
+			cgroupPath_(),
+			cgroupMountPoint_(),
+			cmdLineRegex_(),
+			hasCmdLineRegex_(false),
+			predicates_(),
+			cache_(),
+			generation_(0),
+			buffer_() { }
+
+	protected:
+		/** Evaluate all predicates from cheap to expensive */
+		bool evaluate(pid_t pid, pid_t parentPid) {
+			if (hasParentPid_ && parentPid != parentPid_) {
+				return false;
+			}
+			if (hasUid_) {
+				uid_t uid = 0;
+				if (!LinuxProcessUtils::getProcessUid(pid, uid) || uid != uid_) {
+					return false;
+				}
+			}
+			if (!name_.empty() && !LinuxProcessUtils::isProcessNameMatched(pid, name_, buffer_)) {
+				return false;
+			}
+			if (!cgroupPath_.empty() && !isCgroupMatched(pid)) {
+				return false;
+			}
+			if (hasCmdLineRegex_ && (!LinuxProcessUtils::readProcessCmdLine(pid, buffer_) ||
+				!std::regex_search(buffer_, cmdLineRegex_))) {
+				return false;
+			}
+			for (const auto& predicate : predicates_) {
+				if (!predicate(pid)) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		/** Check whether the process is in the cgroup or it's descendants */
+		bool isCgroupMatched(pid_t pid) {
+			buffer_ = LinuxCgroupUtils::getProcessCgroupPath(pid, cgroupMountPoint_);
+			if (buffer_.size() < cgroupPath_.size() ||
+				buffer_.compare(0, cgroupPath_.size(), cgroupPath_) != 0) {
+				return false;
+			}
+			return (buffer_.size() == cgroupPath_.size() ||
+				buffer_[cgroupPath_.size()] == '/' ||
+				cgroupPath_.back() == '/');
+		}
+
+		/** Cached match result of single process */
+		struct CachedResult {
+			std::uint64_t startTime = 0;
+			std::size_t generation = 0;
+			bool matched = false;
+		};
+
+	protected:
+		pid_t parentPid_;
+		bool hasParentPid_;
+		uid_t uid_;
+		bool hasUid_;
+		std::string name_;
+		std::string cgroupPath_;
+		std::string cgroupMountPoint_;
+		std::regex cmdLineRegex_;
+		bool hasCmdLineRegex_;
+		std::vector<std::function<bool(pid_t)>> predicates_;
+		std::unordered_map<pid_t, CachedResult> cache_;
+		std::size_t generation_;
+		std::string buffer_;
+	};
+}
@@ -3,6 +3,8 @@
 #include <dirent.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <fcntl.h>
+#include <cstdint>
 #include <cstdlib>
 #include <cstdio>
 #include <cstring>
@@ -10,6 +12,8 @@
 #include <array>
 #include <memory>
 #include <functional>
+#include <algorithm>
+#include <string>
 #include "../../../Exceptions/ProfilerException.hpp"
 #include "../../Containers/StackBuffer.hpp"
 #include "../../TypeConvertUtils.hpp"
@@ -102,31 +106,118 @@ namespace LiveProfiler {
 		/** Build a filter function that filters processes by name */
 		static std::function<bool(pid_t)> getProcessFilterByName(const std::string& name) {
 			// reuse some variables to avoid memory allocation
-			static std::string prefix("/proc/");
-			static std::string suffix("/exe");
-			return [name, target=std::string(), buf=StackBuffer<128>()](pid_t pid) mutable {
-				// build exe path "/proc/$pid/exe"
-				buf.clear();
-				buf.appendStr(prefix.data(), prefix.size());
-				buf.appendLongLong(pid);
-				buf.appendStr(suffix.data(), suffix.size());
-				buf.appendNullTerminator();
-				// read link target
-				target.resize(PATH_MAX);
-				auto len = ::readlink(buf.data(), &target.front(), target.size() - 1);
-				if (len <= 0) {
-					return false;
+			return [name, target=std::string()](pid_t pid) mutable {
+				return isProcessNameMatched(pid, name, target);
+			};
+		}
+
+		/**
+		 * Check whether the executable name of the process is the specified name.
+		 * Name should be case sensitive and complete.
+		 * `target` is used to store the executable path, reuse it to avoid memory allocation.
+		 */
+		static bool isProcessNameMatched(pid_t pid, const std::string& name, std::string& target) {
+			if (!readProcessExePath(pid, target)) {
+				return false;
+			}
+			return (target.size() > name.size() &&
+				target.compare(target.size() - name.size(), name.size(), name) == 0 &&
+				target[target.size() - name.size() - 1] == '/');
+		}
+
+		/** Read the executable path of the process, return whether successful */
+		static bool readProcessExePath(pid_t pid, std::string& target) {
+			static const std::string suffix("/exe");
+			StackBuffer<128> buf;
+			// build exe path "/proc/$pid/exe"
+			buildProcessPath(buf, pid, suffix);
+			// read link target
+			target.resize(PATH_MAX);
+			auto len = ::readlink(buf.data(), &target.front(), target.size() - 1);
+			if (len <= 0) {
+				target.clear();
+				return false;
+			}
+			target.resize(len);
+			return true;
+		}
+
+		/**
+		 * Read the parent pid and the start time from /proc/$pid/stat, return whether successful.
+		 * The start time is in clock ticks after system boot,
+		 * (pid, start time) can identify a process even if the pid is reused.
+		 */
+		static bool readProcessStat(pid_t pid, pid_t& parentPid, std::uint64_t& startTime) {
+			static const std::string suffix("/stat");
+			StackBuffer<128> buf;
+			std::array<char, 1024> content;
+			buildProcessPath(buf, pid, suffix);
+			auto size = readSmallFile(buf.data(), content.data(), content.size() - 1);
+			if (size <= 0) {
+				return false;
+			}
+			content[size] = '\0';
+			// format: pid (comm) state ppid ... starttime(22th) ...
+			// comm may contains spaces and parentheses, so find the last ')'
+			const char* ptr = std::strrchr(content.data(), ')');
+			if (ptr == nullptr) {
+				return false;
+			}
+			long long parentPidL = 0;
+			unsigned long long startTimeL = 0;
+			for (std::size_t field = 2; *ptr != '\0'; ++ptr) {
+				if (*ptr != ' ') {
+					continue;
 				}
-				target.resize(len);
-				// determine is process name matched
-				// name should be case sensitive and complete
-				if (target.size() > name.size() &&
-					target.compare(target.size() - name.size(), name.size(), name) == 0 &&
-					target[target.size() - name.size() - 1] == '/') {
+				++field;
+				if (field == 4 && !TypeConvertUtils::strToLongLong(ptr + 1, parentPidL)) {
+					return false;
+				} else if (field == 22) {
+					if (!TypeConvertUtils::strToUnsignedLongLong(ptr + 1, startTimeL)) {
+						return false;
+					}
+					parentPid = static_cast<pid_t>(parentPidL);
+					startTime = static_cast<std::uint64_t>(startTimeL);
 					return true;
 				}
+			}
+			return false;
+		}
+
+		/**
+		 * Read the command line of the process, return whether successful.
+		 * Arguments are separated by space instead of null character.
+		 */
+		static bool readProcessCmdLine(pid_t pid, std::string& cmdLine) {
+			static const std::string suffix("/cmdline");
+			StackBuffer<128> buf;
+			buildProcessPath(buf, pid, suffix);
+			cmdLine.resize(4096);
+			auto size = readSmallFile(buf.data(), &cmdLine.front(), cmdLine.size());
+			if (size <= 0) {
+				// kernel threads have empty command line
+				cmdLine.clear();
 				return false;
-			};
+			}
+			cmdLine.resize(size);
+			if (cmdLine.back() == '\0') {
+				cmdLine.pop_back();
+			}
+			std::replace(cmdLine.begin(), cmdLine.end(), '\0', ' ');
+			return true;
+		}
+
+		/** Get the user id of the process, return whether successful */
+		static bool getProcessUid(pid_t pid, uid_t& uid) {
+			static const std::string suffix("");
+			StackBuffer<128> buf;
+			buildProcessPath(buf, pid, suffix);
+			struct ::stat st;
+			if (::stat(buf.data(), &st) != 0) {
+				return false;
+			}
+			uid = st.st_uid;
+			return true;
 		}
 
 		/** Check if the process exists */
@@ -144,6 +235,79 @@ namespace LiveProfiler {
 			}
 			return S_ISDIR(st.st_mode);
 		}
+
+		/**
+		 * Find the path can access the file mapped by the process from the current mount namespace.
+		 * The path in /proc/$pid/maps is in the mount namespace of the process,
+		 * for processes in containers it may not exist or be a different file in current namespace.
+		 * Candidates are tried in order and the first one has the same (device, inode) is used:
+		 * - /proc/$pid/root$path
+		 * - /proc/$pid/map_files/$start-$end (requires CAP_SYS_ADMIN or CAP_CHECKPOINT_RESTORE)
+		 * - $path
+		 * If inode is 0 or no candidate matches (e.g. overlayfs reports different device),
+		 * the first regular file is used.
+		 * Return false if no candidate is accessible, and `result` will be `path`.
+		 */
+		static bool findMappedFilePath(
+			pid_t pid,
+			const std::string& path,
+			std::uint64_t startAddress,
+			std::uint64_t endAddress,
+			std::uint64_t device,
+			std::uint64_t inode,
+			std::string& result) {
+			std::array<std::string, 3> candidates;
+			std::array<char, 64> range;
+			if (!path.empty() && path.front() == '/') {
+				candidates[0].append("/proc/").append(std::to_string(pid)).append("/root").append(path);
+			}
+			auto rangeSize = std::snprintf(range.data(), range.size(), "%llx-%llx",
+				static_cast<unsigned long long>(startAddress), static_cast<unsigned long long>(endAddress));
+			if (startAddress < endAddress && rangeSize > 0) {
+				candidates[1].append("/proc/").append(std::to_string(pid)).append("/map_files/")
+					.append(range.data(), static_cast<std::size_t>(rangeSize));
+			}
+			candidates[2] = path;
+			const std::string* fallback = nullptr;
+			struct ::stat st;
+			for (const auto& candidate : candidates) {
+				if (candidate.empty() || ::stat(candidate.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+					continue;
+				}
+				if (inode != 0 && static_cast<std::uint64_t>(st.st_dev) == device &&
+					static_cast<std::uint64_t>(st.st_ino) == inode) {
+					result = candidate;
+					return true;
+				} else if (fallback == nullptr) {
+					fallback = &candidate;
+				}
+			}
+			result = (fallback == nullptr) ? path : *fallback;
+			return fallback != nullptr;
+		}
+
+	protected:
+		/** Build path "/proc/$pid$suffix" with null terminator */
+		template <std::size_t Size>
+		static void buildProcessPath(StackBuffer<Size>& buf, pid_t pid, const std::string& suffix) {
+			static const std::string prefix("/proc/");
+			buf.clear();
+			buf.appendStr(prefix.data(), prefix.size());
+			buf.appendLongLong(pid);
+			buf.appendStr(suffix.data(), suffix.size());
+			buf.appendNullTerminator();
+		}
+
+		/** Read file into buffer with single read, return the size read or -1 if failed */
+		static ::ssize_t readSmallFile(const char* path, char* buf, std::size_t size) {
+			int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+			if (fd < 0) {
+				return -1;
+			}
+			auto ret = ::read(fd, buf, size);
+			::close(fd);
+			return ret;
+		}
 	};
 }
 
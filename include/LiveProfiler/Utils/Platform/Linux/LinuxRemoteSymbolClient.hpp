@@ -0,0 +1,278 @@
+#pragma once
+#include <unistd.h>
+#include <chrono>
+#include <memory>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <unordered_map>
+#include "../../../Models/Shared/SymbolName.hpp"
+#include "../../Containers/LruCache.hpp"
+#include "LinuxElfUtils.hpp"
+#include "LinuxProcessAddressMap.hpp"
+#include "LinuxProcessUtils.hpp"
+#include "LinuxRemoteSymbolProtocol.hpp"
+#include "LinuxSocketUtils.hpp"
+
+namespace LiveProfiler {
+	/**
+	 * Class used to resolve symbol names by a remote symbol server (see LinuxRemoteSymbolServer),
+	 * so the symbol tables of executable files don't need to be loaded in every agent.
+	 * Files are identified by their GNU build-id, only the build-id of each mapped file is read locally,
+	 * queries are sent as (build-id, file offset) in batches, one round trip for each batch.
+	 *
+	 * Answers are kept in a LRU cache with fixed capacity, the same symbol of the same file
+	 * is represented by the same SymbolName instance while it's referenced, so analyzers can aggregate on it.
+	 * If the server is unreachable, queries resolve to nullptr and are not cached,
+	 * reconnecting is tried at most once per second.
+	 * This class is not thread safe.
+	 */
+	class LinuxRemoteSymbolClient {
+	public:
+		/** Default parameters */
+		static const std::size_t DefaultCacheCapacity = 65536;
+		static const std::size_t DefaultTimeout = 5000;
+		static const std::size_t DefaultReconnectInterval = 1000;
+
+		/** Query of single address, path is the path of the mapping, it's used as hint and in symbol names */
+		struct Query {
+			std::shared_ptr<std::string> buildId;
+			std::shared_ptr<std::string> path;
+			std::size_t offset;
+		};
+
+		/** Getters */
+		const std::string& getAddress() const& { return address_; }
+		bool isConnected() const { return fd_ >= 0; }
+		std::size_t getRequestCount() const { return requestCount_; }
+		std::size_t getCacheSize() const { return cache_.size(); }
+
+		/** Set the timeout of connect, send and receive, only affects connections opened after the call */
+		void setTimeout(std::chrono::milliseconds timeout) {
+			timeout_ = timeout;
+		}
+
+		/**
+		 * Get the build-id of the file mapped by the process, return nullptr if the file has no build-id,
+		 * such files can't be resolved remotely. The result is remembered by (device, inode) of the mapping.
+		 */
+		const std::shared_ptr<std::string>& getBuildId(pid_t pid, const LinuxProcessAddressMap& map) {
+			static const std::shared_ptr<std::string> empty;
+			if (map.getInode() == 0 || map.getPath() == nullptr) {
+				return empty;
+			}
+			auto fileId = std::make_pair(map.getDevice(), map.getInode());
+			auto it = fileIdToBuildId_.find(fileId);
+			if (it != fileIdToBuildId_.end()) {
+				return it->second;
+			}
+			std::shared_ptr<std::string> buildId;
+			std::string filePath;
+			std::string buildIdValue;
+			LinuxProcessUtils::findMappedFilePath(pid, *map.getPath(),
+				map.getStartAddress(), map.getEndAddress(), map.getDevice(), map.getInode(), filePath);
+			if (LinuxElfUtils::readBuildId(filePath, buildIdValue)) {
+				// build-ids are shared so they can be compared by address
+				auto& internedBuildId = buildIds_[buildIdValue];
+				if (internedBuildId == nullptr) {
+					internedBuildId = std::make_shared<std::string>(buildIdValue);
+				}
+				buildId = internedBuildId;
+			}
+			return fileIdToBuildId_.emplace(fileId, buildId).first->second;
+		}
+
+		/**
+		 * Find the answer of (build-id, offset) from cache, the build-id should be returned by `getBuildId`.
+		 * Return false if it's not cached, `result` may be nullptr if no symbol is found by server.
+		 */
+		bool find(const std::shared_ptr<std::string>& buildId, std::size_t offset, std::shared_ptr<SymbolName>& result) {
+			auto* cached = cache_.get(std::make_pair(buildId.get(), offset));
+			if (cached == nullptr) {
+				return false;
+			}
+			result = *cached;
+			return true;
+		}
+
+		/**
+		 * Resolve queries in one round trip, `results` will have the same size and order as `queries`.
+		 * Answers are added to the cache.
+		 * Return false if the server is unreachable, all results will be nullptr.
+		 */
+		bool resolve(const std::vector<Query>& queries, std::vector<std::shared_ptr<SymbolName>>& results) {
+			results.assign(queries.size(), nullptr);
+			if (queries.empty()) {
+				return true;
+			}
+			// group queries by file, the response is in the order of request
+			order_.resize(queries.size());
+			for (std::size_t i = 0; i < queries.size(); ++i) {
+				order_[i] = i;
+			}
+			std::stable_sort(order_.begin(), order_.end(), [&queries](auto a, auto b) {
+				return queries[a].buildId < queries[b].buildId;
+			});
+			LinuxRemoteSymbolProtocol::beginFrame(request_);
+			auto groupCountOffset = request_.size();
+			std::uint32_t groupCount = 0;
+			LinuxRemoteSymbolProtocol::append<std::uint32_t>(request_, 0);
+			for (std::size_t start = 0, end = 0; start < order_.size(); start = end) {
+				const auto& query = queries[order_[start]];
+				end = start;
+				while (end < order_.size() && queries[order_[end]].buildId == query.buildId) {
+					++end;
+				}
+				LinuxRemoteSymbolProtocol::appendString<std::uint16_t>(request_, *query.buildId);
+				LinuxRemoteSymbolProtocol::appendString<std::uint16_t>(request_, *query.path);
+				LinuxRemoteSymbolProtocol::append<std::uint32_t>(request_, static_cast<std::uint32_t>(end - start));
+				for (std::size_t i = start; i < end; ++i) {
+					LinuxRemoteSymbolProtocol::append<std::uint64_t>(request_, queries[order_[i]].offset);
+				}
+				++groupCount;
+			}
+			std::memcpy(&request_[groupCountOffset], &groupCount, sizeof(groupCount));
+			if (!LinuxRemoteSymbolProtocol::endFrame(request_) || !connect()) {
+				return false;
+			}
+			if (!LinuxSocketUtils::sendAll(fd_, request_.data(), request_.size()) ||
+				!LinuxRemoteSymbolProtocol::receiveFrame(fd_, response_)) {
+				close();
+				return false;
+			}
+			++requestCount_;
+			// parse all results before applying them, a broken response should not pollute the cache
+			LinuxRemoteSymbolProtocol::Reader reader(response_.data(), response_.data() + response_.size());
+			if (reader.read<std::uint32_t>() != queries.size()) {
+				close();
+				return false;
+			}
+			for (auto index : order_) {
+				const auto& query = queries[index];
+				auto start = static_cast<std::size_t>(reader.read<std::uint64_t>());
+				auto end = static_cast<std::size_t>(reader.read<std::uint64_t>());
+				reader.readString<std::uint32_t>(name_);
+				if (reader.failed) {
+					results.assign(queries.size(), nullptr);
+					close();
+					return false;
+				}
+				if (!name_.empty()) {
+					results[index] = getSymbolName(query, start, end);
+				}
+			}
+			for (std::size_t i = 0; i < queries.size(); ++i) {
+				cache_.set(std::make_pair(queries[i].buildId.get(), queries[i].offset), results[i]);
+			}
+			return true;
+		}
+
+		/** Constructor, see LinuxSocketUtils for the address format */
+		explicit LinuxRemoteSymbolClient(
+			const std::string& address,
+			std::size_t cacheCapacity = DefaultCacheCapacity) :
+			address_(address),
+			fd_(-1),
+			timeout_(std::chrono::milliseconds(+DefaultTimeout)),
+			connectFailed_(),
+			reconnectInterval_(std::chrono::milliseconds(+DefaultReconnectInterval)),
+			requestCount_(0),
+			fileIdToBuildId_(),
+			buildIds_(),
+			cache_(cacheCapacity),
+			symbolNames_(),
+			symbolNamesPurgeSize_(cacheCapacity),
+			order_(),
+			request_(),
+			response_(),
+			name_() { }
+
+		/** Destructor */
+		~LinuxRemoteSymbolClient() {
+			close();
+		}
+
+	protected:
+		/** Disable copy */
+		LinuxRemoteSymbolClient(const LinuxRemoteSymbolClient&) = delete;
+		LinuxRemoteSymbolClient& operator=(const LinuxRemoteSymbolClient&) = delete;
+
+		/** (build-id, offset), build-id is compared by address */
+		using KeyType = std::pair<const std::string*, std::size_t>;
+
+		/** Hash function for KeyType and (device, inode) */
+		struct PairHash {
+			template <class A, class B>
+			std::size_t operator()(const std::pair<A, B>& key) const {
+				return std::hash<A>()(key.first) ^ std::hash<B>()(key.second * 0x9e3779b97f4a7c15ULL);
+			}
+		};
+
+		/** Connect to the server if not connected, return false if failed */
+		bool connect() {
+			if (fd_ >= 0) {
+				return true;
+			}
+			auto now = std::chrono::high_resolution_clock::now();
+			if (connectFailed_ != std::chrono::high_resolution_clock::time_point() &&
+				now - connectFailed_ < reconnectInterval_) {
+				return false;
+			}
+			fd_ = LinuxSocketUtils::connect(address_, timeout_);
+			connectFailed_ = (fd_ < 0) ? now : std::chrono::high_resolution_clock::time_point();
+			return fd_ >= 0;
+		}
+
+		/** Close the connection, it will be reopened by the next request */
+		void close() {
+			if (fd_ >= 0) {
+				::close(fd_);
+			}
+			fd_ = -1;
+		}
+
+		/** Get the symbol name instance for the symbol [start, end) in the file, create if not exists */
+		std::shared_ptr<SymbolName> getSymbolName(const Query& query, std::size_t start, std::size_t end) {
+			auto& weakSymbolName = symbolNames_[std::make_pair(query.buildId.get(), start)];
+			auto symbolName = weakSymbolName.lock();
+			if (symbolName == nullptr || symbolName->getOriginalName() != name_) {
+				symbolName = std::make_shared<SymbolName>(name_, query.path);
+				symbolName->setFileOffsetStart(start);
+				symbolName->setFileOffsetEnd(end);
+				weakSymbolName = symbolName;
+			}
+			// remove symbol names no longer referenced
+			if (symbolNames_.size() > symbolNamesPurgeSize_ * 2) {
+				for (auto it = symbolNames_.begin(); it != symbolNames_.end();) {
+					it = it->second.expired() ? symbolNames_.erase(it) : std::next(it);
+				}
+				symbolNamesPurgeSize_ = std::max(symbolNames_.size(), cache_.capacity());
+			}
+			return symbolName;
+		}
+
+	protected:
+		std::string address_;
+		int fd_;
+		std::chrono::milliseconds timeout_;
+		std::chrono::high_resolution_clock::time_point connectFailed_;
+		std::chrono::high_resolution_clock::duration reconnectInterval_;
+		std::size_t requestCount_;
+		// (device, inode) -> build-id, nullptr if the file has no build-id
+		std::unordered_map<std::pair<std::uint64_t, std::uint64_t>,
+			std::shared_ptr<std::string>, PairHash> fileIdToBuildId_;
+		std::unordered_map<std::string, std::shared_ptr<std::string>> buildIds_;
+		// (build-id, offset) -> answer
+		LruCache<KeyType, std::shared_ptr<SymbolName>, PairHash> cache_;
+		// (build-id, symbol start) -> symbol name
+		std::unordered_map<KeyType, std::weak_ptr<SymbolName>, PairHash> symbolNames_;
+		std::size_t symbolNamesPurgeSize_;
+		std::vector<std::size_t> order_;
+		std::string request_;
+		std::string response_;
+		std::string name_;
+	};
+}
+
@@ -0,0 +1,124 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <algorithm>
+#include "LinuxSocketUtils.hpp"
+
+namespace LiveProfiler {
+	/**
+	 * Wire format between LinuxRemoteSymbolClient and LinuxRemoteSymbolServer.
+	 * Each message is a frame: magic (u32), payload size (u32), payload.
+	 * Integers are little endian, strings are prefixed by their size.
+	 *
+	 * Request payload, offsets are grouped by file:
+	 * group count (u32), then for each group:
+	 *   build-id size (u16), build-id (lower case hex),
+	 *   path size (u16), path (hint for server on the same host),
+	 *   offset count (u32), file offsets (u64 each)
+	 * Response payload, one result for each offset in the same order as request:
+	 * result count (u32), then for each result:
+	 *   symbol file offset start (u64), end (u64), name size (u32), original name (empty if not found)
+	 */
+	class LinuxRemoteSymbolProtocol {
+	public:
+		/** "LPS1" */
+		static const std::uint32_t Magic = 0x3153504c;
+		static const std::size_t HeaderSize = 8;
+		/** Frames larger than this are treated as broken */
+		static const std::size_t MaxPayloadSize = 64 * 1024 * 1024;
+
+		/** Bounds checked reader of payload */
+		struct Reader {
+			const char* ptr;
+			const char* end;
+			bool failed;
+
+			Reader(const char* begin, const char* endValue) :
+				ptr(begin),
+				end(endValue),
+				failed(false) { }
+
+			/** Read integer, return 0 and mark as failed if there no enough data */
+			template <class T>
+			T read() {
+				T value = 0;
+				if (failed || static_cast<std::size_t>(end - ptr) < sizeof(T)) {
+					failed = true;
+					return 0;
+				}
+				// little endian only, same as LinuxEhFrameUtils
+				std::memcpy(&value, ptr, sizeof(T));
+				ptr += sizeof(T);
+				return value;
+			}
+
+			/** Read string with the size prefix of type T */
+			template <class T>
+			void readString(std::string& value) {
+				auto size = static_cast<std::size_t>(read<T>());
+				if (failed || static_cast<std::size_t>(end - ptr) < size) {
+					failed = true;
+					value.clear();
+					return;
+				}
+				value.assign(ptr, size);
+				ptr += size;
+			}
+		};
+
+		/** Start a frame in buffer, the header is filled by `endFrame` */
+		static void beginFrame(std::string& buffer) {
+			buffer.assign(HeaderSize, '\0');
+		}
+
+		/** Fill the header of the frame, return false if the payload is too large */
+		static bool endFrame(std::string& buffer) {
+			auto payloadSize = buffer.size() - HeaderSize;
+			if (payloadSize > MaxPayloadSize) {
+				return false;
+			}
+			auto magic = Magic;
+			auto size = static_cast<std::uint32_t>(payloadSize);
+			std::memcpy(&buffer[0], &magic, sizeof(magic));
+			std::memcpy(&buffer[sizeof(magic)], &size, sizeof(size));
+			return true;
+		}
+
+		/** Append integer to buffer */
+		template <class T>
+		static void append(std::string& buffer, T value) {
+			buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+		}
+
+		/** Append string with the size prefix of type T, the string is truncated if it's too long */
+		template <class T>
+		static void appendString(std::string& buffer, const std::string& value) {
+			auto size = static_cast<T>(std::min<std::size_t>(value.size(), static_cast<T>(-1)));
+			append<T>(buffer, size);
+			buffer.append(value.data(), size);
+		}
+
+		/** Parse the frame header, return false if it's not a valid frame */
+		static bool parseHeader(const char* header, std::size_t& payloadSize) {
+			std::uint32_t magic = 0;
+			std::uint32_t size = 0;
+			std::memcpy(&magic, header, sizeof(magic));
+			std::memcpy(&size, header + sizeof(magic), sizeof(size));
+			payloadSize = size;
+			return magic == Magic && payloadSize <= MaxPayloadSize;
+		}
+
+		/** Receive a frame from the blocking socket, return false if failed or the frame is invalid */
+		static bool receiveFrame(int fd, std::string& payload) {
+			char header[HeaderSize];
+			std::size_t payloadSize = 0;
+			if (!LinuxSocketUtils::receiveAll(fd, header, HeaderSize) || !parseHeader(header, payloadSize)) {
+				return false;
+			}
+			payload.resize(payloadSize);
+			return payloadSize == 0 || LinuxSocketUtils::receiveAll(fd, &payload[0], payloadSize);
+		}
+	};
+}
+
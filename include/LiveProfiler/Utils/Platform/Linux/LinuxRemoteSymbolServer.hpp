@@ -0,0 +1,301 @@
+#pragma once
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <cerrno>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "../../../Models/Shared/SymbolName.hpp"
+#include "LinuxElfUtils.hpp"
+#include "LinuxEpollDescriptor.hpp"
+#include "LinuxExecutableSymbolResolver.hpp"
+#include "LinuxRemoteSymbolProtocol.hpp"
+#include "LinuxSocketUtils.hpp"
+#include "LinuxSymbolTableCache.hpp"
+
+namespace LiveProfiler {
+	/**
+	 * Reference symbol server for LinuxRemoteSymbolClient, it answers (build-id, offset) queries
+	 * with LinuxExecutableSymbolResolver, so it works fully offline with the files on local disk.
+	 * The file of a build-id is found from the files added by `addFile`,
+	 * or from the path sent by client if the file at the path has the same build-id
+	 * (it's the case when the server runs on the same host as agents).
+	 * Path hints are only used on unix domain sockets by default, because they let clients
+	 * make the server read any file it can access, use `setUsePathHints` to change it.
+	 * Each file is loaded on the first query and kept until the server is destroyed,
+	 * use the on disk cache to speed up loading after restart.
+	 *
+	 * Requests are handled on the thread calling `poll` or `run`, by a single epoll loop,
+	 * `stop` can be called from other threads.
+	 */
+	class LinuxRemoteSymbolServer {
+	public:
+		/** Default parameters */
+		static const std::size_t DefaultTimeout = 5000;
+		static const std::size_t DefaultPollInterval = 100;
+
+		/** Getters */
+		const std::string& getAddress() const& { return address_; }
+		std::size_t getResolverCount() const { return resolvers_.size(); }
+		std::size_t getConnectionCount() const { return connections_.size(); }
+		std::size_t getRequestCount() const { return requestCount_; }
+		bool isUsingPathHints() const { return usePathHints_; }
+
+		/** Set whether to find files by the paths sent by clients, default is true only for unix domain socket */
+		void setUsePathHints(bool usePathHints) {
+			usePathHints_ = usePathHints;
+		}
+
+		/** Add the file can be found by it's build-id, return false if the file has no build-id */
+		bool addFile(const std::string& path) {
+			if (!LinuxElfUtils::readBuildId(path, buildId_)) {
+				return false;
+			}
+			files_[buildId_] = path;
+			return true;
+		}
+
+		/** Accept connections and handle requests, wait at most `timeout`, return how many requests are handled */
+		template <class Rep, class Period>
+		std::size_t poll(std::chrono::duration<Rep, Period> timeout) {
+			std::size_t handledCount = 0;
+			for (const auto& event : epoll_.wait(timeout)) {
+				auto fd = static_cast<int>(event.data.u64);
+				if (fd == listenFd_) {
+					accept();
+				} else {
+					handledCount += receive(fd);
+				}
+			}
+			requestCount_ += handledCount;
+			return handledCount;
+		}
+
+		/** Handle requests until `stop` is called */
+		void run() {
+			while (!stopped_.load()) {
+				poll(std::chrono::milliseconds(+DefaultPollInterval));
+			}
+		}
+
+		/** Make `run` return, it's thread safe */
+		void stop() {
+			stopped_ = true;
+		}
+
+		/**
+		 * Constructor, listen on the address, see LinuxSocketUtils for the address format,
+		 * port 0 means assigned by system, use `getAddress` to get the actual address.
+		 * Throws ProfilerException if failed.
+		 */
+		explicit LinuxRemoteSymbolServer(
+			const std::string& address,
+			const std::shared_ptr<LinuxSymbolTableCache>& cache = nullptr,
+			const std::string& debugDirectory = LinuxElfUtils::getDefaultDebugDirectory()) :
+			address_(),
+			listenFd_(-1),
+			epoll_(),
+			connections_(),
+			cache_(cache),
+			debugDirectory_(debugDirectory),
+			files_(),
+			resolvers_(),
+			usePathHints_(false),
+			stopped_(false),
+			requestCount_(0),
+			offsets_(),
+			results_(),
+			response_(),
+			buildId_(),
+			path_() {
+			listenFd_ = LinuxSocketUtils::listen(address, address_);
+			usePathHints_ = LinuxSocketUtils::isUnixAddress(address_);
+			epoll_.add(listenFd_, EPOLLIN, static_cast<std::uint64_t>(listenFd_));
+		}
+
+		/** Destructor */
+		~LinuxRemoteSymbolServer() {
+			for (auto& pair : connections_) {
+				::close(pair.first);
+			}
+			::close(listenFd_);
+			if (LinuxSocketUtils::isUnixAddress(address_)) {
+				::unlink(address_.c_str());
+			}
+		}
+
+	protected:
+		/** Disable copy */
+		LinuxRemoteSymbolServer(const LinuxRemoteSymbolServer&) = delete;
+		LinuxRemoteSymbolServer& operator=(const LinuxRemoteSymbolServer&) = delete;
+
+		/** Accept all pending connections */
+		void accept() {
+			while (true) {
+				int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+				if (fd < 0 && errno == EINTR) {
+					continue;
+				} else if (fd < 0) {
+					break;
+				}
+				// responses are sent in blocking mode, don't let a stuck client block others forever
+				LinuxSocketUtils::setTimeout(fd, std::chrono::milliseconds(+DefaultTimeout));
+				epoll_.add(fd, EPOLLIN, static_cast<std::uint64_t>(fd));
+				connections_[fd].clear();
+			}
+		}
+
+		/**
+		 * Read available data from connection and handle complete requests, return how many are handled.
+		 * Reading stops once a complete frame is buffered, the rest is read when the socket is polled again,
+		 * so the buffer of a connection never exceeds the size of a single frame.
+		 */
+		std::size_t receive(int fd) {
+			auto it = connections_.find(fd);
+			if (it == connections_.end()) {
+				return 0;
+			}
+			auto& input = it->second;
+			char buffer[65536];
+			bool closed = false;
+			std::size_t payloadSize = 0;
+			while (true) {
+				// read the header first, then the rest of the frame
+				std::size_t frameSize = LinuxRemoteSymbolProtocol::HeaderSize;
+				if (input.size() >= frameSize) {
+					if (!LinuxRemoteSymbolProtocol::parseHeader(input.data(), payloadSize)) {
+						break; // invalid frame, the connection is closed below
+					}
+					frameSize += payloadSize;
+				}
+				if (input.size() >= frameSize) {
+					break;
+				}
+				auto ret = ::recv(fd, buffer, std::min(sizeof(buffer), frameSize - input.size()), MSG_DONTWAIT);
+				if (ret < 0 && errno == EINTR) {
+					continue;
+				} else if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+					break;
+				} else if (ret <= 0) {
+					closed = true;
+					break;
+				}
+				input.append(buffer, static_cast<std::size_t>(ret));
+			}
+			std::size_t handledCount = 0;
+			std::size_t consumed = 0;
+			while (!closed && input.size() - consumed >= LinuxRemoteSymbolProtocol::HeaderSize) {
+				if (!LinuxRemoteSymbolProtocol::parseHeader(input.data() + consumed, payloadSize)) {
+					closed = true;
+				} else if (input.size() - consumed - LinuxRemoteSymbolProtocol::HeaderSize < payloadSize) {
+					break;
+				} else {
+					const char* payload = input.data() + consumed + LinuxRemoteSymbolProtocol::HeaderSize;
+					closed = !handle(payload, payload + payloadSize) ||
+						!LinuxSocketUtils::sendAll(fd, response_.data(), response_.size());
+					consumed += LinuxRemoteSymbolProtocol::HeaderSize + payloadSize;
+					++handledCount;
+				}
+			}
+			if (closed) {
+				epoll_.del(fd);
+				::close(fd);
+				connections_.erase(it);
+			} else {
+				input.erase(0, consumed);
+			}
+			return handledCount;
+		}
+
+		/** Build the response of the request in `response_`, return false if the request is invalid */
+		bool handle(const char* begin, const char* end) {
+			LinuxRemoteSymbolProtocol::Reader reader(begin, end);
+			LinuxRemoteSymbolProtocol::beginFrame(response_);
+			auto resultCountOffset = response_.size();
+			std::uint32_t resultCount = 0;
+			LinuxRemoteSymbolProtocol::append<std::uint32_t>(response_, 0);
+			auto groupCount = reader.read<std::uint32_t>();
+			for (std::uint32_t group = 0; group < groupCount && !reader.failed; ++group) {
+				reader.readString<std::uint16_t>(buildId_);
+				reader.readString<std::uint16_t>(path_);
+				auto count = static_cast<std::size_t>(reader.read<std::uint32_t>());
+				if (reader.failed || count > static_cast<std::size_t>(reader.end - reader.ptr) / sizeof(std::uint64_t)) {
+					return false;
+				}
+				offsets_.resize(count);
+				for (auto& offset : offsets_) {
+					offset = static_cast<std::size_t>(reader.read<std::uint64_t>());
+				}
+				results_.assign(count, nullptr);
+				auto resolver = getResolver();
+				if (resolver != nullptr) {
+					resolver->resolve(offsets_.data(), count, results_.data());
+				}
+				for (const auto& symbolName : results_) {
+					if (symbolName == nullptr) {
+						LinuxRemoteSymbolProtocol::append<std::uint64_t>(response_, 0);
+						LinuxRemoteSymbolProtocol::append<std::uint64_t>(response_, 0);
+						LinuxRemoteSymbolProtocol::append<std::uint32_t>(response_, 0);
+					} else {
+						LinuxRemoteSymbolProtocol::append<std::uint64_t>(response_, symbolName->getFileOffsetStart());
+						LinuxRemoteSymbolProtocol::append<std::uint64_t>(response_, symbolName->getFileOffsetEnd());
+						LinuxRemoteSymbolProtocol::appendString<std::uint32_t>(response_, symbolName->getOriginalName());
+					}
+				}
+				resultCount += static_cast<std::uint32_t>(count);
+			}
+			std::memcpy(&response_[resultCountOffset], &resultCount, sizeof(resultCount));
+			return !reader.failed && LinuxRemoteSymbolProtocol::endFrame(response_);
+		}
+
+		/** Get the resolver for `buildId_`, `path_` is tried if the build-id is unknown, return nullptr if not found */
+		std::shared_ptr<LinuxExecutableSymbolResolver> getResolver() {
+			auto it = resolvers_.find(buildId_);
+			if (it != resolvers_.end()) {
+				return it->second;
+			}
+			std::string filePath;
+			std::string pathBuildId;
+			auto fileIt = files_.find(buildId_);
+			if (fileIt != files_.end()) {
+				filePath = fileIt->second;
+			} else if (usePathHints_ && !buildId_.empty() && !path_.empty() && path_.front() == '/' &&
+				LinuxElfUtils::readBuildId(path_, pathBuildId) && pathBuildId == buildId_) {
+				filePath = path_;
+			} else {
+				return nullptr; // not cached, the file may be added or sent by other clients later
+			}
+			auto resolver = std::make_shared<LinuxExecutableSymbolResolver>(
+				std::make_shared<std::string>(filePath), cache_, debugDirectory_, filePath);
+			resolvers_.emplace(buildId_, resolver);
+			return resolver;
+		}
+
+	protected:
+		std::string address_;
+		int listenFd_;
+		LinuxEpollDescriptor epoll_;
+		// fd -> received data not handled yet
+		std::unordered_map<int, std::string> connections_;
+		std::shared_ptr<LinuxSymbolTableCache> cache_;
+		std::string debugDirectory_;
+		// build-id -> path
+		std::unordered_map<std::string, std::string> files_;
+		// build-id -> resolver
+		std::unordered_map<std::string, std::shared_ptr<LinuxExecutableSymbolResolver>> resolvers_;
+		bool usePathHints_;
+		std::atomic<bool> stopped_;
+		std::size_t requestCount_;
+		std::vector<std::size_t> offsets_;
+		std::vector<std::shared_ptr<SymbolName>> results_;
+		std::string response_;
+		std::string buildId_;
+		std::string path_;
+	};
+}
+
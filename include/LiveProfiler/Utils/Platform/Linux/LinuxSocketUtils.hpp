@@ -0,0 +1,223 @@
+#pragma once
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include "../../../Exceptions/ProfilerException.hpp"
+
+namespace LiveProfiler {
+	/**
+	 * Static utility functions releated to stream sockets.
+	 * Address format:
+	 * - Path starts with '/' is an unix domain socket, e.g. "/run/live-profiler.sock"
+	 * - Otherwise it's a tcp address "host:port", e.g. "127.0.0.1:7070" or "[::1]:7070"
+	 */
+	class LinuxSocketUtils {
+	public:
+		/** Return whether the address is an unix domain socket */
+		static bool isUnixAddress(const std::string& address) {
+			return !address.empty() && address.front() == '/';
+		}
+
+		/**
+		 * Connect to the address, send and receive will fail after `timeout` (0 means no timeout).
+		 * Return the blocking socket, or -1 with errno set if failed.
+		 */
+		static int connect(const std::string& address, std::chrono::milliseconds timeout) {
+			if (isUnixAddress(address)) {
+				::sockaddr_un unixAddress = {};
+				if (!makeUnixAddress(address, unixAddress)) {
+					errno = ENAMETOOLONG;
+					return -1;
+				}
+				int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+				if (fd >= 0 && (!setTimeout(fd, timeout) ||
+					::connect(fd, reinterpret_cast<::sockaddr*>(&unixAddress), sizeof(unixAddress)) != 0)) {
+					closePreserveErrno(fd);
+					return -1;
+				}
+				return fd;
+			}
+			::addrinfo* addresses = resolve(address, false);
+			if (addresses == nullptr) {
+				return -1;
+			}
+			int fd = -1;
+			for (auto* info = addresses; info != nullptr && fd < 0; info = info->ai_next) {
+				fd = ::socket(info->ai_family, info->ai_socktype | SOCK_CLOEXEC, info->ai_protocol);
+				if (fd >= 0 && (!setTimeout(fd, timeout) ||
+					::connect(fd, info->ai_addr, info->ai_addrlen) != 0)) {
+					closePreserveErrno(fd);
+					fd = -1;
+				}
+			}
+			::freeaddrinfo(addresses);
+			if (fd >= 0) {
+				// requests are small and latency matters
+				int enabled = 1;
+				::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+			}
+			return fd;
+		}
+
+		/**
+		 * Listen on the address, the socket is non blocking.
+		 * Existing unix socket file at the path is replaced.
+		 * `boundAddress` is the actual address, for example the port is assigned if port 0 is used.
+		 * Throws ProfilerException if failed.
+		 */
+		static int listen(const std::string& address, std::string& boundAddress) {
+			int fd = -1;
+			if (isUnixAddress(address)) {
+				::sockaddr_un unixAddress = {};
+				if (!makeUnixAddress(address, unixAddress)) {
+					throw ProfilerException(ENAMETOOLONG, "[LinuxSocketUtils::listen] " + address);
+				}
+				struct ::stat st;
+				if (::lstat(address.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+					::unlink(address.c_str());
+				}
+				fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+				if (fd < 0 || ::bind(fd, reinterpret_cast<::sockaddr*>(&unixAddress), sizeof(unixAddress)) != 0) {
+					closePreserveErrno(fd);
+					throw ProfilerException(errno, "[LinuxSocketUtils::listen] bind " + address);
+				}
+				boundAddress = address;
+			} else {
+				::addrinfo* addresses = resolve(address, true);
+				if (addresses == nullptr) {
+					throw ProfilerException(errno, "[LinuxSocketUtils::listen] resolve " + address);
+				}
+				int enabled = 1;
+				fd = ::socket(addresses->ai_family, addresses->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+				bool bound = fd >= 0 &&
+					::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(enabled)) == 0 &&
+					::bind(fd, addresses->ai_addr, addresses->ai_addrlen) == 0;
+				auto err = errno;
+				::freeaddrinfo(addresses);
+				if (!bound) {
+					if (fd >= 0) {
+						::close(fd);
+					}
+					throw ProfilerException(err, "[LinuxSocketUtils::listen] bind " + address);
+				}
+				boundAddress = getSocketAddress(fd);
+			}
+			if (::listen(fd, SOMAXCONN) != 0) {
+				closePreserveErrno(fd);
+				throw ProfilerException(errno, "[LinuxSocketUtils::listen] listen " + address);
+			}
+			return fd;
+		}
+
+		/** Send all bytes, retry if interrupted, return false if failed */
+		static bool sendAll(int fd, const char* data, std::size_t size) {
+			while (size > 0) {
+				auto ret = ::send(fd, data, size, MSG_NOSIGNAL);
+				if (ret < 0 && errno == EINTR) {
+					continue;
+				} else if (ret <= 0) {
+					return false;
+				}
+				data += ret;
+				size -= static_cast<std::size_t>(ret);
+			}
+			return true;
+		}
+
+		/** Receive exactly `size` bytes, retry if interrupted, return false if failed or closed by peer */
+		static bool receiveAll(int fd, char* data, std::size_t size) {
+			while (size > 0) {
+				auto ret = ::recv(fd, data, size, 0);
+				if (ret < 0 && errno == EINTR) {
+					continue;
+				} else if (ret <= 0) {
+					return false;
+				}
+				data += ret;
+				size -= static_cast<std::size_t>(ret);
+			}
+			return true;
+		}
+
+		/** Set the send and receive timeout, 0 means no timeout, return false if failed */
+		static bool setTimeout(int fd, std::chrono::milliseconds timeout) {
+			::timeval value = {};
+			value.tv_sec = static_cast<::time_t>(timeout.count() / 1000);
+			value.tv_usec = static_cast<::suseconds_t>((timeout.count() % 1000) * 1000);
+			return ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &value, sizeof(value)) == 0 &&
+				::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &value, sizeof(value)) == 0;
+		}
+
+	protected:
+		/** Build the address of unix domain socket, return false if the path is too long */
+		static bool makeUnixAddress(const std::string& path, ::sockaddr_un& result) {
+			if (path.size() >= sizeof(result.sun_path)) {
+				return false;
+			}
+			result.sun_family = AF_UNIX;
+			std::memcpy(result.sun_path, path.c_str(), path.size() + 1);
+			return true;
+		}
+
+		/** Resolve "host:port" by getaddrinfo, return nullptr with errno set if failed */
+		static ::addrinfo* resolve(const std::string& address, bool passive) {
+			auto colonIndex = address.rfind(':');
+			if (colonIndex == std::string::npos || colonIndex + 1 >= address.size()) {
+				errno = EINVAL;
+				return nullptr;
+			}
+			std::string host(address, 0, colonIndex);
+			std::string port(address, colonIndex + 1);
+			if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+				host = host.substr(1, host.size() - 2);
+			}
+			::addrinfo hints = {};
+			hints.ai_family = AF_UNSPEC;
+			hints.ai_socktype = SOCK_STREAM;
+			hints.ai_flags = passive ? AI_PASSIVE : 0;
+			::addrinfo* result = nullptr;
+			if (::getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &result) != 0) {
+				errno = EHOSTUNREACH;
+				return nullptr;
+			}
+			return result;
+		}
+
+		/** Get the local address of tcp socket in "host:port" format */
+		static std::string getSocketAddress(int fd) {
+			::sockaddr_storage storage = {};
+			::socklen_t size = sizeof(storage);
+			char host[INET6_ADDRSTRLEN] = {};
+			if (::getsockname(fd, reinterpret_cast<::sockaddr*>(&storage), &size) != 0) {
+				return std::string();
+			} else if (storage.ss_family == AF_INET6) {
+				const auto& address = reinterpret_cast<const ::sockaddr_in6&>(storage);
+				::inet_ntop(AF_INET6, &address.sin6_addr, host, sizeof(host));
+				return "[" + std::string(host) + "]:" + std::to_string(ntohs(address.sin6_port));
+			}
+			const auto& address = reinterpret_cast<const ::sockaddr_in&>(storage);
+			::inet_ntop(AF_INET, &address.sin_addr, host, sizeof(host));
+			return std::string(host) + ":" + std::to_string(ntohs(address.sin_port));
+		}
+
+		/** Close the socket if it's opened, keep errno of the failed operation */
+		static void closePreserveErrno(int fd) {
+			if (fd >= 0) {
+				auto err = errno;
+				::close(fd);
+				errno = err;
+			}
+		}
+	};
+}
+
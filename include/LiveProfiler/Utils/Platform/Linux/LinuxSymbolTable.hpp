@@ -0,0 +1,225 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <memory>
+#include <numeric>
+#include <algorithm>
+#include <unordered_map>
+#include "../../../Models/Shared/SymbolName.hpp"
+#include "../../Containers/StaticSearchTree.hpp"
+
+namespace LiveProfiler {
+	/**
+	 * Compact symbol table of single executable file (or kernel).
+	 * Symbols are stored in sorted arrays of start offset, end offset and name offset,
+	 * names are stored in a single string pool (arena) owned by the table, offset 0 is the empty string.
+	 * End offsets are also copied into a StaticSearchTree for lookups, it's rebuilt by `sort` and `assign`.
+	 * It costs about 32 bytes plus the name for each symbol, and few allocations for the whole table.
+	 *
+	 * Lookups return handles (index of the symbol), SymbolName instances are only created for
+	 * symbols that are actually resolved, the same instance is returned for the same handle,
+	 * so analyzers can still compare symbol names by address.
+	 */
+	class LinuxSymbolTable {
+	public:
+		/** Handle of symbol in the table */
+		using HandleType = std::uint32_t;
+		static const HandleType InvalidHandle = UINT32_MAX;
+
+		/** Getters */
+		const std::shared_ptr<std::string>& getPath() const& { return path_; }
+		std::size_t size() const { return starts_.size(); }
+		bool empty() const { return starts_.empty(); }
+		const std::vector<std::size_t>& getStarts() const& { return starts_; }
+		const std::vector<std::size_t>& getEnds() const& { return ends_; }
+		const std::vector<std::uint32_t>& getNameOffsets() const& { return nameOffsets_; }
+		const std::string& getStringPool() const& { return stringPool_; }
+
+		/** Get the start offset of the symbol (inclusive) */
+		std::size_t getStart(HandleType handle) const { return starts_[handle]; }
+
+		/** Get the end offset of the symbol (exclusive) */
+		std::size_t getEnd(HandleType handle) const { return ends_[handle]; }
+
+		/** Get the original (mangled) name of the symbol */
+		const char* getOriginalName(HandleType handle) const {
+			return stringPool_.c_str() + nameOffsets_[handle];
+		}
+
+		/**
+		 * Append null terminated name to the string pool and return the offset.
+		 * Return InvalidHandle if the pool exceeds 32 bits offset.
+		 */
+		std::uint32_t appendName(const char* name, std::size_t size) {
+			if (size == 0) {
+				return 0;
+			}
+			if (stringPool_.size() + size + 1 > UINT32_MAX) {
+				return InvalidHandle;
+			}
+			auto offset = static_cast<std::uint32_t>(stringPool_.size());
+			stringPool_.append(name, size);
+			stringPool_.push_back('\0');
+			return offset;
+		}
+
+		/** Append symbol, call `sort` after all symbols are appended */
+		void append(std::size_t start, std::size_t end, std::uint32_t nameOffset) {
+			assert(nameOffset < stringPool_.size());
+			starts_.emplace_back(start);
+			ends_.emplace_back(end);
+			nameOffsets_.emplace_back(nameOffset);
+		}
+
+		/** Reserve space for symbols and names */
+		void reserve(std::size_t symbolCount, std::size_t stringPoolSize) {
+			starts_.reserve(symbolCount);
+			ends_.reserve(symbolCount);
+			nameOffsets_.reserve(symbolCount);
+			stringPool_.reserve(stringPoolSize);
+		}
+
+		/**
+		 * Replace the whole table with the given arrays, they should be sorted already.
+		 * Return false if the arrays are invalid.
+		 */
+		bool assign(
+			std::vector<std::size_t>&& starts,
+			std::vector<std::size_t>&& ends,
+			std::vector<std::uint32_t>&& nameOffsets,
+			std::string&& stringPool) {
+			if (starts.size() != ends.size() || starts.size() != nameOffsets.size() ||
+				stringPool.empty() || stringPool.back() != '\0' ||
+				starts.size() >= InvalidHandle) {
+				return false;
+			}
+			for (auto nameOffset : nameOffsets) {
+				if (nameOffset >= stringPool.size()) {
+					return false;
+				}
+			}
+			starts_ = std::move(starts);
+			ends_ = std::move(ends);
+			nameOffsets_ = std::move(nameOffsets);
+			stringPool_ = std::move(stringPool);
+			symbolNames_.clear();
+			buildSearchTree();
+			return true;
+		}
+
+		/**
+		 * Sort symbols by end offset then by start offset, it's required by `find`.
+		 * Symbols exceed the handle range are removed.
+		 */
+		void sort() {
+			if (starts_.size() >= InvalidHandle) {
+				starts_.resize(InvalidHandle - 1);
+				ends_.resize(InvalidHandle - 1);
+				nameOffsets_.resize(InvalidHandle - 1);
+			}
+			std::vector<HandleType> order(starts_.size());
+			std::iota(order.begin(), order.end(), 0);
+			std::stable_sort(order.begin(), order.end(), [this](auto a, auto b) {
+				if (ends_[a] != ends_[b]) {
+					return ends_[a] < ends_[b];
+				}
+				return starts_[a] < starts_[b];
+			});
+			applyOrder(order, starts_);
+			applyOrder(order, ends_);
+			applyOrder(order, nameOffsets_);
+			symbolNames_.clear();
+			buildSearchTree();
+		}
+
+		/** Find the symbol contains the offset, return InvalidHandle if not found */
+		HandleType find(std::size_t offset) const {
+			// find first symbol that end > offset
+			return checkStart(endsTree_.upperBound(offset), offset);
+		}
+
+		/**
+		 * Find the symbols contain each offset, InvalidHandle is stored if not found.
+		 * Cache misses of different offsets are overlapped, it's faster than calling `find` for each offset.
+		 */
+		void find(const std::size_t* offsets, std::size_t count, HandleType* handles) const {
+			std::size_t indices[StaticSearchTree::BatchSize];
+			for (std::size_t start = 0; start < count; start += StaticSearchTree::BatchSize) {
+				std::size_t batchSize = std::min(StaticSearchTree::BatchSize, count - start);
+				endsTree_.upperBound(offsets + start, batchSize, indices);
+				for (std::size_t i = 0; i < batchSize; ++i) {
+					handles[start + i] = checkStart(indices[i], offsets[start + i]);
+				}
+			}
+		}
+
+		/** Get the symbol name instance of the handle, create if not exists */
+		std::shared_ptr<SymbolName> getSymbolName(HandleType handle) {
+			if (handle == InvalidHandle) {
+				return nullptr;
+			}
+			auto& symbolName = symbolNames_[handle];
+			if (symbolName == nullptr) {
+				symbolName = std::make_shared<SymbolName>(getOriginalName(handle), path_);
+				symbolName->setFileOffsetStart(starts_[handle]);
+				symbolName->setFileOffsetEnd(ends_[handle]);
+			}
+			return symbolName;
+		}
+
+		/** Constructor */
+		explicit LinuxSymbolTable(const std::shared_ptr<std::string>& path) :
+			path_(path),
+			starts_(),
+			ends_(),
+			nameOffsets_(),
+			stringPool_(1, '\0'),
+			symbolNames_(),
+			endsTree_() { }
+
+	protected:
+		/** Disable copy */
+		LinuxSymbolTable(const LinuxSymbolTable&) = delete;
+		LinuxSymbolTable& operator=(const LinuxSymbolTable&) = delete;
+
+		/** Check the symbol at index contains the offset, the index is the first symbol that end > offset */
+		HandleType checkStart(std::size_t index, std::size_t offset) const {
+			// since the smallest start will come first when end is equal, only check the first element
+			if (index < starts_.size() && offset >= starts_[index]) {
+				return static_cast<HandleType>(index);
+			}
+			return InvalidHandle;
+		}
+
+		/** Rebuild the search tree of end offsets */
+		void buildSearchTree() {
+			endsTree_.assign(ends_.size(), [this](auto index) { return ends_[index]; });
+		}
+
+		/** Reorder the array by the order of handles */
+		template <class T>
+		static void applyOrder(const std::vector<HandleType>& order, std::vector<T>& values) {
+			std::vector<T> result;
+			result.reserve(values.size());
+			for (auto handle : order) {
+				result.emplace_back(values[handle]);
+			}
+			values.swap(result);
+		}
+
+	protected:
+		std::shared_ptr<std::string> path_;
+		std::vector<std::size_t> starts_;
+		std::vector<std::size_t> ends_;
+		std::vector<std::uint32_t> nameOffsets_;
+		std::string stringPool_;
+		// symbol names created for resolved handles
+		std::unordered_map<HandleType, std::shared_ptr<SymbolName>> symbolNames_;
+		// copy of ends_ in cache friendly layout
+		StaticSearchTree endsTree_;
+	};
+}
+
@@ -0,0 +1,286 @@
+#pragma once
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <atomic>
+#include <fstream>
+#include <algorithm>
+#include "LinuxElfUtils.hpp"
+#include "LinuxSymbolTable.hpp"
+
+namespace LiveProfiler {
+	/**
+	 * Class used to store resolved symbol tables on disk, so they can be loaded without parsing.
+	 * Each table is stored in a separate file named by the key of the executable file,
+	 * the key is the GNU build-id, or the device, inode, size and mtime if there no build-id.
+	 *
+	 * File format (native byte order, the cache is not portable across architectures):
+	 * - Header: magic, version, symbol count, string pool size
+	 * - Entries: file offset start, file offset end, original name offset, reserved
+	 *   (it was the demangle name offset, names are demangled on access now)
+	 * - String pool: null terminated strings, offset 0 is the empty string
+	 * The layout matches LinuxSymbolTable, so loading a table only copies the arrays.
+	 *
+	 * Total size of the cache files is limited, least recently used files are evicted first,
+	 * the modification time of the file is updated when it's loaded.
+	 * This class is thread safe, and multiple processes can share the same directory.
+	 */
+	class LinuxSymbolTableCache {
+	public:
+		/** Default parameters */
+		static const std::size_t DefaultMaxTotalSize = 256 * 1024 * 1024;
+		// increased when the contents of tables changed, e.g. version 2 added unnamed functions from .eh_frame
+		static const std::uint32_t FileVersion = 2;
+
+		/** Getters */
+		const std::string& getDirectory() const& { return directory_; }
+		std::size_t getMaxTotalSize() const { return maxTotalSize_; }
+
+		/**
+		 * Get the cache key of the executable file.
+		 * Return empty string if the file doesn't exist.
+		 */
+		static std::string getKey(const std::string& path) {
+			std::string key;
+			if (LinuxElfUtils::readBuildId(path, key)) {
+				return key;
+			}
+			struct ::stat fileStat = {};
+			if (::stat(path.c_str(), &fileStat) != 0) {
+				return key;
+			}
+			key.append("ino-").append(std::to_string(fileStat.st_dev))
+				.append("-").append(std::to_string(fileStat.st_ino))
+				.append("-").append(std::to_string(fileStat.st_size))
+				.append("-").append(std::to_string(fileStat.st_mtim.tv_sec))
+				.append("-").append(std::to_string(fileStat.st_mtim.tv_nsec));
+			return key;
+		}
+
+		/**
+		 * Load symbol table from cache file, the previous content of `symbolTable` will be replaced.
+		 * Return false if the table is not cached or the cache file is invalid.
+		 */
+		bool load(const std::string& key, LinuxSymbolTable& symbolTable) {
+			if (key.empty()) {
+				return false;
+			}
+			auto filePath = getFilePath(key);
+			int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+			if (fd < 0) {
+				return false;
+			}
+			struct ::stat fileStat = {};
+			if (::fstat(fd, &fileStat) != 0 ||
+				static_cast<std::size_t>(fileStat.st_size) < sizeof(FileHeader)) {
+				::close(fd);
+				return false;
+			}
+			std::size_t size = static_cast<std::size_t>(fileStat.st_size);
+			void* address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			::close(fd);
+			if (address == MAP_FAILED) {
+				return false;
+			}
+			std::unique_ptr<void, std::function<void(void*)>> addressPtr(
+				address, [size](void* p) { ::munmap(p, size); });
+			// validate header and bounds
+			const char* data = static_cast<const char*>(address);
+			FileHeader header;
+			std::memcpy(&header, data, sizeof(header));
+			if (std::memcmp(header.magic, FileMagic, sizeof(header.magic)) != 0 ||
+				header.version != FileVersion ||
+				header.symbolCount > size / sizeof(FileEntry) ||
+				sizeof(header) + header.symbolCount * sizeof(FileEntry) +
+					header.stringPoolSize != size ||
+				header.stringPoolSize == 0) {
+				return false;
+			}
+			const char* entries = data + sizeof(header);
+			const char* stringPool = entries + header.symbolCount * sizeof(FileEntry);
+			// copy arrays, offsets are validated by the table
+			std::vector<std::size_t> starts(header.symbolCount);
+			std::vector<std::size_t> ends(header.symbolCount);
+			std::vector<std::uint32_t> nameOffsets(header.symbolCount);
+			for (std::size_t i = 0; i < header.symbolCount; ++i) {
+				FileEntry entry;
+				std::memcpy(&entry, entries + i * sizeof(FileEntry), sizeof(entry));
+				starts[i] = static_cast<std::size_t>(entry.fileOffsetStart);
+				ends[i] = static_cast<std::size_t>(entry.fileOffsetEnd);
+				nameOffsets[i] = entry.originalNameOffset;
+			}
+			if (!symbolTable.assign(
+				std::move(starts),
+				std::move(ends),
+				std::move(nameOffsets),
+				std::string(stringPool, header.stringPoolSize))) {
+				return false;
+			}
+			// mark as recently used
+			::utimensat(AT_FDCWD, filePath.c_str(), nullptr, 0);
+			return true;
+		}
+
+		/**
+		 * Store symbol table to cache file, then evict least recently used files if exceeds the limit.
+		 * The file is written to a temporary path then renamed, so readers never see a partial file.
+		 * Return whether the table is stored.
+		 */
+		bool store(const std::string& key, const LinuxSymbolTable& symbolTable) {
+			if (key.empty()) {
+				return false;
+			}
+			// build entries, the string pool is written as is
+			std::vector<FileEntry> entries;
+			entries.reserve(symbolTable.size());
+			for (std::size_t i = 0; i < symbolTable.size(); ++i) {
+				FileEntry entry;
+				entry.fileOffsetStart = symbolTable.getStarts()[i];
+				entry.fileOffsetEnd = symbolTable.getEnds()[i];
+				entry.originalNameOffset = symbolTable.getNameOffsets()[i];
+				entry.reserved = 0;
+				entries.emplace_back(entry);
+			}
+			const auto& stringPool = symbolTable.getStringPool();
+			FileHeader header;
+			std::memcpy(header.magic, FileMagic, sizeof(header.magic));
+			header.version = FileVersion;
+			header.reserved = 0;
+			header.symbolCount = entries.size();
+			header.stringPoolSize = stringPool.size();
+			// write to temporary file
+			auto filePath = getFilePath(key);
+			auto tempPath = filePath + ".tmp" + std::to_string(::getpid()) +
+				"-" + std::to_string(tempFileSequence_++);
+			{
+				std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+				file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+				file.write(reinterpret_cast<const char*>(entries.data()),
+					entries.size() * sizeof(FileEntry));
+				file.write(stringPool.data(), stringPool.size());
+				if (!file.flush()) {
+					file.close();
+					::unlink(tempPath.c_str());
+					return false;
+				}
+			}
+			if (::rename(tempPath.c_str(), filePath.c_str()) != 0) {
+				::unlink(tempPath.c_str());
+				return false;
+			}
+			evict(filePath);
+			return true;
+		}
+
+		/** Constructor, the directory will be created if not exists */
+		explicit LinuxSymbolTableCache(
+			const std::string& directory,
+			std::size_t maxTotalSize = DefaultMaxTotalSize) :
+			directory_(directory),
+			maxTotalSize_(maxTotalSize),
+			evictMutex_(),
+			tempFileSequence_(0) {
+			while (directory_.size() > 1 && directory_.back() == '/') {
+				directory_.pop_back();
+			}
+			::mkdir(directory_.c_str(), 0755);
+		}
+
+	protected:
+		/** Header of the cache file */
+		struct FileHeader {
+			char magic[8];
+			std::uint32_t version;
+			std::uint32_t reserved;
+			std::uint64_t symbolCount;
+			std::uint64_t stringPoolSize;
+		};
+
+		/** Entry of the cache file */
+		struct FileEntry {
+			std::uint64_t fileOffsetStart;
+			std::uint64_t fileOffsetEnd;
+			std::uint32_t originalNameOffset;
+			std::uint32_t reserved;
+		};
+
+		static constexpr const char* FileMagic = "LPSYMTAB";
+		static constexpr const char* FileSuffix = ".symtab";
+
+		/** Get the path of the cache file from key */
+		std::string getFilePath(const std::string& key) const {
+			return directory_ + "/" + key + FileSuffix;
+		}
+
+		/** Remove least recently used cache files until total size is under the limit */
+		void evict(const std::string& keepPath) {
+			std::lock_guard<std::mutex> guard(evictMutex_);
+			std::unique_ptr<DIR, int(*)(DIR*)> dir(::opendir(directory_.c_str()), ::closedir);
+			if (dir == nullptr) {
+				return;
+			}
+			struct CacheFile {
+				std::string path;
+				std::size_t size;
+				struct ::timespec mtime;
+			};
+			std::vector<CacheFile> files;
+			std::size_t totalSize = 0;
+			std::size_t suffixSize = std::strlen(FileSuffix);
+			while (auto* dirEntry = ::readdir(dir.get())) {
+				std::size_t nameSize = std::strlen(dirEntry->d_name);
+				if (nameSize <= suffixSize ||
+					std::strcmp(dirEntry->d_name + nameSize - suffixSize, FileSuffix) != 0) {
+					continue;
+				}
+				auto filePath = directory_ + "/" + dirEntry->d_name;
+				struct ::stat fileStat = {};
+				if (::stat(filePath.c_str(), &fileStat) != 0) {
+					continue;
+				}
+				totalSize += static_cast<std::size_t>(fileStat.st_size);
+				files.emplace_back(CacheFile({
+					std::move(filePath),
+					static_cast<std::size_t>(fileStat.st_size),
+					fileStat.st_mtim }));
+			}
+			if (totalSize <= maxTotalSize_) {
+				return;
+			}
+			std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) {
+				if (a.mtime.tv_sec != b.mtime.tv_sec) {
+					return a.mtime.tv_sec < b.mtime.tv_sec;
+				}
+				return a.mtime.tv_nsec < b.mtime.tv_nsec;
+			});
+			for (const auto& file : files) {
+				if (totalSize <= maxTotalSize_) {
+					break;
+				}
+				if (file.path == keepPath) {
+					continue;
+				}
+				if (::unlink(file.path.c_str()) == 0) {
+					totalSize -= file.size;
+				}
+			}
+		}
+
+	protected:
+		std::string directory_;
+		std::size_t maxTotalSize_;
+		std::mutex evictMutex_;
+		std::atomic_size_t tempFileSequence_;
+	};
+}
+
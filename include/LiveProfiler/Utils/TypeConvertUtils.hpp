@@ -26,6 +26,30 @@ namespace LiveProfiler {
 			return true;
 		}
 
+		/**
+		 * Convert hex digits in [begin, end) to unsigned long long without copy or locale,
+		 * stops at the first non hex digit, overflowed digits are ignored.
+		 * Return the pointer after the last digit, it equals to begin if there no digits.
+		 */
+		static const char* hexToUnsignedLongLong(
+			const char* begin, const char* end, unsigned long long& result) {
+			result = 0;
+			const char* ptr = begin;
+			for (; ptr < end; ++ptr) {
+				unsigned char c = static_cast<unsigned char>(*ptr);
+				unsigned digit = 0;
+				if (c >= '0' && c <= '9') {
+					digit = c - '0';
+				} else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+					digit = (c | 0x20) - 'a' + 10;
+				} else {
+					break;
+				}
+				result = (result << 4) | digit;
+			}
+			return ptr;
+		}
+
 		/** Convert long long to c string, return how many characters appended (exclude null) */
 		static std::size_t longLongToStr(char* str, std::size_t size, long long value) {
 			static constexpr std::size_t cacheSize = 32768;
@@ -63,6 +63,60 @@ namespace LiveProfilerTests {
 			assert(result.getTopExclusiveSymbolNames().empty());
 			assert(result.getTotalSampleCount() == 0);
 		}
+		{
+			// placeholders should be merged into their resolved symbol names
+			auto placeholderA = makeSymbol(path, "test+0x10");
+			auto placeholderB = makeSymbol(path, "test+0x20");
+			placeholderA->setPending();
+			placeholderB->setPending();
+			std::vector<std::unique_ptr<CpuSampleModel>> models;
+			models.emplace_back(makeModel(placeholderA, { symbolNameC }));
+			models.emplace_back(makeModel(symbolNameA, { placeholderA }));
+			models.emplace_back(makeModel(placeholderB, { }));
+			analyzer->feed(models);
+			assert(analyzer->getResult(1000, 1000).getTopExclusiveSymbolNames().size() == 3);
+			placeholderA->setResolved(symbolNameA);
+			placeholderB->setResolved(nullptr);
+			models.clear();
+			models.emplace_back(makeModel(placeholderA, { }));
+			analyzer->feed(models);
+			auto result = analyzer->getResult(1000, 1000);
+			auto& topInclusiveSymbolNames = result.getTopInclusiveSymbolNames();
+			auto& topExclusiveSymbolNames = result.getTopExclusiveSymbolNames();
+			assert(topInclusiveSymbolNames.size() == 2);
+			assert(topInclusiveSymbolNames.at(0).first == symbolNameA);
+			assert(topInclusiveSymbolNames.at(0).second == 4);
+			assert(topInclusiveSymbolNames.at(1).first == symbolNameC);
+			assert(topInclusiveSymbolNames.at(1).second == 1);
+			assert(topExclusiveSymbolNames.size() == 1);
+			assert(topExclusiveSymbolNames.at(0).first == symbolNameA);
+			assert(topExclusiveSymbolNames.at(0).second == 3);
+			assert(result.getTotalSampleCount() == 4);
+		}
+		{
+			// raw address placeholders should be bound once when generating the result
+			analyzer->reset();
+			auto binder = std::make_shared<TestSymbolNameBinder>(symbolNameA, symbolNameB);
+			auto rawA1 = makeRawSymbol(path, 0x10, binder);
+			auto rawA2 = makeRawSymbol(path, 0x20, binder);
+			auto rawB = makeRawSymbol(path, 0x100, binder);
+			std::vector<std::unique_ptr<CpuSampleModel>> models;
+			models.emplace_back(makeModel(rawA1, { rawB }));
+			models.emplace_back(makeModel(rawA2, { rawB }));
+			models.emplace_back(makeModel(rawB, { }));
+			analyzer->feed(models);
+			analyzer->feed(models);
+			assert(binder->getBindCount() == 0);
+			auto result = analyzer->getResult(1, 1);
+			assert(binder->getBindCount() == 1);
+			assert(binder->getPlaceholderCount() == 3);
+			assert(result.getTopInclusiveSymbolNames().at(0).first == symbolNameB);
+			assert(result.getTopInclusiveSymbolNames().at(0).second == 6);
+			assert(result.getTopExclusiveSymbolNames().at(0).first == symbolNameA);
+			assert(result.getTopExclusiveSymbolNames().at(0).second == 4);
+			analyzer->getResult(1, 1);
+			assert(binder->getBindCount() == 1);
+		}
 	}
 }
 
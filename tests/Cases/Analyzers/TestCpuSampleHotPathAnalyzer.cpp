@@ -58,6 +58,61 @@ namespace LiveProfilerTests {
 			assert(root->getCount() == 0);
 			assert(root->getChilds().empty());
 		}
+		{
+			// placeholders should be merged into their resolved symbol names
+			auto placeholderA = makeSymbol(path, "test+0x10");
+			auto placeholderB = makeSymbol(path, "test+0x20");
+			placeholderA->setPending();
+			placeholderB->setPending();
+			std::vector<std::unique_ptr<CpuSampleModel>> models;
+			models.emplace_back(makeModel(symbolNameA, { placeholderA, symbolNameC }));
+			models.emplace_back(makeModel(symbolNameB, { placeholderB, symbolNameC }));
+			analyzer->feed(models);
+			assert(analyzer->getResult().getRoot()->getChilds().at(symbolNameC)->getChilds().size() == 2);
+			placeholderA->setResolved(symbolNameB);
+			placeholderB->setResolved(nullptr);
+			models.clear();
+			models.emplace_back(makeModel(symbolNameA, { placeholderA, symbolNameC }));
+			analyzer->feed(models);
+			auto result = analyzer->getResult();
+			assert(result.getTotalSampleCount() == 3);
+			auto& root = result.getRoot();
+			assert(root->getCount() == 3);
+			assert(root->getChilds().size() == 1);
+			auto& c = root->getChilds().at(symbolNameC);
+			auto& cChilds = c->getChilds();
+			assert(c->getCount() == 3);
+			assert(cChilds.size() == 1);
+			assert(cChilds.count(symbolNameB) == 1);
+			auto& b = cChilds.at(symbolNameB);
+			auto& bChilds = b->getChilds();
+			assert(b->getCount() == 3);
+			assert(bChilds.size() == 1);
+			assert(bChilds.at(symbolNameA)->getCount() == 2);
+		}
+		{
+			// raw address placeholders should be bound once when generating the result
+			analyzer->reset();
+			auto binder = std::make_shared<TestSymbolNameBinder>(symbolNameA, symbolNameB);
+			auto rawA1 = makeRawSymbol(path, 0x10, binder);
+			auto rawA2 = makeRawSymbol(path, 0x20, binder);
+			auto rawB = makeRawSymbol(path, 0x100, binder);
+			std::vector<std::unique_ptr<CpuSampleModel>> models;
+			models.emplace_back(makeModel(rawA1, { rawB, symbolNameC }));
+			models.emplace_back(makeModel(rawA2, { rawB, symbolNameC }));
+			analyzer->feed(models);
+			assert(binder->getBindCount() == 0);
+			auto result = analyzer->getResult();
+			assert(binder->getBindCount() == 1);
+			assert(binder->getPlaceholderCount() == 3);
+			auto& c = result.getRoot()->getChilds().at(symbolNameC);
+			assert(c->getCount() == 2);
+			assert(c->getChilds().size() == 1);
+			auto& b = c->getChilds().at(symbolNameB);
+			assert(b->getCount() == 2);
+			assert(b->getChilds().size() == 1);
+			assert(b->getChilds().at(symbolNameA)->getCount() == 2);
+		}
 	}
 }
 
@@ -26,6 +26,39 @@ namespace LiveProfilerTests {
 			}
 			return model;
 		}
+
+		class TestSymbolNameBinder : public SymbolNameBinder {
+		public:
+			void bind(const std::vector<std::shared_ptr<SymbolName>>& placeholders) override {
+				++bindCount_;
+				for (const auto& placeholder : placeholders) {
+					++placeholderCount_;
+					placeholder->setResolved(placeholder->getFileOffsetStart() < 0x100 ? a_ : b_);
+				}
+			}
+			std::size_t getBindCount() const { return bindCount_; }
+			std::size_t getPlaceholderCount() const { return placeholderCount_; }
+			TestSymbolNameBinder(
+				const std::shared_ptr<SymbolName>& a,
+				const std::shared_ptr<SymbolName>& b) : a_(a), b_(b) { }
+
+		protected:
+			std::shared_ptr<SymbolName> a_;
+			std::shared_ptr<SymbolName> b_;
+			std::size_t bindCount_ = 0;
+			std::size_t placeholderCount_ = 0;
+		};
+
+		std::shared_ptr<SymbolName> makeRawSymbol(
+			const std::shared_ptr<std::string>& path,
+			std::size_t offset,
+			const std::shared_ptr<SymbolNameBinder>& binder) {
+			auto symbolName = makeSymbol(path, *path + "+" + std::to_string(offset));
+			symbolName->setFileOffsetStart(offset);
+			symbolName->setFileOffsetEnd(offset + 1);
+			symbolName->setPending(binder);
+			return symbolName;
+		}
 	}
 }
 
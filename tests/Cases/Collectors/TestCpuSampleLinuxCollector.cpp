@@ -1,4 +1,10 @@
 #if defined(__linux__)
+#include <syscall.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <climits>
+#include <ctime>
 #include <iostream>
 #include <atomic>
 #include <thread>
@@ -19,6 +25,11 @@ namespace LiveProfilerTests {
 					assert(model->getTid() != 0);
 					assert(model->getIp() != 0);
 					assert(model->getCallChainIps().size() == model->getCallChainSymbolNames().size());
+					// timestamp is from CLOCK_MONOTONIC
+					struct ::timespec now;
+					::clock_gettime(CLOCK_MONOTONIC, &now);
+					assert(model->getTimestamp() != 0);
+					assert(model->getTimestamp() <= static_cast<std::uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec);
 				}
 				sampleCount_ += models.size();
 			}
@@ -27,6 +38,92 @@ namespace LiveProfilerTests {
 		protected:
 			std::size_t sampleCount_ = 0;
 		};
+
+		class TestThreadAnalyzer : public BaseAnalyzer<CpuSampleModel> {
+		public:
+			void reset() override { sampleCount_ = 0; };
+			void feed(const std::vector<std::unique_ptr<CpuSampleModel>>& models) override {
+				for (auto& model : models) {
+					if (model->getTid() == static_cast<std::uint64_t>(tid_.load())) {
+						++sampleCount_;
+					}
+				}
+			}
+			std::size_t getResult() const { return sampleCount_; }
+			void setTid(pid_t tid) { tid_ = tid; }
+
+		protected:
+			std::atomic<pid_t> tid_ { 0 };
+			std::size_t sampleCount_ = 0;
+		};
+
+		class TestCgroupAnalyzer : public BaseAnalyzer<CpuSampleModel> {
+		public:
+			void reset() override { sampleCount_ = 0; };
+			void feed(const std::vector<std::unique_ptr<CpuSampleModel>>& models) override {
+				for (auto& model : models) {
+					// other processes may in the same cgroup
+					assert(model->getCgroupId() == cgroupId_);
+					if (model->getPid() == static_cast<std::uint64_t>(::getpid())) {
+						++sampleCount_;
+					}
+				}
+			}
+			std::size_t getResult() const { return sampleCount_; }
+			explicit TestCgroupAnalyzer(std::uint64_t cgroupId) : cgroupId_(cgroupId) { }
+
+		protected:
+			std::uint64_t cgroupId_ = 0;
+			std::size_t sampleCount_ = 0;
+		};
+
+		class TestCallChainAnalyzer : public BaseAnalyzer<CpuSampleModel> {
+		public:
+			void reset() override { sampleCount_ = 0; callChainCount_ = 0; };
+			void feed(const std::vector<std::unique_ptr<CpuSampleModel>>& models) override {
+				for (auto& model : models) {
+					if (!model->getCallChainIps().empty()) {
+						++callChainCount_;
+					}
+				}
+				sampleCount_ += models.size();
+			}
+			std::size_t getResult() const { return sampleCount_; }
+			std::size_t getCallChainCount() const { return callChainCount_; }
+
+		protected:
+			std::size_t sampleCount_ = 0;
+			std::size_t callChainCount_ = 0;
+		};
+
+		class TestAddressMapAnalyzer : public BaseAnalyzer<CpuSampleModel> {
+		public:
+			void reset() override { found_ = false; };
+			void feed(const std::vector<std::unique_ptr<CpuSampleModel>>& models) override {
+				for (auto& model : models) {
+					for (auto& addressMap : model->getAddressMaps()) {
+						if (addressMap.startAddress == address_.load() &&
+							addressMap.endAddress == address_.load() + size_ &&
+							addressMap.pid == static_cast<std::uint64_t>(::getpid()) &&
+							addressMap.fileOffset == 0 &&
+							addressMap.timestamp != 0 &&
+							addressMap.path == path_) {
+							found_ = true;
+						}
+					}
+				}
+			}
+			bool getResult() const { return found_; }
+			void setAddress(std::uintptr_t address) { address_ = address; }
+			TestAddressMapAnalyzer(const std::string& path, std::size_t size) :
+				path_(path), size_(size) { }
+
+		protected:
+			std::string path_;
+			std::size_t size_;
+			std::atomic<std::uintptr_t> address_ { 0 };
+			bool found_ = false;
+		};
 	}
 
 	void testCpuSampleLinuxCollectorWithSelfProcess() {
@@ -54,9 +151,205 @@ namespace LiveProfilerTests {
 		assert(analyzer->getResult() > 0);
 	}
 
+	void testCpuSampleLinuxCollectorWithProcessEvents() {
+		Profiler<CpuSampleModel> profiler;
+		auto collector = profiler.useCollector<CpuSampleLinuxCollector>();
+		auto analyzer = profiler.addAnalyzer<TestThreadAnalyzer>();
+		collector->filterProcessByName("LiveProfilerTest");
+		collector->setUseProcessEvents(true);
+		collector->setProcessesUpdateInterval(std::chrono::seconds(60));
+		profiler.collectFor(std::chrono::milliseconds(10));
+
+		// thread created after the scan should be monitored
+		std::atomic_bool flag(true);
+		std::atomic_int n(0);
+		std::thread t([&flag, &n, &analyzer] {
+			analyzer->setTid(::syscall(__NR_gettid));
+			while (flag.load()) {
+				++n;
+				++n;
+				++n;
+			}
+		});
+
+		for (std::size_t i = 0; i < 3; ++i) {
+			profiler.collectFor(std::chrono::milliseconds(100));
+		}
+		flag.store(false);
+		t.join();
+		assert(analyzer->getResult() > 0);
+	}
+
+	void testCpuSampleLinuxCollectorWithInvalidCgroup() {
+		Profiler<CpuSampleModel> profiler;
+		auto collector = profiler.useCollector<CpuSampleLinuxCollector>();
+		collector->setProcessesUpdateInterval(std::chrono::milliseconds(0));
+		bool thrown = false;
+		try {
+			collector->monitorCgroup("/tmp/LiveProfilerTestCgroupNotExist-" + std::to_string(::getpid()));
+		} catch (const ProfilerException&) {
+			thrown = true;
+		}
+		assert(thrown);
+		// the invalid cgroup is not kept, collector is still usable
+		profiler.collectFor(std::chrono::milliseconds(10));
+		// the cgroup is removed before perf events opened, only the next collect throws
+		auto path = "/tmp/LiveProfilerTestCgroupRemoved-" + std::to_string(::getpid());
+		::mkdir(path.c_str(), 0700);
+		collector->monitorCgroup(path);
+		::rmdir(path.c_str());
+		thrown = false;
+		try {
+			profiler.collectFor(std::chrono::milliseconds(10));
+		} catch (const ProfilerException&) {
+			thrown = true;
+		}
+		assert(thrown);
+		profiler.collectFor(std::chrono::milliseconds(10));
+	}
+
+	void testCpuSampleLinuxCollectorWithSelfCgroup() {
+		auto cgroupPath = LinuxCgroupUtils::getProcessCgroupPath(::getpid());
+		auto cgroupId = LinuxCgroupUtils::getCgroupId(cgroupPath);
+		Profiler<CpuSampleModel> profiler;
+		auto collector = profiler.useCollector<CpuSampleLinuxCollector>();
+		auto analyzer = profiler.addAnalyzer<TestCgroupAnalyzer>(cgroupId);
+		collector->monitorCgroup(cgroupPath);
+
+		std::atomic_bool flag(true);
+		std::atomic_int n(0);
+		std::thread t([&flag, &n] {
+			while (flag.load()) {
+				++n;
+				++n;
+				++n;
+			}
+		});
+
+		for (std::size_t i = 0; i < 3; ++i) {
+			profiler.collectFor(std::chrono::milliseconds(100));
+		}
+		flag.store(false);
+		t.join();
+		assert(analyzer->getResult() > 0);
+	}
+
+	void testCpuSampleLinuxCollectorReconfigure() {
+		Profiler<CpuSampleModel> profiler;
+		auto collector = profiler.useCollector<CpuSampleLinuxCollector>();
+		auto analyzer = profiler.addAnalyzer<TestCallChainAnalyzer>();
+		collector->filterProcessByName("LiveProfilerTest");
+
+		std::atomic_bool flag(true);
+		std::atomic_int n(0);
+		std::thread t([&flag, &n] {
+			while (flag.load()) {
+				++n;
+				++n;
+				++n;
+			}
+		});
+
+		profiler.collectFor(std::chrono::milliseconds(100));
+		assert(analyzer->getResult() > 0);
+		// change attributes while collecting, perf events should be reopened
+		collector->setSamplePeriod(50000);
+		collector->setIncludeCallChain(false);
+		profiler.collectFor(std::chrono::milliseconds(100));
+		analyzer->reset();
+		for (std::size_t i = 0; i < 2; ++i) {
+			profiler.collectFor(std::chrono::milliseconds(100));
+		}
+		flag.store(false);
+		t.join();
+		assert(analyzer->getResult() > 0);
+		assert(analyzer->getCallChainCount() == 0);
+	}
+
+	void testCpuSampleLinuxCollectorSharded() {
+		Profiler<CpuSampleModel> profiler;
+		auto collector = profiler.useCollector<CpuSampleLinuxCollector>();
+		auto analyzer = profiler.addAnalyzer<TestAnalyzer>();
+		collector->filterProcessByName("LiveProfilerTest");
+		collector->setShardCount(2);
+
+		std::atomic_bool flag(true);
+		std::atomic_int n(0);
+		std::vector<std::thread> threads;
+		for (std::size_t i = 0; i < 4; ++i) {
+			threads.emplace_back([&flag, &n] {
+				while (flag.load()) {
+					++n;
+					++n;
+					++n;
+				}
+			});
+		}
+
+		for (std::size_t i = 0; i < 3; ++i) {
+			profiler.collectFor(std::chrono::milliseconds(100));
+		}
+		// models should be returned to workers and reused after reset
+		profiler.reset();
+		profiler.collectFor(std::chrono::milliseconds(100));
+		flag.store(false);
+		for (auto& t : threads) {
+			t.join();
+		}
+		assert(analyzer->getResult() > 0);
+	}
+
+	void testCpuSampleLinuxCollectorAddressMaps() {
+		char path[PATH_MAX] = {};
+		auto pathSize = ::readlink("/proc/self/exe", path, sizeof(path) - 1);
+		assert(pathSize > 0);
+		std::size_t size = ::getpagesize();
+		Profiler<CpuSampleModel> profiler;
+		auto collector = profiler.useCollector<CpuSampleLinuxCollector>();
+		auto analyzer = profiler.addAnalyzer<TestAddressMapAnalyzer>(path, size);
+		collector->filterProcessByName("LiveProfilerTest");
+
+		// map the executable file after the thread is monitored, and keep running on the same thread
+		std::atomic_bool flag(true);
+		std::atomic_bool mapFlag(false);
+		std::atomic_int n(0);
+		std::thread t([&flag, &mapFlag, &n, &analyzer, &path, size] {
+			void* address = nullptr;
+			while (flag.load()) {
+				if (address == nullptr && mapFlag.load()) {
+					int fd = ::open(path, O_RDONLY);
+					assert(fd >= 0);
+					address = ::mmap(nullptr, size, PROT_READ | PROT_EXEC, MAP_PRIVATE, fd, 0);
+					assert(address != MAP_FAILED);
+					::close(fd);
+					analyzer->setAddress(reinterpret_cast<std::uintptr_t>(address));
+				}
+				++n;
+				++n;
+				++n;
+			}
+			::munmap(address, size);
+		});
+
+		profiler.collectFor(std::chrono::milliseconds(100));
+		mapFlag.store(true);
+		for (std::size_t i = 0; i < 3; ++i) {
+			profiler.collectFor(std::chrono::milliseconds(100));
+		}
+		flag.store(false);
+		t.join();
+		assert(analyzer->getResult());
+	}
+
 	void testCpuSampleLinuxCollector() {
 		std::cout << __func__ << std::endl;
 		testCpuSampleLinuxCollectorWithSelfProcess();
+		testCpuSampleLinuxCollectorWithProcessEvents();
+		testCpuSampleLinuxCollectorWithInvalidCgroup();
+		testCpuSampleLinuxCollectorWithSelfCgroup();
+		testCpuSampleLinuxCollectorReconfigure();
+		testCpuSampleLinuxCollectorSharded();
+		testCpuSampleLinuxCollectorAddressMaps();
 	}
 }
 #else // defined(__linux__)
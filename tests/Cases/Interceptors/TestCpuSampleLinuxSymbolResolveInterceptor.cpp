@@ -1,8 +1,12 @@
 #if defined(__linux__)
 #include <unistd.h>
+#include <sys/mman.h>
 #include <iostream>
+#include <fstream>
 #include <cassert>
+#include <thread>
 #include <LiveProfiler/Interceptors/CpuSampleLinuxSymbolResolveInterceptor.hpp>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxRemoteSymbolServer.hpp>
 
 namespace LiveProfilerTests {
 	using namespace LiveProfiler;
@@ -51,10 +55,273 @@ namespace LiveProfilerTests {
 		}
 	}
 
+	void testCpuSampleLinuxSymbolResolveInterceptorIpCache() {
+		auto interceptor = std::make_shared<CpuSampleLinuxSymbolResolveInterceptor>();
+		std::vector<std::unique_ptr<CpuSampleModel>> models;
+		auto model = std::make_unique<CpuSampleModel>();
+		model->setPid(::getpid());
+		model->setTid(::getpid());
+		model->setIp(reinterpret_cast<std::uint64_t>(
+			&testCpuSampleLinuxSymbolResolveInterceptorIpCache));
+		models.emplace_back(std::move(model));
+
+		interceptor->alter(models);
+		auto symbolName = models.at(0)->getSymbolName();
+		assert(symbolName != nullptr);
+		assert(interceptor->getIpCacheHitCount() == 0);
+		assert(interceptor->getIpCacheMissCount() == 1);
+		for (std::size_t i = 0; i < 3; ++i) {
+			interceptor->alter(models);
+			assert(models.at(0)->getSymbolName() == symbolName);
+		}
+		assert(interceptor->getIpCacheHitCount() == 3);
+		assert(interceptor->getIpCacheMissCount() == 1);
+
+		// disable the cache
+		interceptor->setIpCacheCapacity(0);
+		interceptor->reset();
+		interceptor->alter(models);
+		assert(models.at(0)->getSymbolName() == symbolName);
+		assert(interceptor->getIpCacheHitCount() == 0);
+		assert(interceptor->getIpCacheMissCount() == 0);
+	}
+
+	void testCpuSampleLinuxSymbolResolveInterceptorJitCode() {
+		// jitdump file contains two functions loaded at the same address at different time
+		auto append = [](std::string& content, auto value) {
+			content.append(reinterpret_cast<const char*>(&value), sizeof(value));
+		};
+		auto pid = static_cast<std::uint32_t>(::getpid());
+		std::string content;
+		append(content, LinuxJitDumpReader::Magic);
+		append(content, LinuxJitDumpReader::Version);
+		append(content, std::uint32_t(40));
+		append(content, std::uint32_t(62)); // EM_X86_64
+		append(content, std::uint32_t(0));
+		append(content, pid);
+		append(content, std::uint64_t(1));
+		append(content, std::uint64_t(0));
+		for (const auto& nameAndTimestamp : { std::make_pair("funcA", 100), std::make_pair("funcB", 200) }) {
+			std::string name(nameAndTimestamp.first);
+			append(content, std::uint32_t(0)); // JIT_CODE_LOAD
+			append(content, static_cast<std::uint32_t>(56 + name.size() + 1 + 0x20));
+			append(content, static_cast<std::uint64_t>(nameAndTimestamp.second));
+			append(content, pid);
+			append(content, pid);
+			append(content, std::uint64_t(0x1000));
+			append(content, std::uint64_t(0x1000));
+			append(content, std::uint64_t(0x20));
+			append(content, std::uint64_t(0));
+			content.append(name.c_str(), name.size() + 1);
+			content.append(0x20, '\xc3');
+		}
+		std::string path = "/tmp/jit-" + std::to_string(pid) + ".dump";
+		{
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			file.write(content.data(), content.size());
+		}
+
+		// samples are not ordered by time, names of reused addresses should not be cached by ip
+		auto interceptor = std::make_shared<CpuSampleLinuxSymbolResolveInterceptor>();
+		std::vector<std::unique_ptr<CpuSampleModel>> models;
+		for (auto timestamp : { 250, 150, 250 }) {
+			auto model = std::make_unique<CpuSampleModel>();
+			model->setPid(pid);
+			model->setTid(pid);
+			model->setIp(0x1010);
+			model->setTimestamp(timestamp);
+			models.emplace_back(std::move(model));
+		}
+		interceptor->alter(models);
+		assert(models.at(0)->getSymbolName() != nullptr);
+		assert(models.at(0)->getSymbolName()->getName() == "funcB");
+		assert(models.at(1)->getSymbolName() != nullptr);
+		assert(models.at(1)->getSymbolName()->getName() == "funcA");
+		assert(models.at(2)->getSymbolName() == models.at(0)->getSymbolName());
+		assert(interceptor->getIpCacheHitCount() == 0);
+		::unlink(path.c_str());
+	}
+
+	void testCpuSampleLinuxSymbolResolveInterceptorAsync() {
+		auto interceptor = std::make_shared<CpuSampleLinuxSymbolResolveInterceptor>();
+		interceptor->setAsyncSymbolLoading(1);
+		std::vector<std::unique_ptr<CpuSampleModel>> models;
+		auto model = std::make_unique<CpuSampleModel>();
+		model->setPid(::getpid());
+		model->setTid(::getpid());
+		model->setIp(reinterpret_cast<std::uint64_t>(
+			&testCpuSampleLinuxSymbolResolveInterceptorAsync));
+		models.emplace_back(std::move(model));
+
+		// the first result should be a pending placeholder
+		interceptor->alter(models);
+		auto placeholder = models.at(0)->getSymbolName();
+		assert(placeholder != nullptr);
+		assert(placeholder->isPending());
+		assert(placeholder->getName().find("+0x") != std::string::npos);
+
+		// the placeholder should be resolved once the symbol table is loaded
+		for (std::size_t i = 0; i < 1000 && placeholder->isPending(); ++i) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			interceptor->alter(models);
+		}
+		assert(!placeholder->isPending());
+		auto& resolved = SymbolName::resolveLateBound(placeholder);
+		assert(resolved != nullptr);
+		assert(resolved->getName().find(__func__) != std::string::npos);
+		assert(models.at(0)->getSymbolName() == resolved);
+	}
+
+	void testCpuSampleLinuxSymbolResolveInterceptorRawAddress() {
+		auto interceptor = std::make_shared<CpuSampleLinuxSymbolResolveInterceptor>();
+		interceptor->setRawAddressMode(true);
+		std::vector<std::unique_ptr<CpuSampleModel>> models;
+		auto model = std::make_unique<CpuSampleModel>();
+		model->setPid(::getpid());
+		model->setTid(::getpid());
+		model->setIp(reinterpret_cast<std::uint64_t>(
+			&testCpuSampleLinuxSymbolResolveInterceptorRawAddress));
+		models.emplace_back(std::move(model));
+
+		interceptor->alter(models);
+		auto placeholder = models.at(0)->getSymbolName();
+		assert(placeholder != nullptr);
+		assert(placeholder->isPending());
+		assert(placeholder->getBinder() != nullptr);
+		interceptor->alter(models);
+		assert(models.at(0)->getSymbolName() == placeholder);
+
+		std::vector<std::shared_ptr<SymbolName>> placeholders({ placeholder });
+		SymbolName::bindPlaceholders(placeholders);
+		assert(!placeholder->isPending());
+		auto& resolved = SymbolName::resolveLateBound(placeholder);
+		assert(resolved != nullptr);
+		assert(resolved->getName().find(__func__) != std::string::npos);
+
+		// kept placeholders are dropped when exceeds the limit
+		interceptor->setIpCacheCapacity(0);
+		interceptor->reset();
+		interceptor->setRawAddressMode(true, 1);
+		auto ip = models.at(0)->getIp();
+		interceptor->alter(models);
+		auto first = models.at(0)->getSymbolName();
+		interceptor->alter(models);
+		assert(models.at(0)->getSymbolName() == first);
+		models.at(0)->setIp(ip + 1);
+		interceptor->alter(models);
+		assert(models.at(0)->getSymbolName() != first);
+		models.at(0)->setIp(ip);
+		interceptor->alter(models);
+		auto second = models.at(0)->getSymbolName();
+		assert(second != first);
+		placeholders = { first, second };
+		SymbolName::bindPlaceholders(placeholders);
+		assert(SymbolName::resolveLateBound(first) == SymbolName::resolveLateBound(second));
+	}
+
+	void testCpuSampleLinuxSymbolResolveInterceptorRawAddressAnonymous() {
+		// anonymous mapping (jit code) should be resolved by perf map immediately
+		auto size = static_cast<std::size_t>(::getpagesize());
+		void* address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		assert(address != MAP_FAILED);
+		auto start = reinterpret_cast<std::uint64_t>(address);
+		std::string path = "/tmp/perf-" + std::to_string(::getpid()) + ".map";
+		{
+			std::ofstream file(path, std::ios::trunc);
+			file << std::hex << start << " 20 jitted_function" << std::endl;
+		}
+		auto interceptor = std::make_shared<CpuSampleLinuxSymbolResolveInterceptor>();
+		interceptor->setRawAddressMode(true);
+		std::vector<std::unique_ptr<CpuSampleModel>> models;
+		auto model = std::make_unique<CpuSampleModel>();
+		model->setPid(::getpid());
+		model->setTid(::getpid());
+		model->setIp(start + 0x10);
+		models.emplace_back(std::move(model));
+		interceptor->alter(models);
+		auto symbolName = models.at(0)->getSymbolName();
+		assert(symbolName != nullptr);
+		assert(!symbolName->isPlaceholder());
+		assert(symbolName->getName() == "jitted_function");
+		::unlink(path.c_str());
+		::munmap(address, size);
+	}
+
+	void testCpuSampleLinuxSymbolResolveInterceptorPrewarm() {
+		for (std::size_t asyncWorkerCount = 0; asyncWorkerCount < 2; ++asyncWorkerCount) {
+			auto interceptor = std::make_shared<CpuSampleLinuxSymbolResolveInterceptor>();
+			interceptor->setAsyncSymbolLoading(asyncWorkerCount);
+			auto duration = interceptor->prewarm({ ::getpid() }, 4);
+			assert(duration.count() > 0);
+			assert(interceptor->getPrewarmDuration() == duration);
+			// symbol tables are ready, even asynchronous loading doesn't return placeholders
+			std::vector<std::unique_ptr<CpuSampleModel>> models;
+			auto model = std::make_unique<CpuSampleModel>();
+			model->setPid(::getpid());
+			model->setTid(::getpid());
+			model->setIp(reinterpret_cast<std::uint64_t>(
+				&testCpuSampleLinuxSymbolResolveInterceptorPrewarm));
+			models.emplace_back(std::move(model));
+			interceptor->alter(models);
+			auto symbolName = models.at(0)->getSymbolName();
+			assert(symbolName != nullptr);
+			assert(!symbolName->isPending());
+			assert(symbolName->getName().find(__func__) != std::string::npos);
+		}
+	}
+
+	void testCpuSampleLinuxSymbolResolveInterceptorRemote() {
+		auto path = "/tmp/LiveProfilerTestRemoteSymbolInterceptor-" + std::to_string(::getpid()) + ".sock";
+		LinuxRemoteSymbolServer server(path);
+		std::thread thread([&server] { server.run(); });
+		auto interceptor = std::make_shared<CpuSampleLinuxSymbolResolveInterceptor>();
+		interceptor->setRemoteSymbolServer(path);
+		std::vector<std::unique_ptr<CpuSampleModel>> models;
+		for (std::size_t i = 0; i < 2; ++i) {
+			auto model = std::make_unique<CpuSampleModel>();
+			model->setPid(::getpid());
+			model->setTid(::getpid());
+			model->setIp(reinterpret_cast<std::uint64_t>(
+				&testCpuSampleLinuxSymbolResolveInterceptorRemote) + i);
+			model->getCallChainIps().emplace_back(reinterpret_cast<std::uint64_t>(
+				&testCpuSampleLinuxSymbolResolveInterceptorReset));
+			model->getCallChainSymbolNames().emplace_back(nullptr);
+			models.emplace_back(std::move(model));
+		}
+
+		// all addresses are resolved by one request, and placeholders are replaced
+		const auto& client = interceptor->getRemoteSymbolClient();
+		assert(client != nullptr);
+		for (std::size_t i = 0; i < 3; ++i) {
+			interceptor->alter(models);
+			auto symbolNameA = models.at(0)->getSymbolName();
+			auto symbolNameB = models.at(1)->getSymbolName();
+			auto callChainSymbolName = models.at(0)->getCallChainSymbolNames().at(0);
+			assert(symbolNameA != nullptr);
+			assert(!symbolNameA->isPlaceholder());
+			assert(symbolNameA->getName().find(__func__) != std::string::npos);
+			assert(symbolNameB == symbolNameA);
+			assert(callChainSymbolName != nullptr);
+			assert(callChainSymbolName->getName().find(
+				"testCpuSampleLinuxSymbolResolveInterceptorReset") != std::string::npos);
+			assert(client->getRequestCount() == 1);
+		}
+		server.stop();
+		thread.join();
+		assert(server.getResolverCount() == 1);
+	}
+
 	void testCpuSampleLinuxSymbolResolveInterceptor() {
 		std::cout << __func__ << std::endl;
 		testCpuSampleLinuxSymbolResolveInterceptorReset();
 		testCpuSampleLinuxSymbolResolveInterceptorAlter();
+		testCpuSampleLinuxSymbolResolveInterceptorIpCache();
+		testCpuSampleLinuxSymbolResolveInterceptorJitCode();
+		testCpuSampleLinuxSymbolResolveInterceptorAsync();
+		testCpuSampleLinuxSymbolResolveInterceptorRawAddress();
+		testCpuSampleLinuxSymbolResolveInterceptorRawAddressAnonymous();
+		testCpuSampleLinuxSymbolResolveInterceptorPrewarm();
+		testCpuSampleLinuxSymbolResolveInterceptorRemote();
 	}
 }
 #else // defined(__linux__)
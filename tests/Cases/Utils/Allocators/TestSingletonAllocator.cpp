@@ -16,6 +16,15 @@ namespace LiveProfilerTests {
 		assert(a == b);
 		assert(*c == "asd");
 		assert(a != c);
+		// moved keys
+		std::string x("qwe");
+		std::string y("zxc");
+		auto d = allocator.allocate(std::move(x));
+		auto e = allocator.allocate(std::move(y));
+		assert(*d == "qwe");
+		assert(*e == "zxc");
+		assert(allocator.allocate("qwe") == d);
+		assert(allocator.allocate("zxc") == e);
 	}
 }
 
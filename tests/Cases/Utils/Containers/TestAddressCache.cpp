@@ -0,0 +1,53 @@
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <LiveProfiler/Utils/Containers/AddressCache.hpp>
+
+namespace LiveProfilerTests {
+	using namespace LiveProfiler;
+
+	void testAddressCacheGetAndSet() {
+		AddressCache<std::string> cache;
+		cache.reset(3);
+		assert(cache.capacity() == 4);
+		assert(cache.get(0x1000) == nullptr);
+		cache.set(0x1000, "a");
+		cache.set(0x2000, "b");
+		assert(cache.get(0x1000) != nullptr && *cache.get(0x1000) == "a");
+		assert(cache.get(0x2000) != nullptr && *cache.get(0x2000) == "b");
+		cache.set(0x1000, "c");
+		assert(*cache.get(0x1000) == "c");
+		// address 0 can't be cached
+		cache.set(0, "d");
+		assert(cache.get(0) == nullptr);
+		cache.clear();
+		assert(cache.get(0x1000) == nullptr);
+		assert(cache.get(0x2000) == nullptr);
+	}
+
+	void testAddressCacheReplace() {
+		// only one set, the least recently used one should be replaced
+		AddressCache<int> cache;
+		cache.reset(1);
+		assert(cache.capacity() == 2);
+		cache.set(0x1000, 1);
+		cache.set(0x2000, 2);
+		assert(*cache.get(0x1000) == 1);
+		cache.set(0x3000, 3);
+		assert(cache.get(0x1000) != nullptr);
+		assert(cache.get(0x2000) == nullptr);
+		assert(cache.get(0x3000) != nullptr);
+		// values from previous use should be removed
+		cache.freeResources();
+		cache.reset(16);
+		assert(cache.capacity() == 16);
+		assert(cache.get(0x1000) == nullptr);
+	}
+
+	void testAddressCache() {
+		std::cout << __func__ << std::endl;
+		testAddressCacheGetAndSet();
+		testAddressCacheReplace();
+	}
+}
+
@@ -0,0 +1,56 @@
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <LiveProfiler/Utils/Containers/LruCache.hpp>
+
+namespace LiveProfilerTests {
+	using namespace LiveProfiler;
+
+	void testLruCacheGetAndSet() {
+		LruCache<std::string, int> cache(3);
+		assert(cache.capacity() == 3);
+		assert(cache.get("a") == nullptr);
+		cache.set("a", 1);
+		cache.set("b", 2);
+		assert(cache.size() == 2);
+		assert(cache.get("a") != nullptr && *cache.get("a") == 1);
+		assert(cache.get("b") != nullptr && *cache.get("b") == 2);
+		cache.set("a", 3);
+		assert(cache.size() == 2);
+		assert(*cache.get("a") == 3);
+		cache.clear();
+		assert(cache.size() == 0);
+		assert(cache.get("a") == nullptr);
+	}
+
+	void testLruCacheEvict() {
+		LruCache<int, int> cache(2);
+		cache.set(1, 1);
+		cache.set(2, 2);
+		// 1 is used recently so 2 should be evicted
+		assert(*cache.get(1) == 1);
+		cache.set(3, 3);
+		assert(cache.size() == 2);
+		assert(cache.get(1) != nullptr);
+		assert(cache.get(2) == nullptr);
+		assert(cache.get(3) != nullptr);
+		// updating also marks the entry as recently used
+		cache.set(1, 4);
+		cache.set(5, 5);
+		assert(cache.get(3) == nullptr);
+		assert(*cache.get(1) == 4);
+		assert(*cache.get(5) == 5);
+		// nothing is cached if capacity is 0
+		cache.reset(0);
+		cache.set(1, 1);
+		assert(cache.size() == 0);
+		assert(cache.get(1) == nullptr);
+	}
+
+	void testLruCache() {
+		std::cout << __func__ << std::endl;
+		testLruCacheGetAndSet();
+		testLruCacheEvict();
+	}
+}
+
@@ -0,0 +1,77 @@
+#include <iostream>
+#include <cassert>
+#include <memory>
+#include <thread>
+#include <LiveProfiler/Utils/Containers/SpscQueue.hpp>
+
+namespace LiveProfilerTests {
+	using namespace LiveProfiler;
+
+	void testSpscQueueSingleThread() {
+		SpscQueue<std::unique_ptr<int>> queue(3);
+		assert(queue.capacity() == 4);
+		assert(queue.empty());
+		for (int i = 0; i < 4; ++i) {
+			assert(queue.push(std::make_unique<int>(i)));
+		}
+		auto value = std::make_unique<int>(100);
+		assert(!queue.push(std::move(value)));
+		assert(value != nullptr && *value == 100);
+		for (int i = 0; i < 4; ++i) {
+			assert(queue.pop(value));
+			assert(*value == i);
+		}
+		assert(!queue.pop(value));
+		assert(queue.empty());
+	}
+
+	void testSpscQueueLayout() {
+		// head and tail should be in different cache lines even if the queue is allocated on heap
+		class TestQueue : public SpscQueue<int> {
+		public:
+			using SpscQueue<int>::SpscQueue;
+			std::size_t getHeadToTailDistance() const {
+				return reinterpret_cast<const char*>(&tail_) - reinterpret_cast<const char*>(&head_);
+			}
+		};
+		for (std::size_t i = 0; i < 100; ++i) {
+			auto queue = std::make_unique<TestQueue>(4);
+			assert(queue->getHeadToTailDistance() >= TestQueue::CacheLineSize);
+		}
+	}
+
+	void testSpscQueueMultiThread() {
+		static const std::size_t Count = 100000;
+		SpscQueue<std::size_t> queue(64);
+		std::thread producer([&queue] {
+			for (std::size_t i = 0; i < Count;) {
+				std::size_t value = i;
+				if (queue.push(std::move(value))) {
+					++i;
+				} else {
+					std::this_thread::yield();
+				}
+			}
+		});
+		std::size_t expected = 0;
+		while (expected < Count) {
+			std::size_t value = 0;
+			if (queue.pop(value)) {
+				assert(value == expected);
+				++expected;
+			} else {
+				std::this_thread::yield();
+			}
+		}
+		producer.join();
+		assert(queue.empty());
+	}
+
+	void testSpscQueue() {
+		std::cout << __func__ << std::endl;
+		testSpscQueueSingleThread();
+		testSpscQueueLayout();
+		testSpscQueueMultiThread();
+	}
+}
+
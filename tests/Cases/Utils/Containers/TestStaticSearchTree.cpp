@@ -0,0 +1,78 @@
+#include <iostream>
+#include <cassert>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <LiveProfiler/Utils/Containers/StaticSearchTree.hpp>
+
+namespace LiveProfilerTests {
+	using namespace LiveProfiler;
+
+	void testStaticSearchTreeEmpty() {
+		StaticSearchTree tree;
+		assert(tree.empty());
+		assert(tree.upperBound(0) == 0);
+		assert(tree.upperBound(UINT64_MAX) == 0);
+		std::vector<std::uint64_t> keys;
+		assert(tree.assign(keys.size(), [&keys](auto index) { return keys[index]; }));
+		assert(tree.empty());
+		std::uint64_t value = 123;
+		std::size_t result = 1;
+		tree.upperBound(&value, 1, &result);
+		assert(result == 0);
+	}
+
+	void testStaticSearchTreeUpperBound() {
+		// compare with std::upper_bound, include duplicated keys and sizes not fill the last node
+		std::mt19937_64 generator(0x1234);
+		for (std::size_t size = 1; size < 1000; size += (size < 100) ? 1 : 97) {
+			std::vector<std::uint64_t> keys(size);
+			for (auto& key : keys) {
+				key = generator() % (size * 4);
+			}
+			keys.back() = UINT64_MAX - 1;
+			std::sort(keys.begin(), keys.end());
+			StaticSearchTree tree;
+			assert(tree.assign(keys.size(), [&keys](auto index) { return keys[index]; }));
+			assert(tree.size() == size);
+			std::vector<std::uint64_t> values;
+			for (std::size_t i = 0; i < size * 5; ++i) {
+				values.emplace_back(i);
+			}
+			values.emplace_back(UINT64_MAX - 2);
+			values.emplace_back(UINT64_MAX - 1);
+			values.emplace_back(UINT64_MAX);
+			std::vector<std::size_t> results(values.size());
+			tree.upperBound(values.data(), values.size(), results.data());
+			for (std::size_t i = 0; i < values.size(); ++i) {
+				auto expected = static_cast<std::size_t>(
+					std::upper_bound(keys.begin(), keys.end(), values[i]) - keys.begin());
+				assert(tree.upperBound(values[i]) == expected);
+				assert(results[i] == expected);
+			}
+		}
+	}
+
+	void testStaticSearchTreeReassign() {
+		StaticSearchTree tree;
+		std::vector<std::uint64_t> keys({ 10, 20, 30 });
+		assert(tree.assign(keys.size(), [&keys](auto index) { return keys[index]; }));
+		assert(tree.upperBound(15) == 1);
+		keys = { 100 };
+		assert(tree.assign(keys.size(), [&keys](auto index) { return keys[index]; }));
+		assert(tree.size() == 1);
+		assert(tree.upperBound(15) == 0);
+		assert(tree.upperBound(100) == 1);
+		tree.clear();
+		assert(tree.empty());
+		assert(tree.upperBound(15) == 0);
+	}
+
+	void testStaticSearchTree() {
+		std::cout << __func__ << std::endl;
+		testStaticSearchTreeEmpty();
+		testStaticSearchTreeUpperBound();
+		testStaticSearchTreeReassign();
+	}
+}
+
@@ -0,0 +1,52 @@
+#if defined(__linux__)
+#include <unistd.h>
+#include <iostream>
+#include <cassert>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxCgroupUtils.hpp>
+
+namespace LiveProfilerTests {
+	using namespace LiveProfiler;
+
+	void testLinuxCgroupUtilsGetProcessCgroupPath() {
+		auto mountPoint = LinuxCgroupUtils::getCgroupMountPoint();
+		assert(!mountPoint.empty());
+		auto path = LinuxCgroupUtils::getProcessCgroupPath(::getpid());
+		assert(path.size() > mountPoint.size());
+		assert(path.compare(0, mountPoint.size(), mountPoint) == 0);
+		assert(LinuxCgroupUtils::getProcessCgroupPath(0).empty());
+	}
+
+	void testLinuxCgroupUtilsGetCgroupId() {
+		auto path = LinuxCgroupUtils::getProcessCgroupPath(::getpid());
+		assert(LinuxCgroupUtils::getCgroupId(path) != 0);
+		assert(LinuxCgroupUtils::getCgroupId("/path/not/exist") == 0);
+	}
+
+	void testLinuxCgroupUtilsOpenCgroup() {
+		auto path = LinuxCgroupUtils::getProcessCgroupPath(::getpid());
+		auto fd = LinuxCgroupUtils::openCgroup(path);
+		assert(fd > 0);
+		::close(fd);
+		bool thrown = false;
+		try {
+			LinuxCgroupUtils::openCgroup("/path/not/exist");
+		} catch (const ProfilerException&) {
+			thrown = true;
+		}
+		assert(thrown);
+	}
+
+	void testLinuxCgroupUtils() {
+		std::cout << __func__ << std::endl;
+		testLinuxCgroupUtilsGetProcessCgroupPath();
+		testLinuxCgroupUtilsGetCgroupId();
+		testLinuxCgroupUtilsOpenCgroup();
+	}
+}
+#else // defined(__linux__)
+namespace LiveProfilerTests {
+	void testLinuxCgroupUtils() {
+		// unsupported on other platform
+	}
+}
+#endif // defined(__linux__)
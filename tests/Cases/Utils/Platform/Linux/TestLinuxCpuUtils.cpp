@@ -0,0 +1,40 @@
+#if defined(__linux__)
+#include <unistd.h>
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <thread>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxCpuUtils.hpp>
+
+namespace LiveProfilerTests {
+	using namespace LiveProfiler;
+
+	void testLinuxCpuUtils() {
+		std::cout << __func__ << std::endl;
+		std::vector<int> cpus;
+		LinuxCpuUtils::listOnlineCpus(cpus);
+		assert(cpus.size() == static_cast<std::size_t>(::sysconf(_SC_NPROCESSORS_ONLN)));
+		assert(std::is_sorted(cpus.cbegin(), cpus.cend()));
+		assert(cpus.front() >= 0);
+
+		// the process may not allowed to run on all online cpus
+		::cpu_set_t allowed;
+		assert(::sched_getaffinity(0, sizeof(allowed), &allowed) == 0);
+		auto it = std::find_if(cpus.crbegin(), cpus.crend(),
+			[&allowed](int cpu) { return CPU_ISSET(cpu, &allowed); });
+		assert(it != cpus.crend());
+		int cpu = *it;
+		std::thread t([cpu] {
+			assert(LinuxCpuUtils::setCurrentThreadAffinity(cpu));
+			assert(::sched_getcpu() == cpu);
+		});
+		t.join();
+	}
+}
+#else // defined(__linux__)
+namespace LiveProfilerTests {
+	void testLinuxCpuUtils() {
+		// unsupported on other platform
+	}
+}
+#endif // defined(__linux__)
@@ -0,0 +1,5 @@
+#pragma once
+namespace LiveProfilerTests {
+	void testLinuxCpuUtils();
+}
+
@@ -0,0 +1,109 @@
+#if defined(__linux__)
+#include <unistd.h>
+#include <iostream>
+#include <cassert>
+#include <LiveProfiler/Utils/Allocators/SingletonAllocator.hpp>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxProcessAddressLocator.hpp>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxDwarfLineIndex.hpp>
+
+namespace LiveProfilerTests {
+	using namespace LiveProfiler;
+
+	namespace {
+		std::size_t testLinuxDwarfLineIndexCallLine = 0;
+		std::size_t testLinuxDwarfLineIndexInlinedCallLine = 0;
+
+		__attribute__((noinline)) void* testLinuxDwarfLineIndexReturnAddress() {
+			void* address = __builtin_return_address(0);
+			asm volatile("" : : "r"(address) : "memory");
+			return address;
+		}
+
+		__attribute__((always_inline)) inline void* testLinuxDwarfLineIndexInlined() {
+			testLinuxDwarfLineIndexInlinedCallLine = __LINE__ + 1;
+			return testLinuxDwarfLineIndexReturnAddress();
+		}
+
+		__attribute__((noinline)) void* testLinuxDwarfLineIndexOuter() {
+			testLinuxDwarfLineIndexCallLine = __LINE__ + 1;
+			void* address = testLinuxDwarfLineIndexInlined();
+			asm volatile("" : : "r"(address) : "memory");
+			return address;
+		}
+
+		std::pair<std::shared_ptr<std::string>, std::ptrdiff_t> testLinuxDwarfLineIndexLocate(
+			const void* address) {
+			auto pathAllocator = std::make_shared<SingletonAllocator<std::string, std::string>>();
+			LinuxProcessAddressLocator locator;
+			locator.reset(::getpid(), pathAllocator);
+			auto pathAndOffset = locator.locate(reinterpret_cast<std::uintptr_t>(address), false);
+			assert(pathAndOffset.first != nullptr);
+			return pathAndOffset;
+		}
+	}
+
+	void testLinuxDwarfLineIndexResolveInlined() {
+		// the return address points to the instruction after call, minus 1 to get the call site
+		auto address = static_cast<const char*>(testLinuxDwarfLineIndexOuter()) - 1;
+		auto pathAndOffset = testLinuxDwarfLineIndexLocate(address);
+		LinuxDwarfLineIndex index(*pathAndOffset.first);
+		assert(index.isValid());
+		assert(index.getCompileUnitCount() > 0);
+		assert(index.getCachedCompileUnitCount() == 0);
+		std::vector<LinuxDwarfLineIndex::Frame> frames;
+		assert(index.resolve(pathAndOffset.second, frames));
+		assert(index.getCachedCompileUnitCount() == 1);
+		assert(frames.size() == 2);
+		assert(frames[0].function->find("testLinuxDwarfLineIndexInlined") != std::string::npos);
+		assert(frames[0].file != nullptr);
+		assert(frames[0].file->find("TestLinuxDwarfLineIndex.cpp") != std::string::npos);
+		assert(frames[0].line == testLinuxDwarfLineIndexInlinedCallLine);
+		assert(frames[1].function->find("testLinuxDwarfLineIndexOuter") != std::string::npos);
+		assert(frames[1].file != nullptr);
+		assert(*frames[1].file == *frames[0].file);
+		assert(frames[1].line == testLinuxDwarfLineIndexCallLine);
+		// resolve again uses the cached compile unit
+		assert(index.resolve(pathAndOffset.second, frames));
+		assert(frames.size() == 2);
+		assert(index.getCachedCompileUnitCount() == 1);
+	}
+
+	void testLinuxDwarfLineIndexCacheLimit() {
+		auto pathAndOffset = testLinuxDwarfLineIndexLocate(
+			reinterpret_cast<const void*>(&testLinuxDwarfLineIndexCacheLimit));
+		auto otherPathAndOffset = testLinuxDwarfLineIndexLocate(
+			reinterpret_cast<const void*>(&testLinuxDwarfLineIndexResolveInlined));
+		LinuxDwarfLineIndex index(*pathAndOffset.first);
+		index.setMaxCachedCompileUnits(1);
+		std::vector<LinuxDwarfLineIndex::Frame> frames;
+		assert(index.resolve(pathAndOffset.second, frames));
+		assert(frames.size() == 1);
+		assert(frames[0].function->find(__func__) != std::string::npos);
+		assert(frames[0].line > 0);
+		assert(index.resolve(otherPathAndOffset.second, frames));
+		assert(index.getCachedCompileUnitCount() == 1);
+		assert(!index.resolve(0, frames));
+		assert(frames.empty());
+	}
+
+	void testLinuxDwarfLineIndexInvalid() {
+		LinuxDwarfLineIndex index("/proc/self/maps");
+		assert(!index.isValid());
+		std::vector<LinuxDwarfLineIndex::Frame> frames;
+		assert(!index.resolve(0x1000, frames));
+	}
+
+	void testLinuxDwarfLineIndex() {
+		std::cout << __func__ << std::endl;
+		testLinuxDwarfLineIndexResolveInlined();
+		testLinuxDwarfLineIndexCacheLimit();
+		testLinuxDwarfLineIndexInvalid();
+	}
+}
+#else // defined(__linux__)
+namespace LiveProfilerTests {
+	void testLinuxDwarfLineIndex() {
+		// unsupported on other platform
+	}
+}
+#endif // defined(__linux__)
@@ -0,0 +1,64 @@
+#if defined(__linux__)
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxEhFrameUtils.hpp>
+
+namespace LiveProfilerTests {
+	using namespace LiveProfiler;
+
+	void testLinuxEhFrameUtilsReadFunctionRanges() {
+		LinuxElfFile file("/proc/self/exe");
+		assert(file.isOpen());
+		std::vector<LinuxEhFrameUtils::RangeType> ranges;
+		assert(LinuxEhFrameUtils::readFunctionRanges(file, ranges));
+		assert(!ranges.empty());
+		assert(std::is_sorted(ranges.cbegin(), ranges.cend()));
+		assert(std::all_of(ranges.cbegin(), ranges.cend(), [](const auto& range) {
+			return range.first < range.second;
+		}));
+		// the range of this function should be the same as it's symbol
+		std::size_t symbolCount = 0;
+		for (const auto& section : file.getSections()) {
+			if (section.type != SHT_SYMTAB) {
+				continue;
+			}
+			file.forEachSymbol(section, [&ranges, &symbolCount](const auto& symbol) {
+				if (symbol.type != STT_FUNC || symbol.size == 0 ||
+					std::strstr(symbol.name, "testLinuxEhFrameUtilsReadFunctionRanges") == nullptr) {
+					return;
+				}
+				++symbolCount;
+				auto it = std::lower_bound(ranges.cbegin(), ranges.cend(),
+					LinuxEhFrameUtils::RangeType(symbol.value, 0));
+				assert(it != ranges.cend());
+				assert(it->first == symbol.value);
+				assert(it->second == symbol.value + symbol.size);
+			});
+		}
+		assert(symbolCount > 0); // may have clones like .cold, they have their own FDEs
+	}
+
+	void testLinuxEhFrameUtilsReadFromInvalidFile() {
+		LinuxElfFile file("/proc/self/maps");
+		assert(!file.isOpen());
+		std::vector<LinuxEhFrameUtils::RangeType> ranges({ { 1, 2 } });
+		assert(!LinuxEhFrameUtils::readFunctionRanges(file, ranges));
+		assert(ranges.empty());
+	}
+
+	void testLinuxEhFrameUtils() {
+		std::cout << __func__ << std::endl;
+		testLinuxEhFrameUtilsReadFunctionRanges();
+		testLinuxEhFrameUtilsReadFromInvalidFile();
+	}
+}
+#else // defined(__linux__)
+namespace LiveProfilerTests {
+	void testLinuxEhFrameUtils() {
+		// unsupported on other platform
+	}
+}
+#endif // defined(__linux__)
+
@@ -0,0 +1,72 @@
+#if defined(__linux__)
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxElfFile.hpp>
+
+namespace LiveProfilerTests {
+	using namespace LiveProfiler;
+
+	void testLinuxElfFileOpen() {
+		LinuxElfFile file("/proc/self/exe");
+		assert(file.isOpen());
+		assert(file.size() > 0);
+		assert(file.is64Bit() == (sizeof(void*) == 8));
+		assert(file.getType() == ET_EXEC || file.getType() == ET_DYN);
+		bool hasLoadSegment = false;
+		for (const auto& segment : file.getSegments()) {
+			hasLoadSegment = hasLoadSegment || segment.type == PT_LOAD;
+		}
+		assert(hasLoadSegment);
+		auto text = file.findSection(".text");
+		assert(text != nullptr);
+		assert(text->type == SHT_PROGBITS);
+		assert(file.getSectionData(*text) != nullptr);
+		assert(file.findSection(".not_exist") == nullptr);
+		assert(file.findSectionByType(SHT_DYNSYM) != nullptr);
+		file.close();
+		assert(!file.isOpen());
+		assert(file.getSections().empty());
+		assert(!file.open("/path/not/exist"));
+		assert(!file.open("/proc/self/maps"));
+		assert(!file.open("/proc/self"));
+	}
+
+	void testLinuxElfFileForEachSymbol() {
+		LinuxElfFile file("/proc/self/exe");
+		assert(file.isOpen());
+		auto symtab = file.findSectionByType(SHT_SYMTAB);
+		assert(symtab != nullptr);
+		assert(file.getSymbolCount(*symtab) > 0);
+		std::size_t count = 0;
+		bool found = false;
+		LinuxElfFile::Symbol foundSymbol = {};
+		file.forEachSymbol(*symtab, [&count, &found, &foundSymbol](const auto& symbol) {
+			++count;
+			if (std::strstr(symbol.name, "testLinuxElfFileForEachSymbol") != nullptr) {
+				found = true;
+				foundSymbol = symbol;
+			}
+		});
+		assert(count == file.getSymbolCount(*symtab));
+		assert(found);
+		assert(foundSymbol.type == STT_FUNC);
+		assert(foundSymbol.value != 0);
+		assert(foundSymbol.size != 0);
+		assert(foundSymbol.sectionIndex < file.getSections().size());
+		assert(&file.getSections()[foundSymbol.sectionIndex] == file.findSection(".text"));
+	}
+
+	void testLinuxElfFile() {
+		std::cout << __func__ << std::endl;
+		testLinuxElfFileOpen();
+		testLinuxElfFileForEachSymbol();
+	}
+}
+#else // defined(__linux__)
+namespace LiveProfilerTests {
+	void testLinuxElfFile() {
+		// unsupported on other platform
+	}
+}
+#endif // defined(__linux__)
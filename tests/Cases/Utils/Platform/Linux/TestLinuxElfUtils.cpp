@@ -0,0 +1,74 @@
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/stat.h>
+#include <iostream>
+#include <fstream>
+#include <cassert>
+#include <algorithm>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxElfUtils.hpp>
+
+namespace LiveProfilerTests {
+	using namespace LiveProfiler;
+
+	void testLinuxElfUtilsReadBuildId() {
+		std::string buildId;
+		assert(LinuxElfUtils::readBuildId("/proc/self/exe", buildId));
+		assert(!buildId.empty());
+		assert(buildId.size() % 2 == 0);
+		assert(std::all_of(buildId.cbegin(), buildId.cend(), [](char c) {
+			return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+		}));
+		assert(!LinuxElfUtils::readBuildId("/proc/self/maps", buildId));
+		assert(buildId.empty());
+		assert(!LinuxElfUtils::readBuildId("/path/not/exist", buildId));
+	}
+
+	void testLinuxElfUtilsCrc32() {
+		static const char data[] = "123456789";
+		assert(LinuxElfUtils::crc32(data, 0) == 0);
+		assert(LinuxElfUtils::crc32(data, 9) == 0xcbf43926);
+		// crc can be calculated incrementally
+		assert(LinuxElfUtils::crc32(data + 4, 5, LinuxElfUtils::crc32(data, 4)) == 0xcbf43926);
+	}
+
+	void testLinuxElfUtilsFindDebugFile() {
+		LinuxElfFile file("/proc/self/exe");
+		assert(file.isOpen());
+		std::string name;
+		std::uint32_t crc = 0;
+		assert(!LinuxElfUtils::readDebugLink(file, name, crc));
+		std::string debugPath;
+		auto directory = "/tmp/LiveProfilerTestDebugFile-" + std::to_string(::getpid());
+		assert(!LinuxElfUtils::findDebugFile(file, "/proc/self/exe", debugPath, directory));
+		assert(debugPath.empty());
+		// place a copy of the file to $directory/.build-id/xx/yyyy.debug
+		std::string buildId;
+		assert(LinuxElfUtils::readBuildId(file, buildId));
+		auto buildIdDirectory = directory + "/.build-id/" + buildId.substr(0, 2);
+		auto expectedPath = buildIdDirectory + "/" + buildId.substr(2) + ".debug";
+		::mkdir(directory.c_str(), 0700);
+		::mkdir((directory + "/.build-id").c_str(), 0700);
+		::mkdir(buildIdDirectory.c_str(), 0700);
+		{ std::ofstream debugFile(expectedPath); debugFile << "abc"; }
+		assert(LinuxElfUtils::findDebugFile(file, "/proc/self/exe", debugPath, directory));
+		assert(debugPath == expectedPath);
+		::unlink(expectedPath.c_str());
+		::rmdir(buildIdDirectory.c_str());
+		::rmdir((directory + "/.build-id").c_str());
+		::rmdir(directory.c_str());
+	}
+
+	void testLinuxElfUtils() {
+		std::cout << __func__ << std::endl;
+		testLinuxElfUtilsReadBuildId();
+		testLinuxElfUtilsCrc32();
+		testLinuxElfUtilsFindDebugFile();
+	}
+}
+#else // defined(__linux__)
+namespace LiveProfilerTests {
+	void testLinuxElfUtils() {
+		// unsupported on other platform
+	}
+}
+#endif // defined(__linux__)
@@ -1,7 +1,10 @@
 #if defined(__linux__)
 #include <unistd.h>
+#include <sys/stat.h>
 #include <iostream>
+#include <fstream>
 #include <cassert>
+#include <cstdio>
 #include <LiveProfiler/Utils/Allocators/SingletonAllocator.hpp>
 #include <LiveProfiler/Utils/Platform/Linux/LinuxProcessAddressLocator.hpp>
 #include <LiveProfiler/Utils/Platform/Linux/LinuxExecutableSymbolResolver.hpp>
@@ -9,6 +12,63 @@
 namespace LiveProfilerTests {
 	using namespace LiveProfiler;
 
+	namespace {
+		/**
+		 * Function only listed in .symtab, the test binary may be linked with -rdynamic
+		 * and then all external functions are also exported in .dynsym
+		 */
+		__attribute__((noinline)) int testLinuxExecutableSymbolResolverStrippedTarget(int value) {
+			asm volatile("" : "+r"(value) : : "memory");
+			return value * 3 + 1;
+		}
+
+		/** Copy the file, then simulate `strip` by hiding .symtab and .debug_info of the copy */
+		void makeStrippedCopy(const std::string& path, const std::string& strippedPath) {
+			{
+				std::ifstream source(path, std::ios::binary);
+				std::ofstream target(strippedPath, std::ios::binary);
+				target << source.rdbuf();
+			}
+			std::size_t sectionHeaderOffset = 0;
+			std::size_t sectionHeaderSize = 0;
+			std::vector<std::pair<std::size_t, std::size_t>> patches; // (offset, size)
+			{
+				LinuxElfFile file(path);
+				assert(file.isOpen());
+				if (file.is64Bit()) {
+					Elf64_Ehdr header;
+					std::memcpy(&header, file.data(), sizeof(header));
+					sectionHeaderOffset = header.e_shoff;
+					sectionHeaderSize = header.e_shentsize;
+				} else {
+					Elf32_Ehdr header;
+					std::memcpy(&header, file.data(), sizeof(header));
+					sectionHeaderOffset = header.e_shoff;
+					sectionHeaderSize = header.e_shentsize;
+				}
+				const auto& sections = file.getSections();
+				for (std::size_t index = 0; index < sections.size(); ++index) {
+					// sh_type is at the same offset in elf32 and elf64, set it to SHT_NULL
+					if (sections[index].type == SHT_SYMTAB) {
+						patches.emplace_back(sectionHeaderOffset + sectionHeaderSize * index + 4, 4);
+					} else if (std::strncmp(sections[index].name, ".debug_", 7) == 0) {
+						// rename .debug_xxx to .xebug_xxx
+						patches.emplace_back(sections[index].name + 1 - file.data(), 1);
+					}
+				}
+			}
+			std::fstream target(strippedPath, std::ios::binary | std::ios::in | std::ios::out);
+			for (const auto& patch : patches) {
+				target.seekp(patch.first);
+				if (patch.second == 4) {
+					target.write("\0\0\0\0", 4);
+				} else {
+					target.write("x", 1);
+				}
+			}
+		}
+	}
+
 	void testLinuxExecutableSymbolResolverResolveSelf() {
 		auto pathAllocator = std::make_shared<SingletonAllocator<std::string, std::string>>();
 		LinuxProcessAddressLocator locator;
@@ -26,11 +86,110 @@ namespace LiveProfilerTests {
 		assert(symbolName->getPath() == pathAndOffset.first);
 		assert(symbolName->getFileOffsetStart() > 0);
 		assert(symbolName->getFileOffsetEnd() > symbolName->getFileOffsetStart());
+		std::vector<LinuxDwarfLineIndex::Frame> frames;
+		assert(resolver.resolveSourceLocations(pathAndOffset.second, frames));
+		assert(!frames.empty());
+		assert(frames.back().function->find(__func__) != std::string::npos);
+		assert(frames.front().file != nullptr);
+		assert(frames.front().line > 0);
+	}
+
+	void testLinuxExecutableSymbolResolverResolveSharedLibrary() {
+		auto pathAllocator = std::make_shared<SingletonAllocator<std::string, std::string>>();
+		LinuxProcessAddressLocator locator;
+		locator.reset(::getpid(), pathAllocator);
+		auto address = reinterpret_cast<uintptr_t>(&::getpid);
+		auto pathAndOffset = locator.locate(address, false);
+		assert(pathAndOffset.first != nullptr);
+		LinuxExecutableSymbolResolver resolver(pathAndOffset.first);
+		assert(!resolver.getSymbolTable().empty());
+		auto symbolName = resolver.resolve(pathAndOffset.second);
+		assert(symbolName != nullptr);
+		assert(symbolName->getOriginalName().find("getpid") != std::string::npos);
+		assert(symbolName->getFileOffsetEnd() > symbolName->getFileOffsetStart());
+	}
+
+	void testLinuxExecutableSymbolResolverResolveNotElf() {
+		LinuxExecutableSymbolResolver resolver(std::make_shared<std::string>("/proc/self/maps"));
+		assert(resolver.getSymbolTable().empty());
+		assert(resolver.resolve(0) == nullptr);
+		LinuxExecutableSymbolResolver emptyResolver(std::make_shared<std::string>(""));
+		assert(emptyResolver.getSymbolTable().empty());
+	}
+
+	void testLinuxExecutableSymbolResolverResolveStripped() {
+		auto pathAllocator = std::make_shared<SingletonAllocator<std::string, std::string>>();
+		LinuxProcessAddressLocator locator;
+		locator.reset(::getpid(), pathAllocator);
+		auto address = reinterpret_cast<uintptr_t>(
+			&testLinuxExecutableSymbolResolverStrippedTarget) + 1;
+		std::string targetName("testLinuxExecutableSymbolResolverStrippedTarget");
+		auto pathAndOffset = locator.locate(address, false);
+		assert(pathAndOffset.first != nullptr);
+		// stripped copy and debug file placed by build-id
+		auto directory = "/tmp/LiveProfilerTestStripped-" + std::to_string(::getpid());
+		auto strippedPath = std::make_shared<std::string>(directory + "/a.out");
+		std::string buildId;
+		assert(LinuxElfUtils::readBuildId(*pathAndOffset.first, buildId));
+		auto buildIdDirectory = directory + "/.build-id/" + buildId.substr(0, 2);
+		auto debugPath = buildIdDirectory + "/" + buildId.substr(2) + ".debug";
+		::mkdir(directory.c_str(), 0700);
+		::mkdir((directory + "/.build-id").c_str(), 0700);
+		::mkdir(buildIdDirectory.c_str(), 0700);
+		makeStrippedCopy(*pathAndOffset.first, *strippedPath);
+		{
+			// without debug file, the function is found by .eh_frame and has a synthetic name
+			LinuxExecutableSymbolResolver originalResolver(pathAndOffset.first);
+			auto originalSymbolName = originalResolver.resolve(pathAndOffset.second);
+			assert(originalSymbolName != nullptr);
+			LinuxExecutableSymbolResolver resolver(strippedPath, nullptr, directory);
+			auto symbolName = resolver.resolve(pathAndOffset.second);
+			assert(symbolName != nullptr);
+			char expectedName[32];
+			std::snprintf(expectedName, sizeof(expectedName), "sub_%zx@a.out",
+				originalSymbolName->getFileOffsetStart());
+			assert(symbolName->getOriginalName() == expectedName);
+			assert(symbolName->getFileOffsetStart() == originalSymbolName->getFileOffsetStart());
+			assert(symbolName->getFileOffsetEnd() == originalSymbolName->getFileOffsetEnd());
+			std::vector<LinuxDwarfLineIndex::Frame> frames;
+			assert(!resolver.resolveSourceLocations(pathAndOffset.second, frames));
+		}
+		{
+			std::ifstream source(*pathAndOffset.first, std::ios::binary);
+			std::ofstream target(debugPath, std::ios::binary);
+			target << source.rdbuf();
+		}
+		{
+			// with debug file
+			LinuxExecutableSymbolResolver resolver(strippedPath, nullptr, directory);
+			auto symbolName = resolver.resolve(pathAndOffset.second);
+			assert(symbolName != nullptr);
+			assert(symbolName->getOriginalName().find(targetName) != std::string::npos);
+			assert(symbolName->getPath() == strippedPath);
+			std::vector<LinuxDwarfLineIndex::Frame> frames;
+			assert(resolver.resolveSourceLocations(pathAndOffset.second, frames));
+			assert(frames.back().function->find(targetName) != std::string::npos);
+			// functions may also be exported in .dynsym, they should be found from either table
+			auto exportedPathAndOffset = locator.locate(reinterpret_cast<uintptr_t>(
+				&testLinuxExecutableSymbolResolverResolveStripped) + 1, false);
+			assert(exportedPathAndOffset.first == pathAndOffset.first);
+			auto exportedSymbolName = resolver.resolve(exportedPathAndOffset.second);
+			assert(exportedSymbolName != nullptr);
+			assert(exportedSymbolName->getOriginalName().find(__func__) != std::string::npos);
+		}
+		::unlink(debugPath.c_str());
+		::unlink(strippedPath->c_str());
+		::rmdir(buildIdDirectory.c_str());
+		::rmdir((directory + "/.build-id").c_str());
+		::rmdir(directory.c_str());
 	}
 
 	void testLinuxExecutableSymbolResolver() {
 		std::cout << __func__ << std::endl;
 		testLinuxExecutableSymbolResolverResolveSelf();
+		testLinuxExecutableSymbolResolverResolveSharedLibrary();
+		testLinuxExecutableSymbolResolverResolveNotElf();
+		testLinuxExecutableSymbolResolverResolveStripped();
 	}
 }
 #else // defined(__linux__)
@@ -0,0 +1,142 @@
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/stat.h>
+#include <iostream>
+#include <fstream>
+#include <cassert>
+#include <LiveProfiler/Utils/Allocators/SingletonAllocator.hpp>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxElfUtils.hpp>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxExecutableSymbolResolverAllocator.hpp>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxProcessAddressLocator.hpp>
+
+namespace LiveProfilerTests {
+	using namespace LiveProfiler;
+
+	void testLinuxExecutableSymbolResolverAllocatorShareFile() {
+		auto pathAllocator = std::make_shared<SingletonAllocator<std::string, std::string>>();
+		LinuxProcessAddressLocator locator;
+		locator.reset(::getpid(), pathAllocator);
+		auto address = reinterpret_cast<std::uintptr_t>(&testLinuxExecutableSymbolResolverAllocatorShareFile);
+		auto* map = locator.locateMap(address, false);
+		assert(map != nullptr);
+		assert(map->getInode() != 0);
+		auto path = map->getPath();
+		struct ::stat st;
+		assert(::stat(path->c_str(), &st) == 0);
+		assert(map->getDevice() == st.st_dev);
+		assert(map->getInode() == st.st_ino);
+		// the same (device, inode) shares the same resolver
+		LinuxExecutableSymbolResolverAllocator allocator;
+		auto resolver = allocator.allocate(path, map->getDevice(), map->getInode());
+		assert(resolver != nullptr);
+		assert(allocator.getResolverCount() == 1);
+		assert(allocator.allocate(path, map->getDevice(), map->getInode()) == resolver);
+		auto offset = address - map->getStartAddress() + map->getFileOffset();
+		auto symbolName = resolver->resolve(offset);
+		assert(symbolName != nullptr);
+		// the same file from another path
+		std::string linkPathString("/tmp/LiveProfilerTestResolverAllocatorLink-" + std::to_string(::getpid()));
+		auto linkPath = pathAllocator->allocate(linkPathString);
+		::unlink(linkPath->c_str());
+		int result = ::symlink(path->c_str(), linkPath->c_str());
+		assert(result == 0);
+		assert(allocator.allocate(linkPath) == resolver);
+		assert(allocator.getResolverCount() == 1);
+		::unlink(linkPath->c_str());
+		// copy of the file has different inode but the same build-id
+		std::string buildId;
+		if (LinuxElfUtils::readBuildId(*path, buildId)) {
+			std::string copyPathString("/tmp/LiveProfilerTestResolverAllocatorCopy-" + std::to_string(::getpid()));
+			auto copyPath = pathAllocator->allocate(copyPathString);
+			{
+				std::ifstream source(*path, std::ios::binary);
+				std::ofstream target(*copyPath, std::ios::binary);
+				target << source.rdbuf();
+			}
+			assert(allocator.allocate(copyPath) == resolver);
+			assert(allocator.getResolverCount() == 1);
+			// the copy is symbolized by the shared resolver
+			assert(allocator.allocate(copyPath)->resolve(offset) == symbolName);
+			::unlink(copyPath->c_str());
+		}
+	}
+
+	void testLinuxExecutableSymbolResolverAllocatorFromProcess() {
+		auto pathAllocator = std::make_shared<SingletonAllocator<std::string, std::string>>();
+		LinuxProcessAddressLocator locator;
+		locator.reset(::getpid(), pathAllocator);
+		auto address = reinterpret_cast<std::uintptr_t>(&testLinuxExecutableSymbolResolverAllocatorFromProcess);
+		auto* map = locator.locateMap(address, false);
+		assert(map != nullptr);
+		// the file is opened from the root of the process
+		LinuxExecutableSymbolResolverAllocator allocator;
+		auto resolver = allocator.allocate(::getpid(), *map);
+		assert(resolver != nullptr);
+		assert(resolver->getPath() == map->getPath());
+		assert(resolver->getFilePath() == "/proc/" + std::to_string(::getpid()) + "/root" + *map->getPath());
+		auto offset = address - map->getStartAddress() + map->getFileOffset();
+		auto symbolName = resolver->resolve(offset);
+		assert(symbolName != nullptr);
+		assert(symbolName->getPath() == map->getPath());
+		// other mappings of the same file share the resolver
+		LinuxProcessAddressMap otherMap(0x1000, 0x2000, 0, map->getPath(), map->getDevice(), map->getInode());
+		assert(allocator.allocate(1, otherMap) == resolver);
+		assert(allocator.allocate(map->getPath(), map->getDevice(), map->getInode()) == resolver);
+		assert(allocator.getResolverCount() == 1);
+	}
+
+	void testLinuxExecutableSymbolResolverAllocatorWithoutInode() {
+		auto pathAllocator = std::make_shared<SingletonAllocator<std::string, std::string>>();
+		LinuxExecutableSymbolResolverAllocator allocator;
+		// files without identity are shared by path
+		auto emptyPath = pathAllocator->allocate("");
+		auto resolver = allocator.allocate(emptyPath);
+		assert(resolver != nullptr);
+		assert(allocator.allocate(emptyPath, 0, 0) == resolver);
+		assert(resolver->resolve(0) == nullptr);
+		auto vdsoPath = pathAllocator->allocate("[vdso]");
+		assert(allocator.allocate(vdsoPath, 0, 0) != resolver);
+		assert(allocator.getResolverCount() == 2);
+	}
+
+	void testLinuxExecutableSymbolResolverAllocatorPreload() {
+		auto pathAllocator = std::make_shared<SingletonAllocator<std::string, std::string>>();
+		LinuxProcessAddressLocator locator;
+		locator.reset(::getpid(), pathAllocator);
+		std::vector<std::pair<pid_t, LinuxProcessAddressMap*>> maps;
+		locator.forEachMap([&maps](auto& map) { maps.emplace_back(::getpid(), &map); });
+		assert(!maps.empty());
+		LinuxExecutableSymbolResolverAllocator allocator;
+		auto loadedCount = allocator.preload(maps, 4);
+		assert(loadedCount > 0);
+		assert(allocator.getResolverCount() == loadedCount);
+		// the resolver of the test binary is attached and shared with later allocations
+		auto address = reinterpret_cast<std::uintptr_t>(&testLinuxExecutableSymbolResolverAllocatorPreload);
+		auto* map = locator.locateMap(address, false);
+		assert(map != nullptr);
+		assert(map->getResolver() != nullptr);
+		assert(allocator.allocate(::getpid(), *map) == map->getResolver());
+		auto symbolName = map->getResolver()->resolve(address - map->getStartAddress() + map->getFileOffset());
+		assert(symbolName != nullptr);
+		assert(symbolName->getName().find(__func__) != std::string::npos);
+		// files already loaded are skipped
+		assert(allocator.preload(maps, 4) == 0);
+		assert(allocator.getResolverCount() == loadedCount);
+	}
+
+	void testLinuxExecutableSymbolResolverAllocator() {
+		std::cout << __func__ << std::endl;
+		testLinuxExecutableSymbolResolverAllocatorShareFile();
+		testLinuxExecutableSymbolResolverAllocatorFromProcess();
+		testLinuxExecutableSymbolResolverAllocatorWithoutInode();
+		testLinuxExecutableSymbolResolverAllocatorPreload();
+	}
+}
+#else // defined(__linux__)
+namespace LiveProfilerTests {
+	void testLinuxExecutableSymbolResolverAllocator() {
+		// unsupported on other platform
+	}
+}
+#endif // defined(__linux__)
+
@@ -0,0 +1,53 @@
+#if defined(__linux__)
+#include <unistd.h>
+#include <iostream>
+#include <cassert>
+#include <LiveProfiler/Utils/Allocators/SingletonAllocator.hpp>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxProcessAddressLocator.hpp>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxExecutableSymbolResolverLoader.hpp>
+
+namespace LiveProfilerTests {
+	using namespace LiveProfiler;
+
+	void testLinuxExecutableSymbolResolverLoaderLoadSelf() {
+		auto pathAllocator = std::make_shared<SingletonAllocator<std::string, std::string>>();
+		LinuxProcessAddressLocator locator;
+		locator.reset(::getpid(), pathAllocator);
+		auto address = reinterpret_cast<uintptr_t>(
+			&testLinuxExecutableSymbolResolverLoaderLoadSelf) + 1;
+		auto pathAndOffset = locator.locate(address, false);
+		assert(pathAndOffset.first != nullptr);
+		LinuxExecutableSymbolResolverLoader loader;
+		std::vector<std::shared_ptr<std::string>> loadedPaths;
+		assert(loader.tryGet(pathAndOffset.first) == nullptr);
+		loader.waitAll();
+		assert(loader.getLoadingCount() == 0);
+		assert(loader.tryGet(pathAndOffset.first) != nullptr);
+		loader.takeLoadedPaths(loadedPaths);
+		assert(loadedPaths.size() == 1);
+		assert(loadedPaths.at(0) == pathAndOffset.first);
+		// loaded paths are reported only once
+		loader.takeLoadedPaths(loadedPaths);
+		assert(loadedPaths.empty());
+	}
+
+	void testLinuxExecutableSymbolResolverLoaderDestroyWhileLoading() {
+		auto pathAllocator = std::make_shared<SingletonAllocator<std::string, std::string>>();
+		LinuxExecutableSymbolResolverLoader loader(1);
+		loader.tryGet(pathAllocator->allocate("/proc/self/exe"));
+		loader.tryGet(pathAllocator->allocate("/bin/sh"));
+	}
+
+	void testLinuxExecutableSymbolResolverLoader() {
+		std::cout << __func__ << std::endl;
+		testLinuxExecutableSymbolResolverLoaderLoadSelf();
+		testLinuxExecutableSymbolResolverLoaderDestroyWhileLoading();
+	}
+}
+#else // defined(__linux__)
+namespace LiveProfilerTests {
+	void testLinuxExecutableSymbolResolverLoader() {
+		// unsupported on other platform
+	}
+}
+#endif // defined(__linux__)
@@ -0,0 +1,46 @@
+#if defined(__linux__)
+#include <unistd.h>
+#include <iostream>
+#include <fstream>
+#include <cassert>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxFileUtils.hpp>
+
+namespace LiveProfilerTests {
+	using namespace LiveProfiler;
+
+	void testLinuxFileUtilsReadFile() {
+		auto path = "/tmp/LiveProfilerTestReadFile-" + std::to_string(::getpid());
+		std::string content;
+		for (std::size_t i = 0; i < 20000; ++i) {
+			content.append(std::to_string(i)).append("\n");
+		}
+		{ std::ofstream file(path); file << content; }
+		std::string buffer("abc");
+		assert(LinuxFileUtils::readFile(path.c_str(), buffer));
+		assert(buffer == content);
+		// read again reuses the buffer
+		auto capacity = buffer.capacity();
+		assert(LinuxFileUtils::readFile(path.c_str(), buffer));
+		assert(buffer == content);
+		assert(buffer.capacity() == capacity);
+		::unlink(path.c_str());
+		assert(!LinuxFileUtils::readFile(path.c_str(), buffer));
+		assert(buffer.empty());
+		// files under /proc report 0 as size
+		assert(LinuxFileUtils::readFile("/proc/self/maps", buffer));
+		assert(!buffer.empty());
+		assert(buffer.back() == '\n');
+	}
+
+	void testLinuxFileUtils() {
+		std::cout << __func__ << std::endl;
+		testLinuxFileUtilsReadFile();
+	}
+}
+#else // defined(__linux__)
+namespace LiveProfilerTests {
+	void testLinuxFileUtils() {
+		// unsupported on other platform
+	}
+}
+#endif // defined(__linux__)
@@ -0,0 +1,189 @@
+#if defined(__linux__)
+#include <unistd.h>
+#include <cstdint>
+#include <iostream>
+#include <fstream>
+#include <cassert>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxJitDumpReader.hpp>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxProcessCustomSymbolResolver.hpp>
+
+namespace LiveProfilerTests {
+	using namespace LiveProfiler;
+
+	namespace {
+		template <class T>
+		void writeValue(std::string& content, T value) {
+			content.append(reinterpret_cast<const char*>(&value), sizeof(value));
+		}
+
+		void writeHeader(std::string& content, std::uint64_t flags) {
+			writeValue<std::uint32_t>(content, LinuxJitDumpReader::Magic);
+			writeValue<std::uint32_t>(content, LinuxJitDumpReader::Version);
+			writeValue<std::uint32_t>(content, 40);
+			writeValue<std::uint32_t>(content, 62); // EM_X86_64
+			writeValue<std::uint32_t>(content, 0);
+			writeValue<std::uint32_t>(content, static_cast<std::uint32_t>(::getpid()));
+			writeValue<std::uint64_t>(content, 1);
+			writeValue<std::uint64_t>(content, flags);
+		}
+
+		void writeCodeLoad(std::string& content, std::uint64_t timestamp,
+			std::uint64_t address, std::uint64_t size, const std::string& name) {
+			std::uint32_t totalSize = static_cast<std::uint32_t>(56 + name.size() + 1 + size);
+			writeValue<std::uint32_t>(content, 0);
+			writeValue<std::uint32_t>(content, totalSize);
+			writeValue<std::uint64_t>(content, timestamp);
+			writeValue<std::uint32_t>(content, static_cast<std::uint32_t>(::getpid()));
+			writeValue<std::uint32_t>(content, static_cast<std::uint32_t>(::getpid()));
+			writeValue<std::uint64_t>(content, address);
+			writeValue<std::uint64_t>(content, address);
+			writeValue<std::uint64_t>(content, size);
+			writeValue<std::uint64_t>(content, 0);
+			content.append(name.c_str(), name.size() + 1);
+			content.append(size, '\xc3'); // native code
+		}
+
+		void writeCodeMove(std::string& content, std::uint64_t timestamp,
+			std::uint64_t oldAddress, std::uint64_t newAddress, std::uint64_t size) {
+			writeValue<std::uint32_t>(content, 1);
+			writeValue<std::uint32_t>(content, 64);
+			writeValue<std::uint64_t>(content, timestamp);
+			writeValue<std::uint32_t>(content, static_cast<std::uint32_t>(::getpid()));
+			writeValue<std::uint32_t>(content, static_cast<std::uint32_t>(::getpid()));
+			writeValue<std::uint64_t>(content, newAddress);
+			writeValue<std::uint64_t>(content, oldAddress);
+			writeValue<std::uint64_t>(content, newAddress);
+			writeValue<std::uint64_t>(content, size);
+			writeValue<std::uint64_t>(content, 0);
+		}
+
+		void writeFile(const std::string& path, const std::string& content) {
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			file.write(content.data(), content.size());
+		}
+	}
+
+	void testLinuxJitDumpReaderLifetime() {
+		std::string path = "/tmp/LiveProfilerTestJitDump-" + std::to_string(::getpid()) + ".dump";
+		auto symbolNamePath = std::make_shared<std::string>("jitdump");
+		auto symbolNameAllocator = std::make_shared<SingletonAllocator<std::string, SymbolName>>();
+		LinuxJitDumpReader reader;
+		reader.reset(path, symbolNamePath, symbolNameAllocator);
+		// file not exist
+		assert(!reader.update());
+		assert(reader.resolve(0x1000, 0) == nullptr);
+		// load code, the last record is incomplete
+		std::string content;
+		writeHeader(content, 0);
+		writeCodeLoad(content, 100, 0x1000, 0x20, "funcA");
+		writeCodeLoad(content, 110, 0x1020, 0x10, "funcB");
+		auto completeSize = content.size();
+		writeCodeLoad(content, 120, 0x2000, 0x10, "funcC");
+		writeFile(path, content.substr(0, content.size() - 1));
+		assert(reader.update());
+		assert(reader.isOpen());
+		assert(reader.getLiveCount() == 2);
+		auto funcA = reader.resolve(0x1000, 0);
+		assert(funcA != nullptr);
+		assert(funcA->getName() == "funcA");
+		assert(funcA->getPath() == symbolNamePath);
+		assert(reader.resolve(0x101f, 105) == funcA);
+		assert(reader.resolve(0x1020, 0)->getName() == "funcB");
+		assert(reader.resolve(0x1030, 0) == nullptr);
+		assert(reader.resolve(0x2000, 0) == nullptr);
+		// apply remaining records, move funcA and reuse it's address for funcD
+		content.resize(completeSize);
+		writeCodeLoad(content, 120, 0x2000, 0x10, "funcC");
+		writeCodeMove(content, 200, 0x1000, 0x3000, 0x20);
+		writeCodeLoad(content, 300, 0x1000, 0x8, "funcD");
+		writeFile(path, content);
+		assert(reader.update());
+		assert(!reader.update());
+		assert(reader.getLiveCount() == 4);
+		assert(reader.getRetiredCount() == 1);
+		assert(reader.getGeneration() == 1);
+		assert(reader.resolve(0x2008, 0)->getName() == "funcC");
+		assert(reader.resolve(0x3010, 0) == funcA);
+		assert(reader.resolve(0x1000, 0)->getName() == "funcD");
+		assert(reader.resolve(0x1010, 0) == nullptr);
+		// samples taken before the address is reused resolve to the old code
+		assert(reader.resolve(0x1000, 150) == funcA);
+		assert(reader.resolve(0x1010, 199) == funcA);
+		assert(reader.resolve(0x1010, 250) == nullptr);
+		assert(reader.resolve(0x1000, 300)->getName() == "funcD");
+		assert(reader.resolve(0x1000, 50) == nullptr);
+		assert(reader.resolve(0x3010, 150) == nullptr);
+		// overlapped code replaces the old code
+		writeCodeLoad(content, 400, 0x1004, 0x20, "funcE");
+		writeFile(path, content);
+		assert(reader.update());
+		assert(reader.getLiveCount() == 3);
+		assert(reader.getGeneration() == 3);
+		assert(reader.resolve(0x1000, 0) == nullptr);
+		assert(reader.resolve(0x1004, 0)->getName() == "funcE");
+		assert(reader.resolve(0x1000, 350)->getName() == "funcD");
+		assert(reader.resolve(0x1020, 350)->getName() == "funcB");
+		reader.freeResources();
+		assert(!reader.isOpen());
+		assert(reader.getLiveCount() == 0);
+		::unlink(path.c_str());
+	}
+
+	void testLinuxJitDumpReaderInvalidFile() {
+		std::string path = "/tmp/LiveProfilerTestJitDumpInvalid-" + std::to_string(::getpid()) + ".dump";
+		auto symbolNamePath = std::make_shared<std::string>("jitdump");
+		auto symbolNameAllocator = std::make_shared<SingletonAllocator<std::string, SymbolName>>();
+		LinuxJitDumpReader reader;
+		// arch timestamp can't be compared with sample time
+		std::string content;
+		writeHeader(content, 1);
+		writeCodeLoad(content, 100, 0x1000, 0x20, "funcA");
+		writeCodeLoad(content, 200, 0x1000, 0x20, "funcB");
+		writeFile(path, content);
+		reader.reset(path, symbolNamePath, symbolNameAllocator);
+		assert(reader.update());
+		assert(reader.resolve(0x1000, 150)->getName() == "funcB");
+		// bad magic
+		content.assign(64, '\0');
+		writeFile(path, content);
+		reader.reset(path, symbolNamePath, symbolNameAllocator);
+		assert(!reader.update());
+		assert(reader.isClosed());
+		::unlink(path.c_str());
+	}
+
+	void testLinuxJitDumpReaderFromCustomSymbolResolver() {
+		std::string path = "/tmp/jit-" + std::to_string(::getpid()) + ".dump";
+		std::string content;
+		writeHeader(content, 0);
+		writeCodeLoad(content, 100, 0x1000, 0x20, "funcA");
+		writeCodeLoad(content, 200, 0x1000, 0x20, "funcB");
+		writeFile(path, content);
+		auto symbolNamePath = std::make_shared<std::string>("perfmap");
+		auto symbolNameAllocator = std::make_shared<SingletonAllocator<std::string, SymbolName>>();
+		LinuxProcessCustomSymbolResolver resolver;
+		resolver.reset(::getpid(), symbolNamePath, symbolNameAllocator);
+		auto funcB = resolver.resolve(0x1010, false);
+		assert(funcB != nullptr);
+		assert(funcB->getName() == "funcB");
+		assert(resolver.resolve(0x1010, false, 150)->getName() == "funcA");
+		assert(resolver.getGeneration() == 1);
+		resolver.freeResources();
+		::unlink(path.c_str());
+	}
+
+	void testLinuxJitDumpReader() {
+		std::cout << __func__ << std::endl;
+		testLinuxJitDumpReaderLifetime();
+		testLinuxJitDumpReaderInvalidFile();
+		testLinuxJitDumpReaderFromCustomSymbolResolver();
+	}
+}
+#else // defined(__linux__)
+namespace LiveProfilerTests {
+	void testLinuxJitDumpReader() {
+		// unsupported on other platform
+	}
+}
+#endif // defined(__linux__)
+
@@ -0,0 +1,126 @@
+#if defined(__linux__)
+#include <unistd.h>
+#include <iostream>
+#include <fstream>
+#include <cassert>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxKernelSymbolResolver.hpp>
+
+namespace LiveProfilerTests {
+	using namespace LiveProfiler;
+
+	namespace {
+		std::string getKallsymsPath() {
+			return "/tmp/LiveProfilerTestKallsyms-" + std::to_string(::getpid());
+		}
+
+		std::string getModulesPath() {
+			return "/tmp/LiveProfilerTestModules-" + std::to_string(::getpid());
+		}
+
+		void writeKallsyms(bool withNewModule) {
+			std::ofstream file(getKallsymsPath());
+			file << "ffffffff81000000 T _stext\n";
+			file << "ffffffff81000100 T do_one_initcall\n";
+			file << "ffffffff81000200 t run_init_process\n";
+			file << "ffffffffc0001000 t pata_acpi_init\t[pata_acpi]\n";
+			file << "ffffffffc0001080 t pata_acpi_exit\t[pata_acpi]\n";
+			if (withNewModule) {
+				file << "ffffffffc0002000 t loop_init\t[loop]\n";
+				file << "ffffffffc0002040 t loop_exit\t[loop]\n";
+			}
+			file << "ffffffffc0003000 t serio_raw_init\t[serio_raw]\n";
+			file << "ffffffffc0003100 t serio_raw_exit\t[serio_raw]\n";
+		}
+
+		void writeModules(bool withNewModule) {
+			std::ofstream file(getModulesPath());
+			file << "pata_acpi 16384 0 - Live 0xffffffffc0001000\n";
+			if (withNewModule) {
+				file << "loop 28672 0 - Live 0xffffffffc0002000\n";
+			}
+			file << "serio_raw 20480 0 - Live 0xffffffffc0003000\n";
+		}
+	}
+
+	void testLinuxKernelSymbolResolverResolve() {
+		writeKallsyms(false);
+		writeModules(false);
+		LinuxKernelSymbolResolver resolver(getKallsymsPath(), getModulesPath());
+		assert(!resolver.isLoaded());
+		auto symbolName = resolver.resolve(0xffffffff81000110);
+		assert(resolver.isLoaded());
+		assert(resolver.getModuleCount() == 2);
+		assert(resolver.getSymbolCount() == 7);
+		assert(symbolName != nullptr);
+		assert(symbolName->getOriginalName() == "do_one_initcall");
+		assert(*symbolName->getPath() == "[kallsyms]");
+		// demangled before returned, instances are shared between threads
+		assert(symbolName->isDemangled());
+		assert(symbolName->getName() == "do_one_initcall");
+		assert(resolver.resolve(0xffffffff81000100) == symbolName);
+		assert(resolver.resolve(0xffffffff80000000) == nullptr);
+		symbolName = resolver.resolve(0xffffffffc0001004);
+		assert(symbolName != nullptr);
+		assert(symbolName->getOriginalName() == "pata_acpi_init");
+		assert(*symbolName->getPath() == "[pata_acpi]");
+		assert(symbolName->isDemangled());
+		symbolName = resolver.resolve(0xffffffffc0003004);
+		assert(symbolName != nullptr);
+		assert(symbolName->getOriginalName() == "serio_raw_init");
+		assert(*symbolName->getPath() == "[serio_raw]");
+	}
+
+	void testLinuxKernelSymbolResolverReloadModules() {
+		writeKallsyms(false);
+		writeModules(false);
+		LinuxKernelSymbolResolver resolver(getKallsymsPath(), getModulesPath());
+		resolver.setModulesCheckInterval({});
+		auto kernelSymbolName = resolver.resolve(0xffffffff81000000);
+		auto moduleSymbolName = resolver.resolve(0xffffffffc0001000);
+		assert(kernelSymbolName != nullptr);
+		assert(moduleSymbolName != nullptr);
+		assert(resolver.resolve(0xffffffffc0002000) == nullptr);
+		// load a new module
+		writeKallsyms(true);
+		writeModules(true);
+		auto symbolName = resolver.resolve(0xffffffffc0002000);
+		assert(symbolName != nullptr);
+		assert(symbolName->getOriginalName() == "loop_init");
+		assert(*symbolName->getPath() == "[loop]");
+		assert(resolver.getModuleCount() == 3);
+		// symbols of kernel and unchanged modules are kept
+		assert(resolver.resolve(0xffffffff81000000) == kernelSymbolName);
+		assert(resolver.resolve(0xffffffffc0001000) == moduleSymbolName);
+		// unload the module
+		writeKallsyms(false);
+		writeModules(false);
+		assert(resolver.resolve(0xffffffff90000000) == nullptr);
+		assert(resolver.getModuleCount() == 2);
+		assert(resolver.resolve(0xffffffffc0002000) == nullptr);
+		::unlink(getKallsymsPath().c_str());
+		::unlink(getModulesPath().c_str());
+	}
+
+	void testLinuxKernelSymbolResolverShared() {
+		auto& resolver = LinuxKernelSymbolResolver::getShared();
+		assert(resolver != nullptr);
+		assert(resolver == LinuxKernelSymbolResolver::getShared());
+		// addresses may be hidden by kptr_restrict, so don't check the result
+		resolver->resolve(0);
+		assert(resolver->isLoaded());
+	}
+
+	void testLinuxKernelSymbolResolver() {
+		std::cout << __func__ << std::endl;
+		testLinuxKernelSymbolResolverResolve();
+		testLinuxKernelSymbolResolverReloadModules();
+		testLinuxKernelSymbolResolverShared();
+	}
+}
+#else // defined(__linux__)
+namespace LiveProfilerTests {
+	void testLinuxKernelSymbolResolver() {
+		// unsupported on other platform
+	}
+}
+#endif // defined(__linux__)
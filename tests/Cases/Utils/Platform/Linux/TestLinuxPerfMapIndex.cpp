@@ -0,0 +1,113 @@
+#if defined(__linux__)
+#include <unistd.h>
+#include <cstdio>
+#include <iostream>
+#include <fstream>
+#include <cassert>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxPerfMapIndex.hpp>
+
+namespace LiveProfilerTests {
+	using namespace LiveProfiler;
+
+	void testLinuxPerfMapIndexUpdate() {
+		std::string path = "/tmp/LiveProfilerTestPerfMap-" + std::to_string(::getpid()) + ".map";
+		auto symbolNamePath = std::make_shared<std::string>("perfmap");
+		auto symbolNameAllocator = std::make_shared<SingletonAllocator<std::string, SymbolName>>();
+		LinuxPerfMapIndex index;
+		index.reset(path, symbolNamePath, symbolNameAllocator);
+		assert(index.update() == 0);
+		// the last line is incomplete
+		{
+			std::ofstream file(path);
+			file << "50 1c customSymbolB" << std::endl;
+			file << "0x30 0x1a customSymbolA" << std::endl;
+			file << "invalid line" << std::endl;
+			file << "70 1e customSymbolC (check";
+		}
+		assert(index.update() == 2);
+		assert(index.size() == 2);
+		assert(index.getRunCount() == 1);
+		auto symbolA = index.resolve(0x30);
+		assert(symbolA != nullptr);
+		assert(symbolA->getName() == "customSymbolA");
+		assert(symbolA->getPath() == symbolNamePath);
+		assert(index.resolve(0x49) == symbolA);
+		assert(index.resolve(0x4a) == nullptr);
+		assert(index.resolve(0x51)->getName() == "customSymbolB");
+		assert(index.resolve(0x70) == nullptr);
+		// append remaining contents, the same instance is returned for the same name
+		{
+			std::ofstream file(path, std::ios::app);
+			file << "space)" << std::endl;
+			file << "90 10 customSymbolA" << std::endl;
+		}
+		assert(index.update() == 2);
+		assert(index.update() == 0);
+		assert(index.size() == 4);
+		assert(index.resolve(0x8d)->getName() == "customSymbolC (checkspace)");
+		assert(index.resolve(0x90) == symbolA);
+		assert(index.resolve(0x8e) == nullptr);
+		// newer symbols win if the address is reused
+		{
+			std::ofstream file(path, std::ios::app);
+			file << "50 8 customSymbolD" << std::endl;
+		}
+		assert(index.update() == 1);
+		assert(index.resolve(0x50)->getName() == "customSymbolD");
+		assert(index.resolve(0x58)->getName() == "customSymbolB");
+		// truncated file is indexed from the start
+		{
+			std::ofstream file(path, std::ios::trunc);
+			file << "30 10 customSymbolE" << std::endl;
+		}
+		assert(index.update() == 1);
+		assert(index.size() == 1);
+		assert(index.resolve(0x30)->getName() == "customSymbolE");
+		assert(index.resolve(0x50) == nullptr);
+		index.freeResources();
+		::unlink(path.c_str());
+	}
+
+	void testLinuxPerfMapIndexRuns() {
+		auto symbolNamePath = std::make_shared<std::string>("perfmap");
+		auto symbolNameAllocator = std::make_shared<SingletonAllocator<std::string, SymbolName>>();
+		LinuxPerfMapIndex index;
+		index.reset("", symbolNamePath, symbolNameAllocator);
+		// add many small runs, runs are merged so there only few runs
+		char line[64];
+		for (std::size_t run = 0; run < 1000; ++run) {
+			auto runStart = index.size();
+			for (std::size_t i = 0; i < 10; ++i) {
+				// addresses are not ordered
+				std::size_t address = 0x1000 + ((run * 10 + i) * 7919 % 10000) * 0x10;
+				auto size = std::snprintf(line, sizeof(line), "%zx 10 symbol%zu\n", address, address);
+				assert(index.parse(line, line + size) == static_cast<std::size_t>(size));
+			}
+			index.addRun(runStart);
+			assert(index.getRunCount() <= 16);
+		}
+		assert(index.size() == 10000);
+		for (std::size_t i = 0; i < 10000; ++i) {
+			std::size_t address = 0x1000 + i * 0x10;
+			auto symbolName = index.resolve(address + 0xf);
+			assert(symbolName != nullptr);
+			assert(symbolName->getName() == "symbol" + std::to_string(address));
+		}
+		assert(index.resolve(0xfff) == nullptr);
+		assert(index.resolve(0x1000 + 10000 * 0x10) == nullptr);
+	}
+
+	void testLinuxPerfMapIndex() {
+		std::cout << __func__ << std::endl;
+		testLinuxPerfMapIndexUpdate();
+		testLinuxPerfMapIndexRuns();
+	}
+}
+#else // defined(__linux__)
+namespace LiveProfilerTests {
+	void testLinuxPerfMapIndex() {
+		// unsupported on other platform
+	}
+}
+#endif // defined(__linux__)
+
@@ -0,0 +1,57 @@
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/wait.h>
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxEpollDescriptor.hpp>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxProcConnector.hpp>
+
+namespace LiveProfilerTests {
+	using namespace LiveProfiler;
+
+	void testLinuxProcConnector() {
+		std::cout << __func__ << std::endl;
+		LinuxProcConnector connector;
+		LinuxEpollDescriptor epoll;
+		connector.open();
+		assert(connector.isOpened());
+		epoll.add(connector.getFd(), EPOLLIN, 0);
+		pid_t child = ::fork();
+		if (child == 0) {
+			::execl("/bin/true", "true", nullptr);
+			::_exit(0);
+		}
+		assert(child > 0);
+		::waitpid(child, nullptr, 0);
+		std::vector<LinuxProcConnector::Event> events;
+		for (std::size_t i = 0; i < 100; ++i) {
+			auto hasExit = std::any_of(events.cbegin(), events.cend(), [child](auto& e) {
+				return e.type == LinuxProcConnector::EventType::Exit && e.tid == child;
+			});
+			if (hasExit) {
+				break;
+			}
+			epoll.wait(std::chrono::milliseconds(10));
+			assert(connector.receive(events));
+		}
+		auto hasEvent = [&events, child](LinuxProcConnector::EventType type) {
+			return std::any_of(events.cbegin(), events.cend(), [child, type](auto& e) {
+				return e.type == type && e.pid == child && e.tid == child;
+			});
+		};
+		assert(hasEvent(LinuxProcConnector::EventType::Fork));
+		assert(hasEvent(LinuxProcConnector::EventType::Exec));
+		assert(hasEvent(LinuxProcConnector::EventType::Exit));
+		epoll.del(connector.getFd());
+		connector.close();
+		assert(!connector.isOpened());
+	}
+}
+#else // defined(__linux__)
+namespace LiveProfilerTests {
+	void testLinuxProcConnector() {
+		// unsupported on other platform
+	}
+}
+#endif // defined(__linux__)
@@ -1,7 +1,9 @@
 #if defined(__linux__)
 #include <unistd.h>
+#include <time.h>
 #include <iostream>
 #include <cassert>
+#include <thread>
 #include <LiveProfiler/Utils/Platform/Linux/LinuxProcessAddressLocator.hpp>
 
 namespace LiveProfilerTests {
@@ -13,14 +15,121 @@ namespace LiveProfilerTests {
 		locator.reset(::getpid(), pathAllocator);
 		auto address = reinterpret_cast<uintptr_t>(
 			&testLinuxProcessAddressLocatorLocateSelf) + 1;
+		assert(locator.getMapsGeneration() == 0);
 		auto pathAndOffset = locator.locate(address, false);
 		assert(pathAndOffset.first != nullptr);
 		assert(pathAndOffset.second > 0);
+		// maps are reloaded only when locate failed
+		assert(locator.getMapsGeneration() == 1);
+		locator.locate(address, false);
+		assert(locator.getMapsGeneration() == 1);
+		// reloading unchanged maps keeps the generation and the attached resolvers
+		auto resolver = std::make_shared<LinuxExecutableSymbolResolver>(pathAndOffset.first);
+		locator.locateMap(address, false)->setResolver(resolver);
+		locator.locate(0, true);
+		assert(locator.getMapsGeneration() == 1);
+		assert(locator.locateMap(address, false)->getResolver() == resolver);
+	}
+
+	void testLinuxProcessAddressLocatorUpdate() {
+		auto pathAllocator = std::make_shared<SingletonAllocator<std::string, std::string>>();
+		auto a = pathAllocator->allocate("a");
+		auto b = pathAllocator->allocate("b");
+		LinuxProcessAddressLocator locator;
+		locator.reset(::getpid(), pathAllocator);
+		// addresses below mmap_min_addr are never mapped
+		// the initial snapshot is loaded before the first update
+		locator.update(0x1000, 0x3000, 0x100, a);
+		assert(locator.isIncremental());
+		assert(locator.getMapsGeneration() == 1);
+		auto mapCount = locator.getMapCount();
+		assert(mapCount > 1);
+		auto pathAndOffset = locator.locate(0x2000, false);
+		assert(pathAndOffset.first == a);
+		assert(pathAndOffset.second == 0x1100);
+		// resolver attached to the mapping is kept when the mapping is split
+		auto resolver = std::make_shared<LinuxExecutableSymbolResolver>(a);
+		auto* map = locator.locateMap(0x1000, false);
+		assert(map != nullptr);
+		map->setResolver(resolver);
+		// split existing mapping
+		locator.update(0x1800, 0x2000, 0x0, b, 1, 2);
+		assert(locator.getMapsGeneration() == 2);
+		assert(locator.getMapCount() == mapCount + 2);
+		pathAndOffset = locator.locate(0x17ff, false);
+		assert(pathAndOffset.first == a);
+		assert(pathAndOffset.second == 0x8ff);
+		pathAndOffset = locator.locate(0x1900, false);
+		assert(pathAndOffset.first == b);
+		assert(pathAndOffset.second == 0x100);
+		assert(locator.locateMap(0x1000, false)->getResolver() == resolver);
+		assert(locator.locateMap(0x1900, false)->getResolver() == nullptr);
+		assert(locator.locateMap(0x1900, false)->getDevice() == 1);
+		assert(locator.locateMap(0x1900, false)->getInode() == 2);
+		assert(locator.locateMap(0x2000, false)->getResolver() == resolver);
+		pathAndOffset = locator.locate(0x2000, false);
+		assert(pathAndOffset.first == a);
+		assert(pathAndOffset.second == 0x1100);
+		// replace multiple mappings
+		locator.update(0x1400, 0x2400, 0x0, b);
+		assert(locator.getMapCount() == mapCount + 2);
+		pathAndOffset = locator.locate(0x13ff, false);
+		assert(pathAndOffset.first == a);
+		assert(pathAndOffset.second == 0x4ff);
+		pathAndOffset = locator.locate(0x2400, false);
+		assert(pathAndOffset.first == a);
+		assert(pathAndOffset.second == 0x1500);
+		pathAndOffset = locator.locate(0x2000, false);
+		assert(pathAndOffset.first == b);
+		assert(pathAndOffset.second == 0xc00);
+		// mapping without overlap doesn't change generation
+		auto generation = locator.getMapsGeneration();
+		locator.update(0x3000, 0x4000, 0x0, b);
+		assert(locator.getMapsGeneration() == generation);
+		assert(locator.locate(0x3000, false).first == b);
+		// located results from the process are still available
+		auto address = reinterpret_cast<uintptr_t>(&testLinuxProcessAddressLocatorUpdate) + 1;
+		assert(locator.locate(address, false).first != nullptr);
+	}
+
+	void testLinuxProcessAddressLocatorReloadIncremental() {
+		auto pathAllocator = std::make_shared<SingletonAllocator<std::string, std::string>>();
+		auto a = pathAllocator->allocate("a");
+		auto b = pathAllocator->allocate("b");
+		LinuxProcessAddressLocator locator;
+		locator.reset(::getpid(), pathAllocator);
+		::timespec now = {};
+		::clock_gettime(CLOCK_MONOTONIC, &now);
+		auto timestamp = static_cast<std::uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+		// mappings older than the snapshot are ignored
+		locator.update(0x1000, 0x2000, 0x0, a, 0, 0, timestamp);
+		assert(locator.getMapsGeneration() == 1);
+		assert(locator.locate(0x1000, false).first == nullptr);
+		locator.update(0x1000, 0x2000, 0x0, a, 0, 0, timestamp + 1000000000);
+		assert(locator.locate(0x1000, false).first == a);
+		// failed locate still reloads maps in incremental mode, with the same rate limit
+		std::this_thread::sleep_for(std::chrono::milliseconds(
+			LinuxProcessAddressLocator::DefaultMapsUpdateMinInterval + 10));
+		assert(locator.locate(0x3000, false).first == nullptr);
+		assert(locator.getMapsGeneration() == 2);
+		assert(locator.locate(0x1000, false).first == nullptr);
+		// invalidate makes the next locate reload maps even if the address is located
+		locator.update(0x1000, 0x2000, 0x0, b);
+		assert(locator.locate(0x1000, false).first == b);
+		auto generation = locator.getMapsGeneration();
+		locator.invalidate();
+		assert(locator.locate(0x1000, false).first == nullptr);
+		assert(locator.getMapsGeneration() == generation + 1);
+		// located results from the process are still available
+		auto address = reinterpret_cast<uintptr_t>(&testLinuxProcessAddressLocatorReloadIncremental) + 1;
+		assert(locator.locate(address, false).first != nullptr);
 	}
 
 	void testLinuxProcessAddressLocator() {
 		std::cout << __func__ << std::endl;
 		testLinuxProcessAddressLocatorLocateSelf();
+		testLinuxProcessAddressLocatorUpdate();
+		testLinuxProcessAddressLocatorReloadIncremental();
 	}
 }
 #else // defined(__linux__)
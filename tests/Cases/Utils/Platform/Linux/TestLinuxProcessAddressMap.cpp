@@ -1,6 +1,7 @@
 #if defined(__linux__)
 #include <iostream>
 #include <cassert>
+#include <vector>
 #include <LiveProfiler/Utils/Allocators/SingletonAllocator.hpp>
 #include <LiveProfiler/Utils/Platform/Linux/LinuxExecutableSymbolResolver.hpp>
 #include <LiveProfiler/Utils/Platform/Linux/LinuxProcessAddressMap.hpp>
@@ -8,8 +9,7 @@
 namespace LiveProfilerTests {
 	using namespace LiveProfiler;
 
-	void testLinuxProcessAddressMap() {
-		std::cout << __func__ << std::endl;
+	void testLinuxProcessAddressMapParseLine() {
 		auto pathAllocator = std::make_shared<SingletonAllocator<std::string, std::string>>();
 		{
 			std::string line("08048000-08056000 r-xp        00000000 03:0c  64593 /usr/sbin/gpm");
@@ -18,6 +18,8 @@ namespace LiveProfilerTests {
 			assert(map.getStartAddress() == 0x8048000);
 			assert(map.getEndAddress() == 0x8056000);
 			assert(map.getFileOffset() == 0);
+			assert(map.getDevice() == makedev(3, 0xc));
+			assert(map.getInode() == 64593);
 			assert(*map.getPath() == "/usr/sbin/gpm");
 		}
 		{
@@ -49,6 +51,56 @@ namespace LiveProfilerTests {
 			assert(!map.parseLine(line, pathAllocator));
 		}
 	}
+
+	void testLinuxProcessAddressMapParseMaps() {
+		auto pathAllocator = std::make_shared<SingletonAllocator<std::string, std::string>>();
+		std::string content(
+			"08048000-08056000 r-xp 00000000 03:0c 64593                      /usr/sbin/gpm\n"
+			"08056000-08058000 rw-p 0000d000 03:0c 64593                      /usr/sbin/gpm\n"
+			"08058000-0805b000 rwxp 00000000 00:00 0 \n"
+			"invalid line\n"
+			"\n"
+			"7f0000000000-7f0000001000 r-xp 00001000 fd:01 123 /tmp/a b (deleted)\n"
+			"ffffffffff600000-ffffffffff601000 --xp 00000000 00:00 0                  [vsyscall]");
+		std::vector<LinuxProcessAddressMap> maps;
+		auto count = LinuxProcessAddressMap::parseMaps(
+			content.data(), content.data() + content.size(), pathAllocator, maps);
+		assert(count == 5);
+		assert(maps.size() == 5);
+		assert(maps[0].getStartAddress() == 0x8048000);
+		assert(maps[0].getEndAddress() == 0x8056000);
+		assert(maps[0].getFileOffset() == 0);
+		assert(*maps[0].getPath() == "/usr/sbin/gpm");
+		assert(maps[0].getDevice() == makedev(3, 0xc));
+		assert(maps[0].getInode() == 64593);
+		assert(maps[1].getFileOffset() == 0xd000);
+		assert(maps[1].getPath() == maps[0].getPath());
+		assert(*maps[2].getPath() == "");
+		assert(maps[2].getDevice() == 0);
+		assert(maps[2].getInode() == 0);
+		assert(maps[3].getStartAddress() == 0x7f0000000000);
+		assert(maps[3].getFileOffset() == 0x1000);
+		assert(*maps[3].getPath() == "/tmp/a b (deleted)");
+		assert(maps[3].getDevice() == makedev(0xfd, 1));
+		assert(maps[3].getInode() == 123);
+		assert(maps[4].getEndAddress() == 0xffffffffff601000);
+		assert(*maps[4].getPath() == "[vsyscall]");
+		// paths are interned by the allocator
+		assert(pathAllocator->allocate("/usr/sbin/gpm") == maps[0].getPath());
+		// the result is the same as parsing line by line
+		std::string line("08048000-08056000 r-xp        00000000 03:0c  64593 /usr/sbin/gpm");
+		LinuxProcessAddressMap map;
+		assert(map.parseLine(line.data(), line.data() + line.size(), pathAllocator));
+		assert(map.getStartAddress() == 0x8048000);
+		assert(map.getEndAddress() == 0x8056000);
+		assert(map.getPath() == maps[0].getPath());
+	}
+
+	void testLinuxProcessAddressMap() {
+		std::cout << __func__ << std::endl;
+		testLinuxProcessAddressMapParseLine();
+		testLinuxProcessAddressMapParseMaps();
+	}
 }
 #else // defined(__linux__)
 namespace LiveProfilerTests {
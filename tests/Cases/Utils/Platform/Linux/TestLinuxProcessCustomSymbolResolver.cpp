@@ -1,5 +1,6 @@
 #if defined(__linux__)
 #include <unistd.h>
+#include <fstream>
 #include <iostream>
 #include <cassert>
 #include <LiveProfiler/Utils/Platform/Linux/LinuxProcessCustomSymbolResolver.hpp>
@@ -0,0 +1,73 @@
+#if defined(__linux__)
+#include <unistd.h>
+#include <iostream>
+#include <cassert>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxProcessFilter.hpp>
+
+namespace LiveProfilerTests {
+	using namespace LiveProfiler;
+
+	void testLinuxProcessFilterPredicates() {
+		auto selfpid = ::getpid();
+		{
+			LinuxProcessFilter filter;
+			filter.byName("LiveProfilerTest").byUid(::getuid()).byParentPid(::getppid());
+			assert(filter(selfpid));
+			assert(!filter(0));
+		}
+		{
+			LinuxProcessFilter filter;
+			filter.byName("LiveProfilerTest").byUid(::getuid() + 1);
+			assert(!filter(selfpid));
+		}
+		{
+			LinuxProcessFilter filter;
+			filter.byCmdLine(std::regex("LiveProfilerTest$"));
+			assert(filter(selfpid));
+			LinuxProcessFilter filterNotMatched;
+			filterNotMatched.byCmdLine(std::regex("^NotExist"));
+			assert(!filterNotMatched(selfpid));
+		}
+		{
+			LinuxProcessFilter filter;
+			filter.byCgroup(LinuxCgroupUtils::getProcessCgroupPath(selfpid));
+			assert(filter(selfpid));
+			LinuxProcessFilter filterNotMatched;
+			filterNotMatched.byCgroup("/path/not/exist");
+			assert(!filterNotMatched(selfpid));
+		}
+	}
+
+	void testLinuxProcessFilterCache() {
+		auto selfpid = ::getpid();
+		std::size_t evaluated = 0;
+		LinuxProcessFilter filter;
+		filter.by([&evaluated, selfpid](pid_t pid) { ++evaluated; return pid == selfpid; });
+		for (std::size_t i = 0; i < 3; ++i) {
+			filter.beginScan();
+			assert(filter(selfpid));
+			assert(!filter(1));
+		}
+		assert(evaluated == 2);
+		assert(filter.getCachedCount() == 2);
+		// processes not seen in the previous round will be removed
+		filter.beginScan();
+		filter.beginScan();
+		assert(filter.getCachedCount() == 0);
+		assert(filter(selfpid));
+		assert(evaluated == 3);
+	}
+
+	void testLinuxProcessFilter() {
+		std::cout << __func__ << std::endl;
+		testLinuxProcessFilterPredicates();
+		testLinuxProcessFilterCache();
+	}
+}
+#else // defined(__linux__)
+namespace LiveProfilerTests {
+	void testLinuxProcessFilter() {
+		// unsupported on other platform
+	}
+}
+#endif // defined(__linux__)
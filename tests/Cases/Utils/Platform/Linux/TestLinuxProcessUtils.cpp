@@ -1,6 +1,8 @@
 #if defined(__linux__)
 #include <syscall.h>
 #include <cassert>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <algorithm>
 #include <thread>
@@ -41,18 +43,91 @@ namespace LiveProfilerTests {
 		assert(!filter(1));
 	}
 
+	void testLinuxProcessUtilsReadProcessStat() {
+		pid_t parentPid = 0;
+		std::uint64_t startTime = 0;
+		assert(LinuxProcessUtils::readProcessStat(::getpid(), parentPid, startTime));
+		assert(parentPid == ::getppid());
+		assert(startTime > 0);
+		assert(!LinuxProcessUtils::readProcessStat(0, parentPid, startTime));
+	}
+
+	void testLinuxProcessUtilsReadProcessCmdLine() {
+		std::string cmdLine;
+		assert(LinuxProcessUtils::readProcessCmdLine(::getpid(), cmdLine));
+		assert(cmdLine.find("LiveProfilerTest") != std::string::npos);
+		assert(cmdLine.find('\0') == std::string::npos);
+	}
+
+	void testLinuxProcessUtilsGetProcessUid() {
+		uid_t uid = 0;
+		assert(LinuxProcessUtils::getProcessUid(::getpid(), uid));
+		assert(uid == ::geteuid());
+	}
+
 	void testLinuxProcessUtilsIsProcessExists() {
 		auto selfpid = ::getpid();
 		assert(LinuxProcessUtils::isProcessExists(selfpid));
 		assert(!LinuxProcessUtils::isProcessExists(0));
 	}
 
+	void testLinuxProcessUtilsFindMappedFilePath() {
+		auto selfpid = ::getpid();
+		std::string exePath;
+		assert(LinuxProcessUtils::readProcessExePath(selfpid, exePath));
+		struct ::stat st;
+		int result = ::stat(exePath.c_str(), &st);
+		assert(result == 0);
+		std::uint64_t device = st.st_dev;
+		std::uint64_t inode = st.st_ino;
+		std::string rootPath = "/proc/" + std::to_string(selfpid) + "/root" + exePath;
+		// prefer the path under the root of the process
+		std::string filePath;
+		assert(LinuxProcessUtils::findMappedFilePath(selfpid, exePath, 0, 0, device, inode, filePath));
+		assert(filePath == rootPath);
+		assert(LinuxProcessUtils::findMappedFilePath(selfpid, exePath, 0, 0, 0, 0, filePath));
+		assert(filePath == rootPath);
+		// no candidate is accessible
+		assert(!LinuxProcessUtils::findMappedFilePath(
+			selfpid, "/LiveProfilerTestNotExist", 0, 0, device, inode, filePath));
+		assert(filePath == "/LiveProfilerTestNotExist");
+		// the path doesn't exist in current namespace, but the mapping can be accessed from map_files
+		std::ifstream maps("/proc/self/maps");
+		std::string line;
+		unsigned long long startAddress = 0;
+		unsigned long long endAddress = 0;
+		while (std::getline(maps, line)) {
+			if (line.size() > exePath.size() &&
+				line.compare(line.size() - exePath.size(), exePath.size(), exePath) == 0 &&
+				std::sscanf(line.c_str(), "%llx-%llx", &startAddress, &endAddress) == 2) {
+				break;
+			}
+		}
+		assert(startAddress < endAddress);
+		char mapFilePath[128];
+		std::snprintf(mapFilePath, sizeof(mapFilePath), "/proc/%d/map_files/%llx-%llx",
+			static_cast<int>(selfpid), startAddress, endAddress);
+		bool found = LinuxProcessUtils::findMappedFilePath(
+			selfpid, "/LiveProfilerTestNotExist", startAddress, endAddress, device, inode, filePath);
+		if (::stat(mapFilePath, &st) == 0) {
+			// accessing map_files requires CAP_SYS_ADMIN
+			assert(found);
+			assert(filePath == mapFilePath);
+		} else {
+			assert(!found);
+		}
+	}
+
 	void testLinuxProcessUtils() {
 		std::cout << __func__ << std::endl;
 		testLinuxProcessUtilsListProcesses();
 		testLinuxProcessUtilsListThreads();
 		testLinuxProcessUtilsGetProcessFilterByName();
+		testLinuxProcessUtilsReadProcessStat();
+		testLinuxProcessUtilsReadProcessCmdLine();
+		testLinuxProcessUtilsGetProcessUid();
 		testLinuxProcessUtilsIsProcessExists();
+		testLinuxProcessUtilsFindMappedFilePath();
 	}
 }
 #else // defined(__linux__)
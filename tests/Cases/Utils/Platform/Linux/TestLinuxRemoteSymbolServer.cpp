@@ -0,0 +1,207 @@
+#if defined(__linux__)
+#include <unistd.h>
+#include <iostream>
+#include <cassert>
+#include <thread>
+#include <LiveProfiler/Utils/Allocators/SingletonAllocator.hpp>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxProcessAddressLocator.hpp>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxRemoteSymbolClient.hpp>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxRemoteSymbolServer.hpp>
+
+namespace LiveProfilerTests {
+	using namespace LiveProfiler;
+
+	namespace {
+		/** Build the query for the address in the test binary */
+		LinuxRemoteSymbolClient::Query makeQuery(
+			LinuxRemoteSymbolClient& client,
+			LinuxProcessAddressLocator& locator,
+			std::uintptr_t address) {
+			auto* map = locator.locateMap(address, false);
+			assert(map != nullptr);
+			const auto& buildId = client.getBuildId(::getpid(), *map);
+			assert(buildId != nullptr);
+			assert(!buildId->empty());
+			return LinuxRemoteSymbolClient::Query({ buildId, map->getPath(),
+				static_cast<std::size_t>(address - map->getStartAddress() + map->getFileOffset()) });
+		}
+	}
+
+	void testLinuxRemoteSymbolServerUnixSocket() {
+		auto path = "/tmp/LiveProfilerTestRemoteSymbol-" + std::to_string(::getpid()) + ".sock";
+		LinuxRemoteSymbolServer server(path);
+		assert(server.getAddress() == path);
+		assert(server.isUsingPathHints());
+		std::thread thread([&server] { server.run(); });
+
+		auto pathAllocator = std::make_shared<SingletonAllocator<std::string, std::string>>();
+		LinuxProcessAddressLocator locator;
+		locator.reset(::getpid(), pathAllocator);
+		LinuxRemoteSymbolClient client(path);
+		auto query = makeQuery(client, locator, reinterpret_cast<std::uintptr_t>(&testLinuxRemoteSymbolServerUnixSocket));
+		// the build-id is remembered by file, and shared by all mappings of the file
+		auto* map = locator.locateMap(reinterpret_cast<std::uintptr_t>(&testLinuxRemoteSymbolServerUnixSocket), false);
+		assert(client.getBuildId(::getpid(), *map) == query.buildId);
+		// the second offset is in the same function, the unknown build-id is not found by server
+		auto sameFunctionQuery = query;
+		sameFunctionQuery.offset += 1;
+		auto unknownQuery = query;
+		unknownQuery.buildId = std::make_shared<std::string>("00");
+		std::vector<LinuxRemoteSymbolClient::Query> queries({ query, unknownQuery, sameFunctionQuery });
+		std::vector<std::shared_ptr<SymbolName>> results;
+		assert(client.resolve(queries, results));
+		assert(client.isConnected());
+		assert(client.getRequestCount() == 1);
+		assert(results.size() == 3);
+		assert(results.at(0) != nullptr);
+		assert(results.at(0)->getName().find(__func__) != std::string::npos);
+		assert(results.at(0)->getPath() == query.path);
+		assert(results.at(0)->getFileOffsetStart() <= query.offset);
+		assert(results.at(0)->getFileOffsetEnd() > query.offset);
+		assert(results.at(1) == nullptr);
+		assert(results.at(2) == results.at(0));
+		// answers are cached, include not found
+		std::shared_ptr<SymbolName> cached;
+		assert(client.find(query.buildId, query.offset, cached));
+		assert(cached == results.at(0));
+		assert(client.find(unknownQuery.buildId, unknownQuery.offset, cached));
+		assert(cached == nullptr);
+		assert(!client.find(query.buildId, query.offset + 2, cached));
+		assert(client.getCacheSize() == 3);
+
+		server.stop();
+		thread.join();
+		assert(server.getResolverCount() == 1);
+		assert(server.getRequestCount() == 1);
+	}
+
+	void testLinuxRemoteSymbolServerTcp() {
+		LinuxRemoteSymbolServer server("127.0.0.1:0");
+		assert(server.getAddress().find("127.0.0.1:") == 0);
+		assert(server.getAddress() != "127.0.0.1:0");
+		assert(!server.isUsingPathHints());
+		// the file is found by build-id without the path from client
+		std::string selfPath;
+		assert(LinuxProcessUtils::readProcessExePath(::getpid(), selfPath));
+		assert(server.addFile(selfPath));
+		assert(!server.addFile("/proc/self/maps"));
+		std::thread thread([&server] { server.run(); });
+
+		auto pathAllocator = std::make_shared<SingletonAllocator<std::string, std::string>>();
+		LinuxProcessAddressLocator locator;
+		locator.reset(::getpid(), pathAllocator);
+		LinuxRemoteSymbolClient client(server.getAddress(), 2);
+		std::vector<LinuxRemoteSymbolClient::Query> queries({
+			makeQuery(client, locator, reinterpret_cast<std::uintptr_t>(&testLinuxRemoteSymbolServerTcp)) });
+		queries.at(0).path = std::make_shared<std::string>("");
+		std::vector<std::shared_ptr<SymbolName>> results;
+		for (std::size_t i = 0; i < 3; ++i) {
+			assert(client.resolve(queries, results));
+			assert(results.size() == 1);
+			assert(results.at(0) != nullptr);
+			assert(results.at(0)->getName().find(__func__) != std::string::npos);
+		}
+		assert(client.getRequestCount() == 3);
+		// cache capacity is 2
+		auto query = queries.at(0);
+		queries.clear();
+		for (std::size_t i = 0; i < 3; ++i) {
+			queries.emplace_back(query);
+			queries.back().offset += i;
+		}
+		assert(client.resolve(queries, results));
+		assert(client.getCacheSize() == 2);
+
+		server.stop();
+		thread.join();
+		assert(server.getResolverCount() == 1);
+	}
+
+	void testLinuxRemoteSymbolServerPathHints() {
+		auto pathAllocator = std::make_shared<SingletonAllocator<std::string, std::string>>();
+		LinuxProcessAddressLocator locator;
+		locator.reset(::getpid(), pathAllocator);
+		for (bool usePathHints : { false, true }) {
+			// path hints are ignored on tcp unless enabled explicitly
+			LinuxRemoteSymbolServer server("127.0.0.1:0");
+			server.setUsePathHints(usePathHints);
+			std::thread thread([&server] { server.run(); });
+			LinuxRemoteSymbolClient client(server.getAddress());
+			std::vector<LinuxRemoteSymbolClient::Query> queries({
+				makeQuery(client, locator, reinterpret_cast<std::uintptr_t>(&testLinuxRemoteSymbolServerPathHints)) });
+			std::vector<std::shared_ptr<SymbolName>> results;
+			assert(client.resolve(queries, results));
+			assert(results.size() == 1);
+			assert((results.at(0) != nullptr) == usePathHints);
+			server.stop();
+			thread.join();
+			assert(server.getResolverCount() == (usePathHints ? 1 : 0));
+		}
+	}
+
+	void testLinuxRemoteSymbolServerPipelined() {
+		LinuxRemoteSymbolServer server("127.0.0.1:0");
+		int fd = LinuxSocketUtils::connect(server.getAddress(), std::chrono::milliseconds(1000));
+		assert(fd >= 0);
+		// two empty requests in one send, the server reads one frame at a time
+		std::string request;
+		LinuxRemoteSymbolProtocol::beginFrame(request);
+		LinuxRemoteSymbolProtocol::append<std::uint32_t>(request, 0);
+		assert(LinuxRemoteSymbolProtocol::endFrame(request));
+		request += request;
+		assert(LinuxSocketUtils::sendAll(fd, request.data(), request.size()));
+		std::size_t handledCount = 0;
+		for (std::size_t i = 0; i < 100 && handledCount < 2; ++i) {
+			handledCount += server.poll(std::chrono::milliseconds(10));
+		}
+		assert(handledCount == 2);
+		std::string response;
+		for (std::size_t i = 0; i < 2; ++i) {
+			assert(LinuxRemoteSymbolProtocol::receiveFrame(fd, response));
+			assert(response.size() == sizeof(std::uint32_t));
+		}
+		// frame larger than the limit closes the connection without buffering it
+		request.assign("\0\0\0\0\xff\xff\xff\xff", LinuxRemoteSymbolProtocol::HeaderSize);
+		std::uint32_t magic = LinuxRemoteSymbolProtocol::Magic;
+		std::memcpy(&request[0], &magic, sizeof(magic));
+		assert(LinuxSocketUtils::sendAll(fd, request.data(), request.size()));
+		for (std::size_t i = 0; i < 100 && server.getConnectionCount() > 0; ++i) {
+			server.poll(std::chrono::milliseconds(10));
+		}
+		assert(server.getConnectionCount() == 0);
+		::close(fd);
+	}
+
+	void testLinuxRemoteSymbolServerUnreachable() {
+		auto path = "/tmp/LiveProfilerTestRemoteSymbolMissing-" + std::to_string(::getpid()) + ".sock";
+		LinuxRemoteSymbolClient client(path);
+		std::vector<LinuxRemoteSymbolClient::Query> queries({ LinuxRemoteSymbolClient::Query({
+			std::make_shared<std::string>("00"), std::make_shared<std::string>("/bin/true"), 0x1000 }) });
+		std::vector<std::shared_ptr<SymbolName>> results;
+		assert(!client.resolve(queries, results));
+		assert(!client.isConnected());
+		assert(results.size() == 1);
+		assert(results.at(0) == nullptr);
+		// failed queries are not cached, they will be retried
+		std::shared_ptr<SymbolName> cached;
+		assert(!client.find(queries.at(0).buildId, queries.at(0).offset, cached));
+		assert(client.getRequestCount() == 0);
+	}
+
+	void testLinuxRemoteSymbolServer() {
+		std::cout << __func__ << std::endl;
+		testLinuxRemoteSymbolServerUnixSocket();
+		testLinuxRemoteSymbolServerTcp();
+		testLinuxRemoteSymbolServerPathHints();
+		testLinuxRemoteSymbolServerPipelined();
+		testLinuxRemoteSymbolServerUnreachable();
+	}
+}
+#else // defined(__linux__)
+namespace LiveProfilerTests {
+	void testLinuxRemoteSymbolServer() {
+		// unsupported on other platform
+	}
+}
+#endif // defined(__linux__)
+
@@ -0,0 +1,97 @@
+#if defined(__linux__)
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxSymbolTable.hpp>
+
+namespace LiveProfilerTests {
+	using namespace LiveProfiler;
+
+	void testLinuxSymbolTableFind() {
+		auto path = std::make_shared<std::string>("/tmp/a.out");
+		LinuxSymbolTable symbolTable(path);
+		// append out of order, and with symbols have the same end
+		symbolTable.append(0x300, 0x400, symbolTable.appendName("c", 1));
+		symbolTable.append(0x100, 0x200, symbolTable.appendName("a", 1));
+		symbolTable.append(0x180, 0x200, symbolTable.appendName("b", 1));
+		symbolTable.sort();
+		assert(symbolTable.size() == 3);
+		assert(symbolTable.find(0x50) == LinuxSymbolTable::InvalidHandle);
+		assert(symbolTable.find(0x250) == LinuxSymbolTable::InvalidHandle);
+		assert(symbolTable.find(0x400) == LinuxSymbolTable::InvalidHandle);
+		auto a = symbolTable.find(0x100);
+		auto b = symbolTable.find(0x1ff);
+		auto c = symbolTable.find(0x3ff);
+		assert(std::string(symbolTable.getOriginalName(a)) == "a");
+		assert(std::string(symbolTable.getOriginalName(b)) == "a");
+		assert(std::string(symbolTable.getOriginalName(c)) == "c");
+		assert(symbolTable.getStart(c) == 0x300);
+		assert(symbolTable.getEnd(c) == 0x400);
+	}
+
+	void testLinuxSymbolTableFindBatch() {
+		auto path = std::make_shared<std::string>("/tmp/a.out");
+		LinuxSymbolTable symbolTable(path);
+		// more symbols than a batch, with gaps between them
+		for (std::size_t i = 0; i < 100; ++i) {
+			auto name = std::to_string(i);
+			symbolTable.append(i * 0x100, i * 0x100 + 0x80, symbolTable.appendName(name.c_str(), name.size()));
+		}
+		symbolTable.sort();
+		std::vector<std::size_t> offsets;
+		for (std::size_t offset = 0; offset < 0x6500; offset += 0x40) {
+			offsets.emplace_back(offset);
+		}
+		std::vector<LinuxSymbolTable::HandleType> handles(offsets.size());
+		symbolTable.find(offsets.data(), offsets.size(), handles.data());
+		for (std::size_t i = 0; i < offsets.size(); ++i) {
+			assert(handles[i] == symbolTable.find(offsets[i]));
+			assert((handles[i] == LinuxSymbolTable::InvalidHandle) == (offsets[i] % 0x100 >= 0x80 || offsets[i] >= 0x6400));
+		}
+	}
+
+	void testLinuxSymbolTableGetSymbolName() {
+		auto path = std::make_shared<std::string>("/tmp/a.out");
+		LinuxSymbolTable symbolTable(path);
+		symbolTable.append(0x100, 0x200, symbolTable.appendName("_Z4funcv", 8));
+		symbolTable.sort();
+		assert(symbolTable.getSymbolName(LinuxSymbolTable::InvalidHandle) == nullptr);
+		auto symbolName = symbolTable.getSymbolName(symbolTable.find(0x150));
+		assert(symbolName != nullptr);
+		assert(symbolName->getOriginalName() == "_Z4funcv");
+		assert(symbolName->getName() == "func()");
+		assert(symbolName->getPath() == path);
+		assert(symbolName->getFileOffsetStart() == 0x100);
+		assert(symbolName->getFileOffsetEnd() == 0x200);
+		// same handle should return the same instance
+		assert(symbolTable.getSymbolName(symbolTable.find(0x180)) == symbolName);
+	}
+
+	void testLinuxSymbolTableAssign() {
+		auto path = std::make_shared<std::string>("/tmp/a.out");
+		LinuxSymbolTable symbolTable(path);
+		std::string stringPool("\0abc\0", 5);
+		assert(!symbolTable.assign({ 0 }, { 1 }, { 5 }, std::string(stringPool)));
+		assert(!symbolTable.assign({ 0 }, { 1, 2 }, { 1 }, std::string(stringPool)));
+		assert(symbolTable.empty());
+		assert(symbolTable.assign({ 0 }, { 1 }, { 1 }, std::string(stringPool)));
+		assert(symbolTable.size() == 1);
+		assert(std::string(symbolTable.getOriginalName(symbolTable.find(0))) == "abc");
+	}
+
+	void testLinuxSymbolTable() {
+		std::cout << __func__ << std::endl;
+		testLinuxSymbolTableFind();
+		testLinuxSymbolTableFindBatch();
+		testLinuxSymbolTableGetSymbolName();
+		testLinuxSymbolTableAssign();
+	}
+}
+#else // defined(__linux__)
+namespace LiveProfilerTests {
+	void testLinuxSymbolTable() {
+		// unsupported on other platform
+	}
+}
+#endif // defined(__linux__)
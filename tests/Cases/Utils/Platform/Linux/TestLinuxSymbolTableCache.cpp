@@ -0,0 +1,122 @@
+#if defined(__linux__)
+#include <unistd.h>
+#include <iostream>
+#include <cassert>
+#include <fstream>
+#include <LiveProfiler/Utils/Platform/Linux/LinuxSymbolTableCache.hpp>
+
+namespace LiveProfilerTests {
+	using namespace LiveProfiler;
+
+	namespace {
+		void makeSymbolTable(LinuxSymbolTable& symbolTable, std::size_t count) {
+			for (std::size_t i = 0; i < count; ++i) {
+				auto name = "_Z5func" + std::to_string(i) + "v";
+				auto nameOffset = symbolTable.appendName(name.c_str(), name.size());
+				symbolTable.append(i * 0x10, i * 0x10 + 0x8, nameOffset);
+			}
+			symbolTable.sort();
+		}
+
+		std::string getCacheDirectory() {
+			return "/tmp/LiveProfilerTestSymbolCache-" + std::to_string(::getpid());
+		}
+
+		void removeCacheDirectory(const std::string& directory) {
+			std::unique_ptr<DIR, int(*)(DIR*)> dir(::opendir(directory.c_str()), ::closedir);
+			if (dir != nullptr) {
+				while (auto* entry = ::readdir(dir.get())) {
+					::unlink((directory + "/" + entry->d_name).c_str());
+				}
+			}
+			::rmdir(directory.c_str());
+		}
+	}
+
+	void testLinuxSymbolTableCacheGetKey() {
+		auto key = LinuxSymbolTableCache::getKey("/proc/self/exe");
+		assert(!key.empty());
+		// fallback to inode if there no build-id
+		auto path = getCacheDirectory() + ".txt";
+		{ std::ofstream file(path); file << "abc"; }
+		key = LinuxSymbolTableCache::getKey(path);
+		assert(key.find("ino-") == 0);
+		::unlink(path.c_str());
+		assert(LinuxSymbolTableCache::getKey(path).empty());
+	}
+
+	void testLinuxSymbolTableCacheStoreAndLoad() {
+		auto directory = getCacheDirectory();
+		LinuxSymbolTableCache cache(directory);
+		auto path = std::make_shared<std::string>("/tmp/a.out");
+		LinuxSymbolTable symbolTable(path);
+		makeSymbolTable(symbolTable, 100);
+		LinuxSymbolTable loaded(path);
+		assert(!cache.load("0123abcd", loaded));
+		assert(cache.store("0123abcd", symbolTable));
+		assert(cache.load("0123abcd", loaded));
+		assert(loaded.size() == symbolTable.size());
+		for (LinuxSymbolTable::HandleType i = 0; i < loaded.size(); ++i) {
+			assert(std::string(loaded.getOriginalName(i)) == symbolTable.getOriginalName(i));
+			assert(loaded.getStart(i) == symbolTable.getStart(i));
+			assert(loaded.getEnd(i) == symbolTable.getEnd(i));
+		}
+		auto symbolName = loaded.getSymbolName(loaded.find(0x15));
+		assert(symbolName != nullptr);
+		assert(symbolName->getPath() == path);
+		assert(symbolName->getName() == "func1()");
+		// corrupted file should be ignored
+		{
+			std::ofstream file(directory + "/corrupted.symtab");
+			file << "LPSYMTAB but corrupted";
+		}
+		assert(!cache.load("corrupted", loaded));
+		assert(loaded.size() == symbolTable.size());
+		removeCacheDirectory(directory);
+	}
+
+	void testLinuxSymbolTableCacheEvict() {
+		auto directory = getCacheDirectory();
+		auto path = std::make_shared<std::string>("/tmp/a.out");
+		LinuxSymbolTable symbolTable(path);
+		makeSymbolTable(symbolTable, 100);
+		// measure the file size
+		std::size_t fileSize = 0;
+		{
+			LinuxSymbolTableCache cache(directory);
+			assert(cache.store("measure", symbolTable));
+			struct ::stat fileStat = {};
+			assert(::stat((directory + "/measure.symtab").c_str(), &fileStat) == 0);
+			fileSize = static_cast<std::size_t>(fileStat.st_size);
+			removeCacheDirectory(directory);
+		}
+		// keep at most 2 files, least recently used file should be evicted
+		LinuxSymbolTable loaded(path);
+		LinuxSymbolTableCache cache(directory, fileSize * 2);
+		assert(cache.store("a", symbolTable));
+		::usleep(10000);
+		assert(cache.store("b", symbolTable));
+		::usleep(10000);
+		assert(cache.load("a", loaded));
+		::usleep(10000);
+		assert(cache.store("c", symbolTable));
+		assert(cache.load("a", loaded));
+		assert(!cache.load("b", loaded));
+		assert(cache.load("c", loaded));
+		removeCacheDirectory(directory);
+	}
+
+	void testLinuxSymbolTableCache() {
+		std::cout << __func__ << std::endl;
+		testLinuxSymbolTableCacheGetKey();
+		testLinuxSymbolTableCacheStoreAndLoad();
+		testLinuxSymbolTableCacheEvict();
+	}
+}
+#else // defined(__linux__)
+namespace LiveProfilerTests {
+	void testLinuxSymbolTableCache() {
+		// unsupported on other platform
+	}
+}
+#endif // defined(__linux__)
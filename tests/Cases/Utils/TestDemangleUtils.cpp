@@ -0,0 +1,49 @@
+#include <iostream>
+#include <cassert>
+#include <LiveProfiler/Utils/DemangleUtils.hpp>
+#include <LiveProfiler/Models/Shared/SymbolName.hpp>
+
+namespace LiveProfilerTests {
+	using namespace LiveProfiler;
+
+	void testDemangleUtilsDemangle() {
+		assert(*DemangleUtils::demangle("_Z4funcv") == "func()");
+		assert(*DemangleUtils::demangle("_ZNSt6vectorIiSaIiEE9push_backERKi@@Base") ==
+			"std::vector<int, std::allocator<int> >::push_back(int const&)@@Base");
+		assert(DemangleUtils::demangle("main")->empty());
+		assert(DemangleUtils::demangle("i")->empty());
+		assert(DemangleUtils::demangle("_Zinvalid")->empty());
+		// same name should be demangled once and shared
+		auto a = DemangleUtils::demangle("_Z4funcv");
+		auto b = DemangleUtils::demangle(std::string("_Z4funcv"));
+		assert(a == b);
+		assert(DemangleUtils::getCacheSize() > 0);
+		DemangleUtils::clearCache();
+		assert(DemangleUtils::getCacheSize() == 0);
+		assert(*a == "func()");
+	}
+
+	void testDemangleUtilsLazySymbolName() {
+		SymbolName symbolName("_Z4funcv", nullptr);
+		assert(!symbolName.isDemangled());
+		assert(symbolName.getName() == "func()");
+		assert(symbolName.isDemangled());
+		assert(symbolName.getDemangleName() == "func()");
+		// explicit demangle name should not be overwritten
+		symbolName.setDemangleName("");
+		assert(symbolName.getName() == "_Z4funcv");
+		// changing original name should demangle again
+		symbolName.setOriginalName("_Z4funci");
+		assert(symbolName.getName() == "func(int)");
+		SymbolName plainName("main", nullptr);
+		assert(plainName.getName() == "main");
+		assert(plainName.getDemangleName().empty());
+	}
+
+	void testDemangleUtils() {
+		std::cout << __func__ << std::endl;
+		testDemangleUtilsDemangle();
+		testDemangleUtilsLazySymbolName();
+	}
+}
+
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <cassert>
 #include <limits>
+#include <cstring>
 #include <LiveProfiler/Utils/TypeConvertUtils.hpp>
 
 namespace LiveProfilerTests {
@@ -36,6 +37,25 @@ namespace LiveProfilerTests {
 		}
 	}
 
+	void testTypeConvertUtilsHexToUnsignedLongLong() {
+		unsigned long long result = 0;
+		const char* str = "ffffffffc012340d t";
+		auto end = TypeConvertUtils::hexToUnsignedLongLong(str, str + std::strlen(str), result);
+		assert(end == str + 16);
+		assert(result == 0xffffffffc012340dULL);
+		str = "7F00aB-";
+		end = TypeConvertUtils::hexToUnsignedLongLong(str, str + 7, result);
+		assert(end == str + 6);
+		assert(result == 0x7f00ab);
+		// stop at the end even if there more digits
+		end = TypeConvertUtils::hexToUnsignedLongLong(str, str + 2, result);
+		assert(end == str + 2);
+		assert(result == 0x7f);
+		end = TypeConvertUtils::hexToUnsignedLongLong(str + 6, str + 7, result);
+		assert(end == str + 6);
+		assert(result == 0);
+	}
+
 	void testTypeConvertUtilsLongLongToStr() {
 		std::array<char, 100> buf;
 		assert(TypeConvertUtils::longLongToStr(buf.data(), buf.size(), 123) == 3);
@@ -54,6 +74,7 @@ namespace LiveProfilerTests {
 		std::cout << __func__ << std::endl;
 		testTypeConvertUtilsStrToLongLong();
 		testTypeConvertUtilsStrToUnsignedLongLong();
+		testTypeConvertUtilsHexToUnsignedLongLong();
 		testTypeConvertUtilsLongLongToStr();
 	}
 }
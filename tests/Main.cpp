@@ -5,14 +5,36 @@
 #include "./Cases/Profiler/TestProfiler.hpp"
 #include "./Cases/Utils/Allocators/TestFreeListAllocator.hpp"
 #include "./Cases/Utils/Allocators/TestSingletonAllocator.hpp"
+#include "./Cases/Utils/Containers/TestAddressCache.hpp"
+#include "./Cases/Utils/Containers/TestLruCache.hpp"
+#include "./Cases/Utils/Containers/TestSpscQueue.hpp"
 #include "./Cases/Utils/Containers/TestStackBuffer.hpp"
+#include "./Cases/Utils/Containers/TestStaticSearchTree.hpp"
+#include "./Cases/Utils/Platform/Linux/TestLinuxCgroupUtils.hpp"
+#include "./Cases/Utils/Platform/Linux/TestLinuxCpuUtils.hpp"
+#include "./Cases/Utils/Platform/Linux/TestLinuxDwarfLineIndex.hpp"
+#include "./Cases/Utils/Platform/Linux/TestLinuxEhFrameUtils.hpp"
+#include "./Cases/Utils/Platform/Linux/TestLinuxElfFile.hpp"
+#include "./Cases/Utils/Platform/Linux/TestLinuxElfUtils.hpp"
 #include "./Cases/Utils/Platform/Linux/TestLinuxEpollDescriptor.hpp"
 #include "./Cases/Utils/Platform/Linux/TestLinuxExecutableSymbolResolver.hpp"
+#include "./Cases/Utils/Platform/Linux/TestLinuxExecutableSymbolResolverAllocator.hpp"
+#include "./Cases/Utils/Platform/Linux/TestLinuxExecutableSymbolResolverLoader.hpp"
+#include "./Cases/Utils/Platform/Linux/TestLinuxFileUtils.hpp"
+#include "./Cases/Utils/Platform/Linux/TestLinuxJitDumpReader.hpp"
+#include "./Cases/Utils/Platform/Linux/TestLinuxKernelSymbolResolver.hpp"
+#include "./Cases/Utils/Platform/Linux/TestLinuxPerfMapIndex.hpp"
 #include "./Cases/Utils/Platform/Linux/TestLinuxPerfUtils.hpp"
+#include "./Cases/Utils/Platform/Linux/TestLinuxProcConnector.hpp"
 #include "./Cases/Utils/Platform/Linux/TestLinuxProcessAddressLocator.hpp"
 #include "./Cases/Utils/Platform/Linux/TestLinuxProcessAddressMap.hpp"
 #include "./Cases/Utils/Platform/Linux/TestLinuxProcessCustomSymbolResolver.hpp"
+#include "./Cases/Utils/Platform/Linux/TestLinuxProcessFilter.hpp"
 #include "./Cases/Utils/Platform/Linux/TestLinuxProcessUtils.hpp"
+#include "./Cases/Utils/Platform/Linux/TestLinuxRemoteSymbolServer.hpp"
+#include "./Cases/Utils/Platform/Linux/TestLinuxSymbolTable.hpp"
+#include "./Cases/Utils/Platform/Linux/TestLinuxSymbolTableCache.hpp"
+#include "./Cases/Utils/TestDemangleUtils.hpp"
 #include "./Cases/Utils/TestStringUtils.hpp"
 #include "./Cases/Utils/TestTypeConvertUtils.hpp"
 
@@ -25,14 +47,36 @@ namespace LiveProfilerTests {
 		testProfiler();
 		testFreeListAllocator();
 		testSingletonAllocator();
+		testAddressCache();
+		testLruCache();
+		testSpscQueue();
 		testStackBuffer();
+		testStaticSearchTree();
+		testLinuxCgroupUtils();
+		testLinuxCpuUtils();
+		testLinuxDwarfLineIndex();
+		testLinuxEhFrameUtils();
+		testLinuxElfFile();
+		testLinuxElfUtils();
 		testLinuxEpollDescriptor();
 		testLinuxExecutableSymbolResolver();
+		testLinuxExecutableSymbolResolverAllocator();
+		testLinuxExecutableSymbolResolverLoader();
+		testLinuxFileUtils();
+		testLinuxJitDumpReader();
+		testLinuxKernelSymbolResolver();
+		testLinuxPerfMapIndex();
 		testLinuxPerfUtils();
+		testLinuxProcConnector();
 		testLinuxProcessAddressLocator();
 		testLinuxProcessAddressMap();
 		testLinuxProcessCustomSymbolResolver();
+		testLinuxProcessFilter();
 		testLinuxProcessUtils();
+		testLinuxRemoteSymbolServer();
+		testLinuxSymbolTable();
+		testLinuxSymbolTableCache();
+		testDemangleUtils();
 		testStringUtils();
 		testTypeConvertUtils();
 	}